@@ -34,6 +34,7 @@
 #include <QReadWriteLock>
 #include <QMutex>
 #include <QAtomicInt>
+#include <QQueue>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -55,6 +56,8 @@ namespace OsmAnd {
 
             const std::unique_ptr<QThreadPool> localStorage;
             const std::unique_ptr<QThreadPool> network;
+            const std::unique_ptr<QThreadPool> obfReading;
+            const std::unique_ptr<QThreadPool> routing;
         };
         const extern OSMAND_CORE_API std::shared_ptr<Pools> pools;
 
@@ -153,6 +156,72 @@ namespace OsmAnd {
 
             const ThreadProcedureSignature threadProcedure;
         };
+
+        // Queue of limited capacity that connects stages of processing pipeline: producers are blocked while queue
+        // is full, consumers are blocked while it's empty. After queue was closed, producers are rejected and
+        // consumers receive remaining items only
+        template<typename T>
+        class BoundedQueue
+        {
+            Q_DISABLE_COPY(BoundedQueue);
+        private:
+            QQueue<T> _items;
+            bool _isClosed;
+            mutable QMutex _mutex;
+            QWaitCondition _notFullCondition;
+            QWaitCondition _notEmptyCondition;
+        protected:
+        public:
+            BoundedQueue(const int capacity_)
+                : _isClosed(false)
+                , capacity(capacity_)
+            {
+            }
+            ~BoundedQueue()
+            {
+            }
+
+            const int capacity;
+
+            // Returns false if queue was closed
+            bool enqueue(const T& item)
+            {
+                QMutexLocker scopedLocker(&_mutex);
+
+                while(!_isClosed && _items.size() >= capacity)
+                    _notFullCondition.wait(&_mutex);
+                if(_isClosed)
+                    return false;
+
+                _items.enqueue(item);
+                _notEmptyCondition.wakeOne();
+                return true;
+            }
+
+            // Returns false if queue was closed and no items left
+            bool dequeue(T& outItem)
+            {
+                QMutexLocker scopedLocker(&_mutex);
+
+                while(!_isClosed && _items.isEmpty())
+                    _notEmptyCondition.wait(&_mutex);
+                if(_items.isEmpty())
+                    return false;
+
+                outItem = _items.dequeue();
+                _notFullCondition.wakeOne();
+                return true;
+            }
+
+            void close()
+            {
+                QMutexLocker scopedLocker(&_mutex);
+
+                _isClosed = true;
+                _notFullCondition.wakeAll();
+                _notEmptyCondition.wakeAll();
+            }
+        };
     } // namespace Concurrent
 
 } // namespace OsmAnd
@@ -45,20 +45,241 @@ namespace OsmAnd {
 
     namespace Model {
 
+        class MapObjectsBlock;
+
         class OSMAND_CORE_API MapObject
         {
+        public:
+            // Range of elements inside storage of map objects block
+            struct Range
+            {
+                Range()
+                    : offset(0)
+                    , count(0)
+                {
+                }
+
+                int offset;
+                int count;
+            };
+
+            // Name of map object: rule id of name tag and index in string table of map objects block
+            struct NameEntry
+            {
+                uint32_t ruleId;
+                uint32_t stringId;
+            };
+
+            // Read-only view over contiguous points
+            class PointsView
+            {
+            public:
+                typedef const PointI* const_iterator;
+
+                PointsView()
+                    : _data(nullptr)
+                    , _size(0)
+                {
+                }
+
+                PointsView(const PointI* data, const int size)
+                    : _data(data)
+                    , _size(size)
+                {
+                }
+
+                inline int size() const { return _size; }
+                inline int count() const { return _size; }
+                inline bool isEmpty() const { return _size == 0; }
+                inline const PointI* constData() const { return _data; }
+                inline const PointI& operator[](const int index) const { return _data[index]; }
+                inline const PointI& first() const { return _data[0]; }
+                inline const PointI& last() const { return _data[_size - 1]; }
+                inline const_iterator cbegin() const { return _data; }
+                inline const_iterator cend() const { return _data + _size; }
+                inline const_iterator begin() const { return cbegin(); }
+                inline const_iterator end() const { return cend(); }
+            private:
+                const PointI* _data;
+                int _size;
+            };
+
+            // Read-only view over inner polygons, each of them is a view over points
+            class InnerPolygonsView
+            {
+            public:
+                class const_iterator
+                {
+                public:
+                    const_iterator(const PointI* points, const Range* range)
+                        : _points(points)
+                        , _range(range)
+                    {
+                    }
+
+                    inline PointsView operator*() const { return PointsView(_points + _range->offset, _range->count); }
+                    inline const_iterator& operator++() { ++_range; return *this; }
+                    inline bool operator==(const const_iterator& other) const { return _range == other._range; }
+                    inline bool operator!=(const const_iterator& other) const { return _range != other._range; }
+                private:
+                    const PointI* _points;
+                    const Range* _range;
+                };
+
+                InnerPolygonsView()
+                    : _points(nullptr)
+                    , _ranges(nullptr)
+                    , _size(0)
+                {
+                }
+
+                InnerPolygonsView(const PointI* points, const Range* ranges, const int size)
+                    : _points(points)
+                    , _ranges(ranges)
+                    , _size(size)
+                {
+                }
+
+                inline int size() const { return _size; }
+                inline int count() const { return _size; }
+                inline bool isEmpty() const { return _size == 0; }
+                inline PointsView operator[](const int index) const { return *const_iterator(_points, _ranges + index); }
+                inline const_iterator cbegin() const { return const_iterator(_points, _ranges); }
+                inline const_iterator cend() const { return const_iterator(_points, _ranges + _size); }
+                inline const_iterator begin() const { return cbegin(); }
+                inline const_iterator end() const { return cend(); }
+            private:
+                const PointI* _points;
+                const Range* _ranges;
+                int _size;
+            };
+
+            // Read-only view over rule ids, that are resolved to tag-value pairs using decoding table of section
+            class TypesView
+            {
+            public:
+                class const_iterator
+                {
+                public:
+                    const_iterator(const uint32_t* ruleId, const TagValue* decodingRules)
+                        : _ruleId(ruleId)
+                        , _decodingRules(decodingRules)
+                    {
+                    }
+
+                    inline uint32_t ruleId() const { return *_ruleId; }
+                    inline const TagValue& operator*() const { return _decodingRules[*_ruleId]; }
+                    inline const TagValue* operator->() const { return &_decodingRules[*_ruleId]; }
+                    inline const_iterator& operator++() { ++_ruleId; return *this; }
+                    inline bool operator==(const const_iterator& other) const { return _ruleId == other._ruleId; }
+                    inline bool operator!=(const const_iterator& other) const { return _ruleId != other._ruleId; }
+                private:
+                    const uint32_t* _ruleId;
+                    const TagValue* _decodingRules;
+                };
+
+                TypesView()
+                    : _rulesIds(nullptr)
+                    , _size(0)
+                    , _decodingRules(nullptr)
+                {
+                }
+
+                TypesView(const uint32_t* rulesIds, const int size, const TagValue* decodingRules)
+                    : _rulesIds(rulesIds)
+                    , _size(size)
+                    , _decodingRules(decodingRules)
+                {
+                }
+
+                inline int size() const { return _size; }
+                inline int count() const { return _size; }
+                inline bool isEmpty() const { return _size == 0; }
+                inline uint32_t ruleId(const int index) const { return _rulesIds[index]; }
+                inline const TagValue& operator[](const int index) const { return _decodingRules[_rulesIds[index]]; }
+                inline const_iterator cbegin() const { return const_iterator(_rulesIds, _decodingRules); }
+                inline const_iterator cend() const { return const_iterator(_rulesIds + _size, _decodingRules); }
+                inline const_iterator begin() const { return cbegin(); }
+                inline const_iterator end() const { return cend(); }
+            private:
+                const uint32_t* _rulesIds;
+                int _size;
+                const TagValue* _decodingRules;
+            };
+
+            // Read-only view over names, iterated like QHash of name tag to name value
+            class NamesView
+            {
+            public:
+                class const_iterator
+                {
+                public:
+                    const_iterator(const NameEntry* entry, const TagValue* decodingRules, const QString* stringTable)
+                        : _entry(entry)
+                        , _decodingRules(decodingRules)
+                        , _stringTable(stringTable)
+                    {
+                    }
+
+                    inline const QString& key() const { return _decodingRules[_entry->ruleId].tag; }
+                    inline const QString& value() const { return _stringTable[_entry->stringId]; }
+                    inline const QString& operator*() const { return value(); }
+                    inline const_iterator& operator++() { ++_entry; return *this; }
+                    inline bool operator==(const const_iterator& other) const { return _entry == other._entry; }
+                    inline bool operator!=(const const_iterator& other) const { return _entry != other._entry; }
+                private:
+                    const NameEntry* _entry;
+                    const TagValue* _decodingRules;
+                    const QString* _stringTable;
+                };
+
+                NamesView()
+                    : _entries(nullptr)
+                    , _size(0)
+                    , _decodingRules(nullptr)
+                    , _stringTable(nullptr)
+                {
+                }
+
+                NamesView(const NameEntry* entries, const int size, const TagValue* decodingRules, const QString* stringTable)
+                    : _entries(entries)
+                    , _size(size)
+                    , _decodingRules(decodingRules)
+                    , _stringTable(stringTable)
+                {
+                }
+
+                inline int size() const { return _size; }
+                inline int count() const { return _size; }
+                inline bool isEmpty() const { return _size == 0; }
+                inline const_iterator cbegin() const { return const_iterator(_entries, _decodingRules, _stringTable); }
+                inline const_iterator cend() const { return const_iterator(_entries + _size, _decodingRules, _stringTable); }
+                inline const_iterator begin() const { return cbegin(); }
+                inline const_iterator end() const { return cend(); }
+
+                QString value(const QString& key, const QString& defaultValue = QString()) const;
+            private:
+                const NameEntry* _entries;
+                int _size;
+                const TagValue* _decodingRules;
+                const QString* _stringTable;
+            };
         private:
         protected:
-            MapObject(const std::shared_ptr<const ObfMapSectionInfo>& section, const std::shared_ptr<const ObfMapSectionLevel>& level);
+            MapObject(const std::shared_ptr<const ObfMapSectionInfo>& section, const std::shared_ptr<const ObfMapSectionLevel>& level,
+                const std::shared_ptr<const MapObjectsBlock>& block);
+
+            // Storage that actually holds data of this map object
+            const std::shared_ptr<const MapObjectsBlock> _block;
 
             uint64_t _id;
             MapFoundationType _foundation;
             bool _isArea;
-            QVector< PointI > _points31;
-            QList< QVector< PointI > > _innerPolygonsPoints31;
-            QVector< TagValue > _types;
-            QVector< TagValue > _extraTypes;
-            QHash< QString, QString > _names;
+            PointsView _points31;
+            InnerPolygonsView _innerPolygonsPoints31;
+            TypesView _types;
+            TypesView _extraTypes;
+            NamesView _names;
             AreaI _bbox31;
         public:
             virtual ~MapObject();
@@ -68,12 +289,12 @@ namespace OsmAnd {
 
             const uint64_t& id;
             const bool& isArea;
-            const QVector< PointI >& points31;
-            const QList< QVector< PointI > >& innerPolygonsPoints31;
-            const QVector< TagValue >& types;
-            const QVector< TagValue >& extraTypes;
+            const PointsView& points31;
+            const InnerPolygonsView& innerPolygonsPoints31;
+            const TypesView& types;
+            const TypesView& extraTypes;
             const MapFoundationType& foundation;
-            const QHash<QString, QString>& names;
+            const NamesView& names;
             const AreaI& bbox31;
 
             int getSimpleLayerValue() const;
@@ -88,6 +309,7 @@ namespace OsmAnd {
 
             friend class OsmAnd::ObfMapSectionReader_P;
             friend class OsmAnd::Rasterizer_P;
+            friend class OsmAnd::Model::MapObjectsBlock;
         };
 
     } // namespace Model
@@ -24,6 +24,7 @@
 #define __MODEL_STREET_H_
 
 #include <cstdint>
+#include <memory>
 
 #include <QString>
 
@@ -36,6 +37,8 @@ namespace OsmAnd {
 
     namespace Model {
 
+        class StreetGroup;
+
         class OSMAND_CORE_API Street
         {
         private:
@@ -45,6 +48,7 @@ namespace OsmAnd {
             QString _latinName;
             PointI _tile24;
             uint32_t _offset;
+            std::shared_ptr<const StreetGroup> _group;
 
             Street();
         public:
@@ -54,6 +58,7 @@ namespace OsmAnd {
             const QString& name;
             const QString& latinName;
             const PointI& tile24;
+            const std::shared_ptr<const StreetGroup>& group;
 
         friend class OsmAnd::ObfAddressSectionReader_P;
         };
@@ -0,0 +1,80 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __MODEL_TRANSPORT_ROUTE_H_
+#define __MODEL_TRANSPORT_ROUTE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QString>
+#include <QList>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Data/Model/TransportStop.h>
+
+namespace OsmAnd {
+
+    class ObfTransportSectionReader_P;
+
+    namespace Model {
+
+        class OSMAND_CORE_API TransportRoute
+        {
+        private:
+        protected:
+            TransportRoute();
+
+            uint64_t _id;
+            uint32_t _offset;
+            QString _type;
+            QString _operatorName;
+            QString _ref;
+            QString _name;
+            QString _latinName;
+            uint32_t _distance;
+            QList< std::shared_ptr<const TransportStop> > _forwardStops;
+            QList< std::shared_ptr<const TransportStop> > _backwardStops;
+        public:
+            virtual ~TransportRoute();
+
+            const uint64_t& id;
+            const uint32_t& offset;
+            const QString& type;
+            const QString& operatorName;
+            const QString& ref;
+            const QString& name;
+            const QString& latinName;
+            // Length of route in meters
+            const uint32_t& distance;
+            const QList< std::shared_ptr<const TransportStop> >& forwardStops;
+            const QList< std::shared_ptr<const TransportStop> >& backwardStops;
+
+        friend class OsmAnd::ObfTransportSectionReader_P;
+        };
+
+    } // namespace Model
+
+} // namespace OsmAnd
+
+#endif // __MODEL_TRANSPORT_ROUTE_H_
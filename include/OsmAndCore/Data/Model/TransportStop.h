@@ -0,0 +1,72 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __MODEL_TRANSPORT_STOP_H_
+#define __MODEL_TRANSPORT_STOP_H_
+
+#include <cstdint>
+
+#include <QString>
+#include <QVector>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+namespace OsmAnd {
+
+    class ObfTransportSectionReader_P;
+
+    namespace Model {
+
+        class OSMAND_CORE_API TransportStop
+        {
+        private:
+        protected:
+            TransportStop();
+
+            uint64_t _id;
+            uint32_t _offset;
+            PointI _point31;
+            QString _name;
+            QString _latinName;
+            QVector<uint32_t> _routesOffsets;
+        public:
+            virtual ~TransportStop();
+
+            const uint64_t& id;
+            // Offset of stop in file, or 0 for stops read as part of route
+            const uint32_t& offset;
+            const PointI& point31;
+            const QString& name;
+            const QString& latinName;
+            // Offsets of routes that pass this stop, to be loaded by ObfTransportSectionReader::loadTransportRoutes()
+            const QVector<uint32_t>& routesOffsets;
+
+        friend class OsmAnd::ObfTransportSectionReader_P;
+        };
+
+    } // namespace Model
+
+} // namespace OsmAnd
+
+#endif // __MODEL_TRANSPORT_STOP_H_
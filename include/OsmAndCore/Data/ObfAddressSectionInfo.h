@@ -52,10 +52,12 @@ namespace OsmAnd {
 
     class ObfAddressBlocksSectionInfo;
 
+    class ObfAddressSectionInfo_P;
     class OSMAND_CORE_API ObfAddressSectionInfo : public ObfSectionInfo
     {
         Q_DISABLE_COPY(ObfAddressSectionInfo)
     private:
+        const std::unique_ptr<ObfAddressSectionInfo_P> _d;
     protected:
         ObfAddressSectionInfo(const std::weak_ptr<ObfInfo>& owner);
 
@@ -29,6 +29,7 @@
 
 #include <QList>
 #include <QSet>
+#include <QString>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -73,6 +74,21 @@ namespace OsmAnd {
             QList< std::shared_ptr<const Model::StreetIntersection> >* resultOut = nullptr,
             std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetIntersection>&)> visitor = nullptr,
             const IQueryController* const controller = nullptr);
+
+        // Finds cities, villages and postcodes which name has a word starting with query, using name index of section
+        static void findStreetGroupsByName(const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+            const QString& query,
+            QList< std::shared_ptr<const Model::StreetGroup> >* resultOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetGroup>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr,
+            QSet<ObfAddressBlockType>* blockTypeFilter = nullptr);
+
+        // Same as findStreetGroupsByName(), but for streets. Each street refers to group it belongs to
+        static void findStreetsByName(const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+            const QString& query,
+            QList< std::shared_ptr<const Model::Street> >* resultOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::Street>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr);
     };
 
 } // namespace OsmAnd
@@ -28,6 +28,7 @@
 #include <functional>
 
 #include <QList>
+#include <QString>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -42,6 +43,9 @@ namespace OsmAnd {
     class ObfMapSectionInfo;
     namespace Model {
         class MapObject;
+        class Amenity;
+        class StreetGroup;
+        class Street;
     } // namespace Model
     class IQueryController;
 
@@ -52,7 +56,7 @@ namespace OsmAnd {
     private:
         const std::unique_ptr<ObfDataInterface_P> _d;
     protected:
-        ObfDataInterface(const QList< std::shared_ptr<ObfReader> >& readers);
+        ObfDataInterface(const QList< std::shared_ptr<ObfReader> >& readers, const bool parallelReading = false);
     public:
         virtual ~ObfDataInterface();
 
@@ -61,6 +65,27 @@ namespace OsmAnd {
         void obtainMapObjects(QList< std::shared_ptr<const OsmAnd::Model::MapObject> >* resultOut, MapFoundationType* foundationOut,
             const AreaI& area31, const ZoomLevel zoom,
             const IQueryController* const controller = nullptr, std::function<bool (const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t)> filterById = nullptr);
+
+        struct OSMAND_CORE_API SearchResult
+        {
+            SearchResult();
+
+            // Only one of these is set
+            std::shared_ptr<const OsmAnd::Model::Amenity> amenity;
+            std::shared_ptr<const OsmAnd::Model::StreetGroup> streetGroup;
+            std::shared_ptr<const OsmAnd::Model::Street> street;
+
+            PointI location31;
+            double distance;
+            // 1 if query matches beginning of some word of name, 2 if beginning of name, 3 if whole name
+            int nameScore;
+        };
+
+        // Searches amenities, street groups and streets by name in POI and address sections of all files. Only
+        // maxResultsCount best results are kept, ordered by distance divided by name score. Search stops once
+        // that many results match whole name
+        void searchByName(const QString& query, const PointI& location31, const int maxResultsCount,
+            QList<SearchResult>* resultOut, const IQueryController* const controller = nullptr);
         
     friend class OsmAnd::ObfsCollection;
     };
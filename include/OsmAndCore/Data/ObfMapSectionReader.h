@@ -55,6 +55,10 @@ namespace OsmAnd {
             std::function<bool (const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t)> filterById = nullptr,
             std::function<bool (const std::shared_ptr<const OsmAnd::Model::MapObject>&)> visitor = nullptr,
             const IQueryController* const controller = nullptr);
+
+        // Maximal amount of memory (in bytes) used by decoded map tree nodes of all sections
+        static void setTreeNodesCacheBudget(const size_t budget);
+        static size_t getTreeNodesCacheBudget();
     };
 
 } // namespace OsmAnd
@@ -35,10 +35,12 @@ namespace OsmAnd {
     class ObfPoiSectionReader_P;
     class ObfReader_P;
 
+    class ObfPoiSectionInfo_P;
     class OSMAND_CORE_API ObfPoiSectionInfo : public ObfSectionInfo
     {
         Q_DISABLE_COPY(ObfPoiSectionInfo)
     private:
+        const std::unique_ptr<ObfPoiSectionInfo_P> _d;
     protected:
         ObfPoiSectionInfo(const std::weak_ptr<ObfInfo>& owner);
 
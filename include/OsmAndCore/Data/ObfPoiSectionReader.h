@@ -56,6 +56,15 @@ namespace OsmAnd {
             QList< std::shared_ptr<const OsmAnd::Model::Amenity> >* amenitiesOut = nullptr,
             std::function<bool (const std::shared_ptr<const OsmAnd::Model::Amenity>&)> visitor = nullptr,
             const IQueryController* const controller = nullptr);
+
+        // Finds amenities which name (or latin name) has a word starting with query, using name index of section.
+        // Amenities are reported in order of increasing distance from location31
+        static void searchAmenitiesByName(const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const OsmAnd::ObfPoiSectionInfo>& section,
+            const QString& query, const PointI& location31, const AreaI* bbox31 = nullptr,
+            QSet<uint32_t>* desiredCategories = nullptr,
+            QList< std::shared_ptr<const OsmAnd::Model::Amenity> >* amenitiesOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::Amenity>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr);
     };
 
 } // namespace OsmAnd
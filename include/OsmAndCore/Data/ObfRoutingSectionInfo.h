@@ -44,6 +44,7 @@ namespace OsmAnd {
     class RoutePlanner;
     class RoutePlannerContext;
     class RoutingRulesetContext;
+    class RoutingSubsectionData;
 
     class ObfRoutingSectionInfo_P;
     class OSMAND_CORE_API ObfRoutingSectionInfo : public ObfSectionInfo
@@ -68,6 +69,7 @@ namespace OsmAnd {
     friend class OsmAnd::RoutePlanner;
     friend class OsmAnd::RoutePlannerContext;
     friend class OsmAnd::RoutingRulesetContext;
+    friend class OsmAnd::RoutingSubsectionData;
     };
 
     class OSMAND_CORE_API ObfRoutingSubsectionInfo : public ObfSectionInfo
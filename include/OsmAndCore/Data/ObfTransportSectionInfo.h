@@ -35,10 +35,12 @@ namespace OsmAnd {
     class ObfTransportSectionReader_P;
     class ObfReader_P;
 
+    class ObfTransportSectionInfo_P;
     class OSMAND_CORE_API ObfTransportSectionInfo : public ObfSectionInfo
     {
         Q_DISABLE_COPY(ObfTransportSectionInfo)
     private:
+        const std::unique_ptr<ObfTransportSectionInfo_P> _d;
     protected:
         ObfTransportSectionInfo(const std::weak_ptr<ObfInfo>& owner);
 
@@ -46,6 +48,9 @@ namespace OsmAnd {
 
         uint32_t _stopsOffset;
         uint32_t _stopsLength;
+
+        uint32_t _stringTableOffset;
+        uint32_t _stringTableLength;
     public:
         virtual ~ObfTransportSectionInfo();
 
@@ -27,6 +27,9 @@
 #include <memory>
 #include <functional>
 
+#include <QList>
+#include <QVector>
+
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 
@@ -34,6 +37,10 @@ namespace OsmAnd {
 
     class ObfReader;
     class ObfTransportSectionInfo;
+    namespace Model {
+        class TransportStop;
+        class TransportRoute;
+    } // namespace Model
     class IQueryController;
 
     class OSMAND_CORE_API ObfTransportSectionReader
@@ -43,6 +50,18 @@ namespace OsmAnd {
         ~ObfTransportSectionReader();
     protected:
     public:
+        // Loads stops inside bounding box (or all stops of section). Routes of stops are not loaded
+        static void loadTransportStops(const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const OsmAnd::ObfTransportSectionInfo>& section,
+            const AreaI* bbox31 = nullptr,
+            QList< std::shared_ptr<const OsmAnd::Model::TransportStop> >* resultOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::TransportStop>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr);
+
+        // Loads routes by offsets taken from TransportStop::routesOffsets, in same order
+        static void loadTransportRoutes(const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const OsmAnd::ObfTransportSectionInfo>& section,
+            const QVector<uint32_t>& routesOffsets,
+            QList< std::shared_ptr<const OsmAnd::Model::TransportRoute> >* resultOut = nullptr,
+            const IQueryController* const controller = nullptr);
     };
 
 } // namespace OsmAnd
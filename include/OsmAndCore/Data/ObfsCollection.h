@@ -52,6 +52,14 @@ namespace OsmAnd {
         void registerExplicitFile(const QFileInfo& fileInfo);
         void registerExplicitFile(const QString& filePath);
 
+        // Maximal number of idle readers kept per OBF file for reuse by obtainDataInterface()
+        void setReadersPoolCapacity(const unsigned int capacity);
+        unsigned int getReadersPoolCapacity() const;
+
+        // Allows data interfaces to read several OBF files concurrently
+        void setParallelReadingEnabled(const bool enabled);
+        bool isParallelReadingEnabled() const;
+
         std::shared_ptr<ObfDataInterface> obtainDataInterface() const;
     };
 
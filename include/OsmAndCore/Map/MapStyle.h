@@ -80,6 +80,7 @@ namespace OsmAnd {
         static const MapStyleBuiltinValueDefinitions builtinValueDefinitions;
         bool resolveValueDefinition(const QString& name, std::shared_ptr<const MapStyleValueDefinition>& outDefinition) const;
         bool resolveAttribute(const QString& name, std::shared_ptr<const MapStyleRule>& outAttribute) const;
+        bool lookupStringId(const QString& value, uint32_t& outId) const;
 
         void dump(const QString& prefix = QString()) const;
         void dump(MapStyleRulesetType type, const QString& prefix = QString()) const;
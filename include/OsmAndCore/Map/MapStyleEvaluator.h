@@ -40,6 +40,8 @@ namespace OsmAnd {
     class MapStyleValueDefinition;
     struct MapStyleValue;
 
+    class MapStyleEvaluationCache;
+
     class MapStyleEvaluator_P;
     class OSMAND_CORE_API MapStyleEvaluator
     {
@@ -56,7 +58,7 @@ namespace OsmAnd {
 
         const std::shared_ptr<const MapStyle> style;
         const float displayDensityFactor;
-        const std::shared_ptr<const Model::MapObject> mapObject;
+        const std::shared_ptr<const Model::MapObject>& mapObject;
         const MapStyleRulesetType ruleset;
         const std::shared_ptr<const MapStyleRule> singleRule;
 
@@ -66,6 +68,8 @@ namespace OsmAnd {
         void setIntegerValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, const unsigned int value);
         void setFloatValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, const float value);
         void setStringValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, const QString& value);
+        // Sets string value by id resolved earlier using MapStyle::lookupStringId()
+        void setStringIdValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, const uint32_t stringId);
 
         bool getBooleanValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, bool& value) const;
         bool getIntegerValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, int& value) const;
@@ -74,10 +78,14 @@ namespace OsmAnd {
         bool getStringValue(const std::shared_ptr<const MapStyleValueDefinition>& ref, QString& value) const;
 
         void clearValue(const std::shared_ptr<const MapStyleValueDefinition>& ref);
+        // Drops all values, so that same evaluator can be used for another map object
+        void reset(const std::shared_ptr<const Model::MapObject>& mapObject = std::shared_ptr<const Model::MapObject>());
 
         bool evaluate(bool fillOutput = true, bool evaluateChildren = true);
 
         void dump(bool input = true, bool output = true, const QString& prefix = QString()) const;
+
+    friend class OsmAnd::MapStyleEvaluationCache;
     };
 
 } // namespace OsmAnd
@@ -27,6 +27,7 @@
 #include <memory>
 
 #include <QString>
+#include <QAtomicInt>
 
 #include <OsmAndCore.h>
 
@@ -34,6 +35,7 @@ namespace OsmAnd {
 
     class MapStyle_P;
     class MapStyleBuiltinValueDefinitions;
+    class MapStyleEvaluator_P;
 
     STRONG_ENUM(MapStyleValueDataType)
     {
@@ -55,6 +57,7 @@ namespace OsmAnd {
     public:
 
     private:
+        static QAtomicInt _nextId;
     protected:
         MapStyleValueDefinition(const MapStyleValueClass valueClass, const MapStyleValueDataType dataType, const QString& name, const bool isComplex);
     public:
@@ -65,8 +68,12 @@ namespace OsmAnd {
         const QString name;
         const bool isComplex;
 
+        // Dense identifier of definition among all definitions created in runtime, used as index of value slot
+        const int id;
+
     friend class OsmAnd::MapStyle_P;
     friend class OsmAnd::MapStyleBuiltinValueDefinitions;
+    friend class OsmAnd::MapStyleEvaluator_P;
     };
 
 } // namespace OsmAnd
@@ -35,6 +35,7 @@ namespace OsmAnd {
     class ObfsCollection;
     class MapStyle;
     class OfflineMapDataTile;
+    class OfflineMapRasterTileProvider_Software_P;
 
     class OfflineMapDataProvider_P;
     class OSMAND_CORE_API OfflineMapDataProvider
@@ -52,6 +53,8 @@ namespace OsmAnd {
         const std::shared_ptr<RasterizerEnvironment> rasterizerEnvironment;
 
         void obtainTile(const TileId tileId, const ZoomLevel zoom, std::shared_ptr<const OfflineMapDataTile>& outTile) const;
+
+    friend class OsmAnd::OfflineMapRasterTileProvider_Software_P;
     };
 
 } // namespace OsmAnd
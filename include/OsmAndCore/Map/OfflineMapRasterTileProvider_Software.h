@@ -29,6 +29,8 @@
 
 #include <QMutex>
 #include <QSet>
+#include <QList>
+#include <QHash>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -54,6 +56,34 @@ namespace OsmAnd {
         virtual uint32_t getTileSize() const;
 
         virtual bool obtainTile(const TileId tileId, const ZoomLevel zoom, std::shared_ptr<const MapTile>& outTile);
+
+        // Rasterizes metatile of metatileSize x metatileSize tiles, that starts at given top-left tile, in single pass: map data
+        // is read and prepared once for area of entire metatile, drawn onto one surface and then cut into tiles. Part of
+        // metatile that lays outside of the map is skipped. Empty tiles are output as null.
+        bool obtainMetatile(const TileId tileId, const ZoomLevel zoom, const unsigned int metatileSize, QHash< TileId, std::shared_ptr<const MapTile> >& outTiles);
+
+        struct OSMAND_CORE_API PipelineConfiguration
+        {
+            PipelineConfiguration();
+
+            // Workers that read map objects from OBF files
+            unsigned int readoutWorkers;
+            // Workers that prepare rasterizer contexts
+            unsigned int preparationWorkers;
+            // Workers that draw tiles
+            unsigned int drawingWorkers;
+            // Maximal number of tiles (or metatiles) waiting between stages
+            unsigned int queueCapacity;
+            // Tiles per side of metatile, 1 means that each tile is rasterized on its own
+            unsigned int metatileSize;
+        };
+        typedef std::function<void (const TileId tileId, const ZoomLevel zoom, const bool success, const std::shared_ptr<const MapTile>& tile)> TileRasterizedCallback;
+
+        // Rasterizes tiles using pipeline of OBF readout, context preparation and drawing stages, each served by own
+        // workers. Tiles enter pipeline in given order, so most important ones should go first. Callback is invoked
+        // from drawing workers. Blocks until all tiles are rasterized.
+        void rasterizeTiles(const QList< std::pair<TileId, ZoomLevel> >& tiles, const TileRasterizedCallback callback,
+            const PipelineConfiguration& configuration = PipelineConfiguration());
     };
 
 }
@@ -0,0 +1,71 @@
+/**
+ * @file
+ *
+ * @section LICENSE
+ *
+ * OsmAnd - Android navigation software based on OSM maps.
+ * Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __Q_MEMORY_MAPPED_INPUT_STREAM_H_
+#define __Q_MEMORY_MAPPED_INPUT_STREAM_H_
+
+#include <memory>
+
+#include <QFile>
+
+#include <OsmAndCore.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+
+namespace OsmAnd {
+
+    namespace gpb = google::protobuf;
+
+    /**
+    Implementation of zero-copy input stream for Google Protobuf over memory-mapped QFile.
+    Unlike gpb::io::ArrayInputStream, allows backing up by any count, since CodedInputStream::Seek() relies on that.
+    */
+    class OSMAND_CORE_API QMemoryMappedInputStream : public gpb::io::ZeroCopyInputStream
+    {
+    private:
+        GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(QMemoryMappedInputStream);
+
+        //! File that owns the mapping, kept alive as long as stream exists
+        const std::shared_ptr<QFile> _file;
+
+        //! Mapped data
+        const uchar* const _data;
+        const qint64 _size;
+
+        //! Current position
+        qint64 _position;
+    protected:
+    public:
+        //! Ctor
+        QMemoryMappedInputStream(const std::shared_ptr<QFile>& file, const uchar* data, const qint64 size);
+
+        //! Dtor
+        virtual ~QMemoryMappedInputStream();
+
+        virtual bool Next(const void** data, int* size);
+        virtual void BackUp(int count);
+        virtual bool Skip(int count);
+        virtual gpb::int64 ByteCount() const;
+    };
+
+} // namespace OsmAnd
+
+#endif // __Q_MEMORY_MAPPED_INPUT_STREAM_H_
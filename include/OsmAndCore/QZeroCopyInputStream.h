@@ -52,6 +52,9 @@ namespace OsmAnd {
         enum {
             BufferSize = 4096,
         };
+
+        //! Buffer that is reused by each Next() call
+        char _buffer[BufferSize];
     protected:
     public:
         //! Ctor
@@ -25,17 +25,18 @@
 
 #include <limits>
 #include <memory>
-#include <queue>
-#include <functional>
 
 #include <QString>
 #include <QHash>
 #include <QMap>
 #include <QSet>
 #include <QList>
+#include <QVector>
+#include <QAtomicInt>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/Routing/RoutePlannerContext.h>
+#include <OsmAndCore/Routing/RoutingHierarchy.h>
 #include <OsmAndCore/IQueryController.h>
 //#define DEBUG_ROUTING 1
 //#define TRACE_ROUTING 1
@@ -61,6 +62,8 @@
 
 namespace OsmAnd {
 
+    class ObfReader;
+
     struct RouteCalculationResult {
         QList< std::shared_ptr<OsmAnd::RouteSegment> >  list;
         QString warnMessage;
@@ -69,22 +72,61 @@ namespace OsmAnd {
         }
     };
 
+    struct RoadSegmentProjection {
+        // nullptr if no road was found
+        std::shared_ptr<const Model::Road> road;
+        // Segment is between (pointIndex - 1) and pointIndex points of road
+        uint32_t pointIndex;
+        double sqDistance;
+        uint32_t x31;
+        uint32_t y31;
+        RoadSegmentProjection(){
+            pointIndex = 0;
+            sqDistance = 0.0;
+            x31 = 0;
+            y31 = 0;
+        }
+    };
+
+    struct RouteMatrixResult {
+        int sourcesCount;
+        int targetsCount;
+        // Row per source, column per target. Negative if target was not reached from source
+        QVector<float> times;
+        QVector<float> distances;
+        QString warnMessage;
+        RouteMatrixResult(QString warn=""){
+            sourcesCount = 0;
+            targetsCount = 0;
+            warnMessage=warn;
+        }
+    };
+
     class OSMAND_CORE_API RoutePlanner
     {
 
     protected:
         RoutePlanner();
 
-        typedef std::priority_queue<
-            std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>,
-            std::vector< std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >,
-            std::function< bool(const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>&, const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>&) >
-        >  RoadSegmentsPriorityQueue;
+        typedef RoutePlannerContext::RouteCalculationSegmentsQueue RoadSegmentsPriorityQueue;
+        typedef RoutePlannerContext::RouteCalculationVisitedSegments VisitedSegments;
+        typedef RoutePlannerContext::RouteCalculationSegmentsRegistry SegmentsRegistry;
+        struct ParallelSearchState;
 
+        static void projectOnRoadSegment(
+            const std::shared_ptr<const Model::Road>& road,
+            uint32_t pointIndex,
+            uint32_t x31, uint32_t y31,
+            RoadSegmentProjection& outProjection);
+        static void collectClosestRoadSegments(
+            RoutePlannerContext* context,
+            uint32_t x31, uint32_t y31,
+            int count,
+            QList<RoadSegmentProjection>& outSegments);
         static void loadRoads(RoutePlannerContext* context, uint32_t x31, uint32_t y31, uint32_t zoomAround, QList< std::shared_ptr<const Model::Road> >& roads);
         static void loadRoadsFromTile(RoutePlannerContext* context, uint64_t tileId, QList< std::shared_ptr<const Model::Road> >& roads);
         static uint64_t getRoutingTileId(RoutePlannerContext* context, uint32_t x31, uint32_t y31, bool dontLoad);
-        static uint32_t getCurrentEstimatedSize(RoutePlannerContext* context);
+        static size_t getCurrentEstimatedSize(RoutePlannerContext* context);
         static void cacheRoad(RoutePlannerContext* context, const std::shared_ptr<Model::Road>& road);
         static void loadTileHeader(RoutePlannerContext* context, uint32_t x31, uint32_t y31, QList< std::shared_ptr<RoutePlannerContext::RoutingSubsectionContext> >& subsectionsContexts);
         static void loadSubregionContext(RoutePlannerContext::RoutingSubsectionContext* context);
@@ -113,10 +155,27 @@ namespace OsmAnd {
             OsmAnd::RoutePlannerContext::CalculationContext* context,
             bool reverseWaySearch,
             RoadSegmentsPriorityQueue& graphSegments,
-            QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedSegments,
+            VisitedSegments& visitedSegments,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
-            QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& oppositeSegments,
+            VisitedSegments& oppositeSegments,
             bool forwardDirection);
+        static void expandFrontier(
+            OsmAnd::RoutePlannerContext::CalculationContext* context,
+            bool reverseWaySearch,
+            RoadSegmentsPriorityQueue& graphSegments,
+            VisitedSegments& visitedSegments,
+            VisitedSegments& oppositeSegments,
+            ParallelSearchState& state,
+            const IQueryController* const controller);
+        static bool searchInParallel(
+            OsmAnd::RoutePlannerContext::CalculationContext* context,
+            RoadSegmentsPriorityQueue& graphDirectSegments,
+            RoadSegmentsPriorityQueue& graphReverseSegments,
+            VisitedSegments& visitedDirectSegments,
+            VisitedSegments& visitedOppositeSegments,
+            const IQueryController* const controller,
+            std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& outFinalSegment,
+            QString& outError);
         static float calculateTurnTime(
             OsmAnd::RoutePlannerContext::CalculationContext* context,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& a,
@@ -126,7 +185,7 @@ namespace OsmAnd {
         static bool checkIfInitialMovementAllowedOnSegment(
             OsmAnd::RoutePlannerContext::CalculationContext* context,
             bool reverseWaySearch,
-            QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedSegments,
+            VisitedSegments& visitedSegments,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
             bool forwardDirection,
             const std::shared_ptr<const Model::Road>& road);
@@ -135,7 +194,7 @@ namespace OsmAnd {
             bool reverseWaySearch,
             RoadSegmentsPriorityQueue& graphSegments,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
-            QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& oppositeSegments,
+            VisitedSegments& oppositeSegments,
             const std::shared_ptr<const Model::Road>& road,
             uint32_t segmentEnd,
             bool forwardDirection,
@@ -147,26 +206,47 @@ namespace OsmAnd {
             const std::shared_ptr<const Model::Road>& road,
             float distOnRoadToPass,
             float obstaclesTime);
-        static bool processRestrictions(
-            OsmAnd::RoutePlannerContext::CalculationContext* context,
-            QList< std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& prescripted,
+        static float calculateRoadSpeed(
+            OsmAnd::RoutePlannerContext* context,
+            const std::shared_ptr<const Model::Road>& road);
+        enum {
+            // Loaded points of bigger junctions are not tracked, so restrictions there are taken from roads
+            MaxJunctionPointsInBitmap = 64,
+        };
+        // Returns restriction of turn from road to next one, or Special_ReverseWayOnly if in reverse search next road
+        // has exclusive restriction to other loaded road. Junction is nullptr if segments were not all loaded from
+        // same junction table, otherwise roadJunctionIndex and loadedJunctionPoints locate road and loaded segments in it
+        static Model::RoadRestriction getTurnRestriction(
             const std::shared_ptr<const Model::Road>& road,
+            const RoutingSubsectionData::Junction* junction,
+            int roadJunctionIndex,
+            uint64_t loadedJunctionPoints,
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& next,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& inputNext,
             bool reverseWay);
+        static bool isExclusiveRestriction(Model::RoadRestriction restriction);
         static void processIntersections(
             OsmAnd::RoutePlannerContext::CalculationContext* context,
             RoadSegmentsPriorityQueue& graphSegments,
-            QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedSegments,
+            VisitedSegments& visitedSegments,
             float distFromStart,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
             uint32_t segmentEnd,
             const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& inputNext,
             bool reverseWaySearch,
             bool addSameRoadFutureDirection);
-        static bool checkPartialRecalculationPossible(
+        // Returns reverse tree of previous calculation if route to same target can be recalculated from given start using it
+        static std::shared_ptr<RoutePlannerContext::ReverseSearchTree> checkPartialRecalculationPossible(
             OsmAnd::RoutePlannerContext::CalculationContext* context,
-            QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedOppositeSegments,
-            std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment);
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& from,
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& to);
+        // Searches only forward, until search meets reverse tree. Returns empty route if it was not met
+        static OsmAnd::RouteCalculationResult recalculateRoutePartially(
+            OsmAnd::RoutePlannerContext::CalculationContext* context,
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& from,
+            const std::shared_ptr<RoutePlannerContext::ReverseSearchTree>& reverseSearchTree,
+            bool leftSideNavigation,
+            const IQueryController* const controller);
         static std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> loadRouteCalculationSegment(
             OsmAnd::RoutePlannerContext* context,
             uint32_t x31, uint32_t y31);
@@ -179,11 +259,16 @@ namespace OsmAnd {
 
         enum {
             RoutePointsBitSpace = 11,
+            // Roads are looked up for snapping not further than size of tile on this zoom
+            SnappingRadiusZoomLevel = 15,
         };
 
         static OsmAnd::RouteCalculationResult prepareResult(OsmAnd::RoutePlannerContext::CalculationContext* context,
             std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> finalSegment,
             bool leftSideNavigation);
+        static OsmAnd::RouteCalculationResult prepareResult(OsmAnd::RoutePlannerContext::CalculationContext* context,
+            QVector< std::shared_ptr<RouteSegment> >& route,
+            bool leftSideNavigation);
         static void addRouteSegmentToRoute(QVector< std::shared_ptr<RouteSegment> >& route, const std::shared_ptr<RouteSegment>& segment, bool reverse);
         static bool combineTwoSegmentResult(const std::shared_ptr<RouteSegment>& toAdd, const std::shared_ptr<RouteSegment>& previous, bool reverse);
         static bool validateAllPointsConnected(const QVector< std::shared_ptr<RouteSegment> >& route);
@@ -198,6 +283,77 @@ namespace OsmAnd {
             bool isIncrement);
 
         static void printRouteInfo(QVector< std::shared_ptr<RouteSegment> >& route);
+
+        // Returns time to pass road from one point to another, or -1 if it's not possible
+        static float calculateRoadPieceTime(
+            OsmAnd::RoutePlannerContext* context,
+            const std::shared_ptr<const Model::Road>& road,
+            float speed,
+            uint32_t fromPointIndex,
+            uint32_t toPointIndex);
+        static bool isRoadMovementAllowed(
+            OsmAnd::RoutePlannerContext* context,
+            const std::shared_ptr<const Model::Road>& road,
+            bool increasing);
+        static void collectHierarchyEndpoints(
+            OsmAnd::RoutePlannerContext* context,
+            const std::shared_ptr<const RoutingHierarchy>& hierarchy,
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
+            bool isTarget,
+            QList<RoutingHierarchy::Endpoint>& outEndpoints,
+            QList<uint32_t>& outPointIndices);
+        static std::shared_ptr<const Model::Road> obtainRoad(
+            OsmAnd::RoutePlannerContext* context,
+            const RoutingHierarchy::RoadPiece& piece,
+            const PointI& startLocation31,
+            QHash< uint64_t, std::shared_ptr<const Model::Road> >& roadsCache,
+            QSet<uint64_t>& processedTiles);
+        // Hierarchy has no turn restrictions, so each turn of route found in it is checked against junction where it's made
+        static bool isRouteTurnAllowed(
+            OsmAnd::RoutePlannerContext* context,
+            const std::shared_ptr<RouteSegment>& from,
+            const std::shared_ptr<RouteSegment>& to);
+        static bool calculateRouteUsingHierarchy(
+            OsmAnd::RoutePlannerContext::CalculationContext* context,
+            const std::shared_ptr<const RoutingHierarchy>& hierarchy,
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& from,
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& to,
+            bool leftSideNavigation,
+            RouteCalculationResult& outResult,
+            const IQueryController* const controller);
+
+        // Location snapped to nearest point of road
+        struct MatrixPoint
+        {
+            MatrixPoint();
+
+            // nullptr if there is no road near location
+            std::shared_ptr<const Model::Road> road;
+            uint32_t pointIndex;
+            // Time and distance along road between projection of location and point it was snapped to
+            float extraTime;
+            float extraDistance;
+        };
+        static void snapMatrixPoint(
+            OsmAnd::RoutePlannerContext* context,
+            const RoadSegmentProjection& projection,
+            MatrixPoint& outPoint);
+        // Returns false if row was not completed because memory limit of context was exceeded.
+        // Rows are calculated in parallel, so sizes of all running rows are summed in runningRowsSizeKb
+        static bool calculateRouteMatrixRow(
+            OsmAnd::RoutePlannerContext* context,
+            const MatrixPoint& source,
+            const QVector<MatrixPoint>& targets,
+            VisitedSegments& targetSegments,
+            const QHash< uint64_t, QList<int> >& targetsByRoutePoint,
+            float* outTimes,
+            float* outDistances,
+            QAtomicInt& runningRowsSizeKb,
+            const IQueryController* const controller);
+        // Returns length of chain of segments that ends at given point of segment
+        static float calculateSegmentsChainDistance(
+            const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
+            uint32_t endPointIndex);
     public:
         virtual ~RoutePlanner();
         enum {
@@ -212,12 +368,40 @@ namespace OsmAnd {
             double* sqDistanceToClosestPoint = nullptr,
             uint32_t* rx31 = nullptr, uint32_t* ry31 = nullptr);
 
+        // Returns up to given count of road segments closest to location, ordered by distance
+        static void findClosestRoadSegments(
+            OsmAnd::RoutePlannerContext* context,
+            double latitude, double longitude,
+            int count,
+            QList<RoadSegmentProjection>& outSegments);
+
+        // Snaps each location to closest road segment. Locations are processed in parallel
+        static void findClosestRoadPoints(
+            OsmAnd::RoutePlannerContext* context,
+            const QList< std::pair<double, double> >& locations,
+            QVector<RoadSegmentProjection>& outProjections,
+            const OsmAnd::IQueryController* const controller = nullptr);
+
         static RouteCalculationResult calculateRoute(
             OsmAnd::RoutePlannerContext* context,
             const QList< std::pair<double, double> >& points,
             bool leftSideNavigation,
             const OsmAnd::IQueryController* const controller = nullptr);
 
+        // Calculates time and distance of fastest route from each source to each target. Every location is snapped to
+        // nearest road point once, and searches from different sources run in parallel on shared tiles
+        static RouteMatrixResult calculateRouteMatrix(
+            OsmAnd::RoutePlannerContext* context,
+            const QList< std::pair<double, double> >& sources,
+            const QList< std::pair<double, double> >& targets,
+            const OsmAnd::IQueryController* const controller = nullptr);
+
+        // Builds contraction hierarchy of roads of given source, that can be used by contexts with same profile
+        static std::shared_ptr<RoutingHierarchy> buildRoutingHierarchy(
+            OsmAnd::RoutePlannerContext* context,
+            const std::shared_ptr<ObfReader>& source,
+            const OsmAnd::IQueryController* const controller = nullptr);
+
         friend class OsmAnd::RoutePlannerContext;
         friend class OsmAnd::RoutePlannerAnalyzer;
     };
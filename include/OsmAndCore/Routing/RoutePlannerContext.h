@@ -34,6 +34,13 @@
 #include <QMap>
 #include <QSet>
 #include <QList>
+#include <QVector>
+#include <QLinkedList>
+#include <QPair>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QBitArray>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/Common.h>
@@ -41,6 +48,7 @@
 #include <OsmAndCore/Data/Model/Road.h>
 #include <OsmAndCore/Routing/RouteSegment.h>
 #include <OsmAndCore/Routing/RoutingProfileContext.h>
+#include <OsmAndCore/Routing/RoutingSubsectionsCache.h>
 #include <OsmAndCore/CommonTypes.h>
 
 namespace OsmAnd {
@@ -50,6 +58,7 @@ namespace OsmAnd {
     class ObfRoutingSubsectionInfo;
     class ObfRoutingBorderLinePoint;
     class RoutePlanner;
+    class RoutingHierarchy;
 
     struct RouteStatistics
     {
@@ -65,6 +74,9 @@ namespace OsmAnd {
         uint32_t unloadedTiles;
         uint32_t distinctLoadedTiles;
         uint32_t loadedPrevUnloadedTiles;
+        // Loads that took subsection already decoded for other planner context
+        uint32_t sharedLoadedTiles;
+        uint64_t maxLoadedTilesSize;
 
         std::chrono::steady_clock::time_point timeToLoadBegin;
         std::chrono::steady_clock::time_point timeToCalculateBegin;
@@ -73,12 +85,22 @@ namespace OsmAnd {
             //TODO: very dangerous to zeroify non-POD types (timeToLoadBegin, timeToCalculateBegin)
             memset(this, 0, sizeof(struct RouteStatistics));
         }
+
+        // Part of loads that loaded tiles which were already loaded and then unloaded before
+        double getReloadRate() const {
+            return loadedTiles > 0 ? static_cast<double>(loadedPrevUnloadedTiles) / loadedTiles : 0.0;
+        }
     };
 
     class OSMAND_CORE_API RoutePlannerContext
     {
     public:
-        class OSMAND_CORE_API RouteCalculationSegment
+        class CalculationContext;
+        class RouteCalculationSegmentsRegistry;
+        class RouteCalculationSegmentsQueue;
+        class RouteCalculationVisitedSegments;
+
+        class OSMAND_CORE_API RouteCalculationSegment : public std::enable_shared_from_this<RouteCalculationSegment>
         {
         private:
         protected:
@@ -91,6 +113,16 @@ namespace OsmAnd {
 
             int _assignedDirection;
 
+            // Identifier of registry that registered this segment and index of segment in that registry
+            uint32_t _registryId;
+            int _registryIndex;
+
+            // Junction where segment starts and index of its point in it, if segment was loaded from junction table
+            std::shared_ptr<const RoutingSubsectionData::Junction> _junction;
+            int _junctionIndex;
+            // Index of end point of parent in same junction, -1 if it's not known
+            int _parentJunctionIndex;
+
             RouteCalculationSegment(const std::shared_ptr<const Model::Road>& road, uint32_t pointIndex);
 
             void dump(const QString& prefix = QString()) const;
@@ -109,6 +141,7 @@ namespace OsmAnd {
 
             friend class OsmAnd::RoutePlanner;
             friend class OsmAnd::RoutePlannerContext;
+            friend class OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry;
         };
 
         class OSMAND_CORE_API RouteCalculationFinalSegment : public RouteCalculationSegment
@@ -133,14 +166,23 @@ namespace OsmAnd {
         {
         private:
             int _mixedLoadsCounter;
-            int _access;
         protected:
             RoutingSubsectionContext(RoutePlannerContext* owner, const std::shared_ptr<ObfReader>& origin, const std::shared_ptr<const ObfRoutingSubsectionInfo>& subsection);
 
-            QMap< uint64_t, std::shared_ptr<RouteCalculationSegment> > _roadSegments;
+            // Roads of subsection, shared with other contexts, and which of them are accepted by profile of owner
+            std::shared_ptr<const RoutingSubsectionData> _data;
+            QBitArray _acceptedRoads;
 
-            void markLoaded();
+            // Bytes taken by shared data and accepted roads, while loaded
+            size_t _memorySize;
+            // Position in list of loaded subsections of owner, valid only while loaded
+            QLinkedList< RoutingSubsectionContext* >::iterator _lruPosition;
+
+            void markLoaded(const std::shared_ptr<const RoutingSubsectionData>& data);
             void unload();
+            // Marks subsection as most recently used one
+            void touch();
+            void collectSegmentsInCell(uint64_t cellId, QList< QPair< std::shared_ptr<const Model::Road>, uint32_t > >& output) const;
             std::shared_ptr<RouteCalculationSegment> loadRouteCalculationSegment(uint32_t x31, uint32_t y31, QMap<uint64_t, std::shared_ptr<const Model::Road> >& processed, const std::shared_ptr<RouteCalculationSegment>& original);
         public:
             virtual ~RoutingSubsectionContext();
@@ -151,9 +193,8 @@ namespace OsmAnd {
 
             bool isLoaded() const;
             uint32_t getLoadsCounter() const;
-            uint32_t getAccessCounter() const {return _access;}
+            size_t getMemorySize() const;
 
-            void registerRoad(const std::shared_ptr<const Model::Road>& road);
             void collectRoads(QList< std::shared_ptr<const Model::Road> >& output, QMap<uint64_t, std::shared_ptr<const Model::Road> >* duplicatesRegistry = nullptr);
 
             friend class OsmAnd::RoutePlanner;
@@ -178,7 +219,7 @@ namespace OsmAnd {
             
             QList< std::shared_ptr<BorderLine> > _borderLines;
             QVector< uint32_t > _borderLinesY31;
-            
+
             CalculationContext(RoutePlannerContext* owner);
         public:
             virtual ~CalculationContext();
@@ -188,6 +229,151 @@ namespace OsmAnd {
             friend class OsmAnd::RoutePlanner;
             friend class OsmAnd::RoutePlannerContext;
         };
+
+        // All segments reached by one direction of calculation. Queues and visited sets of that direction reference
+        // segments by index in it. Directions have separate registries, since they may be expanded by different threads
+        class OSMAND_CORE_API RouteCalculationSegmentsRegistry
+        {
+        private:
+            Q_DISABLE_COPY(RouteCalculationSegmentsRegistry);
+        protected:
+            static QAtomicInt _nextId;
+            const uint32_t _id;
+            QVector< std::shared_ptr<RouteCalculationSegment> > _segments;
+        public:
+            RouteCalculationSegmentsRegistry();
+            virtual ~RouteCalculationSegmentsRegistry();
+
+            int size() const;
+            // Returns index of segment, registering it if needed
+            int registerSegment(const std::shared_ptr<RouteCalculationSegment>& segment);
+            // Returns -1 if segment is not registered
+            int indexOf(const RouteCalculationSegment* segment) const;
+            const std::shared_ptr<RouteCalculationSegment>& at(int index) const;
+            // Approximate size in bytes of registered segments
+            size_t getMemorySize() const;
+        };
+
+        // 4-ary min-heap of segments ordered by f(x) = distanceFromStart + heuristicCoefficient * distanceToEnd.
+        // Priority of segment is captured on push(), so update() has to be called if distances of queued segment change
+        class OSMAND_CORE_API RouteCalculationSegmentsQueue
+        {
+        private:
+            Q_DISABLE_COPY(RouteCalculationSegmentsQueue);
+        protected:
+            enum {
+                Arity = 4,
+            };
+
+            struct Entry
+            {
+                double priority;
+                int segmentIndex;
+            };
+
+            RouteCalculationSegmentsRegistry* const _registry;
+            const double _heuristicCoefficient;
+            QVector< Entry > _heap;
+            // Position in heap by index of segment in registry, -1 if segment is not queued
+            QVector< int > _positions;
+
+            double priorityOf(const RouteCalculationSegment* segment) const;
+            int positionOf(const RouteCalculationSegment* segment) const;
+            void place(int position, const Entry& entry);
+            void siftUp(int position, const Entry& entry);
+            void siftDown(int position, const Entry& entry);
+            void reposition(int position, const Entry& entry);
+        public:
+            RouteCalculationSegmentsQueue(RouteCalculationSegmentsRegistry* registry, double heuristicCoefficient);
+            virtual ~RouteCalculationSegmentsQueue();
+
+            bool empty() const;
+            int size() const;
+            const std::shared_ptr<RouteCalculationSegment>& top() const;
+            // Segments in heap order, not in priority order
+            const std::shared_ptr<RouteCalculationSegment>& at(int position) const;
+
+            // Pushing segment that is already queued only updates its priority
+            void push(const std::shared_ptr<RouteCalculationSegment>& segment);
+            void pop();
+            bool remove(const std::shared_ptr<RouteCalculationSegment>& segment);
+            void update(const std::shared_ptr<RouteCalculationSegment>& segment);
+        };
+
+        // Open-addressing (linear probing) map from route point id to segment. Only one thread may insert, but other
+        // threads may look segments up at the same time without locking: buckets are never cleared, and tables that
+        // were replaced by bigger ones are kept until destruction. Distances and parents of stored segments are still
+        // changed by inserting thread, so they are read by other threads only under segments mutex
+        class OSMAND_CORE_API RouteCalculationVisitedSegments
+        {
+        private:
+            Q_DISABLE_COPY(RouteCalculationVisitedSegments);
+        protected:
+            enum {
+                InitialCapacity = 1024,
+            };
+
+            struct Bucket
+            {
+                Bucket();
+                Bucket(const Bucket& that);
+
+                uint64_t id;
+                // nullptr if bucket is empty. Stored after id, so that readers that see segment also see its id
+                QAtomicPointer<RouteCalculationSegment> segment;
+            };
+            typedef QVector<Bucket> Table;
+
+            RouteCalculationSegmentsRegistry* const _registry;
+            QAtomicPointer<Table> _table;
+            QList< Table* > _tables;
+            int _size;
+            mutable QMutex _segmentsMutex;
+
+            static int bucketOf(const Table& table, uint64_t id);
+            void grow();
+        public:
+            RouteCalculationVisitedSegments(RouteCalculationSegmentsRegistry* registry);
+            virtual ~RouteCalculationVisitedSegments();
+
+            int size() const;
+            bool contains(uint64_t id) const;
+            // Returns nullptr if nothing was stored for given id
+            std::shared_ptr<RouteCalculationSegment> find(uint64_t id) const;
+            // Same as find(), but also reads distance from start of found segment under segments mutex
+            std::shared_ptr<RouteCalculationSegment> find(uint64_t id, float& outDistanceFromStart) const;
+            // Replaces segment that was stored for given id before
+            void insert(uint64_t id, const std::shared_ptr<RouteCalculationSegment>& segment);
+
+            // Has to be held by inserting thread while it changes distance or parent of segment that may be stored
+            QMutex& getSegmentsMutex() const;
+            // Size in bytes of current and replaced tables, without segments themselves
+            size_t getMemorySize() const;
+        };
+
+        // Reverse direction of search, kept after route was found. Route to same target from other start is then
+        // recalculated by forward search alone, that stops as soon as it meets this tree
+        class OSMAND_CORE_API ReverseSearchTree
+        {
+        private:
+            Q_DISABLE_COPY(ReverseSearchTree);
+        protected:
+            ReverseSearchTree(uint64_t targetRoadId, const PointI& targetPoint);
+
+            RouteCalculationSegmentsRegistry _registry;
+            RouteCalculationVisitedSegments _visitedSegments;
+            // Cost of route that was found together with this tree
+            float _routeCost;
+        public:
+            virtual ~ReverseSearchTree();
+
+            const uint64_t targetRoadId;
+            const PointI targetPoint;
+
+            size_t getMemorySize() const;
+
+            friend class OsmAnd::RoutePlanner;
+        };
     private:
     protected:
         QList< std::shared_ptr<RoutingSubsectionContext> > _subsectionsContexts;
@@ -195,9 +381,25 @@ namespace OsmAnd {
         QMap< const ObfRoutingSectionInfo*, std::shared_ptr<ObfReader> > _sourcesLUT;
 
         QList< std::shared_ptr<RouteSegment> > _previouslyCalculatedRoute;
+        std::shared_ptr<ReverseSearchTree> _reverseSearchTree;
+        // Retained tree is counted in estimated size, and it's released once unloading tiles was not enough
+        size_t _reverseSearchTreeSize;
+        void retainReverseSearchTree(const std::shared_ptr<ReverseSearchTree>& tree);
 
         QMap< uint64_t, QList< std::shared_ptr<RoutingSubsectionContext> > > _indexedSubsectionsContexts;
         QMap< uint64_t, QList< std::shared_ptr<Model::Road> > > _cachedRoadsInTiles;
+        QList< std::shared_ptr<const RoutingHierarchy> > _routingHierarchies;
+
+        // Guards loading and unloading of tiles, since directions of parallel search load them concurrently
+        mutable QMutex _tilesMutex;
+        // Loaded subsections from most to least recently used, and total size of them
+        QLinkedList< RoutingSubsectionContext* > _loadedSubsectionsContexts;
+        size_t _loadedSubsectionsSize;
+        // Unloads least recently used subsections until estimated size fits memory target, but keeps given count of
+        // most recently used ones. If that is not enough, retained reverse search tree is released
+        void unloadLeastRecentlyUsedTiles(size_t memoryTarget, int keepCount);
+        // Expand forward and reverse frontiers of search on separate threads
+        bool _parallelBidirectionalSearch;
 
         float _initialHeading;
         bool _useBasemap;
@@ -205,12 +407,20 @@ namespace OsmAnd {
         uint32_t _roadTilesLoadingZoomLevel;
         int _planRoadDirection;
         float _heuristicCoefficient;
+        // Reverse tree of previous calculation is reused only if new start is not further than this from previous route
         float _partialRecalculationDistanceLimit;
+        // Partial recalculation gives up once cost from new start exceeds this many times cost of previous route, so
+        // that start which does not meet reverse tree soon falls back to full search. Not limited if 0
+        float _partialRecalculationCostFactor;
+        // Route matrix row is not searched further than this many times estimated time to farthest target of it,
+        // so that unreachable targets do not make search visit whole graph. Not limited if 0
+        float _matrixTimeLimitFactor;
         int _loadedTiles;
         std::shared_ptr<RouteStatistics> _routeStatistics;
 
         enum {
             DefaultRoadTilesLoadingZoomLevel = 16,
+            DefaultMemoryUsageLimit = 256 * 1024 * 1024,
         };
     public:
         RoutePlannerContext(
@@ -220,7 +430,7 @@ namespace OsmAnd {
             bool useBasemap,
             float initialHeading = std::numeric_limits<float>::quiet_NaN(),
             QHash<QString, QString>* options = nullptr,
-            size_t memoryLimit = 1000000);
+            size_t memoryLimit = DefaultMemoryUsageLimit);
         virtual ~RoutePlannerContext();
 
         const QList< std::shared_ptr<OsmAnd::ObfReader> > sources;
@@ -228,9 +438,17 @@ namespace OsmAnd {
         const std::shared_ptr<OsmAnd::RoutingProfileContext> profileContext;
 
         uint32_t getCurrentlyLoadedTiles();
-        uint32_t getCurrentEstimatedSize();
+        // Returns size in bytes of all loaded roads and of reverse search tree retained for recalculation
+        size_t getCurrentEstimatedSize();
         void unloadUnusedTiles(size_t memoryTarget);
 
+        // Routes between two points are looked up in attached hierarchies first, so attaching them is an opt-in. Turn
+        // costs are not part of hierarchy, and route that turns against restriction is calculated by A* instead.
+        // Returns false if hierarchy is for other profile or other parameters of profile
+        bool attachRoutingHierarchy(const std::shared_ptr<const RoutingHierarchy>& hierarchy);
+        // Attaches up-to-date hierarchies stored next to sources that were opened from files. Returns count of them
+        int attachRoutingHierarchies();
+
         friend class OsmAnd::RoutePlanner;
     };
 
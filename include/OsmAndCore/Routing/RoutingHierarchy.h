@@ -0,0 +1,160 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ROUTING_HIERARCHY_H_
+#define __ROUTING_HIERARCHY_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QHash>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+namespace OsmAnd {
+
+    class IQueryController;
+
+    /**
+    Contraction hierarchy of road graph of single OBF file for single routing profile. Nodes are road junctions and
+    road ends, arcs are parts of roads between them. Each node has a rank (order of contraction) and only arcs that lead
+    to nodes of higher rank are kept, together with shortcuts that replace paths over contracted nodes. Shortest path is
+    found by two upward Dijkstra searches (from source and backwards from target) that meet at the highest node of path.
+    */
+    class OSMAND_CORE_API RoutingHierarchy
+    {
+        Q_DISABLE_COPY(RoutingHierarchy)
+    public:
+        // Part of road passed from startPointIndex to endPointIndex
+        struct OSMAND_CORE_API RoadPiece
+        {
+            uint64_t roadId;
+            uint32_t startPointIndex;
+            uint32_t endPointIndex;
+        };
+
+        // Directed arc of road graph, passed along road piece
+        struct OSMAND_CORE_API Arc
+        {
+            int source;
+            int target;
+            float cost;
+            int piece;
+        };
+
+        // Node where path starts or ends, with cost to reach it from start (or to reach target from it)
+        struct OSMAND_CORE_API Endpoint
+        {
+            int node;
+            float cost;
+        };
+    private:
+    protected:
+        RoutingHierarchy(const QString& profileName, uint32_t profileParametersHash, uint64_t obfCreationTimestamp);
+
+        enum {
+            FileSignature = 0x4F524348, // "ORCH"
+            FileVersion = 2,
+
+            // Witness searches are limited, so some unnecessary shortcuts may be added, but contraction stays fast
+            WitnessSearchSettledNodesLimit = 500,
+
+            // Sizes of serialized node, edge and road piece, used to bound counts read from file
+            NodeRecordSize = 4 * sizeof(qint32),
+            EdgeRecordSize = 4 * sizeof(qint32) + sizeof(quint8),
+            PieceRecordSize = sizeof(quint64) + 2 * sizeof(quint32),
+        };
+
+        struct Edge
+        {
+            int target;
+            float cost;
+            // Node this shortcut goes over, or -1 if edge is an original arc
+            int middle;
+            // Road piece of original arc, or -1 if edge is a shortcut
+            int piece;
+            // True for arc from owner to target (used by forward search), false for arc from target to owner
+            bool outgoing;
+        };
+
+        QString _profileName;
+        uint32_t _profileParametersHash;
+        uint64_t _obfCreationTimestamp;
+
+        QVector< PointI > _nodesLocations;
+        QVector< int > _nodesRanks;
+        QHash< uint64_t, int > _nodesByLocation;
+        // Edges to nodes of higher rank, edges of node N are [_firstEdges[N], _firstEdges[N + 1])
+        QVector< int > _firstEdges;
+        QVector< Edge > _edges;
+        QVector< RoadPiece > _pieces;
+
+        static uint64_t locationKey(const PointI& location31);
+        void indexNodesLocations();
+        int findEdge(int owner, int target, bool outgoing) const;
+        // Checks that all indices are in range and that every shortcut unpacks into halves of lower rank, so that
+        // hierarchy read from file can be searched and unpacked safely
+        bool checkIntegrity() const;
+        // Appends original arcs that given edge (which is an arc from 'from' to 'to') consists of
+        void unpackArc(int from, int to, const Edge& edge, QList<RoadPiece>& outPieces, QList<int>& outNodes) const;
+    public:
+        virtual ~RoutingHierarchy();
+
+        const QString& profileName;
+        // Costs depend on values of profile context, see RoutingProfileContext::getParametersHash()
+        const uint32_t& profileParametersHash;
+        const uint64_t& obfCreationTimestamp;
+
+        int getNodesCount() const;
+        int getEdgesCount() const;
+        const PointI& getNodeLocation(int node) const;
+        // Returns -1 if there is no node at given location
+        int findNode(const PointI& location31) const;
+
+        // Finds cheapest path from any of sources to any of targets. Outputs road pieces along the path in order of
+        // movement, nodes where each of pieces starts (with target node at the end), and indices of used endpoints.
+        // Returns false if there is no path or search was aborted
+        bool findPath(
+            const QList<Endpoint>& sources, const QList<Endpoint>& targets,
+            QList<RoadPiece>& outPieces, QList<int>& outNodes,
+            float& outCost, int& outSourceIndex, int& outTargetIndex,
+            const IQueryController* const controller = nullptr) const;
+
+        bool saveTo(const QString& fileName) const;
+        static std::shared_ptr<RoutingHierarchy> loadFrom(const QString& fileName);
+        // Hierarchy of OBF file for given profile is stored next to it
+        static QString getSidecarFileName(const QString& obfFileName, const QString& profileName);
+
+        static std::shared_ptr<RoutingHierarchy> contract(
+            const QString& profileName, uint32_t profileParametersHash, uint64_t obfCreationTimestamp,
+            const QVector<PointI>& nodesLocations, const QVector<RoadPiece>& pieces, const QVector<Arc>& arcs,
+            const IQueryController* const controller = nullptr);
+    };
+
+} // namespace OsmAnd
+
+#endif // __ROUTING_HIERARCHY_H_
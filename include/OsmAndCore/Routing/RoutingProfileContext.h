@@ -28,6 +28,8 @@
 
 #include <QString>
 #include <QHash>
+#include <QVector>
+#include <QReadWriteLock>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/Routing/RoutingProfile.h>
@@ -46,6 +48,45 @@ namespace OsmAnd {
         std::shared_ptr<RoutingRulesetContext> _rulesetContexts[RoutingRuleset::TypesCount];
 
         QMap< std::shared_ptr<const ObfRoutingSectionInfo>, QMap<uint32_t, uint32_t> > _tagValueAttribIdCache;
+
+        // Result of ruleset depends only on road types (and values of context, that are constant), so it's evaluated
+        // once per combination of types in section. Sections are owned by sources, that outlive this context
+        struct EvaluationKey
+        {
+            RoutingRuleset::Type rulesetType;
+            const ObfRoutingSectionInfo* section;
+            QVector<uint32_t> roadTypes;
+
+            inline bool operator==(const EvaluationKey& other) const
+            {
+                return
+                    rulesetType == other.rulesetType &&
+                    section == other.section &&
+                    roadTypes == other.roadTypes;
+            }
+        };
+        friend inline uint qHash(const EvaluationKey& key, uint seed)
+        {
+            auto hash = seed ^ static_cast<uint>(key.rulesetType);
+            hash = hash * 31 + ::qHash(key.section);
+            for(auto itType = key.roadTypes.cbegin(); itType != key.roadTypes.cend(); ++itType)
+                hash = hash * 31 + *itType;
+            return hash;
+        }
+        struct EvaluationResult
+        {
+            bool isFound;
+            float value;
+        };
+        mutable QReadWriteLock _evaluationCacheLock;
+        QHash< EvaluationKey, EvaluationResult > _evaluationCache;
+
+        // Evaluation itself is not thread-safe (it registers new attributes in profile), so it's done under write lock
+        bool evaluateCached(
+            RoutingRulesetContext* const rulesetContext,
+            const std::shared_ptr<const ObfRoutingSectionInfo>& section,
+            const QVector<uint32_t>& roadTypes,
+            float& value);
     public:
         RoutingProfileContext(const std::shared_ptr<RoutingProfile>& profile, QHash<QString, QString>* contextValues = nullptr);
         virtual ~RoutingProfileContext();
@@ -62,6 +103,12 @@ namespace OsmAnd {
         float getObstaclesExtraTime(const std::shared_ptr<const OsmAnd::Model::Road>& road, uint32_t pointIndex);
         float getRoutingObstaclesExtraTime(const std::shared_ptr<const OsmAnd::Model::Road>& road, uint32_t pointIndex);
 
+        int getEvaluationCacheSize() const;
+
+        // Hash of profile name and context values, that stays same between runs. Data precomputed for this context
+        // (like routing hierarchy) is valid only for contexts with same hash
+        uint32_t getParametersHash() const;
+
         friend class OsmAnd::RoutingRulesetContext;
     };
 
@@ -29,6 +29,7 @@
 #include <QString>
 #include <QSet>
 #include <QHash>
+#include <QVector>
 #include <QBitArray>
 
 #include <OsmAndCore.h>
@@ -61,8 +62,9 @@ namespace OsmAnd {
         QString _tagRef;
         float _value;
 
-        QBitArray _filterTypes;
-        QBitArray _filterNotTypes;
+        // Ids of tag-value attributes that must (or must not) be set, checked bit by bit instead of masking
+        QVector<uint32_t> _filterTypes;
+        QVector<uint32_t> _filterNotTypes;
         QSet<QString> _onlyTags;
         QSet<QString> _onlyNotTags;
 
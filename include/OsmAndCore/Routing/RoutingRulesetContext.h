@@ -28,6 +28,7 @@
 
 #include <QString>
 #include <QHash>
+#include <QVector>
 #include <QBitArray>
 
 #include <OsmAndCore.h>
@@ -46,10 +47,15 @@ namespace OsmAnd {
     private:
         QHash<QString, QString> _contextValues;
         std::shared_ptr<RoutingRuleset> _ruleset;
+
+        // Bitset returned by encode(), reused so that no allocation happens per evaluation
+        QBitArray _encodedTypes;
     protected:
         bool evaluate(const std::shared_ptr<const Model::Road>& road, const RoutingRuleExpression::ResultType type, void* const result);
+        bool evaluate(const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes, const RoutingRuleExpression::ResultType type, void* const result);
         bool evaluate(const QBitArray& types, const RoutingRuleExpression::ResultType type, void* const result);
-        QBitArray encode(const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes);
+        // Returned bitset is valid only until next call
+        const QBitArray& encode(const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes);
     public:
         RoutingRulesetContext(RoutingProfileContext* owner, const std::shared_ptr<RoutingRuleset>& ruleset, QHash<QString, QString>* const contextValues);
         virtual ~RoutingRulesetContext();
@@ -63,6 +69,8 @@ namespace OsmAnd {
 
         int evaluateAsInteger(const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes, const int defaultValue);
         float evaluateAsFloat(const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes, const float defaultValue);
+
+    friend class OsmAnd::RoutingProfileContext;
     };
 
 } // namespace OsmAnd
@@ -0,0 +1,204 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __ROUTING_SUBSECTIONS_CACHE_H_
+#define __ROUTING_SUBSECTIONS_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QLinkedList>
+#include <QMutex>
+#include <QBitArray>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Data/Model/Road.h>
+
+namespace OsmAnd {
+
+    class ObfReader;
+    class ObfRoutingSubsectionInfo;
+
+    /**
+    Decoded roads of routing subsection together with lookup tables over them. Contains all roads of subsection
+    regardless of routing profile, and is never modified after it was decoded, so planner contexts share it without
+    locking. Anything that depends on request (accepted roads, search state) is kept by planner context.
+    */
+    class OSMAND_CORE_API RoutingSubsectionData
+    {
+        Q_DISABLE_COPY(RoutingSubsectionData)
+    public:
+        // Point of road, given by index of road in subsection. In grid, segment between (pointIndex - 1) and pointIndex
+        struct OSMAND_CORE_API RoadPoint
+        {
+            int roadIndex;
+            uint32_t pointIndex;
+        };
+
+        // Road points that share same location. Everything that route search needs at junction and that does not
+        // depend on routing profile is computed when subsection is decoded. Points go in same order as they are listed
+        // for location of junction
+        struct OSMAND_CORE_API Junction
+        {
+            QVector<uint64_t> roadsIds;
+            QVector<uint32_t> pointsIndices;
+            // Directions of roads from junction, see Model::Road::getDirectionDelta()
+            QVector<double> forwardDirections;
+            QVector<double> backwardDirections;
+            QBitArray trafficSignals;
+            // Restriction of turn from i-th road to j-th one is at [i * count() + j], Invalid if there is none
+            QVector<Model::RoadRestriction> restrictions;
+            // Points of roads that i-th road has exclusive (only_*) restrictions to
+            QVector< QVector<int> > exclusiveRestrictionsTargets;
+
+            int count() const;
+            // Returns -1 if road point is not a part of junction
+            int indexOf(uint64_t roadId, uint32_t pointIndex) const;
+            Model::RoadRestriction getRestriction(int from, int to) const;
+        };
+
+        enum {
+            SegmentsGridZoomLevel = 19,
+        };
+    private:
+    protected:
+        RoutingSubsectionData();
+
+        QVector< std::shared_ptr<const Model::Road> > _roads;
+        // Points of roads by their location, in order roads were decoded
+        QHash< uint64_t, QVector<RoadPoint> > _roadsPoints;
+        // Segments of roads by cells of uniform grid (see SegmentsGridZoomLevel) they cross
+        QHash< uint64_t, QVector<RoadPoint> > _segmentsGrid;
+        // Junctions by their location, only for locations where more than one road point is
+        QHash< uint64_t, std::shared_ptr<const Junction> > _junctions;
+        size_t _memorySize;
+
+        void registerRoad(const std::shared_ptr<const Model::Road>& road);
+        void indexRoadSegments(int roadIndex);
+        void buildJunctions();
+    public:
+        virtual ~RoutingSubsectionData();
+
+        const QVector< std::shared_ptr<const Model::Road> >& roads;
+        // Estimated size in bytes of roads and lookup tables
+        const size_t& memorySize;
+
+        // Return nullptr if there is nothing at given location or in given cell
+        const QVector<RoadPoint>* findRoadsPoints(uint32_t x31, uint32_t y31) const;
+        const QVector<RoadPoint>* findSegmentsInCell(uint64_t cellId) const;
+        std::shared_ptr<const Junction> findJunction(uint32_t x31, uint32_t y31) const;
+
+        static uint64_t encodeLocationId(uint32_t x31, uint32_t y31);
+        static uint64_t encodeSegmentsGridCellId(uint32_t cellX, uint32_t cellY);
+
+        static std::shared_ptr<const RoutingSubsectionData> decode(const std::shared_ptr<ObfReader>& origin, const std::shared_ptr<const ObfRoutingSubsectionInfo>& subsection);
+    };
+
+    /**
+    Process-wide cache of decoded routing subsections, keyed by OBF file (path and creation timestamp) and offset of
+    subsection. Most recently obtained subsections are referenced strongly while their total size fits retained size
+    limit, so that next requests in same area do not decode them again. Other data is referenced weakly: it lives while
+    any planner context uses it, and all contexts that use same subsection at the same time share single copy of it.
+    Safe to use from multiple threads.
+    */
+    class OSMAND_CORE_API RoutingSubsectionsCache
+    {
+        Q_DISABLE_COPY(RoutingSubsectionsCache)
+    private:
+    protected:
+        RoutingSubsectionsCache();
+
+        struct Key
+        {
+            QString filePath;
+            uint64_t creationTimestamp;
+            uint32_t offset;
+
+            inline bool operator==(const Key& other) const
+            {
+                return
+                    offset == other.offset &&
+                    creationTimestamp == other.creationTimestamp &&
+                    filePath == other.filePath;
+            }
+        };
+        friend inline uint qHash(const Key& key, uint seed)
+        {
+            auto hash = qHash(key.filePath, seed);
+            hash = hash * 31 + static_cast<uint>(key.creationTimestamp ^ (key.creationTimestamp >> 32));
+            hash = hash * 31 + key.offset;
+            return hash;
+        }
+
+        struct Entry
+        {
+            // Held while subsection is decoded, so that concurrent requests of it wait instead of decoding it again
+            QMutex decodeMutex;
+            std::weak_ptr<const RoutingSubsectionData> data;
+
+            // Strong reference and position in list of retained entries, guarded by entries mutex
+            std::shared_ptr<const RoutingSubsectionData> retainedData;
+            QLinkedList<Entry*>::iterator retainedPosition;
+        };
+
+        enum {
+            DefaultRetainedSizeLimit = 64 * 1024 * 1024,
+        };
+
+        mutable QMutex _entriesMutex;
+        QHash< Key, std::shared_ptr<Entry> > _entries;
+        // Expired entries are dropped each time count of entries doubles
+        int _pruneThreshold;
+
+        // Retained entries from most to least recently obtained, and total size of their data
+        QLinkedList<Entry*> _retainedEntries;
+        size_t _retainedSize;
+        size_t _retainedSizeLimit;
+
+        void pruneExpiredEntries();
+        void retain(Entry* entry, const std::shared_ptr<const RoutingSubsectionData>& data);
+        void releaseRetainedEntries(size_t sizeLimit);
+    public:
+        virtual ~RoutingSubsectionsCache();
+
+        static const std::shared_ptr<RoutingSubsectionsCache> instance;
+
+        // Returns data of subsection, decoding it only if nobody uses it now. Origins without file are not cached
+        std::shared_ptr<const RoutingSubsectionData> obtain(
+            const std::shared_ptr<ObfReader>& origin, const std::shared_ptr<const ObfRoutingSubsectionInfo>& subsection,
+            bool* outWasDecoded = nullptr);
+
+        int getEntriesCount() const;
+
+        // Least recently obtained subsections stop being retained once retained size exceeds limit. 0 disables retaining
+        void setRetainedSizeLimit(size_t sizeLimit);
+        size_t getRetainedSizeLimit() const;
+        size_t getRetainedSize() const;
+    };
+
+} // namespace OsmAnd
+
+#endif // __ROUTING_SUBSECTIONS_CACHE_H_
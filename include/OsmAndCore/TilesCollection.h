@@ -28,8 +28,9 @@
 #include <array>
 #include <functional>
 #include <type_traits>
+#include <unordered_map>
 
-#include <QMap>
+#include <QList>
 #include <QReadWriteLock>
 
 #include <OsmAndCore.h>
@@ -59,9 +60,59 @@ namespace OsmAnd {
             TilesCollection< ENTRY >& collection;
         };
 
+        // Entries are spread over shards by hash of (zoom, tile), each shard guarded by own lock,
+        // so that workers that access different tiles rarely contend
+        enum {
+            ShardsCount = 64
+        };
+
     private:
-        std::array< QMap< TileId, std::shared_ptr<ENTRY> >, ZoomLevelsCount > _zoomLevels;
-        mutable QReadWriteLock _tilesCollectionLock;
+        struct EntryKey
+        {
+            TileId tileId;
+            ZoomLevel zoom;
+
+            inline bool operator==(const EntryKey& that) const
+            {
+                return tileId.id == that.tileId.id && zoom == that.zoom;
+            }
+        };
+        struct EntryKeyHash
+        {
+            inline std::size_t operator()(const EntryKey& key) const
+            {
+                return static_cast<std::size_t>(hashOf(key.tileId, key.zoom));
+            }
+        };
+        struct Shard
+        {
+            mutable QReadWriteLock lock;
+            std::unordered_map< EntryKey, std::shared_ptr<ENTRY>, EntryKeyHash > entries;
+        };
+        std::array< Shard, ShardsCount > _shards;
+
+        static inline uint64_t hashOf(const TileId tileId, const ZoomLevel zoom)
+        {
+            // Finalizer of MurmurHash3, so that neighbour tiles get to different shards
+            auto hash = tileId.id ^ (static_cast<uint64_t>(zoom) * 0x9E3779B97F4A7C15ull);
+            hash ^= hash >> 33;
+            hash *= 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 33;
+            hash *= 0xC4CEB9FE1A85EC53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+        inline Shard& shardOf(const TileId tileId, const ZoomLevel zoom)
+        {
+            return _shards[hashOf(tileId, zoom) % ShardsCount];
+        }
+        static inline EntryKey keyOf(const TileId tileId, const ZoomLevel zoom)
+        {
+            EntryKey key;
+            key.tileId = tileId;
+            key.zoom = zoom;
+            return key;
+        }
     protected:
         const std::shared_ptr< Link > _link;
     public:
@@ -73,13 +124,13 @@ namespace OsmAnd {
 
         virtual bool obtainTileEntry(std::shared_ptr<ENTRY>& outEntry, const TileId tileId, const ZoomLevel zoom)
         {
-            QReadLocker scopedLocker(&_tilesCollectionLock);
+            auto& shard = shardOf(tileId, zoom);
+            QReadLocker scopedLocker(&shard.lock);
 
-            auto& zoomLevel = _zoomLevels[zoom];
-            auto itEntry = zoomLevel.constFind(tileId);
-            if(itEntry != zoomLevel.cend())
+            const auto itEntry = shard.entries.find(keyOf(tileId, zoom));
+            if(itEntry != shard.entries.cend())
             {
-                outEntry = *itEntry;
+                outEntry = itEntry->second;
 
                 return true;
             }
@@ -91,33 +142,41 @@ namespace OsmAnd {
         {
             assert(allocator != nullptr);
 
-            QWriteLocker scopedLocker(&_tilesCollectionLock);
+            const auto key = keyOf(tileId, zoom);
+            auto& shard = shardOf(tileId, zoom);
 
-            auto& zoomLevel = _zoomLevels[zoom];
-            auto itEntry = zoomLevel.constFind(tileId);
-            if(itEntry != zoomLevel.cend())
+            // Most of times entry exists, so look it up under read lock first
             {
-                outEntry = *itEntry;
-                return;
+                QReadLocker scopedLocker(&shard.lock);
+
+                const auto itEntry = shard.entries.find(key);
+                if(itEntry != shard.entries.cend())
+                {
+                    outEntry = itEntry->second;
+                    return;
+                }
             }
 
-            auto newEntry = allocator(*this, tileId, zoom);
-            outEntry.reset(newEntry);
-            itEntry = zoomLevel.insert(tileId, outEntry);
+            QWriteLocker scopedLocker(&shard.lock);
+
+            // Entry may have been allocated by other thread meanwhile
+            auto& entry = shard.entries[key];
+            if(!entry)
+                entry.reset(allocator(*this, tileId, zoom));
+            outEntry = entry;
         }
 
         virtual void obtainTileEntries(QList< std::shared_ptr<ENTRY> >* outList, std::function<bool (const std::shared_ptr<ENTRY>& entry, bool& cancel)> filter = nullptr)
         {
-            QReadLocker scopedLocker(&_tilesCollectionLock);
-
             bool doCancel = false;
-            for(auto itZoomLevel = _zoomLevels.cbegin(); itZoomLevel != _zoomLevels.cend(); ++itZoomLevel)
+            for(auto itShard = _shards.begin(); itShard != _shards.end(); ++itShard)
             {
-                const auto& zoomLevel = *itZoomLevel;
+                auto& shard = *itShard;
+                QReadLocker scopedLocker(&shard.lock);
 
-                for(auto itEntryPair = zoomLevel.cbegin(); itEntryPair != zoomLevel.cend(); ++itEntryPair)
+                for(auto itEntryPair = shard.entries.cbegin(); itEntryPair != shard.entries.cend(); ++itEntryPair)
                 {
-                    const auto& entry = itEntryPair.value();
+                    const auto& entry = itEntryPair->second;
                     
                     if(!filter || (filter && filter(entry, doCancel)))
                     {
@@ -133,43 +192,44 @@ namespace OsmAnd {
 
         virtual void removeAllEntries()
         {
-            QWriteLocker scopedLocker(&_tilesCollectionLock);
+            for(auto itShard = _shards.begin(); itShard != _shards.end(); ++itShard)
+            {
+                auto& shard = *itShard;
+                QWriteLocker scopedLocker(&shard.lock);
 
-            for(int zoom = ZoomLevel::MinZoomLevel; zoom != ZoomLevel::MaxZoomLevel; zoom++)
-                _zoomLevels[zoom].clear();
+                shard.entries.clear();
+            }
         }
 
         virtual void removeEntry(const std::shared_ptr<ENTRY>& entry)
         {
-            QWriteLocker scopedLock(&_tilesCollectionLock);
-
-            _zoomLevels[entry->zoom].remove(entry->tileId);
+            removeEntry(entry->tileId, entry->zoom);
         }
 
         virtual void removeEntry(const TileId tileId, const ZoomLevel zoom)
         {
-            QWriteLocker scopedLock(&_tilesCollectionLock);
+            auto& shard = shardOf(tileId, zoom);
+            QWriteLocker scopedLock(&shard.lock);
 
-            _zoomLevels[zoom].remove(tileId);
+            shard.entries.erase(keyOf(tileId, zoom));
         }
 
         virtual void removeTileEntries(std::function<bool (const std::shared_ptr<ENTRY>& entry, bool& cancel)> filter = nullptr)
         {
-            QWriteLocker scopedLock(&_tilesCollectionLock);
-
             bool doCancel = false;
-            for(auto itZoomLevel = _zoomLevels.begin(); itZoomLevel != _zoomLevels.end(); ++itZoomLevel)
+            for(auto itShard = _shards.begin(); itShard != _shards.end(); ++itShard)
             {
-                auto& zoomLevel = *itZoomLevel;
+                auto& shard = *itShard;
+                QWriteLocker scopedLock(&shard.lock);
 
-                QMutableMapIterator< TileId, std::shared_ptr<ENTRY> > itEntryPair(zoomLevel);
-                while(itEntryPair.hasNext())
+                auto itEntryPair = shard.entries.begin();
+                while(itEntryPair != shard.entries.end())
                 {
-                    itEntryPair.next();
-
-                    const auto doRemove = (filter == nullptr) || filter(itEntryPair.value(), doCancel);
+                    const auto doRemove = (filter == nullptr) || filter(itEntryPair->second, doCancel);
                     if(doRemove)
-                        itEntryPair.remove();
+                        itEntryPair = shard.entries.erase(itEntryPair);
+                    else
+                        ++itEntryPair;
 
                     if(doCancel)
                         return;
@@ -79,6 +79,7 @@ namespace OsmAnd {
         OSMAND_CORE_API int OSMAND_CORE_CALL javaDoubleCompare(const double l, const double r);
         OSMAND_CORE_API void OSMAND_CORE_CALL findFiles(const QDir& origin, const QStringList& masks, QFileInfoList& files, const bool recursively = true);
         OSMAND_CORE_API double OSMAND_CORE_CALL polygonArea(const QVector<PointI>& points);
+        OSMAND_CORE_API double OSMAND_CORE_CALL polygonArea(const PointI* points, const int count);
         OSMAND_CORE_API bool OSMAND_CORE_CALL rayIntersectX(const PointF& v0, const PointF& v1, const float mY, float& mX);
         OSMAND_CORE_API bool OSMAND_CORE_CALL rayIntersect(const PointF& v0, const PointF& v1, const PointF& v);
         OSMAND_CORE_API bool OSMAND_CORE_CALL rayIntersectX(const PointI& v0, const PointI& v1, const int32_t mY, int32_t& mX);
@@ -8,9 +8,13 @@ const std::shared_ptr<OsmAnd::Concurrent::Pools> OsmAnd::Concurrent::pools(OsmAn
 OsmAnd::Concurrent::Pools::Pools()
     : localStorage(new QThreadPool())
     , network(new QThreadPool())
+    , obfReading(new QThreadPool())
+    , routing(new QThreadPool())
 {
     localStorage->setMaxThreadCount(4);
     network->setMaxThreadCount(4);
+    obfReading->setMaxThreadCount(QThread::idealThreadCount());
+    routing->setMaxThreadCount(QThread::idealThreadCount());
 }
 
 OsmAnd::Concurrent::Pools::~Pools()
@@ -2,12 +2,17 @@
 
 #include <cassert>
 
+#include "MapObjectsBlock.h"
 #include "ObfMapSectionReader.h"
 #include "ObfMapSectionInfo.h"
 
-OsmAnd::Model::MapObject::MapObject(const std::shared_ptr<const ObfMapSectionInfo>& section_, const std::shared_ptr<const ObfMapSectionLevel>& level_)
-    : _id(std::numeric_limits<uint64_t>::max())
+OsmAnd::Model::MapObject::MapObject(
+    const std::shared_ptr<const ObfMapSectionInfo>& section_, const std::shared_ptr<const ObfMapSectionLevel>& level_,
+    const std::shared_ptr<const MapObjectsBlock>& block_)
+    : _block(block_)
+    , _id(std::numeric_limits<uint64_t>::max())
     , _foundation(MapFoundationType::Undefined)
+    , _isArea(false)
     , section(section_)
     , level(level_)
     , id(_id)
@@ -134,3 +139,13 @@ uint64_t OsmAnd::Model::MapObject::getUniqueId( const uint64_t id, const std::sh
 
     return uniqueId;
 }
+
+QString OsmAnd::Model::MapObject::NamesView::value( const QString& key, const QString& defaultValue /*= QString()*/ ) const
+{
+    for(auto itName = cbegin(); itName != cend(); ++itName)
+    {
+        if(itName.key() == key)
+            return itName.value();
+    }
+    return defaultValue;
+}
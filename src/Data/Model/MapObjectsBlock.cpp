@@ -0,0 +1,119 @@
+#include "MapObjectsBlock.h"
+
+#include <cassert>
+#include <limits>
+
+OsmAnd::Model::MapObjectsBlock::MapObjectsBlock( const QVector< TagValue >* const decodingRules )
+    : _decodingRules(decodingRules)
+{
+    assert(_decodingRules != nullptr);
+}
+
+OsmAnd::Model::MapObjectsBlock::~MapObjectsBlock()
+{
+}
+
+OsmAnd::Model::MapObjectsBlock::Entry::Entry()
+    : id(std::numeric_limits<uint64_t>::max())
+    , isArea(false)
+{
+}
+
+OsmAnd::Model::MapObjectsBlock::Checkpoint OsmAnd::Model::MapObjectsBlock::checkpoint() const
+{
+    Checkpoint checkpoint;
+    checkpoint.points31 = _points31.size();
+    checkpoint.innerPolygons = _innerPolygons.size();
+    checkpoint.rulesIds = _rulesIds.size();
+    checkpoint.names = _names.size();
+    return checkpoint;
+}
+
+void OsmAnd::Model::MapObjectsBlock::rollback( const Checkpoint& checkpoint )
+{
+    _points31.resize(checkpoint.points31);
+    _innerPolygons.resize(checkpoint.innerPolygons);
+    _rulesIds.resize(checkpoint.rulesIds);
+    _names.resize(checkpoint.names);
+}
+
+void OsmAnd::Model::MapObjectsBlock::appendPoints( const QVector< PointI >& points31, MapObject::Range& range )
+{
+    range.offset = _points31.size();
+    range.count = points31.size();
+    _points31 += points31;
+}
+
+void OsmAnd::Model::MapObjectsBlock::appendInnerPolygon( const QVector< PointI >& polygon31, MapObject::Range& range )
+{
+    MapObject::Range polygon;
+    appendPoints(polygon31, polygon);
+
+    if(range.count == 0)
+        range.offset = _innerPolygons.size();
+    assert(range.offset + range.count == _innerPolygons.size());
+
+    _innerPolygons.push_back(polygon);
+    range.count++;
+}
+
+void OsmAnd::Model::MapObjectsBlock::appendRuleId( const uint32_t ruleId, MapObject::Range& range )
+{
+    assert(ruleId < static_cast<uint32_t>(_decodingRules->size()));
+
+    if(range.count == 0)
+        range.offset = _rulesIds.size();
+    assert(range.offset + range.count == _rulesIds.size());
+
+    _rulesIds.push_back(ruleId);
+    range.count++;
+}
+
+void OsmAnd::Model::MapObjectsBlock::appendName( const uint32_t ruleId, const uint32_t stringId, MapObject::Range& range )
+{
+    assert(ruleId < static_cast<uint32_t>(_decodingRules->size()));
+
+    if(range.count == 0)
+        range.offset = _names.size();
+    assert(range.offset + range.count == _names.size());
+
+    MapObject::NameEntry name;
+    name.ruleId = ruleId;
+    name.stringId = stringId;
+    _names.push_back(name);
+    range.count++;
+}
+
+void OsmAnd::Model::MapObjectsBlock::squeeze()
+{
+    _points31.squeeze();
+    _innerPolygons.squeeze();
+    _rulesIds.squeeze();
+    _names.squeeze();
+    _stringTable.squeeze();
+}
+
+OsmAnd::Model::MapObject* OsmAnd::Model::MapObjectsBlock::createMapObject(
+    const std::shared_ptr<const MapObjectsBlock>& self,
+    const std::shared_ptr<const ObfMapSectionInfo>& section, const std::shared_ptr<const ObfMapSectionLevel>& level,
+    const Entry& entry ) const
+{
+    assert(self.get() == this);
+
+    const auto mapObject = new MapObject(section, level, self);
+    mapObject->_id = entry.id;
+    mapObject->_isArea = entry.isArea;
+    mapObject->_bbox31 = entry.bbox31;
+    mapObject->_points31 = MapObject::PointsView(
+        _points31.constData() + entry.points31.offset, entry.points31.count);
+    mapObject->_innerPolygonsPoints31 = MapObject::InnerPolygonsView(
+        _points31.constData(), _innerPolygons.constData() + entry.innerPolygons.offset, entry.innerPolygons.count);
+    mapObject->_types = MapObject::TypesView(
+        _rulesIds.constData() + entry.types.offset, entry.types.count, _decodingRules->constData());
+    mapObject->_extraTypes = MapObject::TypesView(
+        _rulesIds.constData() + entry.extraTypes.offset, entry.extraTypes.count, _decodingRules->constData());
+    mapObject->_names = MapObject::NamesView(
+        _names.constData() + entry.names.offset, entry.names.count, _decodingRules->constData(), _stringTable.constData());
+
+    return mapObject;
+}
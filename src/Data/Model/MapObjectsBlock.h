@@ -0,0 +1,111 @@
+/**
+ * @file
+ *
+ * @section LICENSE
+ *
+ * OsmAnd - Android navigation software based on OSM maps.
+ * Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MODEL_MAP_OBJECTS_BLOCK_H_
+#define __MODEL_MAP_OBJECTS_BLOCK_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QVector>
+#include <QString>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/Data/Model/MapObject.h>
+
+namespace OsmAnd {
+
+    class ObfMapSectionReader_P;
+    class Rasterizer_P;
+
+    namespace Model {
+
+        /**
+        Storage of all map objects decoded from single MapDataBlock. Points, rule ids and names of all objects
+        are kept in few contiguous arrays, while each MapObject is only a view into this storage that keeps it alive.
+        */
+        class MapObjectsBlock
+        {
+        private:
+            Q_DISABLE_COPY(MapObjectsBlock);
+        protected:
+            // Decoding table (tag-value per rule id) that is owned by map section, or static for generated objects
+            const QVector< TagValue >* const _decodingRules;
+
+            QVector< PointI > _points31;
+            QVector< MapObject::Range > _innerPolygons;
+            QVector< uint32_t > _rulesIds;
+            QVector< MapObject::NameEntry > _names;
+            QVector< QString > _stringTable;
+
+            // Location of single map object data inside arrays of this block
+            struct Entry
+            {
+                Entry();
+
+                uint64_t id;
+                bool isArea;
+                AreaI bbox31;
+                MapObject::Range points31;
+                MapObject::Range innerPolygons;
+                MapObject::Range types;
+                MapObject::Range extraTypes;
+                MapObject::Range names;
+            };
+
+            // Sizes of arrays, used to drop data of map object that was rejected while being read
+            struct Checkpoint
+            {
+                int points31;
+                int innerPolygons;
+                int rulesIds;
+                int names;
+            };
+            Checkpoint checkpoint() const;
+            void rollback(const Checkpoint& checkpoint);
+
+            void appendPoints(const QVector< PointI >& points31, MapObject::Range& range);
+            void appendInnerPolygon(const QVector< PointI >& polygon31, MapObject::Range& range);
+            void appendRuleId(const uint32_t ruleId, MapObject::Range& range);
+            void appendName(const uint32_t ruleId, const uint32_t stringId, MapObject::Range& range);
+
+            // Releases spare capacity. Must be called before any view into this block is created
+            void squeeze();
+
+            MapObject* createMapObject(
+                const std::shared_ptr<const MapObjectsBlock>& self,
+                const std::shared_ptr<const ObfMapSectionInfo>& section, const std::shared_ptr<const ObfMapSectionLevel>& level,
+                const Entry& entry) const;
+        public:
+            MapObjectsBlock(const QVector< TagValue >* const decodingRules);
+            virtual ~MapObjectsBlock();
+
+        friend class OsmAnd::ObfMapSectionReader_P;
+        friend class OsmAnd::Rasterizer_P;
+        };
+
+    } // namespace Model
+
+} // namespace OsmAnd
+
+#endif // __MODEL_MAP_OBJECTS_BLOCK_H_
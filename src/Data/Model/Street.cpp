@@ -5,6 +5,7 @@ OsmAnd::Model::Street::Street()
     , name(_name)
     , latinName(_name)
     , tile24(_tile24)
+    , group(_group)
 {
 }
 
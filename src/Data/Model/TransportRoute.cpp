@@ -0,0 +1,22 @@
+#include "TransportRoute.h"
+
+OsmAnd::Model::TransportRoute::TransportRoute()
+    : _id(0)
+    , _offset(0)
+    , _distance(0)
+    , id(_id)
+    , offset(_offset)
+    , type(_type)
+    , operatorName(_operatorName)
+    , ref(_ref)
+    , name(_name)
+    , latinName(_latinName)
+    , distance(_distance)
+    , forwardStops(_forwardStops)
+    , backwardStops(_backwardStops)
+{
+}
+
+OsmAnd::Model::TransportRoute::~TransportRoute()
+{
+}
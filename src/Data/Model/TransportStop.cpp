@@ -0,0 +1,17 @@
+#include "TransportStop.h"
+
+OsmAnd::Model::TransportStop::TransportStop()
+    : _id(0)
+    , _offset(0)
+    , id(_id)
+    , offset(_offset)
+    , point31(_point31)
+    , name(_name)
+    , latinName(_latinName)
+    , routesOffsets(_routesOffsets)
+{
+}
+
+OsmAnd::Model::TransportStop::~TransportStop()
+{
+}
@@ -1,4 +1,5 @@
 #include "ObfAddressSectionInfo.h"
+#include "ObfAddressSectionInfo_P.h"
 
 #include "OBF.pb.h"
 
@@ -15,6 +16,7 @@ static_assert(
 
 OsmAnd::ObfAddressSectionInfo::ObfAddressSectionInfo( const std::weak_ptr<ObfInfo>& owner )
     : ObfSectionInfo(owner)
+    , _d(new ObfAddressSectionInfo_P(this))
     , addressBlocksSections(_addressBlocksSections)
 {
 }
@@ -0,0 +1,13 @@
+#include "ObfAddressSectionInfo_P.h"
+
+OsmAnd::ObfAddressSectionInfo_P::ObfAddressSectionInfo_P( ObfAddressSectionInfo* owner_ )
+    : owner(owner_)
+    , _nameIndexOffset(0)
+    , _nameIndexLength(0)
+    , _nameIndexTableOffset(0)
+{
+}
+
+OsmAnd::ObfAddressSectionInfo_P::~ObfAddressSectionInfo_P()
+{
+}
@@ -0,0 +1,74 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __OBF_ADDRESS_SECTION_INFO_P_H_
+#define __OBF_ADDRESS_SECTION_INFO_P_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QMutex>
+#include <QList>
+#include <QString>
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd {
+
+    class ObfAddressSectionReader_P;
+
+    class ObfAddressSectionInfo;
+    class ObfAddressSectionInfo_P
+    {
+        Q_DISABLE_COPY(ObfAddressSectionInfo_P)
+    private:
+    protected:
+        ObfAddressSectionInfo_P(ObfAddressSectionInfo* owner);
+
+        ObfAddressSectionInfo* const owner;
+
+        uint32_t _nameIndexOffset;
+        uint32_t _nameIndexLength;
+        // Values of name index table are relative to start of that table, which is known once table was read
+        uint32_t _nameIndexTableOffset;
+
+        // Keys of name index table with their values (offsets of name index data), decoded once per section.
+        // Key is stored with prefixes of all parent tables
+        struct NameIndexNode
+        {
+            QString key;
+            QList<uint32_t> values;
+            QList< std::shared_ptr<NameIndexNode> > children;
+        };
+        mutable QMutex _nameIndexMutex;
+        std::shared_ptr< QList< std::shared_ptr<NameIndexNode> > > _nameIndex;
+    public:
+        virtual ~ObfAddressSectionInfo_P();
+
+    friend class OsmAnd::ObfAddressSectionInfo;
+    friend class OsmAnd::ObfAddressSectionReader_P;
+    };
+
+} // namespace OsmAnd
+
+#endif // __OBF_ADDRESS_SECTION_INFO_P_H_
@@ -43,3 +43,22 @@ void OsmAnd::ObfAddressSectionReader::loadIntersectionsFromStreet(
 {
     ObfAddressSectionReader_P::loadIntersectionsFromStreet(reader->_d, street, resultOut, visitor, controller);
 }
+
+void OsmAnd::ObfAddressSectionReader::findStreetGroupsByName(
+    const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+    const QString& query,
+    QList< std::shared_ptr<const Model::StreetGroup> >* resultOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetGroup>&)> visitor /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/, QSet<ObfAddressBlockType>* blockTypeFilter /*= nullptr*/ )
+{
+    ObfAddressSectionReader_P::findStreetGroupsByName(reader->_d, section, query, resultOut, visitor, controller, blockTypeFilter);
+}
+
+void OsmAnd::ObfAddressSectionReader::findStreetsByName(
+    const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+    const QString& query,
+    QList< std::shared_ptr<const Model::Street> >* resultOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::Street>&)> visitor /*= nullptr*/, const IQueryController* const controller /*= nullptr*/ )
+{
+    ObfAddressSectionReader_P::findStreetsByName(reader->_d, section, query, resultOut, visitor, controller);
+}
@@ -3,6 +3,7 @@
 #include "ObfReader.h"
 #include "ObfReader_P.h"
 #include "ObfAddressSectionInfo.h"
+#include "ObfAddressSectionInfo_P.h"
 #include "Street.h"
 #include "StreetGroup.h"
 #include "Settlement.h"
@@ -56,6 +57,8 @@ void OsmAnd::ObfAddressSectionReader_P::read( const std::unique_ptr<ObfReader_P>
             {
                 auto indexNameOffset = cis->CurrentPosition();
                 auto length = ObfReaderUtilities::readBigEndianInt(cis);
+                section->_d->_nameIndexOffset = indexNameOffset + 4;
+                section->_d->_nameIndexLength = length;
                 cis->Seek(indexNameOffset + length + 4);
             }
             break;
@@ -294,8 +297,9 @@ void OsmAnd::ObfAddressSectionReader_P::readStreetsFromGroup(
             return;
         case OBF::CityBlockIndex::kStreetsFieldNumber:
             {
-                std::shared_ptr<Model::Street> street(new Model::Street(/*TODO:group*/));
+                std::shared_ptr<Model::Street> street(new Model::Street());
                 street->_offset = cis->CurrentPosition();
+                street->_group = group;
                 gpb::uint32 length;
                 cis->ReadVarint32(&length);
                 auto oldLimit = cis->PushLimit(length);
@@ -610,3 +614,388 @@ void OsmAnd::ObfAddressSectionReader_P::readIntersectedStreet(
         }
     }
 }
+
+std::shared_ptr< const QList< std::shared_ptr<OsmAnd::ObfAddressSectionInfo_P::NameIndexNode> > > OsmAnd::ObfAddressSectionReader_P::obtainNameIndex(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section )
+{
+    QMutexLocker scopedLock(&section->_d->_nameIndexMutex);
+
+    if(!section->_d->_nameIndex)
+    {
+        std::shared_ptr< QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> > > nameIndex(new QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >());
+
+        auto cis = reader->_codedInputStream.get();
+        cis->Seek(section->_d->_nameIndexOffset);
+        auto oldLimit = cis->PushLimit(section->_d->_nameIndexLength);
+        readNameIndex(reader, *nameIndex, section->_d->_nameIndexTableOffset);
+        cis->PopLimit(oldLimit);
+
+        section->_d->_nameIndex = nameIndex;
+    }
+
+    return section->_d->_nameIndex;
+}
+
+void OsmAnd::ObfAddressSectionReader_P::readNameIndex(
+    const std::unique_ptr<ObfReader_P>& reader,
+    QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >& nodes, uint32_t& tableOffsetOut )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndAddressNameIndexData::kTableFieldNumber:
+            {
+                auto length = ObfReaderUtilities::readBigEndianInt(cis);
+                tableOffsetOut = cis->CurrentPosition();
+                auto oldLimit = cis->PushLimit(length);
+                readNameIndexTable(reader, QString(), nodes);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        case OBF::OsmAndAddressNameIndexData::kAtomFieldNumber:
+            // Data is read only when referenced by table
+            cis->Skip(cis->BytesUntilLimit());
+            return;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfAddressSectionReader_P::readNameIndexTable(
+    const std::unique_ptr<ObfReader_P>& reader, const QString& keysPrefix,
+    QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >& nodes )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    // Values and subtables belong to key that precedes them
+    std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> node;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::IndexedStringTable::kKeyFieldNumber:
+            {
+                node.reset(new ObfAddressSectionInfo_P::NameIndexNode());
+                ObfReaderUtilities::readQString(cis, node->key);
+                node->key.prepend(keysPrefix);
+                nodes.push_back(node);
+            }
+            break;
+        case OBF::IndexedStringTable::kValFieldNumber:
+            {
+                const auto value = ObfReaderUtilities::readBigEndianInt(cis);
+                if(node)
+                    node->values.push_back(value);
+            }
+            break;
+        case OBF::IndexedStringTable::kSubtablesFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                if(node)
+                    readNameIndexTable(reader, node->key, node->children);
+                else
+                    cis->Skip(cis->BytesUntilLimit());
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+int OsmAnd::ObfAddressSectionReader_P::lookupNameIndex(
+    const QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >& nodes, const QString& query,
+    QList<uint32_t>& valuesOut, int matchedLength )
+{
+    // Same matching as ObfReaderUtilities::readIndexedStringTable(), but over decoded table
+    for(auto itNode = nodes.cbegin(); itNode != nodes.cend(); ++itNode)
+    {
+        const auto& node = *itNode;
+
+        int keyMatchedLength = -1;
+        if(node->key.startsWith(query, Qt::CaseInsensitive))
+            keyMatchedLength = query.length();
+        else if(query.startsWith(node->key, Qt::CaseInsensitive))
+            keyMatchedLength = node->key.length();
+        if(keyMatchedLength < matchedLength)
+            continue;
+
+        if(keyMatchedLength > matchedLength)
+        {
+            matchedLength = keyMatchedLength;
+            valuesOut.clear();
+        }
+        valuesOut.append(node->values);
+        matchedLength = lookupNameIndex(node->children, query, valuesOut, matchedLength);
+    }
+
+    return matchedLength;
+}
+
+void OsmAnd::ObfAddressSectionReader_P::readNameIndexReferences(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+    const QString& query,
+    QList<NameIndexReference>& references,
+    const IQueryController* const controller )
+{
+    if(query.isEmpty() || section->_d->_nameIndexLength == 0)
+        return;
+
+    QList<uint32_t> dataOffsets;
+    lookupNameIndex(*obtainNameIndex(reader, section), query, dataOffsets, 0);
+    qSort(dataOffsets);
+
+    auto cis = reader->_codedInputStream.get();
+    for(auto itDataOffset = dataOffsets.cbegin(); itDataOffset != dataOffsets.cend(); ++itDataOffset)
+    {
+        if(controller && controller->isAborted())
+            return;
+
+        const auto dataOffset = section->_d->_nameIndexTableOffset + *itDataOffset;
+        cis->Seek(dataOffset);
+        gpb::uint32 length;
+        cis->ReadVarint32(&length);
+        auto oldLimit = cis->PushLimit(length);
+        readNameIndexData(reader, dataOffset, query, references);
+        cis->PopLimit(oldLimit);
+    }
+
+    // Referenced messages are read in order of their offsets
+    qSort(references.begin(), references.end(), [](const NameIndexReference& l, const NameIndexReference& r) -> bool
+    {
+        return l._offset < r._offset;
+    });
+}
+
+void OsmAnd::ObfAddressSectionReader_P::readNameIndexData(
+    const std::unique_ptr<ObfReader_P>& reader, uint32_t dataOffset, const QString& query,
+    QList<NameIndexReference>& references )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndAddressNameIndexData_AddressNameIndexData::kAtomFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                readNameIndexDataAtom(reader, dataOffset, query, references);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfAddressSectionReader_P::readNameIndexDataAtom(
+    const std::unique_ptr<ObfReader_P>& reader, uint32_t dataOffset, const QString& query,
+    QList<NameIndexReference>& references )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    QString name;
+    QString latinName;
+    gpb::uint32 type = 0;
+    QList<uint32_t> offsets;
+    QList<uint32_t> streetGroupOffsets;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            {
+                // Table matches only beginning of names, so actual name is checked here
+                if(latinName.isEmpty())
+                    latinName = reader->transliterate(name);
+                if(!ObfReaderUtilities::nameMatchesQuery(name, query) && !ObfReaderUtilities::nameMatchesQuery(latinName, query))
+                    return;
+
+                for(auto idx = 0; idx < offsets.size(); idx++)
+                {
+                    NameIndexReference reference;
+                    reference._type = type;
+                    reference._offset = offsets[idx];
+                    reference._streetGroupOffset = idx < streetGroupOffsets.size() ? streetGroupOffsets[idx] : 0;
+                    references.push_back(reference);
+                }
+            }
+            return;
+        case OBF::AddressNameIndexDataAtom::kNameFieldNumber:
+            ObfReaderUtilities::readQString(cis, name);
+            break;
+        case OBF::AddressNameIndexDataAtom::kNameEnFieldNumber:
+            ObfReaderUtilities::readQString(cis, latinName);
+            break;
+        case OBF::AddressNameIndexDataAtom::kTypeFieldNumber:
+            cis->ReadVarint32(&type);
+            break;
+        case OBF::AddressNameIndexDataAtom::kShiftToIndexFieldNumber:
+            {
+                // Referenced messages precede name index, so shift is measured backwards
+                gpb::uint32 shift;
+                cis->ReadVarint32(&shift);
+                offsets.push_back(dataOffset - shift);
+            }
+            break;
+        case OBF::AddressNameIndexDataAtom::kShiftToCityIndexFieldNumber:
+            {
+                gpb::uint32 shift;
+                cis->ReadVarint32(&shift);
+                streetGroupOffsets.push_back(dataOffset - shift);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+std::shared_ptr<const OsmAnd::Model::StreetGroup> OsmAnd::ObfAddressSectionReader_P::readStreetGroupAt(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+    uint32_t offset )
+{
+    std::shared_ptr<const ObfAddressBlocksSectionInfo> addressBlocksSection;
+    for(auto itAddressBlocksSection = section->addressBlocksSections.cbegin(); itAddressBlocksSection != section->addressBlocksSections.cend(); ++itAddressBlocksSection)
+    {
+        const auto& block = *itAddressBlocksSection;
+        if(offset >= block->_offset && offset < block->_offset + block->_length)
+        {
+            addressBlocksSection = block;
+            break;
+        }
+    }
+    if(!addressBlocksSection)
+        return nullptr;
+
+    auto cis = reader->_codedInputStream.get();
+    cis->Seek(offset);
+    gpb::uint32 length;
+    cis->ReadVarint32(&length);
+    auto oldLimit = cis->PushLimit(length);
+    std::shared_ptr<Model::StreetGroup> streetGroup;
+    readStreetGroupHeader(reader, addressBlocksSection, offset, streetGroup);
+    cis->PopLimit(oldLimit);
+
+    return streetGroup;
+}
+
+void OsmAnd::ObfAddressSectionReader_P::findStreetGroupsByName(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+    const QString& query,
+    QList< std::shared_ptr<const Model::StreetGroup> >* resultOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetGroup>&)> visitor /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/,
+    QSet<ObfAddressBlockType>* blockTypeFilter /*= nullptr*/ )
+{
+    QList<NameIndexReference> references;
+    readNameIndexReferences(reader, section, query.trimmed(), references, controller);
+
+    // Same street group is referenced by each of its names
+    QSet<uint32_t> processedOffsets;
+    for(auto itReference = references.cbegin(); itReference != references.cend(); ++itReference)
+    {
+        if(controller && controller->isAborted())
+            return;
+
+        const auto& reference = *itReference;
+        if(reference._type == StreetNameIndexAtomType)
+            continue;
+        if(blockTypeFilter && !blockTypeFilter->contains(static_cast<ObfAddressBlockType>(reference._type)))
+            continue;
+        if(processedOffsets.contains(reference._offset))
+            continue;
+        processedOffsets.insert(reference._offset);
+
+        const auto streetGroup = readStreetGroupAt(reader, section, reference._offset);
+        if(!streetGroup)
+            continue;
+
+        if(!visitor || visitor(streetGroup))
+        {
+            if(resultOut)
+                resultOut->push_back(streetGroup);
+        }
+    }
+}
+
+void OsmAnd::ObfAddressSectionReader_P::findStreetsByName(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+    const QString& query,
+    QList< std::shared_ptr<const Model::Street> >* resultOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::Street>&)> visitor /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    QList<NameIndexReference> references;
+    readNameIndexReferences(reader, section, query.trimmed(), references, controller);
+
+    auto cis = reader->_codedInputStream.get();
+    QSet<uint32_t> processedOffsets;
+    QHash< uint32_t, std::shared_ptr<const Model::StreetGroup> > streetGroups;
+    for(auto itReference = references.cbegin(); itReference != references.cend(); ++itReference)
+    {
+        if(controller && controller->isAborted())
+            return;
+
+        const auto& reference = *itReference;
+        if(reference._type != StreetNameIndexAtomType)
+            continue;
+        if(processedOffsets.contains(reference._offset))
+            continue;
+        processedOffsets.insert(reference._offset);
+
+        // Street coordinates are encoded relative to its street group, which is usually shared by many streets
+        std::shared_ptr<const Model::StreetGroup> streetGroup;
+        const auto itStreetGroup = streetGroups.constFind(reference._streetGroupOffset);
+        if(itStreetGroup != streetGroups.cend())
+            streetGroup = *itStreetGroup;
+        else
+        {
+            streetGroup = readStreetGroupAt(reader, section, reference._streetGroupOffset);
+            streetGroups.insert(reference._streetGroupOffset, streetGroup);
+        }
+        if(!streetGroup)
+            continue;
+
+        std::shared_ptr<Model::Street> street(new Model::Street());
+        street->_offset = reference._offset;
+        street->_group = streetGroup;
+        cis->Seek(reference._offset);
+        gpb::uint32 length;
+        cis->ReadVarint32(&length);
+        auto oldLimit = cis->PushLimit(length);
+        readStreet(reader, streetGroup, street);
+        cis->PopLimit(oldLimit);
+
+        if(!visitor || visitor(street))
+        {
+            if(resultOut)
+                resultOut->push_back(street);
+        }
+    }
+}
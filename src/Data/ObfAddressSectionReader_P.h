@@ -29,10 +29,12 @@
 
 #include <QList>
 #include <QSet>
+#include <QString>
 
 #include <OsmAndCore.h>
 #include <CommonTypes.h>
 #include <ObfMapSectionInfo_P.h>
+#include <ObfAddressSectionInfo_P.h>
 #include <MapTypes.h>
 
 namespace OsmAnd {
@@ -97,6 +99,36 @@ namespace OsmAnd {
         static void readIntersectedStreet(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const Model::Street>& street,
             const std::shared_ptr<Model::StreetIntersection>& intersection);
 
+        static std::shared_ptr< const QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> > > obtainNameIndex(
+            const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section);
+        static void readNameIndex(const std::unique_ptr<ObfReader_P>& reader,
+            QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >& nodes, uint32_t& tableOffsetOut);
+        static void readNameIndexTable(const std::unique_ptr<ObfReader_P>& reader, const QString& keysPrefix,
+            QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >& nodes);
+        static int lookupNameIndex(const QList< std::shared_ptr<ObfAddressSectionInfo_P::NameIndexNode> >& nodes, const QString& query,
+            QList<uint32_t>& valuesOut, int matchedLength);
+
+        enum {
+            // Types of name index atoms. Other types match values of ObfAddressBlockType
+            StreetNameIndexAtomType = 4,
+        };
+        struct NameIndexReference
+        {
+            uint32_t _type;
+            uint32_t _offset;
+            uint32_t _streetGroupOffset;
+        };
+        static void readNameIndexReferences(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+            const QString& query,
+            QList<NameIndexReference>& references,
+            const IQueryController* const controller);
+        static void readNameIndexData(const std::unique_ptr<ObfReader_P>& reader, uint32_t dataOffset, const QString& query,
+            QList<NameIndexReference>& references);
+        static void readNameIndexDataAtom(const std::unique_ptr<ObfReader_P>& reader, uint32_t dataOffset, const QString& query,
+            QList<NameIndexReference>& references);
+        static std::shared_ptr<const Model::StreetGroup> readStreetGroupAt(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+            uint32_t offset);
+
         static void loadStreetGroups(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
             QList< std::shared_ptr<const Model::StreetGroup> >* resultOut = nullptr,
             std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetGroup>&)> visitor = nullptr,
@@ -118,6 +150,19 @@ namespace OsmAnd {
             std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetIntersection>&)> visitor = nullptr,
             const IQueryController* const controller = nullptr);
 
+        static void findStreetGroupsByName(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+            const QString& query,
+            QList< std::shared_ptr<const Model::StreetGroup> >* resultOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::StreetGroup>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr,
+            QSet<ObfAddressBlockType>* blockTypeFilter = nullptr);
+
+        static void findStreetsByName(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfAddressSectionInfo>& section,
+            const QString& query,
+            QList< std::shared_ptr<const Model::Street> >* resultOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::Street>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr);
+
     friend class OsmAnd::ObfReader_P;
     friend class OsmAnd::ObfAddressSectionReader;
     };
@@ -4,10 +4,16 @@
 #include "ObfReader.h"
 #include "ObfInfo.h"
 #include "ObfMapSectionReader.h"
+#include "ObfPoiSectionReader.h"
+#include "ObfAddressSectionReader.h"
 #include "IQueryController.h"
+#include "Amenity.h"
+#include "StreetGroup.h"
+#include "Street.h"
+#include "Utilities.h"
 
-OsmAnd::ObfDataInterface::ObfDataInterface( const QList< std::shared_ptr<ObfReader> >& readers )
-    : _d(new ObfDataInterface_P(this, readers))
+OsmAnd::ObfDataInterface::ObfDataInterface( const QList< std::shared_ptr<ObfReader> >& readers, const bool parallelReading /*= false*/ )
+    : _d(new ObfDataInterface_P(this, readers, parallelReading))
 {
 }
 
@@ -54,6 +60,12 @@ void OsmAnd::ObfDataInterface::obtainMapObjects(
     if(foundationOut)
         *foundationOut = MapFoundationType::Undefined;
 
+    if(_d->parallelReading && _d->readers.size() > 1)
+    {
+        _d->obtainMapObjectsInParallel(resultOut, foundationOut, area31, zoom, controller, filterById);
+        return;
+    }
+
     // Iterate through all OBF readers
     for(auto itObfReader = _d->readers.cbegin(); itObfReader != _d->readers.cend(); ++itObfReader)
     {
@@ -76,3 +88,46 @@ void OsmAnd::ObfDataInterface::obtainMapObjects(
         }
     }
 }
+
+OsmAnd::ObfDataInterface::SearchResult::SearchResult()
+    : distance(0.0)
+    , nameScore(0)
+{
+}
+
+void OsmAnd::ObfDataInterface::searchByName(
+    const QString& query, const PointI& location31, const int maxResultsCount,
+    QList<SearchResult>* resultOut, const IQueryController* const controller /*= nullptr*/ )
+{
+    if(query.trimmed().isEmpty() || maxResultsCount <= 0)
+        return;
+
+    // Search is stopped when request is aborted, or when it can not find better results
+    ObfDataInterface_P::SearchController searchController(controller);
+    ObfDataInterface_P::SearchResults results(maxResultsCount);
+
+    if(_d->parallelReading && _d->readers.size() > 1)
+    {
+        _d->searchByNameInParallel(query, location31, results, &searchController);
+    }
+    else
+    {
+        for(auto itObfReader = _d->readers.cbegin(); itObfReader != _d->readers.cend(); ++itObfReader)
+        {
+            if(searchController.isAborted())
+                break;
+
+            _d->searchByName(*itObfReader, query, location31, results, &searchController);
+        }
+    }
+
+    // Check if request is aborted
+    if(controller && controller->isAborted())
+        return;
+
+    if(resultOut)
+    {
+        for(auto itResult = results.ranked.cbegin(); itResult != results.ranked.cend(); ++itResult)
+            resultOut->push_back(*itResult);
+    }
+}
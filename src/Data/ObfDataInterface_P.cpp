@@ -1,12 +1,286 @@
 #include "ObfDataInterface_P.h"
 #include "ObfDataInterface.h"
 
-OsmAnd::ObfDataInterface_P::ObfDataInterface_P( ObfDataInterface* owner_, const QList< std::shared_ptr<ObfReader> >& readers_ )
+#include <QVector>
+#include <QMutex>
+#include <QSemaphore>
+
+#include "ObfReader.h"
+#include "ObfInfo.h"
+#include "ObfMapSectionReader.h"
+#include "ObfPoiSectionReader.h"
+#include "ObfAddressSectionReader.h"
+#include "ObfReaderUtilities.h"
+#include "IQueryController.h"
+#include "Amenity.h"
+#include "StreetGroup.h"
+#include "Street.h"
+#include "Utilities.h"
+#include "Concurrent.h"
+
+OsmAnd::ObfDataInterface_P::ObfDataInterface_P( ObfDataInterface* owner_, const QList< std::shared_ptr<ObfReader> >& readers_, const bool parallelReading_ )
     : owner(owner_)
     , readers(readers_)
+    , parallelReading(parallelReading_)
 {
 }
 
 OsmAnd::ObfDataInterface_P::~ObfDataInterface_P()
 {
 }
+
+void OsmAnd::ObfDataInterface_P::obtainMapObjectsInParallel(
+    QList< std::shared_ptr<const OsmAnd::Model::MapObject> >* resultOut, MapFoundationType* foundationOut,
+    const AreaI& area31, const ZoomLevel zoom,
+    const IQueryController* const controller, std::function<bool (const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t)> filterById )
+{
+    // Each reader is processed by single worker, since reader can not be shared between threads.
+    // Results are collected per-reader and merged in order of readers, to be same as in serial readout
+    struct ReaderResult
+    {
+        ReaderResult()
+            : foundation(MapFoundationType::Undefined)
+        {}
+
+        QList< std::shared_ptr<const OsmAnd::Model::MapObject> > mapObjects;
+        MapFoundationType foundation;
+    };
+    QVector<ReaderResult> results(readers.size());
+    const auto resultsData = results.data();
+
+    // Filter may be not thread-safe, so serialize calls to it
+    QMutex filterMutex;
+    std::function<bool (const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t)> serializedFilterById = nullptr;
+    if(filterById)
+    {
+        serializedFilterById = [&filterMutex, filterById](const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t id) -> bool
+        {
+            QMutexLocker scopedLocker(&filterMutex);
+            return filterById(section, id);
+        };
+    }
+
+    const auto readReader = [resultsData, resultOut, area31, zoom, controller, serializedFilterById](const std::shared_ptr<ObfReader>& obfReader, const int readerIndex)
+    {
+        auto& result = resultsData[readerIndex];
+
+        const auto& obfInfo = obfReader->obtainInfo();
+        for(auto itMapSection = obfInfo->mapSections.cbegin(); itMapSection != obfInfo->mapSections.cend(); ++itMapSection)
+        {
+            // Check if request is aborted
+            if(controller && controller->isAborted())
+                return;
+
+            // Read objects from each map section
+            const auto& mapSection = *itMapSection;
+            OsmAnd::ObfMapSectionReader::loadMapObjects(obfReader, mapSection, zoom, &area31,
+                resultOut ? &result.mapObjects : nullptr, &result.foundation, serializedFilterById, nullptr, controller);
+        }
+    };
+
+    // Fan out all readers except first one to workers, while first is read on this thread
+    QSemaphore finishedReaders;
+    for(auto readerIndex = 1; readerIndex < readers.size(); readerIndex++)
+    {
+        const auto& obfReader = readers[readerIndex];
+        Concurrent::pools->obfReading->start(new Concurrent::Task([&readReader, &finishedReaders, obfReader, readerIndex](const Concurrent::Task* task, QEventLoop& eventLoop)
+            {
+                readReader(obfReader, readerIndex);
+                finishedReaders.release();
+            }));
+    }
+    readReader(readers.first(), 0);
+    finishedReaders.acquire(readers.size() - 1);
+
+    // Check if request is aborted
+    if(controller && controller->isAborted())
+        return;
+
+    // Merge results in order of readers
+    auto foundation = MapFoundationType::Undefined;
+    for(auto itResult = results.cbegin(); itResult != results.cend(); ++itResult)
+    {
+        const auto& result = *itResult;
+
+        if(resultOut)
+            resultOut->append(result.mapObjects);
+
+        if(result.foundation != MapFoundationType::Undefined)
+        {
+            if(foundation == MapFoundationType::Undefined)
+                foundation = result.foundation;
+            else if(foundation != result.foundation)
+                foundation = MapFoundationType::Mixed;
+        }
+    }
+    if(foundationOut)
+        *foundationOut = foundation;
+}
+
+OsmAnd::ObfDataInterface_P::SearchController::SearchController( const IQueryController* const parent_ )
+    : parent(parent_)
+    , isStopped(0)
+{
+}
+
+OsmAnd::ObfDataInterface_P::SearchController::~SearchController()
+{
+}
+
+bool OsmAnd::ObfDataInterface_P::SearchController::isAborted() const
+{
+    return isStopped.load() != 0 || (parent && parent->isAborted());
+}
+
+int OsmAnd::ObfDataInterface_P::getNameScore( const QString& name, const QString& latinName, const QString& query )
+{
+    const QString names[] = { name, latinName };
+
+    // Objects were already matched by name index, maybe by transliterated or other name that is not compared here,
+    // so score is never below word prefix one (and rank never divides by zero)
+    int score = WordPrefixNameScore;
+    for(auto idx = 0; idx < 2; idx++)
+    {
+        const auto& value = names[idx];
+        if(value.compare(query, Qt::CaseInsensitive) == 0)
+            score = qMax<int>(score, WholeNameScore);
+        else if(value.startsWith(query, Qt::CaseInsensitive))
+            score = qMax<int>(score, NamePrefixNameScore);
+        else if(ObfReaderUtilities::nameMatchesQuery(value, query))
+            score = qMax<int>(score, WordPrefixNameScore);
+    }
+    return score;
+}
+
+OsmAnd::ObfDataInterface_P::SearchResults::SearchResults( const int maxCount_ )
+    : maxCount(maxCount_)
+    , wholeNameMatchesCount(0)
+{
+}
+
+bool OsmAnd::ObfDataInterface_P::SearchResults::canAccept( const double rank ) const
+{
+    QMutexLocker scopedLocker(&mutex);
+
+    return ranked.size() < maxCount || rank < ranked.lastKey();
+}
+
+bool OsmAnd::ObfDataInterface_P::SearchResults::insert( const ObfDataInterface::SearchResult& result )
+{
+    const auto rank = result.distance / result.nameScore;
+
+    QMutexLocker scopedLocker(&mutex);
+
+    if(ranked.size() >= maxCount && rank >= ranked.lastKey())
+        return false;
+
+    ranked.insert(rank, result);
+    if(result.nameScore == WholeNameScore)
+        wholeNameMatchesCount++;
+    if(ranked.size() > maxCount)
+    {
+        const auto itWorst = --ranked.end();
+        if(itWorst->nameScore == WholeNameScore)
+            wholeNameMatchesCount--;
+        ranked.erase(itWorst);
+    }
+
+    // All kept results match whole name, so search is complete
+    return wholeNameMatchesCount == maxCount;
+}
+
+void OsmAnd::ObfDataInterface_P::searchByName(
+    const std::shared_ptr<ObfReader>& obfReader, const QString& query, const PointI& location31,
+    SearchResults& results, SearchController* const controller )
+{
+    const auto normalizedQuery = query.trimmed();
+    const auto insertResult = [&results, controller](const ObfDataInterface::SearchResult& result)
+    {
+        if(results.insert(result))
+            controller->isStopped.store(1);
+    };
+
+    const auto& obfInfo = obfReader->obtainInfo();
+    for(auto itPoiSection = obfInfo->poiSections.cbegin(); itPoiSection != obfInfo->poiSections.cend(); ++itPoiSection)
+    {
+        // Check if request is aborted
+        if(controller->isAborted())
+            return;
+
+        // Amenities are reported ordered by distance, so rest of section is skipped once even whole name match
+        // of next amenity can not be accepted
+        SearchController sectionController(controller);
+        const auto visitor = [&](const std::shared_ptr<const Model::Amenity>& amenity) -> bool
+        {
+            ObfDataInterface::SearchResult result;
+            result.amenity = amenity;
+            result.location31 = amenity->point31;
+            result.distance = Utilities::distance31(location31, amenity->point31);
+            result.nameScore = getNameScore(amenity->name, amenity->latinName, normalizedQuery);
+            if(!results.canAccept(result.distance / WholeNameScore))
+            {
+                sectionController.isStopped.store(1);
+                return false;
+            }
+
+            insertResult(result);
+            return false;
+        };
+        ObfPoiSectionReader::searchAmenitiesByName(obfReader, *itPoiSection, normalizedQuery, location31,
+            nullptr, nullptr, nullptr, visitor, &sectionController);
+    }
+
+    for(auto itAddressSection = obfInfo->addressSections.cbegin(); itAddressSection != obfInfo->addressSections.cend(); ++itAddressSection)
+    {
+        // Check if request is aborted
+        if(controller->isAborted())
+            return;
+
+        const auto& addressSection = *itAddressSection;
+        ObfAddressSectionReader::findStreetGroupsByName(obfReader, addressSection, normalizedQuery, nullptr,
+            [&](const std::shared_ptr<const Model::StreetGroup>& streetGroup) -> bool
+            {
+                ObfDataInterface::SearchResult result;
+                result.streetGroup = streetGroup;
+                result.location31.x = Utilities::get31TileNumberX(streetGroup->_longitude);
+                result.location31.y = Utilities::get31TileNumberY(streetGroup->_latitude);
+                result.distance = Utilities::distance31(location31, result.location31);
+                result.nameScore = getNameScore(streetGroup->_name, streetGroup->_latinName, normalizedQuery);
+                insertResult(result);
+                return false;
+            }, controller);
+        ObfAddressSectionReader::findStreetsByName(obfReader, addressSection, normalizedQuery, nullptr,
+            [&](const std::shared_ptr<const Model::Street>& street) -> bool
+            {
+                ObfDataInterface::SearchResult result;
+                result.street = street;
+                result.location31.x = street->tile24.x << 7;
+                result.location31.y = street->tile24.y << 7;
+                result.distance = Utilities::distance31(location31, result.location31);
+                result.nameScore = getNameScore(street->name, street->latinName, normalizedQuery);
+                insertResult(result);
+                return false;
+            }, controller);
+    }
+}
+
+void OsmAnd::ObfDataInterface_P::searchByNameInParallel(
+    const QString& query, const PointI& location31,
+    SearchResults& results, SearchController* const controller )
+{
+    // Each reader is processed by single worker, since reader can not be shared between threads.
+    // Pool of workers is bounded, so readers that were not yet started are skipped once search is stopped
+    QSemaphore finishedReaders;
+    for(auto readerIndex = 1; readerIndex < readers.size(); readerIndex++)
+    {
+        const auto& obfReader = readers[readerIndex];
+        Concurrent::pools->obfReading->start(new Concurrent::Task([this, &finishedReaders, obfReader, &query, &location31, &results, controller](const Concurrent::Task* task, QEventLoop& eventLoop)
+            {
+                if(!controller->isAborted())
+                    searchByName(obfReader, query, location31, results, controller);
+                finishedReaders.release();
+            }));
+    }
+    searchByName(readers.first(), query, location31, results, controller);
+    finishedReaders.acquire(readers.size() - 1);
+}
@@ -25,24 +25,80 @@
 #include <cstdint>
 #include <memory>
 #include <array>
+#include <functional>
 
 #include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QString>
 
 #include <OsmAndCore.h>
+#include <CommonTypes.h>
+#include <MapTypes.h>
+#include <IQueryController.h>
+#include <ObfDataInterface.h>
 
 namespace OsmAnd {
 
     class ObfReader;
+    class ObfMapSectionInfo;
+    namespace Model {
+        class MapObject;
+    } // namespace Model
 
     class ObfDataInterface;
     class ObfDataInterface_P
     {
     private:
     protected:
-        ObfDataInterface_P(ObfDataInterface* owner, const QList< std::shared_ptr<ObfReader> >& readers);
+        ObfDataInterface_P(ObfDataInterface* owner, const QList< std::shared_ptr<ObfReader> >& readers, const bool parallelReading);
 
         ObfDataInterface* const owner;
         const QList< std::shared_ptr<ObfReader> > readers;
+        const bool parallelReading;
+
+        void obtainMapObjectsInParallel(QList< std::shared_ptr<const OsmAnd::Model::MapObject> >* resultOut, MapFoundationType* foundationOut,
+            const AreaI& area31, const ZoomLevel zoom,
+            const IQueryController* const controller, std::function<bool (const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t)> filterById);
+
+        // Aborts when parent controller does, or when stopped explicitly
+        class SearchController : public IQueryController
+        {
+        public:
+            SearchController(const IQueryController* const parent);
+            virtual ~SearchController();
+
+            const IQueryController* const parent;
+            QAtomicInt isStopped;
+
+            virtual bool isAborted() const;
+        };
+
+        enum {
+            WordPrefixNameScore = 1,
+            NamePrefixNameScore = 2,
+            WholeNameScore = 3,
+        };
+        static int getNameScore(const QString& name, const QString& latinName, const QString& query);
+
+        // Best results found so far by all readers, ordered by rank (distance divided by name score)
+        struct SearchResults
+        {
+            SearchResults(const int maxCount);
+
+            const int maxCount;
+            mutable QMutex mutex;
+            QMultiMap<double, ObfDataInterface::SearchResult> ranked;
+            int wholeNameMatchesCount;
+
+            bool canAccept(const double rank) const;
+            bool insert(const ObfDataInterface::SearchResult& result);
+        };
+        void searchByName(const std::shared_ptr<ObfReader>& obfReader, const QString& query, const PointI& location31,
+            SearchResults& results, SearchController* const controller);
+        void searchByNameInParallel(const QString& query, const PointI& location31,
+            SearchResults& results, SearchController* const controller);
     public:
         virtual ~ObfDataInterface_P();
 
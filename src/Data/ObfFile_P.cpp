@@ -1,10 +1,59 @@
 #include "ObfFile_P.h"
 
+#include <QFileInfo>
+
+#include "ObfFile.h"
+#include "Logging.h"
+
 OsmAnd::ObfFile_P::ObfFile_P( ObfFile* owner_ )
     : owner(owner_)
+    , _mappingAttempted(false)
+    , _mappedData(nullptr)
+    , _mappedSize(0)
 {
 }
 
 OsmAnd::ObfFile_P::~ObfFile_P()
 {
 }
+
+bool OsmAnd::ObfFile_P::obtainMapping( std::shared_ptr<QFile>& outFile, const uchar*& outData, qint64& outSize )
+{
+    QMutexLocker scopedLock(&_mappingMutex);
+
+    // Mapping is created only once and shared by all readers of this file
+    if(!_mappingAttempted)
+    {
+        _mappingAttempted = true;
+
+        // Only regular files can be mapped
+        const QFileInfo fileInfo(owner->filePath);
+        if(fileInfo.isFile() && fileInfo.size() > 0)
+        {
+            std::shared_ptr<QFile> file(new QFile(owner->filePath));
+            if(file->open(QIODevice::ReadOnly))
+            {
+                const auto data = file->map(0, file->size());
+                if(data)
+                {
+                    _mappedFile = file;
+                    _mappedData = data;
+                    _mappedSize = file->size();
+                }
+                else
+                {
+                    LogPrintf(LogSeverityLevel::Warning, "Failed to map '%s' into memory: %s", qPrintable(owner->filePath), qPrintable(file->errorString()));
+                    file->close();
+                }
+            }
+        }
+    }
+
+    if(!_mappedFile)
+        return false;
+
+    outFile = _mappedFile;
+    outData = _mappedData;
+    outSize = _mappedSize;
+    return true;
+}
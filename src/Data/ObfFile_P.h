@@ -27,6 +27,7 @@
 #include <memory>
 
 #include <QMutex>
+#include <QFile>
 
 #include <OsmAndCore.h>
 
@@ -47,6 +48,13 @@ namespace OsmAnd {
 
         mutable QMutex _obfInfoMutex;
         std::shared_ptr<ObfInfo> _obfInfo;
+
+        mutable QMutex _mappingMutex;
+        bool _mappingAttempted;
+        std::shared_ptr<QFile> _mappedFile;
+        const uchar* _mappedData;
+        qint64 _mappedSize;
+        bool obtainMapping(std::shared_ptr<QFile>& outFile, const uchar*& outData, qint64& outSize);
     public:
         virtual ~ObfFile_P();
 
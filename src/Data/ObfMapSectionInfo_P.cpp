@@ -1,5 +1,7 @@
 #include "ObfMapSectionInfo_P.h"
 
+#include "ObfMapSectionReader_P.h"
+
 OsmAnd::ObfMapSectionInfo_P::ObfMapSectionInfo_P( ObfMapSectionInfo* owner_ )
     : owner(owner_)
 {
@@ -35,10 +37,13 @@ OsmAnd::ObfMapSectionLevelTreeNode::ObfMapSectionLevelTreeNode(const std::shared
     : _childrenInnerOffset(0)
     , _dataOffset(0)
     , _foundation(MapFoundationType::Undefined)
+    , _childrenCached(false)
     , level(level_)
 {
 }
 
 OsmAnd::ObfMapSectionLevelTreeNode::~ObfMapSectionLevelTreeNode()
 {
+    if(_childrenCached)
+        ObfMapSectionReader_P::releaseTreeNodesCacheSpace(_children.size());
 }
@@ -31,6 +31,7 @@
 #include <QSet>
 #include <QHash>
 #include <QMap>
+#include <QVector>
 #include <QString>
 
 #include <OsmAndCore.h>
@@ -54,6 +55,11 @@ namespace OsmAnd {
         uint32_t _dataOffset;
         MapFoundationType _foundation;
         AreaI _area31;
+
+        // Decoded children are kept in memory once read, unless tree nodes cache budget is exhausted
+        mutable QMutex _childrenMutex;
+        bool _childrenCached;
+        QList< std::shared_ptr<ObfMapSectionLevelTreeNode> > _children;
     public:
         ~ObfMapSectionLevelTreeNode();
 
@@ -101,6 +107,8 @@ namespace OsmAnd {
 
             QHash< QString, QHash<QString, uint32_t> > _encodingRules;
             QMap< uint32_t, DecodingRule > _decodingRules;
+            // Same tag-value pairs as in decoding rules, but indexed directly by rule id
+            QVector< TagValue > _decodingTable;
             uint32_t _nameEncodingType;
             uint32_t _refEncodingType;
             uint32_t _coastlineEncodingType;
@@ -20,3 +20,15 @@ void OsmAnd::ObfMapSectionReader::loadMapObjects(
 {
     ObfMapSectionReader_P::loadMapObjects(reader->_d, section, zoom, bbox31, resultOut, foundationOut, filterById, visitor, controller);
 }
+
+void OsmAnd::ObfMapSectionReader::setTreeNodesCacheBudget( const size_t budget )
+{
+    QMutexLocker scopedLock(&ObfMapSectionReader_P::_treeNodesCacheMutex);
+    ObfMapSectionReader_P::_treeNodesCacheBudget = budget;
+}
+
+size_t OsmAnd::ObfMapSectionReader::getTreeNodesCacheBudget()
+{
+    QMutexLocker scopedLock(&ObfMapSectionReader_P::_treeNodesCacheMutex);
+    return ObfMapSectionReader_P::_treeNodesCacheBudget;
+}
@@ -14,6 +14,10 @@
 #include "OBF.pb.h"
 #include <google/protobuf/wire_format_lite.h>
 
+QMutex OsmAnd::ObfMapSectionReader_P::_treeNodesCacheMutex;
+size_t OsmAnd::ObfMapSectionReader_P::_treeNodesCacheSize = 0;
+size_t OsmAnd::ObfMapSectionReader_P::_treeNodesCacheBudget = 32 * 1024 * 1024;
+
 OsmAnd::ObfMapSectionReader_P::ObfMapSectionReader_P()
 {
 }
@@ -196,8 +200,14 @@ void OsmAnd::ObfMapSectionReader_P::createRule( const std::shared_ptr<ObfMapSect
     itEncodingRule->insert(ruleVal, ruleId);
     
     if(!rules->_decodingRules.contains(ruleId))
+    {
         rules->_decodingRules.insert(ruleId, ObfMapSectionInfo_P::Rules::DecodingRule(ruleTag, ruleVal, ruleType));
 
+        if(ruleId >= static_cast<uint32_t>(rules->_decodingTable.size()))
+            rules->_decodingTable.resize(ruleId + 1);
+        rules->_decodingTable[ruleId] = TagValue(ruleTag, ruleVal);
+    }
+
     if(QLatin1String("name") == ruleTag)
         rules->_nameEncodingType = ruleId;
     else if(QLatin1String("natural") == ruleTag && QLatin1String("coastline") == ruleVal)
@@ -330,13 +340,9 @@ void OsmAnd::ObfMapSectionReader_P::readTreeNode(
 void OsmAnd::ObfMapSectionReader_P::readTreeNodeChildren(
     const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
     const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
-    MapFoundationType& foundation,
-    QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >* nodesWithData,
-    const AreaI* bbox31,
-    const IQueryController* const controller)
+    QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >& children)
 {
     auto cis = reader->_codedInputStream.get();
-    foundation = MapFoundationType::Undefined;
 
     for(;;)
     {
@@ -355,43 +361,10 @@ void OsmAnd::ObfMapSectionReader_P::readTreeNodeChildren(
                 childNode->_offset = offset;
                 childNode->_length = length;
                 readTreeNode(reader, section, treeNode->_area31, childNode);
-                if(bbox31)
-                {
-                    const auto shouldSkip =
-                        !bbox31->contains(childNode->_area31) &&
-                        !childNode->_area31.contains(*bbox31) &&
-                        !bbox31->intersects(childNode->_area31);
-                    if(shouldSkip)
-                    {
-                        cis->Skip(cis->BytesUntilLimit());
-                        cis->PopLimit(oldLimit);
-                        break;
-                    }
-                }
+                assert(cis->BytesUntilLimit() == 0);
                 cis->PopLimit(oldLimit);
 
-                if(nodesWithData && childNode->_dataOffset > 0)
-                    nodesWithData->push_back(childNode);
-
-                auto childrenFoundation = MapFoundationType::Undefined;
-                if(childNode->_childrenInnerOffset > 0)
-                {
-                    cis->Seek(offset);
-                    oldLimit = cis->PushLimit(length);
-                    cis->Skip(childNode->_childrenInnerOffset);
-                    readTreeNodeChildren(reader, section, childNode, childrenFoundation, nodesWithData, bbox31, controller);
-                    assert(cis->BytesUntilLimit() == 0);
-                    cis->PopLimit(oldLimit);
-                }
-
-                const auto foundationToMerge = (childrenFoundation != MapFoundationType::Undefined) ? childrenFoundation : childNode->_foundation;
-                if(foundationToMerge != MapFoundationType::Undefined)
-                {
-                    if(foundation == MapFoundationType::Undefined)
-                        foundation = foundationToMerge;
-                    else if(foundation != foundationToMerge)
-                        foundation = MapFoundationType::Mixed;
-                }
+                children.push_back(childNode);
             }
             break;
         default:
@@ -401,6 +374,105 @@ void OsmAnd::ObfMapSectionReader_P::readTreeNodeChildren(
     }
 }
 
+void OsmAnd::ObfMapSectionReader_P::obtainTreeNodeChildren(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
+    const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
+    QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >& children)
+{
+    auto cis = reader->_codedInputStream.get();
+
+    QMutexLocker scopedLock(&treeNode->_childrenMutex);
+
+    // Use decoded children if they are available
+    if(treeNode->_childrenCached)
+    {
+        children = treeNode->_children;
+        return;
+    }
+
+    // Otherwise read all children of this node, not only those that are needed by current query
+    cis->Seek(treeNode->_offset);
+    auto oldLimit = cis->PushLimit(treeNode->_length);
+    cis->Skip(treeNode->_childrenInnerOffset);
+    readTreeNodeChildren(reader, section, treeNode, children);
+    assert(cis->BytesUntilLimit() == 0);
+    cis->PopLimit(oldLimit);
+
+    // Keep them in memory only if budget allows that
+    if(reserveTreeNodesCacheSpace(children.size()))
+    {
+        treeNode->_children = children;
+        treeNode->_childrenCached = true;
+    }
+}
+
+void OsmAnd::ObfMapSectionReader_P::queryTreeNodeChildren(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
+    const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
+    MapFoundationType& foundation,
+    QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >* nodesWithData,
+    const AreaI* bbox31,
+    const IQueryController* const controller)
+{
+    foundation = MapFoundationType::Undefined;
+
+    QList< std::shared_ptr<ObfMapSectionLevelTreeNode> > children;
+    obtainTreeNodeChildren(reader, section, treeNode, children);
+
+    for(auto itChildNode = children.cbegin(); itChildNode != children.cend(); ++itChildNode)
+    {
+        const auto& childNode = *itChildNode;
+
+        if(bbox31)
+        {
+            const auto shouldSkip =
+                !bbox31->contains(childNode->_area31) &&
+                !childNode->_area31.contains(*bbox31) &&
+                !bbox31->intersects(childNode->_area31);
+            if(shouldSkip)
+                continue;
+        }
+
+        if(nodesWithData && childNode->_dataOffset > 0)
+            nodesWithData->push_back(childNode);
+
+        auto childrenFoundation = MapFoundationType::Undefined;
+        if(childNode->_childrenInnerOffset > 0)
+            queryTreeNodeChildren(reader, section, childNode, childrenFoundation, nodesWithData, bbox31, controller);
+
+        const auto foundationToMerge = (childrenFoundation != MapFoundationType::Undefined) ? childrenFoundation : childNode->_foundation;
+        if(foundationToMerge != MapFoundationType::Undefined)
+        {
+            if(foundation == MapFoundationType::Undefined)
+                foundation = foundationToMerge;
+            else if(foundation != foundationToMerge)
+                foundation = MapFoundationType::Mixed;
+        }
+    }
+}
+
+bool OsmAnd::ObfMapSectionReader_P::reserveTreeNodesCacheSpace( const unsigned int nodesCount )
+{
+    const auto requestedSize = nodesCount * TreeNodeCachedSize;
+
+    QMutexLocker scopedLock(&_treeNodesCacheMutex);
+
+    if(_treeNodesCacheSize + requestedSize > _treeNodesCacheBudget)
+        return false;
+    _treeNodesCacheSize += requestedSize;
+    return true;
+}
+
+void OsmAnd::ObfMapSectionReader_P::releaseTreeNodesCacheSpace( const unsigned int nodesCount )
+{
+    const auto releasedSize = nodesCount * TreeNodeCachedSize;
+
+    QMutexLocker scopedLock(&_treeNodesCacheMutex);
+
+    assert(_treeNodesCacheSize >= releasedSize);
+    _treeNodesCacheSize -= releasedSize;
+}
+
 void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
     const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
     const std::shared_ptr<ObfMapSectionLevelTreeNode>& tree,
@@ -412,8 +484,9 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
 {
     auto cis = reader->_codedInputStream.get();
 
-    QList< std::shared_ptr<OsmAnd::Model::MapObject> > intermediateResult;
-    QStringList mapObjectsNamesTable;
+    // All map objects of this block are stored together, map objects themselves are only views
+    std::shared_ptr<Model::MapObjectsBlock> block(new Model::MapObjectsBlock(&section->_d->_rules->_decodingTable));
+    QVector< Model::MapObjectsBlock::Entry > entries;
     gpb::uint64 baseId = 0;
     for(;;)
     {
@@ -424,33 +497,46 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
         switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
         {
         case 0:
-            for(auto itEntry = intermediateResult.cbegin(); itEntry != intermediateResult.cend(); ++itEntry)
             {
-                const auto& entry = *itEntry;
+                if(entries.isEmpty())
+                    return;
 
-                // Fill names of roads from stringtable
-                for(auto itNameEntry = entry->_names.begin(); itNameEntry != entry->_names.end(); ++itNameEntry)
+                // Verify that names of map objects reference existing strings of stringtable
+                const auto stringTableSize = block->_stringTable.size();
+                for(auto itEntry = entries.cbegin(); itEntry != entries.cend(); ++itEntry)
                 {
-                    const auto& encodedId = itNameEntry.value();
-                    uint32_t stringId = ObfReaderUtilities::decodeIntegerFromString(encodedId);
+                    const auto& entry = *itEntry;
 
-                    if(stringId >= mapObjectsNamesTable.size())
+                    for(auto nameIdx = entry.names.offset; nameIdx < entry.names.offset + entry.names.count; nameIdx++)
                     {
+                        auto& name = block->_names[nameIdx];
+                        if(name.stringId < static_cast<uint32_t>(stringTableSize))
+                            continue;
+
                         LogPrintf(LogSeverityLevel::Error,
                             "Data mismatch: string #%d (map object #%" PRIu64 " (%" PRIi64 ") not found in string table (size %d) in section '%s'",
-                            stringId,
-                            entry->id >> 1, static_cast<int64_t>(entry->id) / 2,
-                            mapObjectsNamesTable.size(), qPrintable(section->name));
-                        itNameEntry.value() = QString::fromLatin1("#%1 NOT FOUND").arg(stringId);
-                        continue;
+                            name.stringId,
+                            entry.id >> 1, static_cast<int64_t>(entry.id) / 2,
+                            stringTableSize, qPrintable(section->name));
+                        block->_stringTable.push_back(QString::fromLatin1("#%1 NOT FOUND").arg(name.stringId));
+                        name.stringId = block->_stringTable.size() - 1;
                     }
-                    itNameEntry.value() = mapObjectsNamesTable[stringId];
                 }
 
-                if(!visitor || visitor(entry))
+                // Storage is complete, so views into it can be created
+                block->squeeze();
+                for(auto itEntry = entries.cbegin(); itEntry != entries.cend(); ++itEntry)
                 {
-                    if(resultOut)
-                        resultOut->push_back(entry);
+                    const auto& entry = *itEntry;
+
+                    std::shared_ptr<Model::MapObject> mapObject(block->createMapObject(block, section, tree->level, entry));
+                    mapObject->_foundation = tree->_foundation;
+
+                    if(!visitor || visitor(mapObject))
+                    {
+                        if(resultOut)
+                            resultOut->push_back(mapObject);
+                    }
                 }
             }
             return;
@@ -480,22 +566,20 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
                     break;
 
                 // Read map object content
-                std::shared_ptr<OsmAnd::Model::MapObject> mapObject;
+                Model::MapObjectsBlock::Entry entry;
+                entry.id = mapObjectId;
+                bool accepted;
                 cis->Seek(origin);
                 {
                     auto oldLimit = cis->PushLimit(length);
-                    readMapObject(reader, section, tree, mapObject, bbox31);
+                    accepted = readMapObject(reader, section, tree, block, entry, bbox31);
                     assert(cis->BytesUntilLimit() == 0);
                     cis->PopLimit(oldLimit);
                 }
 
                 // Save object
-                if(mapObject)
-                {
-                    mapObject->_id = mapObjectId;
-                    mapObject->_foundation = tree->_foundation;
-                    intermediateResult.push_back(mapObject);
-                }
+                if(accepted)
+                    entries.push_back(entry);
             }
             break;
         case OBF::MapDataBlock::kStringTableFieldNumber:
@@ -503,13 +587,15 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
                 gpb::uint32 length;
                 cis->ReadVarint32(&length);
                 auto oldLimit = cis->PushLimit(length);
-                if(intermediateResult.isEmpty())
+                if(entries.isEmpty())
                 {
                     cis->Skip(cis->BytesUntilLimit());
                     cis->PopLimit(oldLimit);
                     break;
                 }
-                ObfReaderUtilities::readStringTable(cis, mapObjectsNamesTable);
+                QStringList stringTable;
+                ObfReaderUtilities::readStringTable(cis, stringTable);
+                block->_stringTable = stringTable.toVector();
                 assert(cis->BytesUntilLimit() == 0);
                 cis->PopLimit(oldLimit);
             }
@@ -564,14 +650,17 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectId(
     }
 }
 
-void OsmAnd::ObfMapSectionReader_P::readMapObject(
+bool OsmAnd::ObfMapSectionReader_P::readMapObject(
     const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
     const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
-    std::shared_ptr<OsmAnd::Model::MapObject>& mapObject,
+    const std::shared_ptr<Model::MapObjectsBlock>& block,
+    Model::MapObjectsBlock::Entry& entry,
     const AreaI* bbox31)
 {
     auto cis = reader->_codedInputStream.get();
 
+    const auto rulesCount = static_cast<uint32_t>(block->_decodingRules->size());
+    const auto checkpoint = block->checkpoint();
     for(;;)
     {
         auto tag = cis->ReadTag();
@@ -579,19 +668,21 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
         switch(tgn)
         {
         case 0:
-            if(mapObject && mapObject->points31.isEmpty())
+            if(entry.points31.count == 0)
             {
                 LogPrintf(LogSeverityLevel::Warning,
                     "Empty MapObject #%" PRIu64 "(%" PRIi64 ") detected in section '%s'",
-                    mapObject->id >> 1, static_cast<int64_t>(mapObject->id) / 2,
+                    entry.id >> 1, static_cast<int64_t>(entry.id) / 2,
                     qPrintable(section->name));
-                mapObject.reset();
+                block->rollback(checkpoint);
+                return false;
             }
-            return;
+            return true;
         case OBF::MapData::kAreaCoordinatesFieldNumber:
         case OBF::MapData::kCoordinatesFieldNumber:
             {
-                QVector< PointI > points31;
+                auto& points31 = block->_points31;
+                const auto pointsOffset = points31.size();
                 gpb::uint32 length;
                 cis->ReadVarint32(&length);
                 auto oldLimit = cis->PushLimit(length);
@@ -618,7 +709,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                         shouldNotSkip = bbox31->contains(p);
                     objectBBox.enlargeToInclude(p);
                 }
-                if(points31.isEmpty())
+                if(points31.size() == pointsOffset)
                 {
                     // Fake that this object is inside bbox
                     shouldNotSkip = true;
@@ -633,36 +724,35 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                 cis->PopLimit(oldLimit);
                 if(!shouldNotSkip)
                 {
+                    // Drop everything that was stored for this object and skip the rest of it
                     cis->Skip(cis->BytesUntilLimit());
-                    break;
+                    block->rollback(checkpoint);
+                    return false;
                 }
 
-                // Finally, create the object
-                if(!mapObject)
-                    mapObject.reset(new OsmAnd::Model::MapObject(section, treeNode->level));
-                mapObject->_isArea = (tgn == OBF::MapData::kAreaCoordinatesFieldNumber);
-                mapObject->_points31 = points31;
-                mapObject->_bbox31 = objectBBox;
-                assert(treeNode->_area31.top - mapObject->_bbox31.top <= 32);
-                assert(treeNode->_area31.left - mapObject->_bbox31.left <= 32);
-                assert(mapObject->_bbox31.bottom - treeNode->_area31.bottom <= 1);
-                assert(mapObject->_bbox31.right - treeNode->_area31.right <= 1);
-                assert(mapObject->_bbox31.right >= mapObject->_bbox31.left);
-                assert(mapObject->_bbox31.bottom >= mapObject->_bbox31.top);
+                entry.isArea = (tgn == OBF::MapData::kAreaCoordinatesFieldNumber);
+                entry.points31.offset = pointsOffset;
+                entry.points31.count = points31.size() - pointsOffset;
+                entry.bbox31 = objectBBox;
+                assert(treeNode->_area31.top - entry.bbox31.top <= 32);
+                assert(treeNode->_area31.left - entry.bbox31.left <= 32);
+                assert(entry.bbox31.bottom - treeNode->_area31.bottom <= 1);
+                assert(entry.bbox31.right - treeNode->_area31.right <= 1);
+                assert(entry.bbox31.right >= entry.bbox31.left);
+                assert(entry.bbox31.bottom >= entry.bbox31.top);
             }
             break;
         case OBF::MapData::kPolygonInnerCoordinatesFieldNumber:
             {
-                if(!mapObject)
-                    mapObject.reset(new OsmAnd::Model::MapObject(section, treeNode->level));
+                auto& points31 = block->_points31;
+                Model::MapObject::Range polygon;
+                polygon.offset = points31.size();
 
                 gpb::uint32 length;
                 cis->ReadVarint32(&length);
                 auto oldLimit = cis->PushLimit(length);
                 auto px = treeNode->_area31.left & MaskToRead;
                 auto py = treeNode->_area31.top & MaskToRead;
-                mapObject->_innerPolygonsPoints31.push_back(QVector< PointI >());
-                auto& polygon = mapObject->_innerPolygonsPoints31.last();
                 while(cis->BytesUntilLimit() > 0)
                 {
                     auto dx = (ObfReaderUtilities::readSInt32(cis) << ShiftCoordinates);
@@ -670,37 +760,24 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     auto dy = (ObfReaderUtilities::readSInt32(cis) << ShiftCoordinates);
                     auto y = dy + py;
 
-                    polygon.push_back(PointI(x, y));
+                    points31.push_back(PointI(x, y));
                     
                     px = x;
                     py = y;
                 }
                 cis->PopLimit(oldLimit);
-            }
-            break;
-        case OBF::MapData::kAdditionalTypesFieldNumber:
-            {
-                if(!mapObject)
-                    mapObject.reset(new OsmAnd::Model::MapObject(section, treeNode->level));
-
-                gpb::uint32 length;
-                cis->ReadVarint32(&length);
-                auto oldLimit = cis->PushLimit(length);
-                while(cis->BytesUntilLimit() > 0)
-                {
-                    gpb::uint32 type;
-                    cis->ReadVarint32(&type);
+                polygon.count = points31.size() - polygon.offset;
 
-                    const auto& tagValue = section->_d->_rules->_decodingRules[type];
-                    mapObject->_extraTypes.push_back(TagValue(std::get<0>(tagValue), std::get<1>(tagValue)));
-                }
-                cis->PopLimit(oldLimit);
+                if(entry.innerPolygons.count == 0)
+                    entry.innerPolygons.offset = block->_innerPolygons.size();
+                block->_innerPolygons.push_back(polygon);
+                entry.innerPolygons.count++;
             }
             break;
+        case OBF::MapData::kAdditionalTypesFieldNumber:
         case OBF::MapData::kTypesFieldNumber:
             {
-                if(!mapObject)
-                    mapObject.reset(new OsmAnd::Model::MapObject(section, treeNode->level));
+                auto& range = (tgn == OBF::MapData::kTypesFieldNumber) ? entry.types : entry.extraTypes;
 
                 gpb::uint32 length;
                 cis->ReadVarint32(&length);
@@ -710,8 +787,16 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     gpb::uint32 type;
                     cis->ReadVarint32(&type);
 
-                    const auto& tagValue = section->_d->_rules->_decodingRules[type];
-                    mapObject->_types.push_back(TagValue(std::get<0>(tagValue), std::get<1>(tagValue)));
+                    if(type >= rulesCount)
+                    {
+                        LogPrintf(LogSeverityLevel::Warning,
+                            "Unknown rule #%d in MapObject #%" PRIu64 "(%" PRIi64 ") in section '%s'",
+                            type,
+                            entry.id >> 1, static_cast<int64_t>(entry.id) / 2,
+                            qPrintable(section->name));
+                        continue;
+                    }
+                    block->appendRuleId(type, range);
                 }
                 cis->PopLimit(oldLimit);
             }
@@ -732,8 +817,16 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     ok = cis->ReadVarint32(&stringId);
                     assert(ok);
 
-                    const auto& tagName = std::get<0>(section->_d->_rules->_decodingRules[stringTag]);
-                    mapObject->_names.insert(tagName, ObfReaderUtilities::encodeIntegerToString(stringId));
+                    if(stringTag >= rulesCount)
+                    {
+                        LogPrintf(LogSeverityLevel::Warning,
+                            "Unknown rule #%d in MapObject #%" PRIu64 "(%" PRIi64 ") in section '%s'",
+                            stringTag,
+                            entry.id >> 1, static_cast<int64_t>(entry.id) / 2,
+                            qPrintable(section->name));
+                        continue;
+                    }
+                    block->appendName(stringTag, stringId, entry.names);
                 }
                 assert(cis->BytesUntilLimit() == 0);
                 cis->PopLimit(oldLimit);
@@ -825,14 +918,7 @@ void OsmAnd::ObfMapSectionReader_P::loadMapObjects(
 
             auto childrenFoundation = MapFoundationType::Undefined;
             if(rootNode->_childrenInnerOffset > 0)
-            {
-                cis->Seek(rootNode->_offset);
-                auto oldLimit = cis->PushLimit(rootNode->_length);
-                cis->Skip(rootNode->_childrenInnerOffset);
-                readTreeNodeChildren(reader, section, rootNode, childrenFoundation, &treeNodesWithData, bbox31, controller);
-                assert(cis->BytesUntilLimit() == 0);
-                cis->PopLimit(oldLimit);
-            }
+                queryTreeNodeChildren(reader, section, rootNode, childrenFoundation, &treeNodesWithData, bbox31, controller);
 
             const auto foundationToMerge = (childrenFoundation != MapFoundationType::Undefined) ? childrenFoundation : rootNode->_foundation;
             if(foundationToMerge != MapFoundationType::Undefined)
@@ -30,20 +30,20 @@
 #include <QHash>
 #include <QMap>
 #include <QSet>
+#include <QMutex>
 
 #include <OsmAndCore.h>
 #include <CommonTypes.h>
 #include <ObfMapSectionInfo_P.h>
 #include <MapTypes.h>
+#include <MapObjectsBlock.h>
 
 namespace OsmAnd {
 
     class ObfReader_P;
     class ObfMapSectionInfo;
     class ObfMapSectionLevel;
-    namespace Model {
-        class MapObject;
-    } // namespace Model
+    class ObfMapSectionLevelTreeNode;
     class IQueryController;
 
     class ObfMapSectionReader;
@@ -71,12 +71,24 @@ namespace OsmAnd {
             const AreaI& parentArea,
             const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode);
         static void readTreeNodeChildren(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
+            const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
+            QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >& children);
+        static void obtainTreeNodeChildren(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
+            const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
+            QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >& children);
+        static void queryTreeNodeChildren(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
             const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
             MapFoundationType& foundation,
             QList< std::shared_ptr<ObfMapSectionLevelTreeNode> >* nodesWithData,
             const AreaI* bbox31,
             const IQueryController* const controller);
 
+        static QMutex _treeNodesCacheMutex;
+        static size_t _treeNodesCacheSize;
+        static size_t _treeNodesCacheBudget;
+        static bool reserveTreeNodesCacheSpace(const unsigned int nodesCount);
+        static void releaseTreeNodesCacheSpace(const unsigned int nodesCount);
+
         static void readMapObjectsBlock(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
             const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
             QList< std::shared_ptr<const OsmAnd::Model::MapObject> >* resultOut,
@@ -89,14 +101,18 @@ namespace OsmAnd {
             uint64_t baseId,
             uint64_t& objectId);
 
-        static void readMapObject(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
+        static bool readMapObject(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
             const std::shared_ptr<ObfMapSectionLevelTreeNode>& treeNode,
-            std::shared_ptr<OsmAnd::Model::MapObject>& mapObjectOut,
+            const std::shared_ptr<Model::MapObjectsBlock>& block,
+            Model::MapObjectsBlock::Entry& entry,
             const AreaI* bbox31);
 
         enum {
             ShiftCoordinates = 5,
             MaskToRead = ~((1u << ShiftCoordinates) - 1),
+
+            // Node itself, control block of shared pointer and entry in list of children
+            TreeNodeCachedSize = sizeof(ObfMapSectionLevelTreeNode) + 2 * sizeof(std::shared_ptr<ObfMapSectionLevelTreeNode>) + sizeof(void*),
         };
 
         static void loadMapObjects(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfMapSectionInfo>& section,
@@ -108,6 +124,7 @@ namespace OsmAnd {
 
     friend class OsmAnd::ObfMapSectionReader;
     friend class OsmAnd::ObfReader_P;
+    friend class OsmAnd::ObfMapSectionLevelTreeNode;
     };
 
 } // namespace OsmAnd
@@ -1,7 +1,9 @@
 #include "ObfPoiSectionInfo.h"
+#include "ObfPoiSectionInfo_P.h"
 
 OsmAnd::ObfPoiSectionInfo::ObfPoiSectionInfo( const std::weak_ptr<ObfInfo>& owner )
     : ObfSectionInfo(owner)
+    , _d(new ObfPoiSectionInfo_P(this))
     , area31(_area31)
 {
 }
@@ -0,0 +1,10 @@
+#include "ObfPoiSectionInfo_P.h"
+
+OsmAnd::ObfPoiSectionInfo_P::ObfPoiSectionInfo_P( ObfPoiSectionInfo* owner_ )
+    : owner(owner_)
+{
+}
+
+OsmAnd::ObfPoiSectionInfo_P::~ObfPoiSectionInfo_P()
+{
+}
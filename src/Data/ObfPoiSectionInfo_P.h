@@ -0,0 +1,90 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __OBF_POI_SECTION_INFO_P_H_
+#define __OBF_POI_SECTION_INFO_P_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QMutex>
+#include <QVector>
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd {
+
+    class ObfPoiSectionReader_P;
+
+    class ObfPoiSectionInfo;
+    class ObfPoiSectionInfo_P
+    {
+        Q_DISABLE_COPY(ObfPoiSectionInfo_P)
+    private:
+    protected:
+        ObfPoiSectionInfo_P(ObfPoiSectionInfo* owner);
+
+        ObfPoiSectionInfo* const owner;
+
+        // Tree of OsmAndPoiBox messages, decoded once per section
+        struct BoxTree
+        {
+            enum {
+                // Category id takes 7 bits, so 128 bits are enough for bitmap of box categories
+                CategoriesBitmapWords = 2,
+            };
+
+            struct Box
+            {
+                uint32_t zoom;
+                uint32_t x;
+                uint32_t y;
+                // Boxes are stored in depth-first order, so subtree of box ends right before this index
+                uint32_t subtreeEnd;
+                // Offset of OsmAndPoiBoxData from section start, or 0 if box has no data
+                uint32_t dataOffset;
+                // Categories listed by box are in categories[categoriesStart, categoriesStart + categoriesCount)
+                uint32_t categoriesStart;
+                uint32_t categoriesCount;
+                bool hasCategories;
+            };
+            QVector<Box> boxes;
+
+            // CategoriesBitmapWords words for each box, bit is set for each category id listed by box
+            QVector<uint64_t> categoriesBitmaps;
+
+            // Category (upper 16 bits) and subcategory (lower 16 bits) pairs listed by boxes
+            QVector<uint32_t> categories;
+        };
+        mutable QMutex _boxTreeMutex;
+        std::shared_ptr<const BoxTree> _boxTree;
+    public:
+        virtual ~ObfPoiSectionInfo_P();
+
+    friend class OsmAnd::ObfPoiSectionInfo;
+    friend class OsmAnd::ObfPoiSectionReader_P;
+    };
+
+} // namespace OsmAnd
+
+#endif // __OBF_POI_SECTION_INFO_P_H_
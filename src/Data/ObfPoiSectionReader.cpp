@@ -26,3 +26,12 @@ void OsmAnd::ObfPoiSectionReader::loadAmenities(
 {
     ObfPoiSectionReader_P::loadAmenities(reader->_d, section, zoom, zoomDepth, bbox31, desiredCategories, amenitiesOut, visitor, controller);
 }
+
+void OsmAnd::ObfPoiSectionReader::searchAmenitiesByName(
+    const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const OsmAnd::ObfPoiSectionInfo>& section,
+    const QString& query, const PointI& location31, const AreaI* bbox31 /*= nullptr*/, QSet<uint32_t>* desiredCategories /*= nullptr*/,
+    QList< std::shared_ptr<const OsmAnd::Model::Amenity> >* amenitiesOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::Amenity>&)> visitor /*= nullptr*/, const IQueryController* const controller /*= nullptr*/ )
+{
+    ObfPoiSectionReader_P::searchAmenitiesByName(reader->_d, section, query, location31, bbox31, desiredCategories, amenitiesOut, visitor, controller);
+}
\ No newline at end of file
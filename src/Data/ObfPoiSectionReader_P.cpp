@@ -1,5 +1,7 @@
 #include "ObfPoiSectionReader_P.h"
 
+#include <limits>
+
 #include "ObfReader_P.h"
 #include "ObfPoiSectionInfo.h"
 #include "Amenity.h"
@@ -162,11 +164,7 @@ void OsmAnd::ObfPoiSectionReader_P::loadAmenities(
     std::function<bool (const std::shared_ptr<const Model::Amenity>&)> visitor /*= nullptr*/,
     const IQueryController* const controller /*= nullptr*/ )
 {
-    auto cis = reader->_codedInputStream.get();
-    cis->Seek(section->_offset);
-    auto oldLimit = cis->PushLimit(section->_length);
     readAmenities(reader, section, desiredCategories, amenitiesOut, zoom, zoomDepth, bbox31, visitor, controller);
-    cis->PopLimit(oldLimit);
 }
 
 void OsmAnd::ObfPoiSectionReader_P::readAmenities(
@@ -178,7 +176,67 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenities(
     const IQueryController* const controller)
 {
     auto cis = reader->_codedInputStream.get();
+
+    // Boxes are decoded once per section, so only data of matching boxes is read from file
+    const auto boxTree = obtainBoxTree(reader, section);
+    std::unique_ptr<CategoriesFilter> categoriesFilter;
+    if(desiredCategories)
+        categoriesFilter.reset(new CategoriesFilter(desiredCategories));
+
     QList< std::shared_ptr<Tile> > tiles;
+    for(auto rootIndex = 0; rootIndex < boxTree->boxes.size(); rootIndex = boxTree->boxes[rootIndex].subtreeEnd)
+    {
+        QSet< uint64_t > tilesToSkip;
+        collectTiles(*boxTree, rootIndex, categoriesFilter.get(), zoom, zoomDepth, bbox31, tiles, tilesToSkip);
+        if(controller && controller->isAborted())
+            return;
+    }
+
+    // Sort tiles byte data offset, to all cache-friendly with I/O system
+    qSort(tiles.begin(), tiles.end(), [](const std::shared_ptr<Tile>& l, const std::shared_ptr<Tile>& r) -> bool
+    {
+        return l->_hash < r->_hash;
+    });
+
+    for(auto itTile = tiles.cbegin(); itTile != tiles.cend(); ++itTile)
+    {
+        const auto& tile = *itTile;
+
+        cis->Seek(section->_offset + tile->_offset);
+        auto length = ObfReaderUtilities::readBigEndianInt(cis);
+        auto oldLimit = cis->PushLimit(length);
+        readAmenitiesFromTile(reader, section, tile.get(), desiredCategories, amenitiesOut, zoom, zoomDepth, bbox31, visitor, controller, nullptr);
+        cis->PopLimit(oldLimit);
+        if(controller && controller->isAborted())
+            return;
+    }
+}
+
+std::shared_ptr<const OsmAnd::ObfPoiSectionInfo_P::BoxTree> OsmAnd::ObfPoiSectionReader_P::obtainBoxTree(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section )
+{
+    QMutexLocker scopedLock(&section->_d->_boxTreeMutex);
+
+    if(!section->_d->_boxTree)
+    {
+        std::shared_ptr<ObfPoiSectionInfo_P::BoxTree> boxTree(new ObfPoiSectionInfo_P::BoxTree());
+
+        auto cis = reader->_codedInputStream.get();
+        cis->Seek(section->_offset);
+        auto oldLimit = cis->PushLimit(section->_length);
+        readBoxTree(reader, *boxTree);
+        cis->PopLimit(oldLimit);
+
+        section->_d->_boxTree = boxTree;
+    }
+
+    return section->_d->_boxTree;
+}
+
+void OsmAnd::ObfPoiSectionReader_P::readBoxTree( const std::unique_ptr<ObfReader_P>& reader, ObfPoiSectionInfo_P::BoxTree& tree )
+{
+    auto cis = reader->_codedInputStream.get();
+
     for(;;)
     {
         auto tag = cis->ReadTag();
@@ -190,34 +248,12 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenities(
             {
                 auto length = ObfReaderUtilities::readBigEndianInt(cis);
                 auto oldLimit = cis->PushLimit(length);
-                readTile(reader, section, tiles, nullptr, desiredCategories, zoom, zoomDepth, bbox31, controller, nullptr);
+                readBox(reader, tree, 0, 0, 0);
                 cis->PopLimit(oldLimit);
-                if(controller && controller->isAborted())
-                    return;
             }
             break;
         case OBF::OsmAndPoiIndex::kPoiDataFieldNumber:
-            {
-                // Sort tiles byte data offset, to all cache-friendly with I/O system
-                qSort(tiles.begin(), tiles.end(), [](const std::shared_ptr<Tile>& l, const std::shared_ptr<Tile>& r) -> bool
-                {
-                    return l->_hash < r->_hash;
-                });
-
-                for(auto itTile = tiles.cbegin(); itTile != tiles.cend(); ++itTile)
-                {
-                    const auto& tile = *itTile;
-
-                    cis->Seek(section->_offset + tile->_offset);
-                    auto length = ObfReaderUtilities::readBigEndianInt(cis);
-                    auto oldLimit = cis->PushLimit(length);
-                    readAmenitiesFromTile(reader, section, tile.get(), desiredCategories, amenitiesOut, zoom, zoomDepth, bbox31, visitor, controller, nullptr);
-                    cis->PopLimit(oldLimit);
-                    if(controller && controller->isAborted())
-                        return;
-                }
-                cis->Skip(cis->BytesUntilLimit());
-            }
+            cis->Skip(cis->BytesUntilLimit());
             return;
         default:
             ObfReaderUtilities::skipUnknownField(cis, tag);
@@ -226,135 +262,56 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenities(
     }
 }
 
-bool OsmAnd::ObfPoiSectionReader_P::readTile(
-    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
-    QList< std::shared_ptr<Tile> >& tiles,
-    Tile* parent,
-    QSet<uint32_t>* desiredCategories,
-    uint32_t zoom, uint32_t zoomDepth, const AreaI* bbox31,
-    const IQueryController* const controller,
-    QSet< uint64_t >* tilesToSkip)
+void OsmAnd::ObfPoiSectionReader_P::readBox(
+    const std::unique_ptr<ObfReader_P>& reader, ObfPoiSectionInfo_P::BoxTree& tree,
+    const uint32_t parentZoom, const uint32_t parentX, const uint32_t parentY )
 {
     auto cis = reader->_codedInputStream.get();
 
-    const auto zoomToSkip = zoom + zoomDepth;
-    QSet< uint64_t > tilesToSkip_;
-    if(parent == nullptr && !tilesToSkip)
-        tilesToSkip = &tilesToSkip_;
-
-    std::shared_ptr<Tile> tile(new Tile());
-    gpb::uint32 lzoom;
+    const auto boxIndex = tree.boxes.size();
+    tree.boxes.push_back(ObfPoiSectionInfo_P::BoxTree::Box());
+    tree.categoriesBitmaps.resize(tree.categoriesBitmaps.size() + ObfPoiSectionInfo_P::BoxTree::CategoriesBitmapWords);
 
+    // Coordinates are delta-encoded to parent box
+    gpb::uint32 lzoom = 0;
     for(;;)
     {
-        if(controller && controller->isAborted())
-            return false;
         auto tag = cis->ReadTag();
         switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
         {
         case 0:
-            tiles.push_back(tile);
-            return true;
+            tree.boxes[boxIndex].subtreeEnd = tree.boxes.size();
+            return;
         case OBF::OsmAndPoiBox::kZoomFieldNumber:
-            {
-                cis->ReadVarint32(&lzoom);
-                tile->_zoom = lzoom;
-                if(parent)
-                    tile->_zoom += parent->_zoom;
-            }
+            cis->ReadVarint32(&lzoom);
+            tree.boxes[boxIndex].zoom = parentZoom + lzoom;
             break;
         case OBF::OsmAndPoiBox::kLeftFieldNumber:
-            {
-                auto x = ObfReaderUtilities::readSInt32(cis);
-                if(parent)
-                    tile->_x = x + (parent->_x << lzoom);
-                else
-                    tile->_x = x;
-            }
+            tree.boxes[boxIndex].x = ObfReaderUtilities::readSInt32(cis) + (parentX << lzoom);
             break;
         case OBF::OsmAndPoiBox::kTopFieldNumber:
-            {
-                auto y = ObfReaderUtilities::readSInt32(cis);
-                if(parent)
-                    tile->_y = y + (parent->_y << lzoom);
-                else
-                    tile->_y = y;
-
-                // Check that we're inside bounding box, if requested
-                if(bbox31)
-                {
-                    AreaI area31;
-                    area31.left = tile->_x << (31 - tile->_zoom);
-                    area31.right = (tile->_x + 1) << (31 - tile->_zoom);
-                    area31.top = tile->_y << (31 - tile->_zoom);
-                    area31.bottom = (tile->_y + 1) << (31 - tile->_zoom);
-
-                    const auto shouldSkip =
-                        !bbox31->contains(area31) &&
-                        !area31.contains(*bbox31) &&
-                        !bbox31->intersects(area31);
-                    if(shouldSkip)
-                    {
-                        // This tile is outside of bounding box
-                        cis->Skip(cis->BytesUntilLimit());
-                        return false;
-                    }
-                }
-            }
+            tree.boxes[boxIndex].y = ObfReaderUtilities::readSInt32(cis) + (parentY << lzoom);
             break;
         case OBF::OsmAndPoiBox::kCategoriesFieldNumber:
             {
-                if(!desiredCategories)
-                {
-                    ObfReaderUtilities::skipUnknownField(cis, tag);
-                    break;
-                }
                 gpb::uint32 length;
-                cis->ReadLittleEndian32(&length);
+                cis->ReadVarint32(&length);
                 auto oldLimit = cis->PushLimit(length);
-                const auto containsDesired = checkTileCategories(reader, section, desiredCategories);
+                readBoxCategories(reader, tree, boxIndex);
                 cis->PopLimit(oldLimit);
-                if(!containsDesired)
-                {
-                    cis->Skip(cis->BytesUntilLimit());
-                    return false;
-                }
             }
             break;
         case OBF::OsmAndPoiBox::kSubBoxesFieldNumber:
             {
+                const auto box = tree.boxes[boxIndex];
                 auto length = ObfReaderUtilities::readBigEndianInt(cis);
                 auto oldLimit = cis->PushLimit(length);
-                auto tileOmitted = readTile(reader, section, tiles, tile.get(), desiredCategories, zoom, zoomDepth, bbox31, controller, tilesToSkip);
+                readBox(reader, tree, box.zoom, box.x, box.y);
                 cis->PopLimit(oldLimit);
-
-                if(tilesToSkip && tile->_zoom >= zoomToSkip && tileOmitted)
-                {
-                    auto skipHash = (static_cast<uint64_t>(tile->_x) >> (tile->_zoom - zoomToSkip)) << zoomToSkip;
-                    skipHash |= static_cast<uint64_t>(tile->_y) >> (tile->_zoom - zoomToSkip);
-                    if(tilesToSkip->contains(skipHash))
-                    {
-                        cis->Skip(cis->BytesUntilLimit());
-                        return true;
-                    }
-                }
             }
             break;
         case OBF::OsmAndPoiBox::kShiftToDataFieldNumber:
-            {
-                tile->_offset = ObfReaderUtilities::readBigEndianInt(cis);
-                tile->_hash  = static_cast<uint64_t>(tile->_x) << tile->_zoom;
-                tile->_hash |= static_cast<uint64_t>(tile->_y);
-                tile->_hash |= tile->_zoom;
-
-                // skipTiles - these tiles are going to be ignored, since we need only 1 POI object (x;y)@zoom
-                if(tilesToSkip && tile->_zoom >= zoomToSkip)
-                {
-                    auto skipHash = (static_cast<uint64_t>(tile->_x) >> (tile->_zoom - zoomToSkip)) << zoomToSkip;
-                    skipHash |= static_cast<uint64_t>(tile->_y) >> (tile->_zoom - zoomToSkip);
-                    tilesToSkip->insert(skipHash);
-                }
-            }
+            tree.boxes[boxIndex].dataOffset = ObfReaderUtilities::readBigEndianInt(cis);
             break;
         default:
             ObfReaderUtilities::skipUnknownField(cis, tag);
@@ -363,18 +320,22 @@ bool OsmAnd::ObfPoiSectionReader_P::readTile(
     }
 }
 
-bool OsmAnd::ObfPoiSectionReader_P::checkTileCategories(
-    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
-    QSet<uint32_t>* desiredCategories )
+void OsmAnd::ObfPoiSectionReader_P::readBoxCategories(
+    const std::unique_ptr<ObfReader_P>& reader, ObfPoiSectionInfo_P::BoxTree& tree, const uint32_t boxIndex )
 {
     auto cis = reader->_codedInputStream.get();
+
+    auto& box = tree.boxes[boxIndex];
+    const auto pBitmap = tree.categoriesBitmaps.data() + boxIndex * ObfPoiSectionInfo_P::BoxTree::CategoriesBitmapWords;
+    box.hasCategories = true;
+    box.categoriesStart = tree.categories.size();
     for(;;)
     {
         auto tag = cis->ReadTag();
         switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
         {
         case 0:
-            return false;
+            return;
         case OBF::OsmAndPoiCategories::kCategoriesFieldNumber:
             {
                 gpb::uint32 binaryMixedId;
@@ -382,13 +343,9 @@ bool OsmAnd::ObfPoiSectionReader_P::checkTileCategories(
                 const auto catId = binaryMixedId & CategoryIdMask;
                 const auto subId = binaryMixedId >> SubcategoryIdShift;
 
-                const uint32_t allSubsId = (catId << 16) | 0xFFFF;
-                const uint32_t mixedId = (catId << 16) | subId;
-                if(desiredCategories->contains(allSubsId) || desiredCategories->contains(mixedId))
-                {
-                    cis->Skip(cis->BytesUntilLimit());
-                    return true;
-                }
+                tree.categories.push_back((catId << 16) | subId);
+                box.categoriesCount++;
+                pBitmap[catId / 64] |= static_cast<uint64_t>(1) << (catId % 64);
             }
             break;
         default:
@@ -398,6 +355,116 @@ bool OsmAnd::ObfPoiSectionReader_P::checkTileCategories(
     }
 }
 
+OsmAnd::ObfPoiSectionReader_P::CategoriesFilter::CategoriesFilter( const QSet<uint32_t>* const desiredCategories_ )
+    : desiredCategories(desiredCategories_)
+    , isExact(true)
+{
+    for(auto wordIdx = 0; wordIdx < ObfPoiSectionInfo_P::BoxTree::CategoriesBitmapWords; wordIdx++)
+        bitmap[wordIdx] = 0;
+
+    for(auto itDesiredCategory = desiredCategories->cbegin(); itDesiredCategory != desiredCategories->cend(); ++itDesiredCategory)
+    {
+        const auto catId = *itDesiredCategory >> 16;
+        const auto subId = *itDesiredCategory & 0xFFFF;
+        if(catId > CategoryIdMask)
+            continue;
+
+        bitmap[catId / 64] |= static_cast<uint64_t>(1) << (catId % 64);
+        if(subId != 0xFFFF)
+            isExact = false;
+    }
+}
+
+bool OsmAnd::ObfPoiSectionReader_P::CategoriesFilter::matches( const ObfPoiSectionInfo_P::BoxTree& tree, const uint32_t boxIndex ) const
+{
+    const auto pBitmap = tree.categoriesBitmaps.constData() + boxIndex * ObfPoiSectionInfo_P::BoxTree::CategoriesBitmapWords;
+    uint64_t intersection = 0;
+    for(auto wordIdx = 0; wordIdx < ObfPoiSectionInfo_P::BoxTree::CategoriesBitmapWords; wordIdx++)
+        intersection |= pBitmap[wordIdx] & bitmap[wordIdx];
+    if(intersection == 0)
+        return false;
+    if(isExact)
+        return true;
+
+    // Some of desired categories are limited to certain subcategories, so listed ones have to be checked
+    const auto& box = tree.boxes[boxIndex];
+    const auto pCategories = tree.categories.constData() + box.categoriesStart;
+    for(auto idx = 0u; idx < box.categoriesCount; idx++)
+    {
+        const auto mixedId = pCategories[idx];
+        const uint32_t allSubsId = mixedId | 0xFFFF;
+        if(desiredCategories->contains(allSubsId) || desiredCategories->contains(mixedId))
+            return true;
+    }
+    return false;
+}
+
+bool OsmAnd::ObfPoiSectionReader_P::collectTiles(
+    const ObfPoiSectionInfo_P::BoxTree& tree, const uint32_t boxIndex,
+    const CategoriesFilter* const categoriesFilter,
+    const uint32_t zoom, const uint32_t zoomDepth, const AreaI* bbox31,
+    QList< std::shared_ptr<Tile> >& tiles,
+    QSet< uint64_t >& tilesToSkip )
+{
+    const auto& box = tree.boxes[boxIndex];
+
+    // Check that we're inside bounding box, if requested
+    if(bbox31)
+    {
+        const auto shift = 31 - box.zoom;
+        AreaI area31;
+        area31.left = box.x << shift;
+        area31.top = box.y << shift;
+        area31.right = ((static_cast<uint64_t>(box.x) + 1) << shift) - 1;
+        area31.bottom = ((static_cast<uint64_t>(box.y) + 1) << shift) - 1;
+
+        const auto shouldSkip =
+            !bbox31->contains(area31) &&
+            !area31.contains(*bbox31) &&
+            !bbox31->intersects(area31);
+        if(shouldSkip)
+            return false;
+    }
+
+    // Boxes that do not list categories are not filtered
+    if(categoriesFilter && box.hasCategories && !categoriesFilter->matches(tree, boxIndex))
+        return false;
+
+    // These tiles are going to be ignored, since we need only 1 POI object (x;y)@zoom
+    const auto zoomToSkip = zoom + zoomDepth;
+    uint64_t skipHash = 0;
+    if(box.zoom >= zoomToSkip)
+    {
+        skipHash = (static_cast<uint64_t>(box.x) >> (box.zoom - zoomToSkip)) << zoomToSkip;
+        skipHash |= static_cast<uint64_t>(box.y) >> (box.zoom - zoomToSkip);
+    }
+
+    for(auto childIndex = boxIndex + 1; childIndex < box.subtreeEnd; childIndex = tree.boxes[childIndex].subtreeEnd)
+    {
+        const auto childCollected = collectTiles(tree, childIndex, categoriesFilter, zoom, zoomDepth, bbox31, tiles, tilesToSkip);
+        if(childCollected && box.zoom >= zoomToSkip && tilesToSkip.contains(skipHash))
+            return true;
+    }
+
+    if(box.dataOffset != 0)
+    {
+        std::shared_ptr<Tile> tile(new Tile());
+        tile->_zoom = box.zoom;
+        tile->_x = box.x;
+        tile->_y = box.y;
+        tile->_offset = box.dataOffset;
+        tile->_hash  = static_cast<uint64_t>(box.x) << box.zoom;
+        tile->_hash |= static_cast<uint64_t>(box.y);
+        tile->_hash |= box.zoom;
+        tiles.push_back(tile);
+
+        if(box.zoom >= zoomToSkip)
+            tilesToSkip.insert(skipHash);
+    }
+
+    return true;
+}
+
 void OsmAnd::ObfPoiSectionReader_P::readAmenitiesFromTile(
     const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section, Tile* tile,
     QSet<uint32_t>* desiredCategories,
@@ -503,17 +570,30 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenity(
 {
     auto cis = reader->_codedInputStream.get();
     PointI point;
-    uint32_t catId;
-    uint32_t subId;
+    uint32_t catId = 0;
+    uint32_t subId = 0;
+    // Amenity may have several categories, and it's accepted if any of them is desired, so that is known only at
+    // end of atom. Category of amenity is first desired one, or first one if none is
+    auto accepted = (desiredCategories == nullptr);
+    auto categoryRead = false;
+    amenity.reset(new Model::Amenity());
     for(;;)
     {
         if(controller && controller->isAborted())
+        {
+            amenity.reset();
             return;
+        }
 
         auto tag = cis->ReadTag();
         switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
         {
         case 0:
+            if(!accepted)
+            {
+                amenity.reset();
+                return;
+            }
             if(amenity->_latinName.isEmpty())
                 amenity->_latinName = reader->transliterate(amenity->_name);
             amenity->_point31 = point;
@@ -528,6 +608,7 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenity(
             if(bbox31 && !bbox31->contains(point))
             {
                 cis->Skip(cis->BytesUntilLimit());
+                amenity.reset();
                 return;
             }
             break;
@@ -535,20 +616,24 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenity(
             {
                 gpb::uint32 value;
                 cis->ReadVarint32(&value);
-                catId = value & CategoryIdMask;
-                subId = value >> SubcategoryIdShift;
+                const uint32_t valueCatId = value & CategoryIdMask;
+                const uint32_t valueSubId = value >> SubcategoryIdShift;
 
+                auto desired = false;
                 if(desiredCategories)
                 {
-                    const uint32_t allSubsId = (catId << 16) | 0xFFFF;
-                    const uint32_t mixedId = (catId << 16) | subId;
-                    if(desiredCategories->contains(allSubsId) || desiredCategories->contains(mixedId))
-                    {
-                        cis->Skip(cis->BytesUntilLimit());
-                        return;
-                    }
+                    const uint32_t allSubsId = (valueCatId << 16) | 0xFFFF;
+                    const uint32_t mixedId = (valueCatId << 16) | valueSubId;
+                    desired = desiredCategories->contains(allSubsId) || desiredCategories->contains(mixedId);
                 }
-                amenity.reset(new Model::Amenity());
+                if(!categoryRead || (desired && !accepted))
+                {
+                    catId = valueCatId;
+                    subId = valueSubId;
+                    categoryRead = true;
+                }
+                if(desired)
+                    accepted = true;
             }
             break;
         case OBF::OsmAndPoiBoxDataAtom::kIdFieldNumber:
@@ -579,4 +664,329 @@ void OsmAnd::ObfPoiSectionReader_P::readAmenity(
             break;
         }
     }
-}
\ No newline at end of file
+}
+
+void OsmAnd::ObfPoiSectionReader_P::searchAmenitiesByName(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+    const QString& query, const PointI& location31, const AreaI* bbox31 /*= nullptr*/,
+    QSet<uint32_t>* desiredCategories /*= nullptr*/,
+    QList< std::shared_ptr<const Model::Amenity> >* amenitiesOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const Model::Amenity>&)> visitor /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    const auto normalizedQuery = query.trimmed();
+    if(normalizedQuery.isEmpty())
+        return;
+
+    auto cis = reader->_codedInputStream.get();
+    cis->Seek(section->_offset);
+    auto oldLimit = cis->PushLimit(section->_length);
+    readAmenitiesByName(reader, section, normalizedQuery, location31, bbox31, desiredCategories, amenitiesOut, visitor, controller);
+    cis->PopLimit(oldLimit);
+}
+
+void OsmAnd::ObfPoiSectionReader_P::readAmenitiesByName(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+    const QString& query, const PointI& location31, const AreaI* bbox31,
+    QSet<uint32_t>* desiredCategories,
+    QList< std::shared_ptr<const Model::Amenity> >* amenitiesOut,
+    std::function<bool (const std::shared_ptr<const Model::Amenity>&)> visitor,
+    const IQueryController* const controller)
+{
+    auto cis = reader->_codedInputStream.get();
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndPoiIndex::kNameIndexFieldNumber:
+            {
+                // Name index gives offsets of all data blocks that contain matching names, so boxes are not needed
+                QHash< uint32_t, std::shared_ptr<Tile> > tiles;
+                auto length = ObfReaderUtilities::readBigEndianInt(cis);
+                auto oldLimit = cis->PushLimit(length);
+                readNameIndex(reader, section, query, bbox31, tiles, controller);
+                cis->PopLimit(oldLimit);
+                if(controller && controller->isAborted())
+                    return;
+
+                // Blocks are read from closest to farthest one. Found amenity is reported only when none of blocks
+                // that are not yet read may contain closer one, so that amenities are reported ordered by distance
+                QList< QPair<double, std::shared_ptr<Tile> > > sortedTiles;
+                for(auto itTile = tiles.cbegin(); itTile != tiles.cend(); ++itTile)
+                {
+                    const auto& tile = *itTile;
+
+                    const auto shift = 31 - tile->_zoom;
+                    const int64_t left = static_cast<int64_t>(tile->_x) << shift;
+                    const int64_t top = static_cast<int64_t>(tile->_y) << shift;
+                    const int64_t right = qMin<int64_t>(((static_cast<int64_t>(tile->_x) + 1) << shift) - 1, std::numeric_limits<int32_t>::max());
+                    const int64_t bottom = qMin<int64_t>(((static_cast<int64_t>(tile->_y) + 1) << shift) - 1, std::numeric_limits<int32_t>::max());
+                    const auto closestX = static_cast<int32_t>(qBound<int64_t>(left, location31.x, right));
+                    const auto closestY = static_cast<int32_t>(qBound<int64_t>(top, location31.y, bottom));
+
+                    sortedTiles.push_back(qMakePair(Utilities::squareDistance31(location31.x, location31.y, closestX, closestY), tile));
+                }
+                qSort(sortedTiles.begin(), sortedTiles.end(), [](const QPair<double, std::shared_ptr<Tile> >& l, const QPair<double, std::shared_ptr<Tile> >& r) -> bool
+                {
+                    return l.first < r.first;
+                });
+
+                QMultiMap< double, std::shared_ptr<Model::Amenity> > pendingAmenities;
+                const auto reportPendingAmenities = [&pendingAmenities, amenitiesOut, visitor](const double squareDistanceLimit)
+                {
+                    while(!pendingAmenities.isEmpty() && pendingAmenities.firstKey() <= squareDistanceLimit)
+                    {
+                        const auto itAmenity = pendingAmenities.begin();
+                        const std::shared_ptr<const Model::Amenity> amenity = itAmenity.value();
+                        pendingAmenities.erase(itAmenity);
+
+                        const auto visitorAgrees = visitor ? visitor(amenity) : true;
+                        if(amenitiesOut && visitorAgrees)
+                            amenitiesOut->push_back(amenity);
+                    }
+                };
+
+                for(auto itTile = sortedTiles.cbegin(); itTile != sortedTiles.cend(); ++itTile)
+                {
+                    reportPendingAmenities(itTile->first);
+
+                    cis->Seek(section->_offset + itTile->second->_offset);
+                    auto length = ObfReaderUtilities::readBigEndianInt(cis);
+                    auto oldLimit = cis->PushLimit(length);
+                    QList< std::shared_ptr<Model::Amenity> > amenities;
+                    readAmenitiesByNameFromTile(reader, section, query, bbox31, desiredCategories, amenities, controller);
+                    cis->PopLimit(oldLimit);
+                    if(controller && controller->isAborted())
+                        return;
+
+                    for(auto itAmenity = amenities.cbegin(); itAmenity != amenities.cend(); ++itAmenity)
+                    {
+                        const auto& amenity = *itAmenity;
+                        pendingAmenities.insert(Utilities::squareDistance31(location31, amenity->_point31), amenity);
+                    }
+                }
+                reportPendingAmenities(std::numeric_limits<double>::max());
+
+                cis->Skip(cis->BytesUntilLimit());
+            }
+            return;
+        case OBF::OsmAndPoiIndex::kPoiDataFieldNumber:
+            // Section has no name index
+            cis->Skip(cis->BytesUntilLimit());
+            return;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfPoiSectionReader_P::readNameIndex(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+    const QString& query, const AreaI* bbox31,
+    QHash< uint32_t, std::shared_ptr<Tile> >& tiles,
+    const IQueryController* const controller)
+{
+    auto cis = reader->_codedInputStream.get();
+
+    QList<uint32_t> dataOffsets;
+    int tableOffset = 0;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndPoiNameIndex::kTableFieldNumber:
+            {
+                auto length = ObfReaderUtilities::readBigEndianInt(cis);
+                tableOffset = cis->CurrentPosition();
+                auto oldLimit = cis->PushLimit(length);
+                ObfReaderUtilities::readIndexedStringTable(cis, query, dataOffsets);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        case OBF::OsmAndPoiNameIndex::kDataFieldNumber:
+            {
+                // Values of table are offsets of data messages, relative to table start
+                qSort(dataOffsets);
+                for(auto itDataOffset = dataOffsets.cbegin(); itDataOffset != dataOffsets.cend(); ++itDataOffset)
+                {
+                    cis->Seek(tableOffset + *itDataOffset);
+                    gpb::uint32 length;
+                    cis->ReadVarint32(&length);
+                    auto oldLimit = cis->PushLimit(length);
+                    readNameIndexData(reader, section, bbox31, tiles);
+                    cis->PopLimit(oldLimit);
+                    if(controller && controller->isAborted())
+                        break;
+                }
+                cis->Skip(cis->BytesUntilLimit());
+            }
+            return;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfPoiSectionReader_P::readNameIndexData(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+    const AreaI* bbox31,
+    QHash< uint32_t, std::shared_ptr<Tile> >& tiles)
+{
+    auto cis = reader->_codedInputStream.get();
+
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndPoiNameIndex_OsmAndPoiNameIndexData::kAtomsFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                readNameIndexDataAtom(reader, section, bbox31, tiles);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfPoiSectionReader_P::readNameIndexDataAtom(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+    const AreaI* bbox31,
+    QHash< uint32_t, std::shared_ptr<Tile> >& tiles)
+{
+    auto cis = reader->_codedInputStream.get();
+
+    gpb::uint32 zoom = 0;
+    gpb::uint32 x = 0;
+    gpb::uint32 y = 0;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndPoiNameIndexDataAtom::kZoomFieldNumber:
+            cis->ReadVarint32(&zoom);
+            break;
+        case OBF::OsmAndPoiNameIndexDataAtom::kXFieldNumber:
+            cis->ReadVarint32(&x);
+            break;
+        case OBF::OsmAndPoiNameIndexDataAtom::kYFieldNumber:
+            cis->ReadVarint32(&y);
+            break;
+        case OBF::OsmAndPoiNameIndexDataAtom::kShiftToFieldNumber:
+            {
+                // Same data block is referenced by atoms of every matching name in it
+                const auto offset = ObfReaderUtilities::readBigEndianInt(cis);
+                if(tiles.contains(offset))
+                    break;
+
+                if(bbox31)
+                {
+                    const auto shift = 31 - zoom;
+                    AreaI area31;
+                    area31.left = x << shift;
+                    area31.top = y << shift;
+                    area31.right = ((static_cast<uint64_t>(x) + 1) << shift) - 1;
+                    area31.bottom = ((static_cast<uint64_t>(y) + 1) << shift) - 1;
+                    if(!bbox31->contains(area31) && !area31.contains(*bbox31) && !bbox31->intersects(area31))
+                        break;
+                }
+
+                std::shared_ptr<Tile> tile(new Tile());
+                tile->_zoom = zoom;
+                tile->_x = x;
+                tile->_y = y;
+                tile->_hash = (static_cast<uint64_t>(x) << zoom) | static_cast<uint64_t>(y) | zoom;
+                tile->_offset = offset;
+                tiles.insert(offset, tile);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfPoiSectionReader_P::readAmenitiesByNameFromTile(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+    const QString& query, const AreaI* bbox31,
+    QSet<uint32_t>* desiredCategories,
+    QList< std::shared_ptr<Model::Amenity> >& amenitiesOut,
+    const IQueryController* const controller)
+{
+    auto cis = reader->_codedInputStream.get();
+
+    PointI pTile;
+    uint32_t zoomTile = 0;
+    for(;;)
+    {
+        if(controller && controller->isAborted())
+            return;
+
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::OsmAndPoiBoxData::kZoomFieldNumber:
+            {
+                gpb::uint32 value;
+                cis->ReadVarint32(&value);
+                zoomTile = value;
+            }
+            break;
+        case OBF::OsmAndPoiBoxData::kXFieldNumber:
+            {
+                gpb::uint32 value;
+                cis->ReadVarint32(&value);
+                pTile.x = value;
+            }
+            break;
+        case OBF::OsmAndPoiBoxData::kYFieldNumber:
+            {
+                gpb::uint32 value;
+                cis->ReadVarint32(&value);
+                pTile.y = value;
+            }
+            break;
+        case OBF::OsmAndPoiBoxData::kPoiDataFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                std::shared_ptr<Model::Amenity> amenity;
+                readAmenity(reader, section, pTile, zoomTile, amenity, desiredCategories, bbox31, controller);
+                cis->PopLimit(oldLimit);
+                if(!amenity)
+                    break;
+
+                // Block also contains amenities that were referenced by other names
+                if(ObfReaderUtilities::nameMatchesQuery(amenity->_name, query) || ObfReaderUtilities::nameMatchesQuery(amenity->_latinName, query))
+                    amenitiesOut.push_back(amenity);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
@@ -29,6 +29,7 @@
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
+#include <ObfPoiSectionInfo_P.h>
 
 namespace OsmAnd {
 
@@ -72,15 +73,29 @@ namespace OsmAnd {
             uint64_t _hash;
             int32_t _offset;
         };
-        static bool readTile(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+        static std::shared_ptr<const ObfPoiSectionInfo_P::BoxTree> obtainBoxTree(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section);
+        static void readBoxTree(const std::unique_ptr<ObfReader_P>& reader, ObfPoiSectionInfo_P::BoxTree& tree);
+        static void readBox(const std::unique_ptr<ObfReader_P>& reader, ObfPoiSectionInfo_P::BoxTree& tree,
+            const uint32_t parentZoom, const uint32_t parentX, const uint32_t parentY);
+        static void readBoxCategories(const std::unique_ptr<ObfReader_P>& reader, ObfPoiSectionInfo_P::BoxTree& tree, const uint32_t boxIndex);
+
+        // Bitmap of desired category ids, to reject boxes without checking each listed category
+        struct CategoriesFilter
+        {
+            CategoriesFilter(const QSet<uint32_t>* const desiredCategories);
+
+            const QSet<uint32_t>* const desiredCategories;
+            uint64_t bitmap[ObfPoiSectionInfo_P::BoxTree::CategoriesBitmapWords];
+            // True if all desired categories include all subcategories, so bitmap match is enough
+            bool isExact;
+
+            bool matches(const ObfPoiSectionInfo_P::BoxTree& tree, const uint32_t boxIndex) const;
+        };
+        static bool collectTiles(const ObfPoiSectionInfo_P::BoxTree& tree, const uint32_t boxIndex,
+            const CategoriesFilter* const categoriesFilter,
+            const uint32_t zoom, const uint32_t zoomDepth, const AreaI* bbox31,
             QList< std::shared_ptr<Tile> >& tiles,
-            Tile* parent,
-            QSet<uint32_t>* desiredCategories,
-            uint32_t zoom, uint32_t zoomDepth, const AreaI* bbox31,
-            const IQueryController* const controller,
-            QSet< uint64_t >* tilesToSkip);
-        static bool checkTileCategories(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
-            QSet<uint32_t>* desiredCategories);
+            QSet< uint64_t >& tilesToSkip);
         static void readAmenitiesFromTile(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section, Tile* tile,
             QSet<uint32_t>* desiredCategories,
             QList< std::shared_ptr<const Model::Amenity> >* amenitiesOut,
@@ -94,6 +109,28 @@ namespace OsmAnd {
             const AreaI* bbox31,
             const IQueryController* const controller);
 
+        static void readAmenitiesByName(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+            const QString& query, const PointI& location31, const AreaI* bbox31,
+            QSet<uint32_t>* desiredCategories,
+            QList< std::shared_ptr<const Model::Amenity> >* amenitiesOut,
+            std::function<bool (const std::shared_ptr<const Model::Amenity>&)> visitor,
+            const IQueryController* const controller);
+        static void readNameIndex(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+            const QString& query, const AreaI* bbox31,
+            QHash< uint32_t, std::shared_ptr<Tile> >& tiles,
+            const IQueryController* const controller);
+        static void readNameIndexData(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+            const AreaI* bbox31,
+            QHash< uint32_t, std::shared_ptr<Tile> >& tiles);
+        static void readNameIndexDataAtom(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+            const AreaI* bbox31,
+            QHash< uint32_t, std::shared_ptr<Tile> >& tiles);
+        static void readAmenitiesByNameFromTile(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfPoiSectionInfo>& section,
+            const QString& query, const AreaI* bbox31,
+            QSet<uint32_t>* desiredCategories,
+            QList< std::shared_ptr<Model::Amenity> >& amenitiesOut,
+            const IQueryController* const controller);
+
         static void loadCategories(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const OsmAnd::ObfPoiSectionInfo>& section,
             QList< std::shared_ptr<const Model::AmenityCategory> >& categories);
 
@@ -104,6 +141,13 @@ namespace OsmAnd {
             std::function<bool (const std::shared_ptr<const OsmAnd::Model::Amenity>&)> visitor = nullptr,
             const IQueryController* const controller = nullptr);
 
+        static void searchAmenitiesByName(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const OsmAnd::ObfPoiSectionInfo>& section,
+            const QString& query, const PointI& location31, const AreaI* bbox31 = nullptr,
+            QSet<uint32_t>* desiredCategories = nullptr,
+            QList< std::shared_ptr<const OsmAnd::Model::Amenity> >* amenitiesOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::Amenity>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr);
+
         friend class OsmAnd::ObfReader_P;
         friend class OsmAnd::ObfPoiSectionReader;
     };
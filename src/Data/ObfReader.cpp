@@ -5,6 +5,7 @@
 #include "ObfFile_P.h"
 
 #include "QZeroCopyInputStream.h"
+#include "QMemoryMappedInputStream.h"
 
 OsmAnd::ObfReader::ObfReader( const std::shared_ptr<const ObfFile>& obfFile_ )
     : _d(new ObfReader_P(this))
@@ -31,13 +32,28 @@ std::shared_ptr<OsmAnd::ObfInfo> OsmAnd::ObfReader::obtainInfo() const
     // Open file for reading (if needed)
     if(!_d->_codedInputStream)
     {
+        // Regular files are read via shared memory mapping, falling back to plain file access if that fails
+        gpb::io::ZeroCopyInputStream* zcis = nullptr;
         if(obfFile)
         {
-            auto input = new QFile(obfFile->filePath);
-            _d->_input.reset(input);
+            std::shared_ptr<QFile> mappedFile;
+            const uchar* mappedData = nullptr;
+            qint64 mappedSize = 0;
+            if(obfFile->_d->obtainMapping(mappedFile, mappedData, mappedSize))
+            {
+                zcis = new QMemoryMappedInputStream(mappedFile, mappedData, mappedSize);
+            }
+            else
+            {
+                auto input = new QFile(obfFile->filePath);
+                _d->_input.reset(input);
+            }
         }
+        if(!zcis)
+            zcis = new QZeroCopyInputStream(_d->_input);
+        _d->_zeroCopyInputStream.reset(zcis);
 
-        auto cis = new gpb::io::CodedInputStream(new QZeroCopyInputStream(_d->_input));
+        auto cis = new gpb::io::CodedInputStream(zcis);
         cis->SetTotalBytesLimit(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
         _d->_codedInputStream.reset(cis);
     }
@@ -65,6 +65,81 @@ void OsmAnd::ObfReaderUtilities::readStringTable( gpb::io::CodedInputStream* cis
     }
 }
 
+int OsmAnd::ObfReaderUtilities::readIndexedStringTable(
+    gpb::io::CodedInputStream* cis, const QString& query, QList<uint32_t>& valuesOut,
+    const QString& keysPrefix /*= QString()*/, int matchedLength /*= 0*/ )
+{
+    // Only values of keys that share longest common prefix with query are collected. Key either starts with
+    // query, or query starts with key (since keys are usually shorter than names they index)
+    QString key;
+    bool keyMatches = false;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return matchedLength;
+        case OBF::IndexedStringTable::kKeyFieldNumber:
+            {
+                readQString(cis, key);
+                key.prepend(keysPrefix);
+
+                int keyMatchedLength = -1;
+                if(key.startsWith(query, Qt::CaseInsensitive))
+                    keyMatchedLength = query.length();
+                else if(query.startsWith(key, Qt::CaseInsensitive))
+                    keyMatchedLength = key.length();
+
+                keyMatches = (keyMatchedLength >= matchedLength);
+                if(keyMatchedLength > matchedLength)
+                {
+                    matchedLength = keyMatchedLength;
+                    valuesOut.clear();
+                }
+            }
+            break;
+        case OBF::IndexedStringTable::kValFieldNumber:
+            {
+                const auto value = readBigEndianInt(cis);
+                if(keyMatches)
+                    valuesOut.push_back(value);
+            }
+            break;
+        case OBF::IndexedStringTable::kSubtablesFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                if(keyMatches)
+                    matchedLength = readIndexedStringTable(cis, query, valuesOut, key, matchedLength);
+                else
+                    cis->Skip(cis->BytesUntilLimit());
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        default:
+            skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+bool OsmAnd::ObfReaderUtilities::nameMatchesQuery( const QString& name, const QString& query )
+{
+    // Query has to match beginning of any word in name
+    auto position = 0;
+    for(;;)
+    {
+        position = name.indexOf(query, position, Qt::CaseInsensitive);
+        if(position < 0)
+            return false;
+        if(position == 0 || !name.at(position - 1).isLetterOrNumber())
+            return true;
+        position++;
+    }
+}
+
 void OsmAnd::ObfReaderUtilities::skipUnknownField( gpb::io::CodedInputStream* cis, int tag )
 {
     auto wireType = gpb::internal::WireFormatLite::GetTagWireType(tag);
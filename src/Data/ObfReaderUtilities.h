@@ -42,6 +42,9 @@ namespace OsmAnd {
         int64_t readSInt64(gpb::io::CodedInputStream* cis);
         uint32_t readBigEndianInt(gpb::io::CodedInputStream* cis);
         void readStringTable(gpb::io::CodedInputStream* cis, QStringList& stringTableOut);
+        int readIndexedStringTable(gpb::io::CodedInputStream* cis, const QString& query, QList<uint32_t>& valuesOut,
+            const QString& keysPrefix = QString(), int matchedLength = 0);
+        bool nameMatchesQuery(const QString& name, const QString& query);
         void skipUnknownField(gpb::io::CodedInputStream* cis, int tag);
         QString encodeIntegerToString(const uint32_t value);
         uint32_t decodeIntegerFromString(const QString& container);
@@ -30,6 +30,7 @@
 #include <QString>
 
 #include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream.h>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/IQueryController.h>
@@ -56,6 +57,7 @@ namespace OsmAnd {
         ObfReader_P(ObfReader* owner);
 
         ObfReader* const owner;
+        std::shared_ptr<gpb::io::ZeroCopyInputStream> _zeroCopyInputStream;
         std::shared_ptr<gpb::io::CodedInputStream> _codedInputStream;
 
         std::shared_ptr<QIODevice> _input;
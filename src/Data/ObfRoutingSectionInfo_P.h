@@ -41,6 +41,7 @@ namespace OsmAnd {
     class RoutePlanner;
     class RoutePlannerContext;
     class RoutingRulesetContext;
+    class RoutingSubsectionData;
 
     class ObfRoutingSectionInfo;
     class ObfRoutingSectionInfo_P
@@ -95,6 +96,7 @@ namespace OsmAnd {
     friend class OsmAnd::RoutePlanner;
     friend class OsmAnd::RoutePlannerContext;
     friend class OsmAnd::RoutingRulesetContext;
+    friend class OsmAnd::RoutingSubsectionData;
     };
 
 } // namespace OsmAnd
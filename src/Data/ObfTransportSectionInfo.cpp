@@ -1,7 +1,13 @@
 #include "ObfTransportSectionInfo.h"
+#include "ObfTransportSectionInfo_P.h"
 
 OsmAnd::ObfTransportSectionInfo::ObfTransportSectionInfo( const std::weak_ptr<ObfInfo>& owner )
     : ObfSectionInfo(owner)
+    , _d(new ObfTransportSectionInfo_P(this))
+    , _stopsOffset(0)
+    , _stopsLength(0)
+    , _stringTableOffset(0)
+    , _stringTableLength(0)
     , area24(_area24)
 {
 }
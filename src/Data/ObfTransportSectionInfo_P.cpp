@@ -0,0 +1,10 @@
+#include "ObfTransportSectionInfo_P.h"
+
+OsmAnd::ObfTransportSectionInfo_P::ObfTransportSectionInfo_P( ObfTransportSectionInfo* owner_ )
+    : owner(owner_)
+{
+}
+
+OsmAnd::ObfTransportSectionInfo_P::~ObfTransportSectionInfo_P()
+{
+}
@@ -0,0 +1,61 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __OBF_TRANSPORT_SECTION_INFO_P_H_
+#define __OBF_TRANSPORT_SECTION_INFO_P_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QMutex>
+#include <QStringList>
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd {
+
+    class ObfTransportSectionReader_P;
+
+    class ObfTransportSectionInfo;
+    class ObfTransportSectionInfo_P
+    {
+        Q_DISABLE_COPY(ObfTransportSectionInfo_P)
+    private:
+    protected:
+        ObfTransportSectionInfo_P(ObfTransportSectionInfo* owner);
+
+        ObfTransportSectionInfo* const owner;
+
+        // Names of stops and routes, decoded once per section
+        mutable QMutex _stringTableMutex;
+        std::shared_ptr<const QStringList> _stringTable;
+    public:
+        virtual ~ObfTransportSectionInfo_P();
+
+    friend class OsmAnd::ObfTransportSectionInfo;
+    friend class OsmAnd::ObfTransportSectionReader_P;
+    };
+
+} // namespace OsmAnd
+
+#endif // __OBF_TRANSPORT_SECTION_INFO_P_H_
@@ -1,4 +1,7 @@
 #include "ObfTransportSectionReader.h"
+#include "ObfTransportSectionReader_P.h"
+
+#include "ObfReader.h"
 
 OsmAnd::ObfTransportSectionReader::ObfTransportSectionReader()
 {
@@ -7,3 +10,22 @@ OsmAnd::ObfTransportSectionReader::ObfTransportSectionReader()
 OsmAnd::ObfTransportSectionReader::~ObfTransportSectionReader()
 {
 }
+
+void OsmAnd::ObfTransportSectionReader::loadTransportStops(
+    const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const OsmAnd::ObfTransportSectionInfo>& section,
+    const AreaI* bbox31 /*= nullptr*/,
+    QList< std::shared_ptr<const OsmAnd::Model::TransportStop> >* resultOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::TransportStop>&)> visitor /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    ObfTransportSectionReader_P::loadTransportStops(reader->_d, section, bbox31, resultOut, visitor, controller);
+}
+
+void OsmAnd::ObfTransportSectionReader::loadTransportRoutes(
+    const std::shared_ptr<ObfReader>& reader, const std::shared_ptr<const OsmAnd::ObfTransportSectionInfo>& section,
+    const QVector<uint32_t>& routesOffsets,
+    QList< std::shared_ptr<const OsmAnd::Model::TransportRoute> >* resultOut /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    ObfTransportSectionReader_P::loadTransportRoutes(reader->_d, section, routesOffsets, resultOut, controller);
+}
@@ -2,7 +2,11 @@
 
 #include "ObfReader_P.h"
 #include "ObfTransportSectionInfo.h"
+#include "ObfTransportSectionInfo_P.h"
+#include "TransportStop.h"
+#include "TransportRoute.h"
 #include "ObfReaderUtilities.h"
+#include "IQueryController.h"
 #include "Utilities.h"
 
 #include "OBF.pb.h"
@@ -28,6 +32,7 @@ void OsmAnd::ObfTransportSectionReader_P::read( const std::unique_ptr<ObfReader_
         case 0:
             return;
         case OBF::OsmAndTransportIndex::kRoutesFieldNumber:
+            // Routes are read on demand, by offsets referenced from stops
             ObfReaderUtilities::skipUnknownField(cis, tag);
             break;
         case OBF::OsmAndTransportIndex::kNameFieldNumber:
@@ -46,17 +51,10 @@ void OsmAnd::ObfTransportSectionReader_P::read( const std::unique_ptr<ObfReader_
             {
                 gpb::uint32 length;
                 cis->ReadVarint32(&length);
-                auto offset = cis->CurrentPosition();
-                cis->Seek(offset + length);
-            }
-            //TODO:
-            /*IndexStringTable st = new IndexStringTable();
-            st.length = codedIS.readRawVarint32();
-            st.fileOffset = codedIS.getTotalBytesRead();
-            // Do not cache for now save memory
-            // readStringTable(st, 0, 20, true);
-            ind.stringTable = st;
-            codedIS.seek(st.length + st.fileOffset);*/
+                section->_stringTableLength = length;
+                section->_stringTableOffset = cis->CurrentPosition();
+                cis->Seek(section->_stringTableOffset + section->_stringTableLength);
+            }
             break;
         default:
             ObfReaderUtilities::skipUnknownField(cis, tag);
@@ -94,3 +92,379 @@ void OsmAnd::ObfTransportSectionReader_P::readTransportStopsBounds( const std::u
         }
     }
 }
+
+std::shared_ptr<const QStringList> OsmAnd::ObfTransportSectionReader_P::obtainStringTable(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section )
+{
+    QMutexLocker scopedLock(&section->_d->_stringTableMutex);
+
+    if(!section->_d->_stringTable)
+    {
+        std::shared_ptr<QStringList> stringTable(new QStringList());
+        if(section->_stringTableLength > 0)
+        {
+            auto cis = reader->_codedInputStream.get();
+            cis->Seek(section->_stringTableOffset);
+            auto oldLimit = cis->PushLimit(section->_stringTableLength);
+            ObfReaderUtilities::readStringTable(cis, *stringTable);
+            cis->PopLimit(oldLimit);
+        }
+
+        section->_d->_stringTable = stringTable;
+    }
+
+    return section->_d->_stringTable;
+}
+
+void OsmAnd::ObfTransportSectionReader_P::readTransportStopsTree(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section,
+    const QStringList& stringTable, const AreaI& parentArea24, const AreaI* bbox24,
+    QList< std::shared_ptr<const OsmAnd::Model::TransportStop> >* resultOut,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::TransportStop>&)> visitor,
+    const IQueryController* const controller )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    AreaI area24;
+    QList< std::shared_ptr<Model::TransportStop> > stops;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            {
+                // Base id is written after stops, so stops are reported only once whole node was read
+                for(auto itStop = stops.cbegin(); itStop != stops.cend(); ++itStop)
+                {
+                    const auto& stop = *itStop;
+
+                    const auto visitorAgrees = visitor ? visitor(stop) : true;
+                    if(resultOut && visitorAgrees)
+                        resultOut->push_back(stop);
+                }
+            }
+            return;
+        case OBF::TransportStopsTree::kLeftFieldNumber:
+            area24.left = ObfReaderUtilities::readSInt32(cis) + parentArea24.left;
+            break;
+        case OBF::TransportStopsTree::kRightFieldNumber:
+            area24.right = ObfReaderUtilities::readSInt32(cis) + parentArea24.right;
+            break;
+        case OBF::TransportStopsTree::kTopFieldNumber:
+            area24.top = ObfReaderUtilities::readSInt32(cis) + parentArea24.top;
+            break;
+        case OBF::TransportStopsTree::kBottomFieldNumber:
+            {
+                area24.bottom = ObfReaderUtilities::readSInt32(cis) + parentArea24.bottom;
+
+                // Bounds are written first, so whole node is skipped if it's outside of bounding box
+                if(bbox24 && !bbox24->intersects(area24))
+                {
+                    cis->Skip(cis->BytesUntilLimit());
+                    return;
+                }
+            }
+            break;
+        case OBF::TransportStopsTree::kSubtreesFieldNumber:
+            {
+                auto length = ObfReaderUtilities::readBigEndianInt(cis);
+                auto oldLimit = cis->PushLimit(length);
+                readTransportStopsTree(reader, section, stringTable, area24, bbox24, resultOut, visitor, controller);
+                cis->PopLimit(oldLimit);
+                if(controller && controller->isAborted())
+                    return;
+            }
+            break;
+        case OBF::TransportStopsTree::kLeafsFieldNumber:
+            {
+                // Routes of stop are referenced relatively to position of stop message including its length
+                const auto stopOffset = cis->CurrentPosition();
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                std::shared_ptr<Model::TransportStop> stop;
+                readTransportStop(reader, stringTable, stopOffset, area24, bbox24, stop);
+                if(stop)
+                    stops.push_back(stop);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        case OBF::TransportStopsTree::kBaseIdFieldNumber:
+            {
+                gpb::uint64 baseId;
+                cis->ReadVarint64(&baseId);
+                for(auto itStop = stops.begin(); itStop != stops.end(); ++itStop)
+                    (*itStop)->_id += baseId;
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfTransportSectionReader_P::readTransportStop(
+    const std::unique_ptr<ObfReader_P>& reader,
+    const QStringList& stringTable, const uint32_t stopOffset, const AreaI& area24, const AreaI* bbox24,
+    std::shared_ptr<Model::TransportStop>& stop )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    // Position is written first, so stop is created only if it's inside bounding box
+    PointI position24;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        const auto tagFieldNumber = gpb::internal::WireFormatLite::GetTagFieldNumber(tag);
+        if(!stop && tagFieldNumber != 0 && tagFieldNumber != OBF::TransportStop::kDxFieldNumber && tagFieldNumber != OBF::TransportStop::kDyFieldNumber)
+        {
+            // Stop without position is broken
+            cis->Skip(cis->BytesUntilLimit());
+            return;
+        }
+
+        switch(tagFieldNumber)
+        {
+        case 0:
+            return;
+        case OBF::TransportStop::kDxFieldNumber:
+            position24.x = ObfReaderUtilities::readSInt32(cis) + area24.left;
+            break;
+        case OBF::TransportStop::kDyFieldNumber:
+            {
+                position24.y = ObfReaderUtilities::readSInt32(cis) + area24.top;
+                if(bbox24 && !bbox24->contains(position24))
+                {
+                    cis->Skip(cis->BytesUntilLimit());
+                    return;
+                }
+
+                stop.reset(new Model::TransportStop());
+                stop->_offset = stopOffset;
+                stop->_point31 = PointI(position24.x << ShiftCoordinates24To31, position24.y << ShiftCoordinates24To31);
+            }
+            break;
+        case OBF::TransportStop::kIdFieldNumber:
+            stop->_id = ObfReaderUtilities::readSInt64(cis);
+            break;
+        case OBF::TransportStop::kNameFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                stop->_name = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportStop::kNameEnFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                stop->_latinName = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportStop::kRoutesFieldNumber:
+            {
+                gpb::uint32 shift;
+                cis->ReadVarint32(&shift);
+                stop->_routesOffsets.push_back(stopOffset - shift);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfTransportSectionReader_P::readTransportRoute(
+    const std::unique_ptr<ObfReader_P>& reader,
+    const QStringList& stringTable,
+    const std::shared_ptr<Model::TransportRoute>& route )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    // Stops of each direction are delta-encoded to previous stop of same direction
+    uint64_t forwardStopId = 0;
+    PointI forwardStopPosition24;
+    uint64_t backwardStopId = 0;
+    PointI backwardStopPosition24;
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            return;
+        case OBF::TransportRoute::kIdFieldNumber:
+            cis->ReadVarint64(reinterpret_cast<gpb::uint64*>(&route->_id));
+            break;
+        case OBF::TransportRoute::kTypeFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                route->_type = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportRoute::kOperatorFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                route->_operatorName = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportRoute::kRefFieldNumber:
+            ObfReaderUtilities::readQString(cis, route->_ref);
+            break;
+        case OBF::TransportRoute::kNameFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                route->_name = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportRoute::kNameEnFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                route->_latinName = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportRoute::kDistanceFieldNumber:
+            cis->ReadVarint32(&route->_distance);
+            break;
+        case OBF::TransportRoute::kDirectStopsFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                std::shared_ptr<Model::TransportStop> stop(new Model::TransportStop());
+                readTransportRouteStop(reader, stringTable, forwardStopId, forwardStopPosition24, stop);
+                route->_forwardStops.push_back(stop);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        case OBF::TransportRoute::kReverseStopsFieldNumber:
+            {
+                gpb::uint32 length;
+                cis->ReadVarint32(&length);
+                auto oldLimit = cis->PushLimit(length);
+                std::shared_ptr<Model::TransportStop> stop(new Model::TransportStop());
+                readTransportRouteStop(reader, stringTable, backwardStopId, backwardStopPosition24, stop);
+                route->_backwardStops.push_back(stop);
+                cis->PopLimit(oldLimit);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfTransportSectionReader_P::readTransportRouteStop(
+    const std::unique_ptr<ObfReader_P>& reader,
+    const QStringList& stringTable, uint64_t& previousId, PointI& previousPosition24,
+    const std::shared_ptr<Model::TransportStop>& stop )
+{
+    auto cis = reader->_codedInputStream.get();
+
+    for(;;)
+    {
+        auto tag = cis->ReadTag();
+        switch(gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+        case 0:
+            stop->_point31 = PointI(previousPosition24.x << ShiftCoordinates24To31, previousPosition24.y << ShiftCoordinates24To31);
+            return;
+        case OBF::TransportRouteStop::kIdFieldNumber:
+            previousId += ObfReaderUtilities::readSInt64(cis);
+            stop->_id = previousId;
+            break;
+        case OBF::TransportRouteStop::kDxFieldNumber:
+            previousPosition24.x += ObfReaderUtilities::readSInt32(cis);
+            break;
+        case OBF::TransportRouteStop::kDyFieldNumber:
+            previousPosition24.y += ObfReaderUtilities::readSInt32(cis);
+            break;
+        case OBF::TransportRouteStop::kNameFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                stop->_name = stringTable.value(stringId);
+            }
+            break;
+        case OBF::TransportRouteStop::kNameEnFieldNumber:
+            {
+                gpb::uint32 stringId;
+                cis->ReadVarint32(&stringId);
+                stop->_latinName = stringTable.value(stringId);
+            }
+            break;
+        default:
+            ObfReaderUtilities::skipUnknownField(cis, tag);
+            break;
+        }
+    }
+}
+
+void OsmAnd::ObfTransportSectionReader_P::loadTransportStops(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section,
+    const AreaI* bbox31 /*= nullptr*/,
+    QList< std::shared_ptr<const OsmAnd::Model::TransportStop> >* resultOut /*= nullptr*/,
+    std::function<bool (const std::shared_ptr<const OsmAnd::Model::TransportStop>&)> visitor /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    if(section->_stopsLength == 0)
+        return;
+
+    AreaI bbox24;
+    if(bbox31)
+    {
+        bbox24.top = bbox31->top >> ShiftCoordinates24To31;
+        bbox24.left = bbox31->left >> ShiftCoordinates24To31;
+        bbox24.bottom = bbox31->bottom >> ShiftCoordinates24To31;
+        bbox24.right = bbox31->right >> ShiftCoordinates24To31;
+
+        if(!bbox24.intersects(section->_area24))
+            return;
+    }
+
+    const auto stringTable = obtainStringTable(reader, section);
+
+    auto cis = reader->_codedInputStream.get();
+    cis->Seek(section->_stopsOffset);
+    auto oldLimit = cis->PushLimit(section->_stopsLength);
+    readTransportStopsTree(reader, section, *stringTable, AreaI(), bbox31 ? &bbox24 : nullptr, resultOut, visitor, controller);
+    cis->PopLimit(oldLimit);
+}
+
+void OsmAnd::ObfTransportSectionReader_P::loadTransportRoutes(
+    const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section,
+    const QVector<uint32_t>& routesOffsets,
+    QList< std::shared_ptr<const OsmAnd::Model::TransportRoute> >* resultOut /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    const auto stringTable = obtainStringTable(reader, section);
+
+    auto cis = reader->_codedInputStream.get();
+    for(auto itRouteOffset = routesOffsets.cbegin(); itRouteOffset != routesOffsets.cend(); ++itRouteOffset)
+    {
+        const auto routeOffset = *itRouteOffset;
+
+        cis->Seek(routeOffset);
+        gpb::uint32 length;
+        cis->ReadVarint32(&length);
+        auto oldLimit = cis->PushLimit(length);
+        std::shared_ptr<Model::TransportRoute> route(new Model::TransportRoute());
+        route->_offset = routeOffset;
+        readTransportRoute(reader, *stringTable, route);
+        cis->PopLimit(oldLimit);
+
+        if(resultOut)
+            resultOut->push_back(route);
+
+        if(controller && controller->isAborted())
+            return;
+    }
+}
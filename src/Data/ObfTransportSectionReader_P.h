@@ -27,6 +27,10 @@
 #include <memory>
 #include <functional>
 
+#include <QList>
+#include <QVector>
+#include <QStringList>
+
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 
@@ -34,8 +38,13 @@ namespace OsmAnd {
 
     class ObfReader_P;
     class ObfTransportSectionInfo;
+    namespace Model {
+        class TransportStop;
+        class TransportRoute;
+    } // namespace Model
     class IQueryController;
 
+    class ObfTransportSectionReader;
     class OSMAND_CORE_API ObfTransportSectionReader_P
     {
     private:
@@ -46,7 +55,42 @@ namespace OsmAnd {
 
         static void readTransportStopsBounds(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<ObfTransportSectionInfo>& section);
 
+        enum {
+            // Transport data is stored in 24 zoom
+            ShiftCoordinates24To31 = 7,
+        };
+
+        static std::shared_ptr<const QStringList> obtainStringTable(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section);
+
+        static void readTransportStopsTree(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section,
+            const QStringList& stringTable, const AreaI& parentArea24, const AreaI* bbox24,
+            QList< std::shared_ptr<const OsmAnd::Model::TransportStop> >* resultOut,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::TransportStop>&)> visitor,
+            const IQueryController* const controller);
+        static void readTransportStop(const std::unique_ptr<ObfReader_P>& reader,
+            const QStringList& stringTable, const uint32_t stopOffset, const AreaI& area24, const AreaI* bbox24,
+            std::shared_ptr<Model::TransportStop>& stop);
+
+        static void readTransportRoute(const std::unique_ptr<ObfReader_P>& reader,
+            const QStringList& stringTable,
+            const std::shared_ptr<Model::TransportRoute>& route);
+        static void readTransportRouteStop(const std::unique_ptr<ObfReader_P>& reader,
+            const QStringList& stringTable, uint64_t& previousId, PointI& previousPosition24,
+            const std::shared_ptr<Model::TransportStop>& stop);
+
+        static void loadTransportStops(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section,
+            const AreaI* bbox31 = nullptr,
+            QList< std::shared_ptr<const OsmAnd::Model::TransportStop> >* resultOut = nullptr,
+            std::function<bool (const std::shared_ptr<const OsmAnd::Model::TransportStop>&)> visitor = nullptr,
+            const IQueryController* const controller = nullptr);
+
+        static void loadTransportRoutes(const std::unique_ptr<ObfReader_P>& reader, const std::shared_ptr<const ObfTransportSectionInfo>& section,
+            const QVector<uint32_t>& routesOffsets,
+            QList< std::shared_ptr<const OsmAnd::Model::TransportRoute> >* resultOut = nullptr,
+            const IQueryController* const controller = nullptr);
+
     friend class OsmAnd::ObfReader_P;
+    friend class OsmAnd::ObfTransportSectionReader;
     };
 
 } // namespace OsmAnd
@@ -21,7 +21,7 @@ void OsmAnd::ObfsCollection::watchDirectory( const QDir& dir, bool recursive /*=
     entry->dir = dir;
     entry->recursive = recursive;
     _d->_watchedCollection.push_back(std::shared_ptr<ObfsCollection_P::WatchEntry>(entry));
-    _d->_watchedCollectionChanged = true;
+    _d->_watchedCollectionChanged.store(1);
 }
 
 void OsmAnd::ObfsCollection::watchDirectory( const QString& dirPath, bool recursive /*= true*/ )
@@ -36,7 +36,7 @@ void OsmAnd::ObfsCollection::registerExplicitFile( const QFileInfo& fileInfo )
     auto entry = new ObfsCollection_P::ExplicitFileEntry();
     entry->fileInfo = fileInfo;
     _d->_watchedCollection.push_back(std::shared_ptr<ObfsCollection_P::WatchEntry>(entry));
-    _d->_watchedCollectionChanged = true;
+    _d->_watchedCollectionChanged.store(1);
 }
 
 void OsmAnd::ObfsCollection::registerExplicitFile( const QString& filePath )
@@ -44,26 +44,59 @@ void OsmAnd::ObfsCollection::registerExplicitFile( const QString& filePath )
     registerExplicitFile(QFileInfo(filePath));
 }
 
+void OsmAnd::ObfsCollection::setReadersPoolCapacity( const unsigned int capacity )
+{
+    QReadLocker scopedLock(&_d->_sourcesLock);
+
+    _d->_readersPoolCapacity.store(capacity);
+    for(auto itSource = _d->_sources.cbegin(); itSource != _d->_sources.cend(); ++itSource)
+        itSource.value()->setCapacity(capacity);
+}
+
+unsigned int OsmAnd::ObfsCollection::getReadersPoolCapacity() const
+{
+    return _d->_readersPoolCapacity.load();
+}
+
+void OsmAnd::ObfsCollection::setParallelReadingEnabled( const bool enabled )
+{
+    _d->_parallelReadingEnabled.store(enabled ? 1 : 0);
+}
+
+bool OsmAnd::ObfsCollection::isParallelReadingEnabled() const
+{
+    return _d->_parallelReadingEnabled.load() != 0;
+}
+
 std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ObfsCollection::obtainDataInterface() const
 {
-    QMutexLocker scopedLock_sourcesMutex(&_d->_sourcesMutex);
-    QMutexLocker scopedLock_watchedEntries(&_d->_watchedCollectionMutex);
+    const bool parallelReading = (_d->_parallelReadingEnabled.load() != 0);
+
+    QList< std::shared_ptr<ObfReader> > obfReaders;
 
-    // Refresh sources, if collection was not yet initialized
-    if(!_d->_sourcesRefreshedOnce || _d->_watchedCollectionChanged)
+    // In most cases sources are already up-to-date, so only shared lock is needed
     {
-        _d->refreshSources();
-        _d->_watchedCollectionChanged = false;
+        QReadLocker scopedLock(&_d->_sourcesLock);
+
+        if(_d->_sourcesRefreshedOnce && !_d->_watchedCollectionChanged.load())
+        {
+            for(auto itSource = _d->_sources.cbegin(); itSource != _d->_sources.cend(); ++itSource)
+                obfReaders.push_back(itSource.value()->obtainReader());
+
+            return std::shared_ptr<ObfDataInterface>(new ObfDataInterface(obfReaders, parallelReading));
+        }
     }
 
-    QList< std::shared_ptr<ObfReader> > obfReaders;
-    for(auto itSource = _d->_sources.cbegin(); itSource != _d->_sources.cend(); ++itSource)
+    // Otherwise refresh sources, if collection was not yet initialized or was changed
     {
-        const auto& obfFile = itSource.value();
+        QWriteLocker scopedLock(&_d->_sourcesLock);
+
+        if(!_d->_sourcesRefreshedOnce || _d->_watchedCollectionChanged.fetchAndStoreOrdered(0))
+            _d->refreshSources();
 
-        auto obfReader = new ObfReader(obfFile);
-        obfReaders.push_back(std::shared_ptr<ObfReader>(obfReader));
+        for(auto itSource = _d->_sources.cbegin(); itSource != _d->_sources.cend(); ++itSource)
+            obfReaders.push_back(itSource.value()->obtainReader());
     }
 
-    return std::shared_ptr<ObfDataInterface>(new ObfDataInterface(obfReaders));
+    return std::shared_ptr<ObfDataInterface>(new ObfDataInterface(obfReaders, parallelReading));
 }
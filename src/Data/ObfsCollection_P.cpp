@@ -1,14 +1,18 @@
 #include "ObfsCollection_P.h"
 #include "ObfsCollection.h"
 
+#include <QThread>
+
 #include "ObfFile.h"
+#include "ObfReader.h"
 #include "Utilities.h"
 
 OsmAnd::ObfsCollection_P::ObfsCollection_P( ObfsCollection* owner_ )
     : owner(owner_)
     , _watchedCollectionMutex(QMutex::Recursive)
-    , _watchedCollectionChanged(false)
-    , _sourcesMutex(QMutex::Recursive)
+    , _watchedCollectionChanged(0)
+    , _readersPoolCapacity(QThread::idealThreadCount())
+    , _parallelReadingEnabled(0)
     , _sourcesRefreshedOnce(false)
 {
 }
@@ -19,7 +23,7 @@ OsmAnd::ObfsCollection_P::~ObfsCollection_P()
 
 void OsmAnd::ObfsCollection_P::refreshSources()
 {
-    QMutexLocker scopedLock(&_sourcesMutex);
+    // Caller must hold _sourcesLock for writing
 
     // Find all files that are present in watched entries
     QFileInfoList obfs;
@@ -48,17 +52,16 @@ void OsmAnd::ObfsCollection_P::refreshSources()
 
     // For each file in registry, ...
     {
-        QMutableHashIterator< QString, std::shared_ptr<ObfFile> > itObfFileEntry(_sources);
+        QMutableHashIterator< QString, std::shared_ptr<ReadersPool> > itObfFileEntry(_sources);
         while(itObfFileEntry.hasNext())
         {
+            itObfFileEntry.next();
+
             // ... which does not exist, ...
             if(QFile::exists(itObfFileEntry.key()))
-            {
-                itObfFileEntry.next();
                 continue;
-            }
 
-            // ... remove entry
+            // ... remove entry (readers that are still in use will be destroyed on release)
             itObfFileEntry.remove();
         }
     }
@@ -74,12 +77,74 @@ void OsmAnd::ObfsCollection_P::refreshSources()
         // ... which is not yet present in registry, ...
         if(itObfFileEntry == _sources.cend())
         {
-            // ... create ObfFile
-            auto obfFile = new ObfFile(obfFilePath);
-            itObfFileEntry = _sources.insert(obfFilePath, std::shared_ptr<ObfFile>(obfFile));
+            // ... create ObfFile and pool of readers for it
+            std::shared_ptr<ObfFile> obfFile(new ObfFile(obfFilePath));
+            itObfFileEntry = _sources.insert(obfFilePath, std::shared_ptr<ReadersPool>(new ReadersPool(obfFile, _readersPoolCapacity.load())));
         }
     }
 
     // Mark that sources were refreshed at least once
     _sourcesRefreshedOnce = true;
 }
+
+OsmAnd::ObfsCollection_P::ReadersPool::ReadersPool( const std::shared_ptr<ObfFile>& obfFile_, const int capacity )
+    : _capacity(capacity)
+    , obfFile(obfFile_)
+{
+}
+
+OsmAnd::ObfsCollection_P::ReadersPool::~ReadersPool()
+{
+    QMutexLocker scopedLock(&_idleReadersMutex);
+
+    qDeleteAll(_idleReaders);
+    _idleReaders.clear();
+}
+
+void OsmAnd::ObfsCollection_P::ReadersPool::setCapacity( const int capacity )
+{
+    QMutexLocker scopedLock(&_idleReadersMutex);
+
+    _capacity = capacity;
+    while(_idleReaders.size() > capacity)
+        delete _idleReaders.takeLast();
+}
+
+std::shared_ptr<OsmAnd::ObfReader> OsmAnd::ObfsCollection_P::ReadersPool::obtainReader()
+{
+    ObfReader* reader = nullptr;
+    {
+        QMutexLocker scopedLock(&_idleReadersMutex);
+
+        if(!_idleReaders.isEmpty())
+            reader = _idleReaders.takeLast();
+    }
+    if(!reader)
+        reader = new ObfReader(obfFile);
+
+    // Reader returns to this pool when released, or is destroyed if pool is already gone
+    const std::weak_ptr<ReadersPool> weakThis(shared_from_this());
+    return std::shared_ptr<ObfReader>(reader, [weakThis](ObfReader* reader)
+    {
+        if(const auto pool = weakThis.lock())
+            pool->releaseReader(reader);
+        else
+            delete reader;
+    });
+}
+
+void OsmAnd::ObfsCollection_P::ReadersPool::releaseReader( ObfReader* reader )
+{
+    {
+        QMutexLocker scopedLock(&_idleReadersMutex);
+
+        if(_idleReaders.size() < _capacity)
+        {
+            _idleReaders.push_back(reader);
+            return;
+        }
+    }
+
+    // Pool is full, so this reader is not needed anymore
+    delete reader;
+}
@@ -28,7 +28,10 @@
 
 #include <QDir>
 #include <QHash>
+#include <QList>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QAtomicInt>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -36,6 +39,7 @@
 namespace OsmAnd {
 
     class ObfFile;
+    class ObfReader;
 
     class ObfsCollection;
     class ObfsCollection_P
@@ -82,10 +86,35 @@ namespace OsmAnd {
             QFileInfo fileInfo;
         };
         QList< std::shared_ptr<WatchEntry> > _watchedCollection;
-        bool _watchedCollectionChanged;
+        QAtomicInt _watchedCollectionChanged;
 
-        mutable QMutex _sourcesMutex;
-        QHash< QString, std::shared_ptr<ObfFile> > _sources;
+        // Readers of single OBF file that are not used at the moment. Reader is checked out
+        // exclusively and returned to the pool once the last reference to it is released.
+        class ReadersPool : public std::enable_shared_from_this<ReadersPool>
+        {
+            Q_DISABLE_COPY(ReadersPool)
+        private:
+            mutable QMutex _idleReadersMutex;
+            QList< ObfReader* > _idleReaders;
+            int _capacity;
+
+            void releaseReader(ObfReader* reader);
+        protected:
+        public:
+            ReadersPool(const std::shared_ptr<ObfFile>& obfFile, const int capacity);
+            ~ReadersPool();
+
+            const std::shared_ptr<ObfFile> obfFile;
+
+            void setCapacity(const int capacity);
+            std::shared_ptr<ObfReader> obtainReader();
+        };
+
+        QAtomicInt _readersPoolCapacity;
+        QAtomicInt _parallelReadingEnabled;
+
+        mutable QReadWriteLock _sourcesLock;
+        QHash< QString, std::shared_ptr<ReadersPool> > _sources;
         bool _sourcesRefreshedOnce;
         void refreshSources();
     public:
@@ -64,6 +64,11 @@ bool OsmAnd::MapStyle::resolveAttribute( const QString& name, std::shared_ptr<co
     return false;
 }
 
+bool OsmAnd::MapStyle::lookupStringId( const QString& value, uint32_t& outId ) const
+{
+    return _d->lookupStringId(value, outId);
+}
+
 void OsmAnd::MapStyle::dump( const QString& prefix /*= QString()*/ ) const
 {
     OsmAnd::LogPrintf(LogSeverityLevel::Debug, "%sPoint rules:", prefix.toStdString().c_str());
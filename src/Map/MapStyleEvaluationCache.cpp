@@ -0,0 +1,132 @@
+#include "MapStyleEvaluationCache.h"
+
+#include <cassert>
+
+#include "MapStyleEvaluator.h"
+#include "MapStyleEvaluator_P.h"
+#include "MapStyleValueDefinition.h"
+
+OsmAnd::MapStyleEvaluationCache::MapStyleEvaluationCache( const std::shared_ptr<const MapStyle>& style_ )
+    : _entriesLock(QReadWriteLock::NonRecursive)
+    , _generation(0)
+    , style(style_)
+{
+}
+
+OsmAnd::MapStyleEvaluationCache::~MapStyleEvaluationCache()
+{
+}
+
+OsmAnd::MapStyleEvaluationCache::Key OsmAnd::MapStyleEvaluationCache::composeKey( const MapStyleEvaluator& evaluator )
+{
+    const auto& defs = MapStyle::builtinValueDefinitions;
+    const auto& d = evaluator._d;
+
+    // Value that is not set is compared same as default one
+    const auto uintValue = [&d](const std::shared_ptr<const MapStyleValueDefinition>& definition) -> uint32_t
+    {
+        const auto pValue = d->findValue(definition.get());
+        return pValue ? pValue->asSimple.asUInt : 0;
+    };
+    const auto intValue = [&d](const std::shared_ptr<const MapStyleValueDefinition>& definition) -> int
+    {
+        const auto pValue = d->findValue(definition.get());
+        return pValue ? pValue->asSimple.asInt : 0;
+    };
+
+    Key key;
+    key.ruleset = evaluator.ruleset;
+    key.tagStringId = uintValue(defs.INPUT_TAG);
+    key.valueStringId = uintValue(defs.INPUT_VALUE);
+    key.minZoom = intValue(defs.INPUT_MINZOOM);
+    key.maxZoom = intValue(defs.INPUT_MAXZOOM);
+    key.layer = intValue(defs.INPUT_LAYER);
+    key.flags = 0;
+    if(intValue(defs.INPUT_AREA) == 1)
+        key.flags |= 1u << 0;
+    if(intValue(defs.INPUT_POINT) == 1)
+        key.flags |= 1u << 1;
+    if(intValue(defs.INPUT_CYCLE) == 1)
+        key.flags |= 1u << 2;
+    return key;
+}
+
+bool OsmAnd::MapStyleEvaluationCache::dependsOnMapObject( const MapStyleEvaluator& evaluator )
+{
+    const auto& defs = MapStyle::builtinValueDefinitions;
+    const auto& d = evaluator._d;
+
+    return
+        d->wasConsulted(defs.INPUT_ADDITIONAL.get()) ||
+        d->wasConsulted(defs.INPUT_NAME_TAG.get()) ||
+        d->wasConsulted(defs.INPUT_TEXT_LENGTH.get());
+}
+
+bool OsmAnd::MapStyleEvaluationCache::evaluate( MapStyleEvaluator& evaluator )
+{
+    assert(evaluator.style == style);
+    assert(!evaluator.singleRule);
+
+    const auto key = composeKey(evaluator);
+    {
+        QReadLocker scopedLocker(&_entriesLock);
+
+        const auto itEntry = _entries.constFind(key);
+        if(itEntry != _entries.cend())
+        {
+            if(!itEntry->isCacheable)
+            {
+                scopedLocker.unlock();
+                return evaluator.evaluate();
+            }
+
+            for(auto itOutput = itEntry->outputs.cbegin(); itOutput != itEntry->outputs.cend(); ++itOutput)
+                evaluator._d->obtainValue(itOutput->first) = itOutput->second;
+            return itEntry->result;
+        }
+    }
+
+    // Entry is stored only if cache was not cleared while evaluating
+    const auto generation = _generation.load();
+
+    const auto result = evaluator.evaluate();
+
+    Entry entry;
+    entry.isCacheable = !dependsOnMapObject(evaluator);
+    entry.result = result;
+    if(entry.isCacheable)
+    {
+        const auto& d = evaluator._d;
+        for(auto itSlot = d->_slots.cbegin(); itSlot != d->_slots.cend(); ++itSlot)
+        {
+            if(itSlot->stamp != d->_stamp || itSlot->definition->valueClass != MapStyleValueClass::Output)
+                continue;
+
+            entry.outputs.push_back(qMakePair(itSlot->definition, itSlot->value));
+        }
+    }
+
+    {
+        QWriteLocker scopedLocker(&_entriesLock);
+
+        if(generation == _generation.load())
+            _entries.insert(key, entry);
+    }
+
+    return result;
+}
+
+void OsmAnd::MapStyleEvaluationCache::clear()
+{
+    QWriteLocker scopedLocker(&_entriesLock);
+
+    _generation.fetchAndAddOrdered(1);
+    _entries.clear();
+}
+
+int OsmAnd::MapStyleEvaluationCache::getEntriesCount() const
+{
+    QReadLocker scopedLocker(&_entriesLock);
+
+    return _entries.size();
+}
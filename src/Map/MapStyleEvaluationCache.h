@@ -0,0 +1,121 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __MAP_STYLE_EVALUATION_CACHE_H_
+#define __MAP_STYLE_EVALUATION_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Map/MapStyle.h>
+#include <OsmAndCore/Map/MapStyleValue.h>
+
+namespace OsmAnd {
+
+    class MapStyleEvaluator;
+    class MapStyleValueDefinition;
+
+    /**
+    Decision table of map style, filled lazily by evaluations. Result of evaluation and all output values are
+    remembered for combination of ruleset, tag, value, zoom, layer and area/point/cycle flags. Evaluations that
+    compared any other per-object input (additional types, name tag or text length) are never cached and always
+    evaluated in full. Values of all other inputs (e.g. settings of environment) must be same for all evaluations.
+    Safe to use from multiple threads.
+    */
+    class MapStyleEvaluationCache
+    {
+    private:
+        Q_DISABLE_COPY(MapStyleEvaluationCache);
+    protected:
+        struct Key
+        {
+            MapStyleRulesetType ruleset;
+            uint32_t tagStringId;
+            uint32_t valueStringId;
+            int minZoom;
+            int maxZoom;
+            int layer;
+            uint32_t flags;
+
+            inline bool operator==(const Key& other) const
+            {
+                return
+                    ruleset == other.ruleset &&
+                    tagStringId == other.tagStringId &&
+                    valueStringId == other.valueStringId &&
+                    minZoom == other.minZoom &&
+                    maxZoom == other.maxZoom &&
+                    layer == other.layer &&
+                    flags == other.flags;
+            }
+        };
+        friend inline uint qHash(const Key& key, uint seed)
+        {
+            auto hash = seed ^ static_cast<uint>(key.ruleset);
+            hash = hash * 31 + key.tagStringId;
+            hash = hash * 31 + key.valueStringId;
+            hash = hash * 31 + static_cast<uint>(key.minZoom);
+            hash = hash * 31 + static_cast<uint>(key.maxZoom);
+            hash = hash * 31 + static_cast<uint>(key.layer);
+            hash = hash * 31 + key.flags;
+            return hash;
+        }
+
+        struct Entry
+        {
+            // False if evaluation depends on per-object inputs, so it has to be performed for each object
+            bool isCacheable;
+            bool result;
+            QVector< QPair<const MapStyleValueDefinition*, MapStyleValue> > outputs;
+        };
+
+        mutable QReadWriteLock _entriesLock;
+        QHash< Key, Entry > _entries;
+        QAtomicInt _generation;
+
+        static Key composeKey(const MapStyleEvaluator& evaluator);
+        static bool dependsOnMapObject(const MapStyleEvaluator& evaluator);
+    public:
+        MapStyleEvaluationCache(const std::shared_ptr<const MapStyle>& style);
+        virtual ~MapStyleEvaluationCache();
+
+        const std::shared_ptr<const MapStyle> style;
+
+        // Same as MapStyleEvaluator::evaluate(), but takes result and output values from cache if possible
+        bool evaluate(MapStyleEvaluator& evaluator);
+
+        // Drops all entries. Must be called when any value that is not a part of key is changed
+        void clear();
+
+        int getEntriesCount() const;
+    };
+
+} // namespace OsmAnd
+
+#endif // __MAP_STYLE_EVALUATION_CACHE_H_
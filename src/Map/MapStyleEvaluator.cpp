@@ -16,9 +16,10 @@ OsmAnd::MapStyleEvaluator::MapStyleEvaluator( const std::shared_ptr<const MapSty
     : _d(new MapStyleEvaluator_P(this))
     , style(style_)
     , displayDensityFactor(displayDensityFactor_)
-    , mapObject(mapObject_)
+    , mapObject(_d->_mapObject)
     , ruleset(ruleset_)
 {
+    _d->_mapObject = mapObject_;
 }
 
 OsmAnd::MapStyleEvaluator::MapStyleEvaluator( const std::shared_ptr<const MapStyle>& style_, const float displayDensityFactor_, const std::shared_ptr<const MapStyleRule>& singleRule_ )
@@ -26,7 +27,7 @@ OsmAnd::MapStyleEvaluator::MapStyleEvaluator( const std::shared_ptr<const MapSty
     , style(style_)
     , displayDensityFactor(displayDensityFactor_)
     , singleRule(singleRule_)
-    , mapObject()
+    , mapObject(_d->_mapObject)
     , ruleset(MapStyleRulesetType::Invalid)
 {
 }
@@ -37,105 +38,123 @@ OsmAnd::MapStyleEvaluator::~MapStyleEvaluator()
 
 void OsmAnd::MapStyleEvaluator::setValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const MapStyleValue value )
 {
-    _d->_values[ref] = value;
+    _d->obtainValue(ref.get()) = value;
 }
 
 void OsmAnd::MapStyleEvaluator::setBooleanValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const bool value )
 {
-    _d->_values[ref].isComplex = false;
-    _d->_values[ref].asSimple.asInt = value ? 1 : 0;
+    auto& slotValue = _d->obtainValue(ref.get());
+    slotValue.isComplex = false;
+    slotValue.asSimple.asInt = value ? 1 : 0;
 }
 
 void OsmAnd::MapStyleEvaluator::setIntegerValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const int value )
 {
-    _d->_values[ref].isComplex = false;
-    _d->_values[ref].asSimple.asInt = value;
+    auto& slotValue = _d->obtainValue(ref.get());
+    slotValue.isComplex = false;
+    slotValue.asSimple.asInt = value;
 }
 
 void OsmAnd::MapStyleEvaluator::setIntegerValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const unsigned int value )
 {
-    _d->_values[ref].isComplex = false;
-    _d->_values[ref].asSimple.asUInt = value;
+    auto& slotValue = _d->obtainValue(ref.get());
+    slotValue.isComplex = false;
+    slotValue.asSimple.asUInt = value;
 }
 
 void OsmAnd::MapStyleEvaluator::setFloatValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const float value )
 {
-    _d->_values[ref].isComplex = false;
-    _d->_values[ref].asSimple.asFloat = value;
+    auto& slotValue = _d->obtainValue(ref.get());
+    slotValue.isComplex = false;
+    slotValue.asSimple.asFloat = value;
 }
 
 void OsmAnd::MapStyleEvaluator::setStringValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const QString& value )
 {
-    _d->_values[ref].isComplex = false;
-    bool ok = style->_d->lookupStringId(value, _d->_values[ref].asSimple.asUInt);
+    auto& slotValue = _d->obtainValue(ref.get());
+    slotValue.isComplex = false;
+    bool ok = style->_d->lookupStringId(value, slotValue.asSimple.asUInt);
     if(!ok)
-        _d->_values[ref].asSimple.asUInt = std::numeric_limits<uint32_t>::max();
+        slotValue.asSimple.asUInt = std::numeric_limits<uint32_t>::max();
+}
+
+void OsmAnd::MapStyleEvaluator::setStringIdValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, const uint32_t stringId )
+{
+    auto& slotValue = _d->obtainValue(ref.get());
+    slotValue.isComplex = false;
+    slotValue.asSimple.asUInt = stringId;
 }
 
 bool OsmAnd::MapStyleEvaluator::getBooleanValue( const std::shared_ptr<const MapStyleValueDefinition>& ref, bool& value ) const
 {
-    const auto& itValue = _d->_values.constFind(ref);
-    if(itValue == _d->_values.cend())
+    const auto pValue = _d->findValue(ref.get());
+    if(!pValue)
         return false;
 
-    assert(!itValue->isComplex);
-    value = itValue->asSimple.asInt == 1;
+    assert(!pValue->isComplex);
+    value = pValue->asSimple.asInt == 1;
     return true;
 }
 
 bool OsmAnd::MapStyleEvaluator::getIntegerValue( const std::shared_ptr<const OsmAnd::MapStyleValueDefinition>& ref, int& value ) const
 {
-    const auto& itValue = _d->_values.constFind(ref);
-    if(itValue == _d->_values.cend())
+    const auto pValue = _d->findValue(ref.get());
+    if(!pValue)
         return false;
 
-    if(itValue->isComplex)
-        value = (*itValue).asComplex.asInt.evaluate(displayDensityFactor);
+    if(pValue->isComplex)
+        value = pValue->asComplex.asInt.evaluate(displayDensityFactor);
     else
-        value = (*itValue).asSimple.asInt;
+        value = pValue->asSimple.asInt;
     return true;
 }
 
 bool OsmAnd::MapStyleEvaluator::getIntegerValue( const std::shared_ptr<const OsmAnd::MapStyleValueDefinition>& ref, unsigned int& value ) const
 {
-    const auto& itValue = _d->_values.constFind(ref);
-    if(itValue == _d->_values.cend())
+    const auto pValue = _d->findValue(ref.get());
+    if(!pValue)
         return false;
 
-    if(itValue->isComplex)
-        value = (*itValue).asComplex.asUInt.evaluate(displayDensityFactor);
+    if(pValue->isComplex)
+        value = pValue->asComplex.asUInt.evaluate(displayDensityFactor);
     else
-        value = (*itValue).asSimple.asUInt;
+        value = pValue->asSimple.asUInt;
     return true;
 }
 
 bool OsmAnd::MapStyleEvaluator::getFloatValue( const std::shared_ptr<const OsmAnd::MapStyleValueDefinition>& ref, float& value ) const
 {
-    const auto& itValue = _d->_values.constFind(ref);
-    if(itValue == _d->_values.cend())
+    const auto pValue = _d->findValue(ref.get());
+    if(!pValue)
         return false;
 
-    if(itValue->isComplex)
-        value = (*itValue).asComplex.asFloat.evaluate(displayDensityFactor);
+    if(pValue->isComplex)
+        value = pValue->asComplex.asFloat.evaluate(displayDensityFactor);
     else
-        value = (*itValue).asSimple.asFloat;
+        value = pValue->asSimple.asFloat;
     return true;
 }
 
 bool OsmAnd::MapStyleEvaluator::getStringValue( const std::shared_ptr<const OsmAnd::MapStyleValueDefinition>& ref, QString& value ) const
 {
-    const auto& itValue = _d->_values.constFind(ref);
-    if(itValue == _d->_values.cend())
+    const auto pValue = _d->findValue(ref.get());
+    if(!pValue)
         return false;
 
-    assert(!itValue->isComplex);
-    value = style->_d->lookupStringValue((*itValue).asSimple.asUInt);
+    assert(!pValue->isComplex);
+    value = style->_d->lookupStringValue(pValue->asSimple.asUInt);
     return true;
 }
 
 void OsmAnd::MapStyleEvaluator::clearValue( const std::shared_ptr<const OsmAnd::MapStyleValueDefinition>& ref )
 {
-    _d->_values.remove(ref);
+    _d->clearValue(ref.get());
+}
+
+void OsmAnd::MapStyleEvaluator::reset( const std::shared_ptr<const Model::MapObject>& mapObject_ /*= std::shared_ptr<const Model::MapObject>()*/ )
+{
+    _d->clearValues();
+    _d->_mapObject = mapObject_;
 }
 
 bool OsmAnd::MapStyleEvaluator::evaluate( bool fillOutput /*= true*/, bool evaluateChildren /*=true*/ )
@@ -150,10 +169,12 @@ bool OsmAnd::MapStyleEvaluator::evaluate( bool fillOutput /*= true*/, bool evalu
     }
     else
     {
-        assert(!_d->_values[MapStyle::builtinValueDefinitions.INPUT_TAG].isComplex);
-        const auto tagKey = _d->_values[MapStyle::builtinValueDefinitions.INPUT_TAG].asSimple.asUInt;
-        assert(!_d->_values[MapStyle::builtinValueDefinitions.INPUT_VALUE].isComplex);
-        const auto valueKey = _d->_values[MapStyle::builtinValueDefinitions.INPUT_VALUE].asSimple.asUInt;
+        const auto& tagValue = _d->obtainValue(MapStyle::builtinValueDefinitions.INPUT_TAG.get());
+        assert(!tagValue.isComplex);
+        const auto tagKey = tagValue.asSimple.asUInt;
+        const auto& valueValue = _d->obtainValue(MapStyle::builtinValueDefinitions.INPUT_VALUE.get());
+        assert(!valueValue.isComplex);
+        const auto valueKey = valueValue.asSimple.asUInt;
 
         auto evaluationResult = evaluate(tagKey, valueKey, fillOutput, evaluateChildren);
         if(evaluationResult)
@@ -173,8 +194,8 @@ bool OsmAnd::MapStyleEvaluator::evaluate( bool fillOutput /*= true*/, bool evalu
 
 bool OsmAnd::MapStyleEvaluator::evaluate( uint32_t tagKey, uint32_t valueKey, bool fillOutput, bool evaluateChildren )
 {
-    _d->_values[MapStyle::builtinValueDefinitions.INPUT_TAG].asSimple.asUInt = tagKey;
-    _d->_values[MapStyle::builtinValueDefinitions.INPUT_VALUE].asSimple.asUInt = valueKey;
+    _d->obtainValue(MapStyle::builtinValueDefinitions.INPUT_TAG.get()).asSimple.asUInt = tagKey;
+    _d->obtainValue(MapStyle::builtinValueDefinitions.INPUT_VALUE.get()).asSimple.asUInt = valueKey;
 
     const auto& rules = style->_d->obtainRules(ruleset);
     uint64_t ruleId = MapStyle_P::encodeRuleId(tagKey, valueKey);
@@ -188,7 +209,7 @@ bool OsmAnd::MapStyleEvaluator::evaluate( uint32_t tagKey, uint32_t valueKey, bo
 bool OsmAnd::MapStyleEvaluator::evaluate( const std::shared_ptr<const MapStyleRule>& rule, bool fillOutput, bool evaluateChildren )
 {
     auto itValueDef = rule->_d->_valueDefinitionsRefs.cbegin();
-    auto itValueData = rule->_d->_values.cbegin();
+    auto itValueData = rule->_d->_orderedValues.cbegin();
     for(; itValueDef != rule->_d->_valueDefinitionsRefs.cend(); ++itValueDef, ++itValueData)
     {
         const auto& valueDef = *itValueDef;
@@ -197,7 +218,7 @@ bool OsmAnd::MapStyleEvaluator::evaluate( const std::shared_ptr<const MapStyleRu
             continue;
 
         const auto& valueData = *itValueData;
-        const auto& stackValue = _d->_values[valueDef];
+        const auto& stackValue = _d->consultValue(valueDef.get());
 
         bool evaluationResult = false;
         if(valueDef == MapStyle::builtinValueDefinitions.INPUT_MINZOOM)
@@ -253,7 +274,7 @@ bool OsmAnd::MapStyleEvaluator::evaluate( const std::shared_ptr<const MapStyleRu
     if (fillOutput || evaluateChildren)
     {
         auto itValueDef = rule->_d->_valueDefinitionsRefs.cbegin();
-        auto itValueData = rule->_d->_values.cbegin();
+        auto itValueData = rule->_d->_orderedValues.cbegin();
         for(; itValueDef != rule->_d->_valueDefinitionsRefs.cend(); ++itValueDef, ++itValueData)
         {
             const auto& valueDef = *itValueDef;
@@ -262,7 +283,7 @@ bool OsmAnd::MapStyleEvaluator::evaluate( const std::shared_ptr<const MapStyleRu
             if(valueDef->valueClass != MapStyleValueClass::Output)
                 continue;
 
-            _d->_values[valueDef] = valueData;
+            _d->obtainValue(valueDef.get()) = valueData;
         }
     }
 
@@ -286,10 +307,13 @@ bool OsmAnd::MapStyleEvaluator::evaluate( const std::shared_ptr<const MapStyleRu
 
 void OsmAnd::MapStyleEvaluator::dump( bool input /*= true*/, bool output /*= true*/, const QString& prefix /*= QString()*/ ) const
 {
-    for(auto itValue = _d->_values.cbegin(); itValue != _d->_values.cend(); ++itValue)
+    for(auto itSlot = _d->_slots.cbegin(); itSlot != _d->_slots.cend(); ++itSlot)
     {
-        auto pValueDef = itValue.key();
-        const auto& value = itValue.value();
+        if(itSlot->stamp != _d->_stamp)
+            continue;
+
+        auto pValueDef = itSlot->definition;
+        const auto& value = itSlot->value;
 
         if((pValueDef->valueClass == MapStyleValueClass::Input && input) || (pValueDef->valueClass == MapStyleValueClass::Output && output))
         {
@@ -1,13 +1,94 @@
 #include "MapStyleEvaluator_P.h"
 #include "MapStyleEvaluator.h"
 
+#include <cassert>
+#include <limits>
+
 #include "MapStyleValue.h"
+#include "MapStyleValueDefinition.h"
 
 OsmAnd::MapStyleEvaluator_P::MapStyleEvaluator_P( MapStyleEvaluator* owner_ )
     : owner(owner_)
+    , _slots(MapStyleValueDefinition::_nextId.load())
+    , _stamp(1)
 {
 }
 
 OsmAnd::MapStyleEvaluator_P::~MapStyleEvaluator_P()
 {
 }
+
+OsmAnd::MapStyleEvaluator_P::ValueSlot::ValueSlot()
+    : stamp(0)
+    , consultedStamp(0)
+    , definition(nullptr)
+{
+}
+
+OsmAnd::MapStyleValue& OsmAnd::MapStyleEvaluator_P::obtainValue( const MapStyleValueDefinition* const definition )
+{
+    assert(definition->id >= 0);
+
+    // Definitions created after this evaluator (by styles loaded later) do not fit into slots
+    if(definition->id >= _slots.size())
+        _slots.resize(definition->id + 1);
+
+    auto& slot = _slots[definition->id];
+    if(slot.stamp != _stamp)
+    {
+        slot.stamp = _stamp;
+        slot.definition = definition;
+        slot.value = MapStyleValue();
+    }
+    return slot.value;
+}
+
+const OsmAnd::MapStyleValue* OsmAnd::MapStyleEvaluator_P::findValue( const MapStyleValueDefinition* const definition ) const
+{
+    if(definition->id >= _slots.size())
+        return nullptr;
+
+    const auto& slot = _slots[definition->id];
+    if(slot.stamp != _stamp)
+        return nullptr;
+    return &slot.value;
+}
+
+const OsmAnd::MapStyleValue& OsmAnd::MapStyleEvaluator_P::consultValue( const MapStyleValueDefinition* const definition )
+{
+    const auto& value = obtainValue(definition);
+    _slots[definition->id].consultedStamp = _stamp;
+    return value;
+}
+
+bool OsmAnd::MapStyleEvaluator_P::wasConsulted( const MapStyleValueDefinition* const definition ) const
+{
+    if(definition->id >= _slots.size())
+        return false;
+
+    return _slots[definition->id].consultedStamp == _stamp;
+}
+
+void OsmAnd::MapStyleEvaluator_P::clearValue( const MapStyleValueDefinition* const definition )
+{
+    if(definition->id >= _slots.size())
+        return;
+
+    _slots[definition->id].stamp = 0;
+}
+
+void OsmAnd::MapStyleEvaluator_P::clearValues()
+{
+    _stamp++;
+
+    // On wrap-around, stale stamps could match again, so invalidate them explicitly
+    if(_stamp == std::numeric_limits<uint32_t>::max())
+    {
+        for(auto itSlot = _slots.begin(); itSlot != _slots.end(); ++itSlot)
+        {
+            itSlot->stamp = 0;
+            itSlot->consultedStamp = 0;
+        }
+        _stamp = 1;
+    }
+}
@@ -26,16 +26,21 @@
 #include <cstdint>
 #include <memory>
 
-#include <QMap>
+#include <QVector>
 
 #include <OsmAndCore.h>
 #include <MapStyle.h>
+#include <MapStyleValue.h>
 
 namespace OsmAnd {
 
+    namespace Model {
+        class MapObject;
+    } // namespace Model
     class MapStyleValueDefinition;
-    struct MapStyleValue;
     
+    class MapStyleEvaluationCache;
+
     class MapStyleEvaluator;
     class MapStyleEvaluator_P
     {
@@ -45,11 +50,36 @@ namespace OsmAnd {
 
         MapStyleEvaluator* const owner;
 
-        QMap< std::shared_ptr<const MapStyleValueDefinition>, MapStyleValue > _values;
+        std::shared_ptr<const Model::MapObject> _mapObject;
+
+        // Values are stored in slots indexed by MapStyleValueDefinition::id. Slot holds a value only if its stamp
+        // matches current one, so all values are dropped by incrementing current stamp instead of clearing slots
+        struct ValueSlot
+        {
+            ValueSlot();
+
+            uint32_t stamp;
+            // Equals current stamp if input value was compared to value of any rule since last reset
+            uint32_t consultedStamp;
+            const MapStyleValueDefinition* definition;
+            MapStyleValue value;
+        };
+        QVector< ValueSlot > _slots;
+        uint32_t _stamp;
+
+        // Returns value of definition, which is default-initialized if it was not set
+        MapStyleValue& obtainValue(const MapStyleValueDefinition* const definition);
+        const MapStyleValue* findValue(const MapStyleValueDefinition* const definition) const;
+        // Same as obtainValue(), but also marks value as one that evaluation result depends on
+        const MapStyleValue& consultValue(const MapStyleValueDefinition* const definition);
+        bool wasConsulted(const MapStyleValueDefinition* const definition) const;
+        void clearValue(const MapStyleValueDefinition* const definition);
+        void clearValues();
     public:
         ~MapStyleEvaluator_P();
 
     friend class OsmAnd::MapStyleEvaluator;
+    friend class OsmAnd::MapStyleEvaluationCache;
     };
 
 } // namespace OsmAnd
@@ -16,6 +16,7 @@ OsmAnd::MapStyleRule::MapStyleRule(MapStyle* owner_, const QHash< QString, QStri
 {
     _d->_valueDefinitionsRefs.reserve(attributes.size());
     _d->_values.reserve(attributes.size());
+    _d->_orderedValues.reserve(attributes.size());
     
     for(auto itAttribute = attributes.cbegin(); itAttribute != attributes.cend(); ++itAttribute)
     {
@@ -99,6 +100,7 @@ OsmAnd::MapStyleRule::MapStyleRule(MapStyle* owner_, const QHash< QString, QStri
         }
         
         _d->_values.insert(key, parsedValue);
+        _d->_orderedValues.push_back(parsedValue);
     }
 }
 
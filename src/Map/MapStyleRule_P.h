@@ -29,6 +29,7 @@
 #include <QString>
 #include <QHash>
 #include <QList>
+#include <QVector>
 
 #include <OsmAndCore.h>
 #include <MapStyleValue.h>
@@ -49,6 +50,8 @@ namespace OsmAnd {
 
         QList< std::shared_ptr<const MapStyleValueDefinition> > _valueDefinitionsRefs;
         QHash< QString, MapStyleValue > _values;
+        // Same values as in _values, but in order of _valueDefinitionsRefs
+        QVector< MapStyleValue > _orderedValues;
         QList< std::shared_ptr<MapStyleRule> > _ifElseChildren;
         QList< std::shared_ptr<MapStyleRule> > _ifChildren;
     public:
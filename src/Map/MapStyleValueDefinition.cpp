@@ -1,10 +1,13 @@
 #include "MapStyleValueDefinition.h"
 
+QAtomicInt OsmAnd::MapStyleValueDefinition::_nextId(0);
+
 OsmAnd::MapStyleValueDefinition::MapStyleValueDefinition( const MapStyleValueClass valueClass_, const MapStyleValueDataType dataType_, const QString& name_, const bool isComplex_ )
     : valueClass(valueClass_)
     , dataType(dataType_)
     , name(name_)
     , isComplex(isComplex_)
+    , id(_nextId.fetchAndAddOrdered(1))
 {
 }
 
@@ -27,60 +27,89 @@ OsmAnd::OfflineMapDataProvider_P::~OfflineMapDataProvider_P()
 }
 
 void OsmAnd::OfflineMapDataProvider_P::obtainTile( const TileId tileId, const ZoomLevel zoom, std::shared_ptr<const OfflineMapDataTile>& outTile )
+{
+    TileReadout readout;
+    if(!readTile(tileId, zoom, readout, outTile))
+        return;
+
+    prepareTile(readout, outTile);
+}
+
+bool OsmAnd::OfflineMapDataProvider_P::readTile( const TileId tileId, const ZoomLevel zoom, TileReadout& outReadout, std::shared_ptr<const OfflineMapDataTile>& outLoadedTile )
 {
     // Check if there is a weak reference to that tile, and if that reference is still valid, use that
-    std::shared_ptr<TileEntry> tileEntry;
+    auto& tileEntry = outReadout.entry;
     _tileReferences.obtainOrAllocateTileEntry(tileEntry, tileId, zoom, [](const TilesCollection<TileEntry>& collection, const TileId tileId, const ZoomLevel zoom) -> TileEntry*
         {
             return new TileEntry(collection, tileId, zoom);
         });
 
     // Only if tile entry has "Unknown" state proceed to "Requesting" state
+    auto released = false;
     {
         QWriteLocker scopedLock(&tileEntry->stateLock);
 
-        assert(tileEntry->state != TileState::Released);
-        if(tileEntry->state == TileState::Undefined)
+        if(tileEntry->state == TileState::Released)
+            released = true;
+        else if(tileEntry->state == TileState::Undefined)
         {
             // Since tile is in undefined state, it will be processed right now,
             // so just change state to 'Loading' and continue execution
             tileEntry->state = TileState::Loading;
         }
-        else if(tileEntry->state == TileState::Loading)
+        else
         {
             // If tile is in 'Loading' state, wait until it will become 'Loaded'
-            while(tileEntry->state != TileState::Loading)
+            while(tileEntry->state == TileState::Loading)
                 tileEntry->_loadedCondition.wait(&tileEntry->stateLock);
-        }
-        else if(tileEntry->state == TileState::Loaded)
-        {
-            // If tile is already 'Loaded', just verify it's reference and return that
-            assert(!tileEntry->_tile.expired());
-            outTile = tileEntry->_tile.lock();
-            return;
+
+            // If tile is already 'Loaded', use it. But it may have been released just now,
+            // and then it's loaded once again
+            if(tileEntry->state == TileState::Released)
+                released = true;
+            else if(const auto loadedTile = tileEntry->_tile.lock())
+            {
+                outLoadedTile = loadedTile;
+                return false;
+            }
+            else
+                tileEntry->state = TileState::Loading;
         }
     }
 
+    // Entry that was released while this request was in progress is not going to be loaded
+    if(released)
+    {
+        tileEntry.reset();
+        return false;
+    }
+
+    // Read map objects of area covered by tile
+    outReadout.tileId = tileId;
+    outReadout.zoom = zoom;
+    readMapObjects(Utilities::tileBoundingBox31(tileId, zoom), zoom, outReadout.mapObjects, outReadout.foundation);
+
+    return true;
+}
+
+void OsmAnd::OfflineMapDataProvider_P::readMapObjects( const AreaI& area31, const ZoomLevel zoom, QList< std::shared_ptr<const Model::MapObject> >& outMapObjects, MapFoundationType& outFoundation )
+{
     // Obtain OBF data interface
     const auto& dataInterface = owner->obfsCollection->obtainDataInterface();
 
-    // Get bounding box that covers this tile
-    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
-
     // Perform read-out
     QList< std::shared_ptr<const Model::MapObject> > duplicateMapObjects;
-    QList< std::shared_ptr<const Model::MapObject> > mapObjects;
-    MapFoundationType tileFoundation;
+    auto& mapObjects = outMapObjects;
 #if defined(_DEBUG) || defined(DEBUG)
     float dataFilter = 0.0f;
     const auto dataRead_Begin = std::chrono::high_resolution_clock::now();
 #endif
     auto& dataCache = _dataCache[zoom];
-    dataInterface->obtainMapObjects(&mapObjects, &tileFoundation, tileBBox31, zoom, nullptr,
+    dataInterface->obtainMapObjects(&mapObjects, &outFoundation, area31, zoom, nullptr,
 #if defined(_DEBUG) || defined(DEBUG)
-        [&dataCache, &duplicateMapObjects, tileBBox31, &dataFilter](const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t id) -> bool
+        [&dataCache, &duplicateMapObjects, area31, &dataFilter](const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t id) -> bool
 #else
-        [&dataCache, &duplicateMapObjects, tileBBox31](const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t id) -> bool
+        [&dataCache, &duplicateMapObjects, area31](const std::shared_ptr<const ObfMapSectionInfo>& section, const uint64_t id) -> bool
 #endif
         {
 #if defined(_DEBUG) || defined(DEBUG)
@@ -99,7 +128,7 @@ void OsmAnd::OfflineMapDataProvider_P::obtainTile( const TileId tileId, const Zo
                     if(const auto& mapObject = mapObjectWeakRef.lock())
                     {
                         // Not all duplicates should be used, since some may lay outside bbox
-                        if(mapObject->intersects(tileBBox31))
+                        if(mapObject->intersects(area31))
                             duplicateMapObjects.push_back(mapObject);
 
 #if defined(_DEBUG) || defined(DEBUG)
@@ -150,30 +179,45 @@ void OsmAnd::OfflineMapDataProvider_P::obtainTile( const TileId tileId, const Zo
 #if defined(_DEBUG) || defined(DEBUG)
     const auto dataIdsProcess_End = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<float> dataIdsProcess_Elapsed = dataIdsProcess_End - dataIdsProcess_Begin;
-
-    const auto dataProcess_Begin = std::chrono::high_resolution_clock::now();
+    LogPrintf(LogSeverityLevel::Info,
+        "%d map objects (%d unique, %d shared) in %d,%d-%d,%d@%d: read %fs (filter-by-id %fs), process-ids %fs",
+        mapObjects.size() + duplicateMapObjects.size(), mapObjects.size(), duplicateMapObjects.size(),
+        area31.left, area31.top, area31.right, area31.bottom, zoom,
+        dataRead_Elapsed.count(), dataFilter, dataIdsProcess_Elapsed.count());
 #endif
 
-    // Prepare data for the tile
+    // Map objects read before are shared with this read-out
     mapObjects << duplicateMapObjects;
+}
+
+void OsmAnd::OfflineMapDataProvider_P::prepareTile( const TileReadout& readout, std::shared_ptr<const OfflineMapDataTile>& outTile )
+{
+    const auto& tileEntry = readout.entry;
+    const auto tileId = readout.tileId;
+    const auto zoom = readout.zoom;
+
+    // Get bounding box that covers this tile
+    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+
+#if defined(_DEBUG) || defined(DEBUG)
+    const auto dataProcess_Begin = std::chrono::high_resolution_clock::now();
+#endif
 
     // Allocate and prepare rasterizer context
     bool nothingToRasterize = false;
     std::shared_ptr<RasterizerContext> rasterizerContext(new RasterizerContext(owner->rasterizerEnvironment));
-    Rasterizer::prepareContext(*rasterizerContext, tileBBox31, zoom, tileFoundation, mapObjects, &nothingToRasterize);
+    Rasterizer::prepareContext(*rasterizerContext, tileBBox31, zoom, readout.foundation, readout.mapObjects, &nothingToRasterize);
 
 #if defined(_DEBUG) || defined(DEBUG)
     const auto dataProcess_End = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<float> dataProcess_Elapsed = dataProcess_End - dataProcess_Begin;
     LogPrintf(LogSeverityLevel::Info,
-        "%d map objects (%d unique, %d shared) in %dx%d@%d: read %fs (filter-by-id %fs), process-ids %fs, process-content %fs",
-        mapObjects.size() + duplicateMapObjects.size(), mapObjects.size(), duplicateMapObjects.size(),
-        tileId.x, tileId.y, zoom,
-        dataRead_Elapsed.count(), dataFilter, dataIdsProcess_Elapsed.count(), dataProcess_Elapsed.count());
+        "%d map objects in %dx%d@%d: process-content %fs",
+        readout.mapObjects.size(), tileId.x, tileId.y, zoom, dataProcess_Elapsed.count());
 #endif
 
     // Create tile
-    const auto newTile = new OfflineMapDataTile(tileId, zoom, tileFoundation, mapObjects, rasterizerContext, nothingToRasterize);
+    const auto newTile = new OfflineMapDataTile(tileId, zoom, readout.foundation, readout.mapObjects, rasterizerContext, nothingToRasterize);
     newTile->_d->_link = _link;
     newTile->_d->_refEntry = tileEntry;
 
@@ -184,7 +228,13 @@ void OsmAnd::OfflineMapDataProvider_P::obtainTile( const TileId tileId, const Zo
     {
         QWriteLocker scopedLock(&tileEntry->stateLock);
 
-        assert(tileEntry->state == TileState::Loading);
+        // Entry may have been released while tile was prepared, then tile is only given to caller
+        if(tileEntry->state == TileState::Released)
+        {
+            tileEntry->_loadedCondition.wakeAll();
+            return;
+        }
+
         tileEntry->state = TileState::Loaded;
         tileEntry->_tile = outTile;
 
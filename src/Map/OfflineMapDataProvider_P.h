@@ -27,6 +27,7 @@
 #include <memory>
 
 #include <QHash>
+#include <QList>
 #include <QAtomicInt>
 #include <QMutex>
 #include <QReadWriteLock>
@@ -34,6 +35,7 @@
 
 #include <OsmAndCore.h>
 #include <CommonTypes.h>
+#include <MapTypes.h>
 #include <TilesCollection.h>
 
 namespace OsmAnd {
@@ -43,6 +45,7 @@ namespace OsmAnd {
     }
     class OfflineMapDataTile;
     class OfflineMapDataTile_P;
+    class OfflineMapRasterTileProvider_Software_P;
 
     class OfflineMapDataProvider;
     class OfflineMapDataProvider_P
@@ -97,6 +100,22 @@ namespace OsmAnd {
             OfflineMapDataProvider_P& provider;
         };
         const std::shared_ptr<Link> _link;
+
+        // Map objects read for a tile, from which tile is created by prepareTile()
+        struct TileReadout
+        {
+            TileId tileId;
+            ZoomLevel zoom;
+            std::shared_ptr<TileEntry> entry;
+            QList< std::shared_ptr<const Model::MapObject> > mapObjects;
+            MapFoundationType foundation;
+        };
+        // Returns false if tile was already loaded, and then it's returned in outLoadedTile, or if tile entry was released,
+        // and then outLoadedTile is left empty
+        bool readTile(const TileId tileId, const ZoomLevel zoom, TileReadout& outReadout, std::shared_ptr<const OfflineMapDataTile>& outLoadedTile);
+        void prepareTile(const TileReadout& readout, std::shared_ptr<const OfflineMapDataTile>& outTile);
+        // Reads map objects of area, sharing ones that were already read for other tiles or areas
+        void readMapObjects(const AreaI& area31, const ZoomLevel zoom, QList< std::shared_ptr<const Model::MapObject> >& outMapObjects, MapFoundationType& outFoundation);
     public:
         ~OfflineMapDataProvider_P();
 
@@ -104,6 +123,7 @@ namespace OsmAnd {
 
     friend class OsmAnd::OfflineMapDataProvider;
     friend class OsmAnd::OfflineMapDataTile_P;
+    friend class OsmAnd::OfflineMapRasterTileProvider_Software_P;
     };
 
 } // namespace OsmAnd
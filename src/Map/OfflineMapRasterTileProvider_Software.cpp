@@ -1,6 +1,8 @@
 #include "OfflineMapRasterTileProvider_Software.h"
 #include "OfflineMapRasterTileProvider_Software_P.h"
 
+#include <QThread>
+
 OsmAnd::OfflineMapRasterTileProvider_Software::OfflineMapRasterTileProvider_Software( const std::shared_ptr<OfflineMapDataProvider>& dataProvider_, const uint32_t outputTileSize /*= 256*/, const float density /*= 1.0f*/)
     : _d(new OfflineMapRasterTileProvider_Software_P(this, outputTileSize, density))
     , dataProvider(dataProvider_)
@@ -26,3 +28,23 @@ bool OsmAnd::OfflineMapRasterTileProvider_Software::obtainTile(const TileId tile
 {
     return _d->obtainTile(tileId, zoom, outTile);
 }
+
+bool OsmAnd::OfflineMapRasterTileProvider_Software::obtainMetatile(const TileId tileId, const ZoomLevel zoom, const unsigned int metatileSize, QHash< TileId, std::shared_ptr<const MapTile> >& outTiles)
+{
+    return _d->obtainMetatile(tileId, zoom, metatileSize, outTiles);
+}
+
+void OsmAnd::OfflineMapRasterTileProvider_Software::rasterizeTiles(const QList< std::pair<TileId, ZoomLevel> >& tiles, const TileRasterizedCallback callback,
+    const PipelineConfiguration& configuration /*= PipelineConfiguration()*/)
+{
+    _d->rasterizeTiles(tiles, callback, configuration);
+}
+
+OsmAnd::OfflineMapRasterTileProvider_Software::PipelineConfiguration::PipelineConfiguration()
+    : readoutWorkers(qMax(1, QThread::idealThreadCount() / 2))
+    , preparationWorkers(qMax(1, QThread::idealThreadCount()))
+    , drawingWorkers(qMax(1, QThread::idealThreadCount()))
+    , queueCapacity(qMax(1, QThread::idealThreadCount()) * 2)
+    , metatileSize(1)
+{
+}
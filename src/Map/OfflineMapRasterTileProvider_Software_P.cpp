@@ -14,6 +14,7 @@
 #include <SkImageEncoder.h>
 
 #include "OfflineMapDataProvider.h"
+#include "OfflineMapDataProvider_P.h"
 #include "OfflineMapDataTile.h"
 #include "ObfsCollection.h"
 #include "ObfDataInterface.h"
@@ -37,13 +38,22 @@ OsmAnd::OfflineMapRasterTileProvider_Software_P::~OfflineMapRasterTileProvider_S
 
 bool OsmAnd::OfflineMapRasterTileProvider_Software_P::obtainTile(const TileId tileId, const ZoomLevel zoom, std::shared_ptr<const MapTile>& outTile)
 {
-    // Get bounding box that covers this tile
-    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
-
     // Obtain offline map data tile
     std::shared_ptr< const OfflineMapDataTile > dataTile;
     owner->dataProvider->obtainTile(tileId, zoom, dataTile);
 
+    return rasterizeTile(tileId, zoom, dataTile, outTile);
+}
+
+bool OsmAnd::OfflineMapRasterTileProvider_Software_P::rasterizeTile(const TileId tileId, const ZoomLevel zoom, const std::shared_ptr<const OfflineMapDataTile>& dataTile, std::shared_ptr<const MapTile>& outTile)
+{
+    // Data tile is not available if its entry was released while it was requested
+    if(!dataTile)
+    {
+        outTile.reset();
+        return false;
+    }
+
 #if defined(_DEBUG) || defined(DEBUG)
     const auto dataRasterization_Begin = std::chrono::high_resolution_clock::now();
 #endif
@@ -102,6 +112,283 @@ bool OsmAnd::OfflineMapRasterTileProvider_Software_P::obtainTile(const TileId ti
     return true;
 }
 
+void OsmAnd::OfflineMapRasterTileProvider_Software_P::rasterizeTiles(const QList< std::pair<TileId, ZoomLevel> >& tiles, const OfflineMapRasterTileProvider_Software::TileRasterizedCallback callback,
+    const OfflineMapRasterTileProvider_Software::PipelineConfiguration& configuration)
+{
+    if(tiles.isEmpty())
+        return;
+
+    auto& dataProvider = *owner->dataProvider->_d;
+
+    // Tile (or metatile) travels through all stages inside single item, so that queues hold only pointers
+    struct PipelineItem
+    {
+        TileId tileId;
+        ZoomLevel zoom;
+
+        OfflineMapDataProvider_P::TileReadout readout;
+        std::shared_ptr<const OfflineMapDataTile> dataTile;
+
+        std::shared_ptr<Metatile> metatile;
+        QList<TileId> requestedTiles;
+    };
+
+    // In metatile mode, all requested tiles of same metatile are served by single item, that takes place of first of them
+    const auto metatileSize = qMax(1u, configuration.metatileSize);
+    QList< std::shared_ptr<PipelineItem> > items;
+    std::array< QHash< TileId, std::shared_ptr<PipelineItem> >, ZoomLevelsCount > metatileItems;
+    for(auto itTile = tiles.cbegin(); itTile != tiles.cend(); ++itTile)
+    {
+        const auto& tileId = itTile->first;
+        const auto zoom = itTile->second;
+
+        if(metatileSize == 1)
+        {
+            const std::shared_ptr<PipelineItem> item(new PipelineItem());
+            item->tileId = tileId;
+            item->zoom = zoom;
+            items.push_back(item);
+            continue;
+        }
+
+        TileId metatileId;
+        metatileId.x = tileId.x - tileId.x % static_cast<int32_t>(metatileSize);
+        metatileId.y = tileId.y - tileId.y % static_cast<int32_t>(metatileSize);
+        auto& item = metatileItems[zoom][metatileId];
+        if(!item)
+        {
+            item.reset(new PipelineItem());
+            item->tileId = metatileId;
+            item->zoom = zoom;
+            item->metatile.reset(new Metatile());
+            items.push_back(item);
+        }
+        item->requestedTiles.push_back(tileId);
+    }
+
+    typedef Concurrent::BoundedQueue< std::shared_ptr<PipelineItem> > PipelineQueue;
+    PipelineQueue readoutQueue(qMax(1u, configuration.queueCapacity));
+    PipelineQueue preparedQueue(qMax(1u, configuration.queueCapacity));
+
+    const auto readoutWorkers = qMax(1u, configuration.readoutWorkers);
+    const auto preparationWorkers = qMax(1u, configuration.preparationWorkers);
+    const auto drawingWorkers = qMax(1u, configuration.drawingWorkers);
+
+    // Last worker of each stage closes queue to next stage
+    QAtomicInt nextItemIndex(0);
+    QAtomicInt activeReadoutWorkers(readoutWorkers);
+    QAtomicInt activePreparationWorkers(preparationWorkers);
+
+    const auto readoutProcedure =
+        [this, &items, metatileSize, &dataProvider, &nextItemIndex, &activeReadoutWorkers, &readoutQueue]()
+        {
+            for(;;)
+            {
+                const auto itemIndex = nextItemIndex.fetchAndAddOrdered(1);
+                if(itemIndex >= items.size())
+                    break;
+                const auto& item = items.at(itemIndex);
+
+                // Tile that is loaded already by data provider skips readout and preparation
+                if(!item->metatile)
+                    dataProvider.readTile(item->tileId, item->zoom, item->readout, item->dataTile);
+                else
+                    readMetatile(item->tileId, item->zoom, metatileSize, *item->metatile);
+
+                if(!readoutQueue.enqueue(item))
+                    break;
+            }
+
+            if(activeReadoutWorkers.fetchAndAddOrdered(-1) == 1)
+                readoutQueue.close();
+        };
+    const auto preparationProcedure =
+        [this, &dataProvider, &activePreparationWorkers, &readoutQueue, &preparedQueue]()
+        {
+            std::shared_ptr<PipelineItem> item;
+            while(readoutQueue.dequeue(item))
+            {
+                if(item->metatile)
+                {
+                    prepareMetatile(*item->metatile);
+                }
+                else if(!item->dataTile && item->readout.entry)
+                {
+                    dataProvider.prepareTile(item->readout, item->dataTile);
+                    item->readout = OfflineMapDataProvider_P::TileReadout();
+                }
+
+                if(!preparedQueue.enqueue(item))
+                    break;
+            }
+
+            if(activePreparationWorkers.fetchAndAddOrdered(-1) == 1)
+                preparedQueue.close();
+        };
+    const auto drawingProcedure =
+        [this, callback, &preparedQueue]()
+        {
+            std::shared_ptr<PipelineItem> item;
+            while(preparedQueue.dequeue(item))
+            {
+                if(item->metatile)
+                {
+                    QHash< TileId, std::shared_ptr<const MapTile> > metatileTiles;
+                    const auto success = rasterizeMetatile(*item->metatile, metatileTiles);
+                    item->metatile.reset();
+
+                    if(callback)
+                    {
+                        for(auto itTileId = item->requestedTiles.cbegin(); itTileId != item->requestedTiles.cend(); ++itTileId)
+                            callback(*itTileId, item->zoom, success, metatileTiles.value(*itTileId));
+                    }
+                    continue;
+                }
+
+                std::shared_ptr<const MapTile> tile;
+                const auto success = rasterizeTile(item->tileId, item->zoom, item->dataTile, tile);
+                item->dataTile.reset();
+
+                if(callback)
+                    callback(item->tileId, item->zoom, success, tile);
+            }
+        };
+
+    QList< std::shared_ptr<Concurrent::Thread> > workers;
+    for(auto workerIdx = 0u; workerIdx < readoutWorkers; workerIdx++)
+        workers.push_back(std::shared_ptr<Concurrent::Thread>(new Concurrent::Thread(readoutProcedure)));
+    for(auto workerIdx = 0u; workerIdx < preparationWorkers; workerIdx++)
+        workers.push_back(std::shared_ptr<Concurrent::Thread>(new Concurrent::Thread(preparationProcedure)));
+    for(auto workerIdx = 0u; workerIdx < drawingWorkers; workerIdx++)
+        workers.push_back(std::shared_ptr<Concurrent::Thread>(new Concurrent::Thread(drawingProcedure)));
+
+    for(auto itWorker = workers.cbegin(); itWorker != workers.cend(); ++itWorker)
+        (*itWorker)->start();
+    for(auto itWorker = workers.cbegin(); itWorker != workers.cend(); ++itWorker)
+        (*itWorker)->wait();
+}
+
+bool OsmAnd::OfflineMapRasterTileProvider_Software_P::obtainMetatile(const TileId tileId, const ZoomLevel zoom, const unsigned int metatileSize, QHash< TileId, std::shared_ptr<const MapTile> >& outTiles)
+{
+    Metatile metatile;
+    readMetatile(tileId, zoom, qMax(1u, metatileSize), metatile);
+    prepareMetatile(metatile);
+    return rasterizeMetatile(metatile, outTiles);
+}
+
+void OsmAnd::OfflineMapRasterTileProvider_Software_P::readMetatile(const TileId tileId, const ZoomLevel zoom, const unsigned int metatileSize, Metatile& outMetatile)
+{
+    // Metatile is clipped by edges of the map
+    const auto tilesCount = 1u << zoom;
+    outMetatile.tileId = tileId;
+    outMetatile.zoom = zoom;
+    outMetatile.columns = qMin(metatileSize, tilesCount - static_cast<unsigned int>(tileId.x));
+    outMetatile.rows = qMin(metatileSize, tilesCount - static_cast<unsigned int>(tileId.y));
+
+    TileId lastTileId;
+    lastTileId.x = tileId.x + outMetatile.columns - 1;
+    lastTileId.y = tileId.y + outMetatile.rows - 1;
+    const auto firstTileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+    const auto lastTileBBox31 = Utilities::tileBoundingBox31(lastTileId, zoom);
+    outMetatile.area31 = AreaI(firstTileBBox31.top, firstTileBBox31.left, lastTileBBox31.bottom, lastTileBBox31.right);
+
+    owner->dataProvider->_d->readMapObjects(outMetatile.area31, zoom, outMetatile.mapObjects, outMetatile.foundation);
+}
+
+void OsmAnd::OfflineMapRasterTileProvider_Software_P::prepareMetatile(Metatile& metatile)
+{
+#if defined(_DEBUG) || defined(DEBUG)
+    const auto dataProcess_Begin = std::chrono::high_resolution_clock::now();
+#endif
+
+    metatile.nothingToRasterize = false;
+    metatile.rasterizerContext.reset(new RasterizerContext(owner->dataProvider->rasterizerEnvironment));
+    Rasterizer::prepareContext(*metatile.rasterizerContext, metatile.area31, metatile.zoom, metatile.foundation, metatile.mapObjects, &metatile.nothingToRasterize);
+
+#if defined(_DEBUG) || defined(DEBUG)
+    const auto dataProcess_End = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<float> dataProcess_Elapsed = dataProcess_End - dataProcess_Begin;
+    LogPrintf(LogSeverityLevel::Info,
+        "%d map objects in %dx%d metatile %dx%d@%d: process-content %fs",
+        metatile.mapObjects.size(), metatile.columns, metatile.rows, metatile.tileId.x, metatile.tileId.y, metatile.zoom, dataProcess_Elapsed.count());
+#endif
+}
+
+bool OsmAnd::OfflineMapRasterTileProvider_Software_P::rasterizeMetatile(const Metatile& metatile, QHash< TileId, std::shared_ptr<const MapTile> >& outTiles)
+{
+    // If there is no data to rasterize, tell that none of tiles is available
+    if(metatile.nothingToRasterize)
+    {
+        for(auto row = 0u; row < metatile.rows; row++)
+        {
+            for(auto column = 0u; column < metatile.columns; column++)
+            {
+                TileId tileId;
+                tileId.x = metatile.tileId.x + column;
+                tileId.y = metatile.tileId.y + row;
+                outTiles.insert(tileId, std::shared_ptr<const MapTile>());
+            }
+        }
+        return true;
+    }
+
+#if defined(_DEBUG) || defined(DEBUG)
+    const auto dataRasterization_Begin = std::chrono::high_resolution_clock::now();
+#endif
+
+    // Allocate rasterization target that covers entire metatile
+    SkBitmap rasterizationSurface;
+    rasterizationSurface.setConfig(SkBitmap::kARGB_8888_Config, metatile.columns * outputTileSize, metatile.rows * outputTileSize);
+    if(!rasterizationSurface.allocPixels())
+    {
+        LogPrintf(LogSeverityLevel::Error, "Failed to allocate buffer for ARGB8888 rasterization surface %dx%d",
+            metatile.columns * outputTileSize, metatile.rows * outputTileSize);
+        return false;
+    }
+    SkBitmapDevice rasterizationTarget(rasterizationSurface);
+
+    // Create rasterization canvas
+    SkCanvas canvas(&rasterizationTarget);
+
+    // Perform actual rendering of all tiles at once
+    Rasterizer rasterizer(metatile.rasterizerContext);
+    rasterizer.rasterizeMap(canvas);
+
+    // Cut tiles out of metatile. Each tile gets a copy of its pixels, so that entire metatile is not kept in memory
+    for(auto row = 0u; row < metatile.rows; row++)
+    {
+        for(auto column = 0u; column < metatile.columns; column++)
+        {
+            TileId tileId;
+            tileId.x = metatile.tileId.x + column;
+            tileId.y = metatile.tileId.y + row;
+
+            SkBitmap tileSubset;
+            const auto tileSubsetArea = SkIRect::MakeXYWH(column * outputTileSize, row * outputTileSize, outputTileSize, outputTileSize);
+            auto tileSurface = new SkBitmap();
+            if(!rasterizationSurface.extractSubset(&tileSubset, tileSubsetArea) || !tileSubset.copyTo(tileSurface, SkBitmap::kARGB_8888_Config))
+            {
+                delete tileSurface;
+
+                LogPrintf(LogSeverityLevel::Error, "Failed to cut tile %dx%d@%d out of metatile", tileId.x, tileId.y, metatile.zoom);
+                return false;
+            }
+
+            outTiles.insert(tileId, std::shared_ptr<const MapTile>(new Tile(tileSurface, nullptr)));
+        }
+    }
+
+#if defined(_DEBUG) || defined(DEBUG)
+    const auto dataRasterization_End = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<float> dataRasterization_Elapsed = dataRasterization_End - dataRasterization_Begin;
+    LogPrintf(LogSeverityLevel::Info,
+        "%dx%d metatile %dx%d@%d: rasterization %fs",
+        metatile.columns, metatile.rows, metatile.tileId.x, metatile.tileId.y, metatile.zoom, dataRasterization_Elapsed.count());
+#endif
+
+    return true;
+}
+
 OsmAnd::OfflineMapRasterTileProvider_Software_P::Tile::Tile( SkBitmap* bitmap, const std::shared_ptr<const OfflineMapDataTile>& dataTile_ )
     : MapBitmapTile(bitmap, MapBitmapTile::AlphaChannelData::NotPresent)
     , _dataTile(dataTile_)
@@ -27,18 +27,27 @@
 #include <functional>
 #include <array>
 
+#include <QHash>
+#include <QList>
+
 #include <OsmAndCore.h>
 #include <CommonTypes.h>
+#include <MapTypes.h>
 #include <Concurrent.h>
 #include <TilesCollection.h>
 #include <IMapBitmapTileProvider.h>
 #include <IRetainedMapTile.h>
+#include <OfflineMapRasterTileProvider_Software.h>
 
 class SkBitmap;
 
 namespace OsmAnd {
 
+    namespace Model {
+        class MapObject;
+    }
     class OfflineMapDataTile;
+    class RasterizerContext;
 
     class OfflineMapRasterTileProvider_Software;
     class OfflineMapRasterTileProvider_Software_P
@@ -94,6 +103,31 @@ namespace OsmAnd {
         TilesCollection<TileEntry> _tiles;
 
         bool obtainTile(const TileId tileId, const ZoomLevel zoom, std::shared_ptr<const MapTile>& outTile);
+        bool rasterizeTile(const TileId tileId, const ZoomLevel zoom, const std::shared_ptr<const OfflineMapDataTile>& dataTile, std::shared_ptr<const MapTile>& outTile);
+
+        // Group of adjacent tiles, which is read, prepared and drawn at once
+        struct Metatile
+        {
+            // Top-left tile
+            TileId tileId;
+            ZoomLevel zoom;
+            unsigned int columns;
+            unsigned int rows;
+            AreaI area31;
+
+            MapFoundationType foundation;
+            QList< std::shared_ptr<const Model::MapObject> > mapObjects;
+
+            std::shared_ptr<RasterizerContext> rasterizerContext;
+            bool nothingToRasterize;
+        };
+        bool obtainMetatile(const TileId tileId, const ZoomLevel zoom, const unsigned int metatileSize, QHash< TileId, std::shared_ptr<const MapTile> >& outTiles);
+        void readMetatile(const TileId tileId, const ZoomLevel zoom, const unsigned int metatileSize, Metatile& outMetatile);
+        void prepareMetatile(Metatile& metatile);
+        bool rasterizeMetatile(const Metatile& metatile, QHash< TileId, std::shared_ptr<const MapTile> >& outTiles);
+
+        void rasterizeTiles(const QList< std::pair<TileId, ZoomLevel> >& tiles, const OfflineMapRasterTileProvider_Software::TileRasterizedCallback callback,
+            const OfflineMapRasterTileProvider_Software::PipelineConfiguration& configuration);
     public:
         virtual ~OfflineMapRasterTileProvider_Software_P();
 
@@ -25,6 +25,8 @@ bool OsmAnd::OfflineMapSymbolProvider_P::obtainSymbols( const TileId tileId, con
     // Obtain offline map data tile
     std::shared_ptr< const OfflineMapDataTile > dataTile;
     owner->dataProvider->obtainTile(tileId, zoom, dataTile);
+    if(!dataTile)
+        return false;
 
     // If tile has nothing to be rasterized, mark that data is not available for it
     if(dataTile->nothingToRasterize || dataTile->rasterizerContext->getSymbolsCount() == 0)
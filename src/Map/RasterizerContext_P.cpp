@@ -13,6 +13,13 @@ OsmAnd::RasterizerContext_P::~RasterizerContext_P()
     clear();
 }
 
+OsmAnd::RasterizerContext_P::TypeStringIds::TypeStringIds()
+    : isResolved(false)
+    , tagStringId(0)
+    , valueStringId(0)
+{
+}
+
 void OsmAnd::RasterizerContext_P::clear()
 {
     _combinedMapObjects.clear();
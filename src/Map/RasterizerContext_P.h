@@ -28,6 +28,7 @@
 
 #include <QList>
 #include <QVector>
+#include <QHash>
 
 #include <SkColor.h>
 
@@ -67,6 +68,19 @@ namespace OsmAnd {
 
         QVector< Rasterizer_P::PrimitiveSymbol > _symbols;
 
+        // Style string ids of tag and value per OBF rule id, kept for each map section by its runtime-generated id.
+        // Objects generated by rasterizer itself use key 0. Since style of environment never changes, these are
+        // kept between rasterizations
+        struct TypeStringIds
+        {
+            TypeStringIds();
+
+            bool isResolved;
+            uint32_t tagStringId;
+            uint32_t valueStringId;
+        };
+        QHash< int, QVector< TypeStringIds > > _typesStringIds;
+
         void clear();
     public:
         virtual ~RasterizerContext_P();
@@ -9,6 +9,7 @@
 #include <SkStream.h>
 
 #include "MapStyleEvaluator.h"
+#include "MapStyleEvaluationCache.h"
 #include "MapStyleValue.h"
 #include "EmbeddedResources.h"
 #include "Utilities.h"
@@ -66,6 +67,8 @@ void OsmAnd::RasterizerEnvironment_P::initializeOneWayPaint( SkPaint& paint )
 
 void OsmAnd::RasterizerEnvironment_P::initialize()
 {
+    _evaluationCache.reset(new MapStyleEvaluationCache(owner->style));
+
     _mapPaint.setAntiAlias(true);
 
     _textPaint.setAntiAlias(true);
@@ -197,6 +200,9 @@ void OsmAnd::RasterizerEnvironment_P::setSettings( const QMap< std::shared_ptr<c
     QMutexLocker scopedLocker(&_settingsChangeMutex);
 
     _settings = newSettings;
+
+    // Cached evaluations were made with previous settings
+    _evaluationCache->clear();
 }
 
 void OsmAnd::RasterizerEnvironment_P::applyTo( MapStyleEvaluator& evaluator ) const
@@ -209,6 +215,11 @@ void OsmAnd::RasterizerEnvironment_P::applyTo( MapStyleEvaluator& evaluator ) co
     }
 }
 
+bool OsmAnd::RasterizerEnvironment_P::evaluate( MapStyleEvaluator& evaluator ) const
+{
+    return _evaluationCache->evaluate(evaluator);
+}
+
 bool OsmAnd::RasterizerEnvironment_P::obtainBitmapShader( const QString& name, SkBitmapProcShader* &outShader ) const
 {
     QMutexLocker scopedLock(&_bitmapShadersMutex);
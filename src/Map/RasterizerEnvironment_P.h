@@ -47,6 +47,7 @@ namespace OsmAnd {
 
     class MapStyle;
     class MapStyleEvaluator;
+    class MapStyleEvaluationCache;
     class Rasterizer;
 
     class RasterizerEnvironment;
@@ -91,6 +92,9 @@ namespace OsmAnd {
 
         mutable QMutex _iconsMutex;
         mutable QHash< QString, std::shared_ptr<const SkBitmap> > _icons;
+
+        // Style evaluations shared by all rasterizations that use this environment
+        std::unique_ptr<MapStyleEvaluationCache> _evaluationCache;
     public:
         virtual ~RasterizerEnvironment_P();
 
@@ -121,6 +125,7 @@ namespace OsmAnd {
         void setSettings(const QMap< std::shared_ptr<const MapStyleValueDefinition>, MapStyleValue >& newSettings);
 
         void applyTo(MapStyleEvaluator& evaluator) const;
+        bool evaluate(MapStyleEvaluator& evaluator) const;
 
         bool obtainBitmapShader(const QString& name, SkBitmapProcShader* &outShader) const;
         bool obtainPathEffect(const QString& encodedPathEffect, SkPathEffect* &outPathEffect) const;
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cinttypes>
+#include <limits>
 #include <set>
 
 #include "RasterizerEnvironment.h"
@@ -13,6 +14,7 @@
 #include "MapStyleEvaluator.h"
 #include "MapTypes.h"
 #include "MapObject.h"
+#include "MapObjectsBlock.h"
 #include "ObfMapSectionInfo.h"
 #include "IQueryController.h"
 #include "Utilities.h"
@@ -33,6 +35,8 @@ OsmAnd::Rasterizer_P::Rasterizer_P(Rasterizer* const owner_, const RasterizerEnv
     : owner(owner_)
     , env(env_)
     , context(context_)
+    , _polygonEvaluator(env_.owner->style, env_.owner->displayDensityFactor, MapStyleRulesetType::Polygon)
+    , _polylineEvaluator(env_.owner->style, env_.owner->displayDensityFactor, MapStyleRulesetType::Polyline)
 {
 }
 
@@ -135,23 +139,28 @@ void OsmAnd::Rasterizer_P::prepareContext(
     {
         assert(foundation != MapFoundationType::Undefined);
 
-        std::shared_ptr<Model::MapObject> bgMapObject(new Model::MapObject(nullptr, nullptr));
-        bgMapObject->_isArea = true;
-        bgMapObject->_points31.push_back(PointI(area31.left, area31.top));
-        bgMapObject->_points31.push_back(PointI(area31.right, area31.top));
-        bgMapObject->_points31.push_back(PointI(area31.right, area31.bottom));
-        bgMapObject->_points31.push_back(PointI(area31.left, area31.bottom));
-        bgMapObject->_points31.push_back(bgMapObject->_points31.first());
+        QVector< PointI > points31;
+        points31.reserve(5);
+        points31.push_back(PointI(area31.left, area31.top));
+        points31.push_back(PointI(area31.right, area31.top));
+        points31.push_back(PointI(area31.right, area31.bottom));
+        points31.push_back(PointI(area31.left, area31.bottom));
+        points31.push_back(points31.first());
+
+        auto typeRuleId = GeneratedRules::NaturalCoastlineBroken;
+        auto isArea = false;
         if(foundation == MapFoundationType::FullWater)
-            bgMapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline")));
+        {
+            typeRuleId = GeneratedRules::NaturalCoastline;
+            isArea = true;
+        }
         else if(foundation == MapFoundationType::FullLand || foundation == MapFoundationType::Mixed)
-            bgMapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("land")));
-        else
         {
-            bgMapObject->_isArea = false;
-            bgMapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline_broken")));
+            typeRuleId = GeneratedRules::NaturalLand;
+            isArea = true;
         }
-        bgMapObject->_extraTypes.push_back(TagValue(QString::fromLatin1("layer"), QString::fromLatin1("-5")));
+        const auto bgMapObject = createGeneratedMapObject(typeRuleId, isArea, points31,
+            std::numeric_limits<uint64_t>::max(), QList< QVector< PointI > >(), QVector< uint32_t >(1, GeneratedRules::LayerBasemap));
 
         assert(bgMapObject->isClosedFigure());
         context._triangulatedCoastlineObjects.push_back(bgMapObject);
@@ -194,35 +203,67 @@ void OsmAnd::Rasterizer_P::prepareContext(
     }
 }
 
+void OsmAnd::Rasterizer_P::resolveTypeStringIds(
+    const RasterizerEnvironment_P& env, RasterizerContext_P& context,
+    const std::shared_ptr<const Model::MapObject>& mapObject, const uint32_t typeIndex,
+    uint32_t& outTagStringId, uint32_t& outValueStringId)
+{
+    const auto sectionKey = mapObject->section ? mapObject->section->runtimeGeneratedId : 0;
+    const auto ruleId = mapObject->_types.ruleId(typeIndex);
+
+    auto& typesStringIds = context._typesStringIds[sectionKey];
+    if(ruleId >= static_cast<uint32_t>(typesStringIds.size()))
+        typesStringIds.resize(ruleId + 1);
+
+    auto& typeStringIds = typesStringIds[ruleId];
+    if(!typeStringIds.isResolved)
+    {
+        // Strings that are not known to style can not match any rule
+        const auto& type = mapObject->_types[typeIndex];
+        if(!env.owner->style->lookupStringId(type.tag, typeStringIds.tagStringId))
+            typeStringIds.tagStringId = std::numeric_limits<uint32_t>::max();
+        if(!env.owner->style->lookupStringId(type.value, typeStringIds.valueStringId))
+            typeStringIds.valueStringId = std::numeric_limits<uint32_t>::max();
+        typeStringIds.isResolved = true;
+    }
+
+    outTagStringId = typeStringIds.tagStringId;
+    outValueStringId = typeStringIds.valueStringId;
+}
+
 void OsmAnd::Rasterizer_P::obtainPrimitives(
     const RasterizerEnvironment_P& env, RasterizerContext_P& context,
     const IQueryController* const controller)
 {
     QVector< Primitive > unfilteredLines;
+    MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Order);
+    MapStyleEvaluator polygonEvaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Polygon);
+    MapStyleEvaluator polylineEvaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Polyline);
     for(auto itMapObject = context._combinedMapObjects.cbegin(); itMapObject != context._combinedMapObjects.cend(); ++itMapObject)
     {
         if(controller && controller->isAborted())
             return;
 
         auto mapObject = *itMapObject;
+        const auto layer = mapObject->getSimpleLayerValue();
 
-        uint32_t typeIdx = 0;
-        for(auto itType = mapObject->types.cbegin(); itType != mapObject->types.cend(); ++itType, typeIdx++)
+        for(uint32_t typeIdx = 0, typesCount = mapObject->types.size(); typeIdx < typesCount; typeIdx++)
         {
-            const auto& type = *itType;
-            auto layer = mapObject->getSimpleLayerValue();
+            uint32_t tagStringId;
+            uint32_t valueStringId;
+            resolveTypeStringIds(env, context, mapObject, typeIdx, tagStringId, valueStringId);
 
-            MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Order, mapObject);
+            evaluator.reset(mapObject);
             env.applyTo(evaluator);
-            evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_TAG, type.tag);
-            evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, type.value);
+            evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_TAG, tagStringId);
+            evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, valueStringId);
             evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MINZOOM, context._zoom);
             evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MAXZOOM, context._zoom);
             evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_LAYER, layer);
             evaluator.setBooleanValue(MapStyle::builtinValueDefinitions.INPUT_AREA, mapObject->isArea);
             evaluator.setBooleanValue(MapStyle::builtinValueDefinitions.INPUT_POINT, mapObject->points31.size() == 1);
             evaluator.setBooleanValue(MapStyle::builtinValueDefinitions.INPUT_CYCLE, mapObject->isClosedFigure());
-            if(!evaluator.evaluate())
+            if(!env.evaluate(evaluator))
                 continue;
 
             int objectType;
@@ -237,6 +278,8 @@ void OsmAnd::Rasterizer_P::obtainPrimitives(
             primitive.objectType = static_cast<PrimitiveType>(objectType);
             primitive.zOrder = zOrder;
             primitive.typeIndex = typeIdx;
+            primitive.tagStringId = tagStringId;
+            primitive.valueStringId = valueStringId;
 
             if(objectType == PrimitiveType::Polygon)
             {
@@ -265,16 +308,15 @@ void OsmAnd::Rasterizer_P::obtainPrimitives(
                 }
 
                 // Evaluate style for this primitive to check if it passes
-                MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Polygon, primitive.mapObject);
-                initializePolygonEvaluator(env, context, primitive, evaluator);
-                if(!evaluator.evaluate())
+                initializePolygonEvaluator(env, context, primitive, polygonEvaluator);
+                if(!env.evaluate(polygonEvaluator))
                     continue;
 
                 // Accept this primitive
                 auto pointPrimitive = primitive;
                 pointPrimitive.objectType = PrimitiveType::Point;
 
-                auto polygonArea31 = Utilities::polygonArea(mapObject->points31);
+                auto polygonArea31 = Utilities::polygonArea(mapObject->points31.constData(), mapObject->points31.size());
                 if(polygonArea31 > PolygonAreaCutoffLowerThreshold)
                 {
                     primitive.zOrder += 1.0 / polygonArea31;
@@ -295,9 +337,8 @@ void OsmAnd::Rasterizer_P::obtainPrimitives(
                 }
 
                 // Evaluate style for this primitive to check if it passes
-                MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Polyline, primitive.mapObject);
-                initializePolylineEvaluator(env, context, primitive, evaluator);
-                if(!evaluator.evaluate())
+                initializePolylineEvaluator(env, context, primitive, polylineEvaluator);
+                if(!env.evaluate(polylineEvaluator))
                     continue;
 
                 // Accept this primitive
@@ -545,7 +586,7 @@ void OsmAnd::Rasterizer_P::obtainPointSymbol(
     // Point can have icon associated with it
     MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Point, primitive.mapObject);
     initializePointEvaluator(env, context, primitive, evaluator);
-    if(evaluator.evaluate())
+    if(env.evaluate(evaluator))
     {
         bool ok;
 
@@ -573,10 +614,9 @@ void OsmAnd::Rasterizer_P::obtainPrimitiveTexts(
     const RasterizerEnvironment_P& env, RasterizerContext_P& context,
     const Primitive& primitive, PrimitiveSymbol& primitiveSymbol )
 {
-    const auto& type = primitive.mapObject->_types[primitive.typeIndex];
-
     bool ok;
     auto firstTextProcessed = false;
+    MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Text);
     for(auto itName = primitive.mapObject->names.cbegin(); itName != primitive.mapObject->names.cend(); ++itName)
     {
         const auto& name = itName.value();
@@ -588,10 +628,10 @@ void OsmAnd::Rasterizer_P::obtainPrimitiveTexts(
         //TODO: reshape name with icu4c
 
         // Evaluate style to obtain text parameters
-        MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Text, primitive.mapObject);
+        evaluator.reset(primitive.mapObject);
         env.applyTo(evaluator);
-        evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_TAG, type.tag);
-        evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, type.value);
+        evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_TAG, primitive.tagStringId);
+        evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, primitive.valueStringId);
         evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MINZOOM, context._zoom);
         evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MAXZOOM, context._zoom);
         evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_TEXT_LENGTH, name.length());
@@ -599,7 +639,7 @@ void OsmAnd::Rasterizer_P::obtainPrimitiveTexts(
         if(nameTag == QLatin1String("name"))
             nameTag.clear();
         evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_NAME_TAG, nameTag);
-        if(!evaluator.evaluate())
+        if(!env.evaluate(evaluator))
             continue;
 
         // Skip text that doesn't have valid size
@@ -771,8 +811,9 @@ void OsmAnd::Rasterizer_P::rasterizeMap(
         const auto targetSize = canvas.getDeviceSize();
         _destinationArea = AreaI(0, 0, targetSize.height(), targetSize.width());
     }
-    _31toPixelDivisor.x = context._tileDivisor / static_cast<double>(_destinationArea.width());
-    _31toPixelDivisor.y = context._tileDivisor / static_cast<double>(_destinationArea.height());
+    // Area of context may span several tiles (e.g. metatile), so scale is derived from the area itself
+    _31toPixelDivisor.x = (static_cast<double>(context._area31.width()) + 1.0) / static_cast<double>(_destinationArea.width());
+    _31toPixelDivisor.y = (static_cast<double>(context._area31.height()) + 1.0) / static_cast<double>(_destinationArea.height());
 
     // Rasterize layers of map:
     rasterizeMapPrimitives(destinationArea, canvas, context._polygons, Polygons, controller);
@@ -787,11 +828,10 @@ void OsmAnd::Rasterizer_P::initializePolygonEvaluator(
 {
     assert(primitive.objectType == PrimitiveType::Polygon);
 
-    const auto& type = primitive.mapObject->_types[primitive.typeIndex];
-
+    evaluator.reset(primitive.mapObject);
     env.applyTo(evaluator);
-    evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_TAG, type.tag);
-    evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, type.value);
+    evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_TAG, primitive.tagStringId);
+    evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, primitive.valueStringId);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MINZOOM, context._zoom);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MAXZOOM, context._zoom);
 }
@@ -802,11 +842,10 @@ void OsmAnd::Rasterizer_P::initializePolylineEvaluator(
 {
     assert(primitive.objectType == PrimitiveType::Polyline);
 
-    const auto& type = primitive.mapObject->_types[primitive.typeIndex];
-
+    evaluator.reset(primitive.mapObject);
     env.applyTo(evaluator);
-    evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_TAG, type.tag);
-    evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, type.value);
+    evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_TAG, primitive.tagStringId);
+    evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, primitive.valueStringId);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MINZOOM, context._zoom);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MAXZOOM, context._zoom);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_LAYER, primitive.mapObject->getSimpleLayerValue());
@@ -818,11 +857,10 @@ void OsmAnd::Rasterizer_P::initializePointEvaluator(
 {
     assert(primitive.objectType == PrimitiveType::Point);
 
-    const auto& type = primitive.mapObject->_types[primitive.typeIndex];
-
+    evaluator.reset(primitive.mapObject);
     env.applyTo(evaluator);
-    evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_TAG, type.tag);
-    evaluator.setStringValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, type.value);
+    evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_TAG, primitive.tagStringId);
+    evaluator.setStringIdValue(MapStyle::builtinValueDefinitions.INPUT_VALUE, primitive.valueStringId);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MINZOOM, context._zoom);
     evaluator.setIntegerValue(MapStyle::builtinValueDefinitions.INPUT_MAXZOOM, context._zoom);
 }
@@ -998,9 +1036,9 @@ void OsmAnd::Rasterizer_P::rasterizePolygon(
     assert(primitive.mapObject->isClosedFigure());
     assert(primitive.mapObject->isClosedFigure(true));
 
-    MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Polygon, primitive.mapObject);
+    auto& evaluator = _polygonEvaluator;
     initializePolygonEvaluator(env, context, primitive, evaluator);
-    if(!evaluator.evaluate())
+    if(!env.evaluate(evaluator))
         return;
     if(!updatePaint(evaluator, Set_0, true))
         return;
@@ -1095,9 +1133,9 @@ void OsmAnd::Rasterizer_P::rasterizePolyline(
 {
     assert(primitive.mapObject->_points31.size() >= 2);
 
-    MapStyleEvaluator evaluator(env.owner->style, env.owner->displayDensityFactor, MapStyleRulesetType::Polyline, primitive.mapObject);
+    auto& evaluator = _polylineEvaluator;
     initializePolylineEvaluator(env, context, primitive, evaluator);
-    if(!evaluator.evaluate())
+    if(!env.evaluate(evaluator))
         return;
     if(!updatePaint(evaluator, Set_0, false))
         return;
@@ -1357,29 +1395,24 @@ bool OsmAnd::Rasterizer_P::polygonizeCoastlines(
     {
         const auto& polyline = *itPolyline;
 
-        std::shared_ptr<Model::MapObject> mapObject(new Model::MapObject(nullptr, nullptr));
-        mapObject->_isArea = false;
-        mapObject->_points31 = polyline;
-        mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline_line")));
-
-        outVectorized.push_back(mapObject);
+        outVectorized.push_back(createGeneratedMapObject(GeneratedRules::NaturalCoastlineLine, false, polyline));
     }
 
     const bool coastlineCrossesBounds = !coastlinePolylines.isEmpty();
     if(!coastlinePolylines.isEmpty())
     {
         // Add complete water tile with holes
-        std::shared_ptr<Model::MapObject> mapObject(new Model::MapObject(nullptr, nullptr));
-        mapObject->_points31.push_back(PointI(context._area31.left, context._area31.top));
-        mapObject->_points31.push_back(PointI(context._area31.right, context._area31.top));
-        mapObject->_points31.push_back(PointI(context._area31.right, context._area31.bottom));
-        mapObject->_points31.push_back(PointI(context._area31.left, context._area31.bottom));
-        mapObject->_points31.push_back(mapObject->_points31.first());
-        convertCoastlinePolylinesToPolygons(env, context, coastlinePolylines, mapObject->_innerPolygonsPoints31, osmId);
-
-        mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline")));
-        mapObject->_id = osmId;
-        mapObject->_isArea = true;
+        QVector< PointI > points31;
+        points31.reserve(5);
+        points31.push_back(PointI(context._area31.left, context._area31.top));
+        points31.push_back(PointI(context._area31.right, context._area31.top));
+        points31.push_back(PointI(context._area31.right, context._area31.bottom));
+        points31.push_back(PointI(context._area31.left, context._area31.bottom));
+        points31.push_back(points31.first());
+        QList< QVector< PointI > > innerPolygonsPoints31;
+        convertCoastlinePolylinesToPolygons(env, context, coastlinePolylines, innerPolygonsPoints31, osmId);
+
+        const auto mapObject = createGeneratedMapObject(GeneratedRules::NaturalCoastline, true, points31, osmId, innerPolygonsPoints31);
 
         assert(mapObject->isClosedFigure());
         assert(mapObject->isClosedFigure(true));
@@ -1402,12 +1435,7 @@ bool OsmAnd::Rasterizer_P::polygonizeCoastlines(
         {
             const auto& polygon = *itPolygon;
 
-            std::shared_ptr<Model::MapObject> mapObject(new Model::MapObject(nullptr, nullptr));
-            mapObject->_isArea = false;
-            mapObject->_points31 = polygon;
-            mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline_broken")));
-
-            outVectorized.push_back(mapObject);
+            outVectorized.push_back(createGeneratedMapObject(GeneratedRules::NaturalCoastlineBroken, false, polygon));
         }
     }
 
@@ -1416,12 +1444,7 @@ bool OsmAnd::Rasterizer_P::polygonizeCoastlines(
     {
         const auto& polygon = *itPolygon;
 
-        std::shared_ptr<Model::MapObject> mapObject(new Model::MapObject(nullptr, nullptr));
-        mapObject->_isArea = false;
-        mapObject->_points31 = polygon;
-        mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline_line")));
-
-        outVectorized.push_back(mapObject);
+        outVectorized.push_back(createGeneratedMapObject(GeneratedRules::NaturalCoastlineLine, false, polygon));
     }
 
     if (abortIfBrokenCoastlinesExist && !coastlinePolylines.isEmpty())
@@ -1439,20 +1462,12 @@ bool OsmAnd::Rasterizer_P::polygonizeCoastlines(
 
         bool clockwise = isClockwiseCoastlinePolygon(polygon);
 
-        std::shared_ptr<Model::MapObject> mapObject(new Model::MapObject(nullptr, nullptr));
-        mapObject->_points31 = polygon;
         if(clockwise)
-        {
-            mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline")));
             fullWaterObjects++;
-        }
         else
-        {
-            mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("land")));
             fullLandObjects++;
-        }
-        mapObject->_id = osmId;
-        mapObject->_isArea = true;
+        const auto mapObject = createGeneratedMapObject(
+            clockwise ? GeneratedRules::NaturalCoastline : GeneratedRules::NaturalLand, true, polygon, osmId);
 
         assert(mapObject->isClosedFigure());
         outVectorized.push_back(mapObject);
@@ -1468,16 +1483,15 @@ bool OsmAnd::Rasterizer_P::polygonizeCoastlines(
             context._zoom);
 
         // Add complete water tile
-        std::shared_ptr<Model::MapObject> mapObject(new Model::MapObject(nullptr, nullptr));
-        mapObject->_points31.push_back(PointI(context._area31.left, context._area31.top));
-        mapObject->_points31.push_back(PointI(context._area31.right, context._area31.top));
-        mapObject->_points31.push_back(PointI(context._area31.right, context._area31.bottom));
-        mapObject->_points31.push_back(PointI(context._area31.left, context._area31.bottom));
-        mapObject->_points31.push_back(mapObject->_points31.first());
+        QVector< PointI > points31;
+        points31.reserve(5);
+        points31.push_back(PointI(context._area31.left, context._area31.top));
+        points31.push_back(PointI(context._area31.right, context._area31.top));
+        points31.push_back(PointI(context._area31.right, context._area31.bottom));
+        points31.push_back(PointI(context._area31.left, context._area31.bottom));
+        points31.push_back(points31.first());
 
-        mapObject->_types.push_back(TagValue(QString::fromLatin1("natural"), QString::fromLatin1("coastline")));
-        mapObject->_id = osmId;
-        mapObject->_isArea = true;
+        const auto mapObject = createGeneratedMapObject(GeneratedRules::NaturalCoastline, true, points31, osmId);
 
         assert(mapObject->isClosedFigure());
         outVectorized.push_back(mapObject);
@@ -1871,6 +1885,39 @@ void OsmAnd::Rasterizer_P::convertCoastlinePolylinesToPolygons(
     }
 }
 
+const OsmAnd::Rasterizer_P::GeneratedRules OsmAnd::Rasterizer_P::_generatedRules;
+
+OsmAnd::Rasterizer_P::GeneratedRules::GeneratedRules()
+{
+    decodingTable.resize(LayerBasemap + 1);
+    decodingTable[NaturalCoastline] = TagValue("natural", "coastline");
+    decodingTable[NaturalLand] = TagValue("natural", "land");
+    decodingTable[NaturalCoastlineBroken] = TagValue("natural", "coastline_broken");
+    decodingTable[NaturalCoastlineLine] = TagValue("natural", "coastline_line");
+    decodingTable[LayerBasemap] = TagValue("layer", "-5");
+}
+
+std::shared_ptr<const OsmAnd::Model::MapObject> OsmAnd::Rasterizer_P::createGeneratedMapObject(
+    const uint32_t typeRuleId, const bool isArea, const QVector< PointI >& points31,
+    const uint64_t id /*= std::numeric_limits<uint64_t>::max()*/,
+    const QList< QVector< PointI > >& innerPolygonsPoints31 /*= QList< QVector< PointI > >()*/,
+    const QVector< uint32_t >& extraTypesRuleIds /*= QVector< uint32_t >()*/ )
+{
+    std::shared_ptr<Model::MapObjectsBlock> block(new Model::MapObjectsBlock(&_generatedRules.decodingTable));
+
+    Model::MapObjectsBlock::Entry entry;
+    entry.id = id;
+    entry.isArea = isArea;
+    block->appendPoints(points31, entry.points31);
+    for(auto itPolygon = innerPolygonsPoints31.cbegin(); itPolygon != innerPolygonsPoints31.cend(); ++itPolygon)
+        block->appendInnerPolygon(*itPolygon, entry.innerPolygons);
+    block->appendRuleId(typeRuleId, entry.types);
+    for(auto itRuleId = extraTypesRuleIds.cbegin(); itRuleId != extraTypesRuleIds.cend(); ++itRuleId)
+        block->appendRuleId(*itRuleId, entry.extraTypes);
+
+    return std::shared_ptr<const Model::MapObject>(block->createMapObject(block, nullptr, nullptr, entry));
+}
+
 bool OsmAnd::Rasterizer_P::isClockwiseCoastlinePolygon( const QVector< PointI > & polygon )
 {
     if(polygon.isEmpty())
@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <limits>
 
 #include <QList>
 #include <QVector>
@@ -35,6 +36,7 @@
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 #include <OsmAndCore/Map/MapTypes.h>
+#include <OsmAndCore/Map/MapStyleEvaluator.h>
 
 namespace OsmAnd {
 
@@ -60,6 +62,10 @@ namespace OsmAnd {
         AreaI _destinationArea;
         PointD _31toPixelDivisor;
 
+        // Evaluators are reset for each primitive instead of being created from scratch
+        MapStyleEvaluator _polygonEvaluator;
+        MapStyleEvaluator _polylineEvaluator;
+
         static void adjustContextFromEnvironment(
             const RasterizerEnvironment_P& env, RasterizerContext_P& context,
             const ZoomLevel zoom);
@@ -84,6 +90,29 @@ namespace OsmAnd {
             QList< QVector< PointI > >& coastlinePolylines, QList< QVector< PointI > >& coastlinePolygons, uint64_t osmId);
         static bool isClockwiseCoastlinePolygon( const QVector< PointI > & polygon);
 
+        // Map objects generated by rasterizer (coastlines and background) are decoded using own table of rules
+        struct GeneratedRules
+        {
+            GeneratedRules();
+
+            enum : uint32_t
+            {
+                NaturalCoastline = 0,
+                NaturalLand,
+                NaturalCoastlineBroken,
+                NaturalCoastlineLine,
+                LayerBasemap,
+            };
+
+            QVector< TagValue > decodingTable;
+        };
+        static const GeneratedRules _generatedRules;
+        static std::shared_ptr<const Model::MapObject> createGeneratedMapObject(
+            const uint32_t typeRuleId, const bool isArea, const QVector< PointI >& points31,
+            const uint64_t id = std::numeric_limits<uint64_t>::max(),
+            const QList< QVector< PointI > >& innerPolygonsPoints31 = QList< QVector< PointI > >(),
+            const QVector< uint32_t >& extraTypesRuleIds = QVector< uint32_t >());
+
         enum {
             PolygonAreaCutoffLowerThreshold = 75,
             BasemapZoom = 11,
@@ -146,8 +175,17 @@ namespace OsmAnd {
             double zOrder;
             uint32_t typeIndex;
             PrimitiveType objectType;
+
+            // Style string ids of tag and value of map object type
+            uint32_t tagStringId;
+            uint32_t valueStringId;
         };
 
+        static void resolveTypeStringIds(
+            const RasterizerEnvironment_P& env, RasterizerContext_P& context,
+            const std::shared_ptr<const Model::MapObject>& mapObject, const uint32_t typeIndex,
+            uint32_t& outTagStringId, uint32_t& outValueStringId);
+
         static void obtainPrimitives(
             const RasterizerEnvironment_P& env, RasterizerContext_P& context,
             const IQueryController* const controller);
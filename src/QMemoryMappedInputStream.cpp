@@ -0,0 +1,60 @@
+#include "QMemoryMappedInputStream.h"
+
+#include <cassert>
+#include <limits>
+
+namespace gpb = google::protobuf;
+
+OsmAnd::QMemoryMappedInputStream::QMemoryMappedInputStream( const std::shared_ptr<QFile>& file, const uchar* data, const qint64 size )
+    : _file(file)
+    , _data(data)
+    , _size(size)
+    , _position(0)
+{
+    assert(_data != nullptr);
+}
+
+OsmAnd::QMemoryMappedInputStream::~QMemoryMappedInputStream()
+{
+}
+
+bool OsmAnd::QMemoryMappedInputStream::Next( const void** data, int* size )
+{
+    if(_position >= _size)
+    {
+        *size = 0;
+        return false;
+    }
+
+    // Hand out entire remaining mapping at once (as much as fits into int)
+    const auto available = qMin(_size - _position, static_cast<qint64>(std::numeric_limits<int>::max()));
+    *data = _data + _position;
+    *size = static_cast<int>(available);
+    _position += available;
+    return true;
+}
+
+void OsmAnd::QMemoryMappedInputStream::BackUp( int count )
+{
+    if(count > _position)
+        _position = 0;
+    else
+        _position -= count;
+}
+
+bool OsmAnd::QMemoryMappedInputStream::Skip( int count )
+{
+    if(_position + count > _size)
+    {
+        _position = _size;
+        return false;
+    }
+
+    _position += count;
+    return true;
+}
+
+gpb::int64 OsmAnd::QMemoryMappedInputStream::ByteCount() const
+{
+    return _position;
+}
@@ -14,6 +14,7 @@
 #include "Logging.h"
 #include "Utilities.h"
 #include "PlainQueryFilter.h"
+#include "Concurrent.h"
 
 OsmAnd::RoutePlanner::RoutePlanner()
 {
@@ -30,80 +31,241 @@ bool OsmAnd::RoutePlanner::findClosestRoadPoint(
     uint32_t* closestPointIndex /*= nullptr*/,
     double* sqDistanceToClosestPoint /*= nullptr*/,
     uint32_t* _rx31 /*= nullptr*/, uint32_t* _ry31 /*= nullptr*/ )
+{
+    QList<RoadSegmentProjection> segments;
+    findClosestRoadSegments(context, latitude, longitude, 1, segments);
+    if(segments.isEmpty())
+        return false;
+
+    const auto& closest = segments.first();
+    if(closestRoad)
+        *closestRoad = closest.road;
+    if(closestPointIndex)
+        *closestPointIndex = closest.pointIndex;
+    if(sqDistanceToClosestPoint)
+        *sqDistanceToClosestPoint = closest.sqDistance;
+    if(_rx31)
+        *_rx31 = closest.x31;
+    if(_ry31)
+        *_ry31 = closest.y31;
+    return true;
+}
+
+void OsmAnd::RoutePlanner::findClosestRoadSegments(
+    OsmAnd::RoutePlannerContext* context,
+    double latitude, double longitude,
+    int count,
+    QList<RoadSegmentProjection>& outSegments)
 {
     const auto x31 = Utilities::get31TileNumberX(longitude);
     const auto y31 = Utilities::get31TileNumberY(latitude);
 
-    QList< std::shared_ptr<const Model::Road> > roads;
-    loadRoads(context, x31, y31, 17, roads);
-    if(roads.isEmpty())
-        loadRoads(context, x31, y31, 15, roads);
+    collectClosestRoadSegments(context, x31, y31, count, outSegments);
+}
+
+void OsmAnd::RoutePlanner::findClosestRoadPoints(
+    OsmAnd::RoutePlannerContext* context,
+    const QList< std::pair<double, double> >& locations,
+    QVector<RoadSegmentProjection>& outProjections,
+    const IQueryController* const controller /*= nullptr*/)
+{
+    outProjections.fill(RoadSegmentProjection(), locations.size());
+    if(locations.isEmpty())
+        return;
 
-    std::shared_ptr<const OsmAnd::Model::Road> minDistanceRoad;
-    uint32_t minDistancePointIdx;
-    double minSqDistance = std::numeric_limits<double>::max();
-    uint32_t min31x, min31y;
-    for(auto itRoad = roads.cbegin(); itRoad != roads.cend(); ++itRoad)
+    // Locations are split into contiguous chunks, so that each task writes only own part of output
+    const auto pProjections = outProjections.data();
+    const auto chunksCount = qMin(locations.size(), qMax(1, Concurrent::pools->routing->maxThreadCount()));
+    const auto chunkSize = (locations.size() + chunksCount - 1) / chunksCount;
+    QSemaphore finishedChunks;
+    for(auto chunkIdx = 0; chunkIdx < chunksCount; chunkIdx++)
     {
-        auto road = *itRoad;
-        if(road->points.size() <= 1)
-            continue;
+        const auto begin = chunkIdx * chunkSize;
+        const auto end = qMin(begin + chunkSize, locations.size());
+        Concurrent::pools->routing->start(new Concurrent::Task([context, &locations, pProjections, begin, end, &finishedChunks, controller](const Concurrent::Task* task, QEventLoop& eventLoop)
+            {
+                for(auto idx = begin; idx < end; idx++)
+                {
+                    if(controller && controller->isAborted())
+                        break;
 
-        for(auto idx = 1; idx < road->points.size(); idx++)
-        {
-            const auto& cpx31 = road->points[idx].x;
-            const auto& cpy31 = road->points[idx].y;
-            const auto& ppx31 = road->points[idx - 1].x;
-            const auto& ppy31 = road->points[idx - 1].y;
+                    QList<RoadSegmentProjection> segments;
+                    findClosestRoadSegments(context, locations[idx].first, locations[idx].second, 1, segments);
+                    if(!segments.isEmpty())
+                        pProjections[idx] = segments.first();
+                }
+                finishedChunks.release();
+            }));
+    }
+    finishedChunks.acquire(chunksCount);
+}
 
-            auto sqDistance = Utilities::squareDistance31(cpx31, cpy31, ppx31, ppy31);
+void OsmAnd::RoutePlanner::projectOnRoadSegment(
+    const std::shared_ptr<const Model::Road>& road,
+    uint32_t pointIndex,
+    uint32_t x31, uint32_t y31,
+    RoadSegmentProjection& outProjection)
+{
+    const auto& cpx31 = road->points[pointIndex].x;
+    const auto& cpy31 = road->points[pointIndex].y;
+    const auto& ppx31 = road->points[pointIndex - 1].x;
+    const auto& ppy31 = road->points[pointIndex - 1].y;
 
-            uint32_t rx31;
-            uint32_t ry31;
-            auto projection = Utilities::projection31(ppx31, ppy31, cpx31, cpy31, x31, y31);
-            if (projection < 0)
-            {
-                rx31 = ppx31;
-                ry31 = ppy31;
-            }
-            else if (projection >= sqDistance)
-            {
-                rx31 = cpx31;
-                ry31 = cpy31;
-            }
-            else
+    const auto sqLength = Utilities::squareDistance31(cpx31, cpy31, ppx31, ppy31);
+
+    uint32_t rx31;
+    uint32_t ry31;
+    const auto projection = Utilities::projection31(ppx31, ppy31, cpx31, cpy31, x31, y31);
+    if (projection < 0)
+    {
+        rx31 = ppx31;
+        ry31 = ppy31;
+    }
+    else if (projection >= sqLength)
+    {
+        rx31 = cpx31;
+        ry31 = cpy31;
+    }
+    else
+    {
+        const auto& factor = projection / sqLength;
+        rx31 = ppx31 + (cpx31 - ppx31) * factor;
+        ry31 = ppy31 + (cpy31 - ppy31) * factor;
+    }
+
+    outProjection.road = road;
+    outProjection.pointIndex = pointIndex;
+    outProjection.sqDistance = Utilities::squareDistance31(rx31, ry31, x31, y31);
+    outProjection.x31 = rx31;
+    outProjection.y31 = ry31;
+}
+
+void OsmAnd::RoutePlanner::collectClosestRoadSegments(
+    RoutePlannerContext* context,
+    uint32_t x31, uint32_t y31,
+    int count,
+    QList<RoadSegmentProjection>& outSegments)
+{
+    const auto cellShift = 31 - RoutingSubsectionData::SegmentsGridZoomLevel;
+    const auto tileShift = 31 - context->_roadTilesLoadingZoomLevel;
+    const int64_t cellsCount = 1ll << RoutingSubsectionData::SegmentsGridZoomLevel;
+    const int64_t centerCellX = x31 >> cellShift;
+    const int64_t centerCellY = y31 >> cellShift;
+    const auto maxRing = qMax(1, 1 << (RoutingSubsectionData::SegmentsGridZoomLevel - SnappingRadiusZoomLevel));
+
+    QSet<uint64_t> processedTiles;
+    // Roads cached in tiles (split at previously snapped points) replace same roads from subsections
+    QSet<uint64_t> cachedRoadsIds;
+    QSet<uint64_t> processedSegments;
+
+    // Cells are visited in rings of growing size around cell of location
+    for(auto ring = 0; ring <= maxRing; ring++)
+    {
+        QList< int64_t > ringCellsX;
+        QList< int64_t > ringCellsY;
+        for(auto dy = -ring; dy <= ring; dy++)
+        {
+            for(auto dx = -ring; dx <= ring; dx++)
             {
-                const auto& factor = projection / sqDistance;
-                rx31 = ppx31 + (cpx31 - ppx31) * factor;
-                ry31 = ppy31 + (cpy31 - ppy31) * factor;
+                if(qAbs(dx) != ring && qAbs(dy) != ring)
+                    continue;
+
+                const auto cellX = centerCellX + dx;
+                const auto cellY = centerCellY + dy;
+                if(cellX < 0 || cellY < 0 || cellX >= cellsCount || cellY >= cellsCount)
+                    continue;
+                ringCellsX.push_back(cellX);
+                ringCellsY.push_back(cellY);
             }
-            sqDistance = Utilities::squareDistance31(rx31, ry31, x31, y31);
-            if (!road || sqDistance < minSqDistance)
+        }
+
+        // Candidates of each tile are taken right after it was loaded, while it can not be unloaded by loading of
+        // next tile. Roads of candidates stay valid after that, so they are projected without lock. Cached roads go first
+        QList< QPair< std::shared_ptr<const Model::Road>, uint32_t > > cachedCandidates;
+        QList< QPair< std::shared_ptr<const Model::Road>, uint32_t > > cellsCandidates;
+        for(auto idx = 0; idx < ringCellsX.size(); idx++)
+        {
+            const auto cellX = ringCellsX[idx];
+            const auto cellY = ringCellsY[idx];
+            const auto cellId = RoutingSubsectionData::encodeSegmentsGridCellId(cellX, cellY);
+            const auto cellLeft = cellX << cellShift;
+            const auto cellTop = cellY << cellShift;
+            const auto cellRight = cellLeft + (1ll << cellShift) - 1;
+            const auto cellBottom = cellTop + (1ll << cellShift) - 1;
+            for(auto tileY = cellTop >> tileShift; tileY <= (cellBottom >> tileShift); tileY++)
             {
-                minDistanceRoad = road;
-                minDistancePointIdx = idx;
-                minSqDistance = sqDistance;
-                min31x = rx31;
-                min31y = ry31;
+                for(auto tileX = cellLeft >> tileShift; tileX <= (cellRight >> tileShift); tileX++)
+                {
+                    QMutexLocker scopedLocker(&context->_tilesMutex);
+
+                    const auto tileId = getRoutingTileId(context, tileX << tileShift, tileY << tileShift, false);
+                    if(!processedTiles.contains(tileId))
+                    {
+                        processedTiles.insert(tileId);
+
+                        const auto itCachedRoads = context->_cachedRoadsInTiles.constFind(tileId);
+                        if(itCachedRoads != context->_cachedRoadsInTiles.cend())
+                        {
+                            for(auto itRoad = itCachedRoads->cbegin(); itRoad != itCachedRoads->cend(); ++itRoad)
+                            {
+                                const auto& road = *itRoad;
+                                if(cachedRoadsIds.contains(road->id))
+                                    continue;
+                                cachedRoadsIds.insert(road->id);
+
+                                for(auto pointIdx = 1; pointIdx < road->points.size(); pointIdx++)
+                                    cachedCandidates.push_back(qMakePair(std::shared_ptr<const Model::Road>(road), static_cast<uint32_t>(pointIdx)));
+                            }
+                        }
+                    }
+
+                    const auto itSubsectionsContexts = context->_indexedSubsectionsContexts.constFind(tileId);
+                    if(itSubsectionsContexts == context->_indexedSubsectionsContexts.cend())
+                        continue;
+                    for(auto itSubsectionContext = itSubsectionsContexts->cbegin(); itSubsectionContext != itSubsectionsContexts->cend(); ++itSubsectionContext)
+                        (*itSubsectionContext)->collectSegmentsInCell(cellId, cellsCandidates);
+                }
             }
         }
-    }
+        const auto cachedCandidatesCount = cachedCandidates.size();
+        auto& candidates = cachedCandidates;
+        candidates.append(cellsCandidates);
 
-    if (minDistanceRoad)
-    {
-        if(closestRoad)
-            *closestRoad = minDistanceRoad;
-        if(closestPointIndex)
-            *closestPointIndex = minDistancePointIdx;
-        if(sqDistanceToClosestPoint)
-            *sqDistanceToClosestPoint = minSqDistance;
-        if(_rx31)
-            *_rx31 = min31x;
-        if(_ry31)
-            *_ry31 = min31y;
-        return true;
+        for(auto candidateIdx = 0; candidateIdx < candidates.size(); candidateIdx++)
+        {
+            const auto& road = candidates[candidateIdx].first;
+            const auto pointIndex = candidates[candidateIdx].second;
+            if(candidateIdx >= cachedCandidatesCount && cachedRoadsIds.contains(road->id))
+                continue;
+
+            // Roads may be present in several subsections, and segments may cross several cells
+            const auto segmentId = encodeRoutePointId(road, pointIndex);
+            if(processedSegments.contains(segmentId))
+                continue;
+            processedSegments.insert(segmentId);
+
+            RoadSegmentProjection projection;
+            projectOnRoadSegment(road, pointIndex, x31, y31, projection);
+            if(outSegments.size() >= count && projection.sqDistance >= outSegments.last().sqDistance)
+                continue;
+
+            auto insertPosition = outSegments.size();
+            while(insertPosition > 0 && outSegments[insertPosition - 1].sqDistance > projection.sqDistance)
+                insertPosition--;
+            outSegments.insert(insertPosition, projection);
+            if(outSegments.size() > count)
+                outSegments.removeLast();
+        }
+
+        // Segments that were not visited yet are not closer than distance from location to outer border of ring
+        if(outSegments.size() >= count)
+        {
+            const auto ringDistance31 = static_cast<int32_t>(ring << cellShift);
+            const auto ringDistance = qMin(Utilities::x31toMeters(ringDistance31), Utilities::y31toMeters(ringDistance31));
+            if(outSegments.last().sqDistance <= ringDistance * ringDistance)
+                break;
+        }
     }
-    return false;
 }
 
 bool OsmAnd::RoutePlanner::findClosestRouteSegment( OsmAnd::RoutePlannerContext* context, double latitude, double longitude, std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment>& routeSegment )
@@ -175,6 +337,8 @@ void OsmAnd::RoutePlanner::loadRoads( RoutePlannerContext* context, uint32_t x31
 
 void OsmAnd::RoutePlanner::loadRoadsFromTile( RoutePlannerContext* context, uint64_t tileId, QList< std::shared_ptr<const Model::Road> >& roads )
 {
+    QMutexLocker scopedLocker(&context->_tilesMutex);
+
     QMap<uint64_t, std::shared_ptr<const Model::Road> > duplicates;
 
     auto itRoadsInTile = context->_cachedRoadsInTiles.constFind(tileId);
@@ -201,7 +365,7 @@ void OsmAnd::RoutePlanner::loadRoadsFromTile( RoutePlannerContext* context, uint
     }
 }
 
-uint32_t OsmAnd::RoutePlanner::getCurrentEstimatedSize(RoutePlannerContext* context)
+size_t OsmAnd::RoutePlanner::getCurrentEstimatedSize(RoutePlannerContext* context)
 {
     // TODO Victor
     return context->getCurrentEstimatedSize(); // + current stack size  * 2000; //+ current queue size
@@ -214,20 +378,8 @@ uint64_t OsmAnd::RoutePlanner::getRoutingTileId( RoutePlannerContext* context, u
     uint64_t tileId = (xTileId << context->_roadTilesLoadingZoomLevel) + yTileId;
     if(dontLoad)
         return tileId;
-    
-    if(!dontLoad) {
-        auto memoryLimit = context->_memoryUsageLimit;
-        uint32_t estimatedSize = getCurrentEstimatedSize(context);
-        if ( estimatedSize > 0.9 * memoryLimit) {
-            int clt = context->getCurrentlyLoadedTiles();
-            context->unloadUnusedTiles(memoryLimit);
-            int unloaded = clt - context->getCurrentlyLoadedTiles() ;
-            if (unloaded > 0) {
-                OsmAnd::LogPrintf(LogSeverityLevel::Warning,"Unload %d tiles :  estimated size %d", unloaded,
-                                  (estimatedSize - getCurrentEstimatedSize(context)));
-            }
-        }
-    }
+
+    QMutexLocker scopedLocker(&context->_tilesMutex);
 
     auto itIndexedSubsectionContexts = context->_indexedSubsectionsContexts.constFind(tileId);
     if(itIndexedSubsectionContexts == context->_indexedSubsectionsContexts.cend())
@@ -242,11 +394,19 @@ uint64_t OsmAnd::RoutePlanner::getRoutingTileId( RoutePlannerContext* context, u
     {
         auto subsectionContext = *itSubsectionContext;
 
-        if(subsectionContext->isLoaded())continue;
+        if(subsectionContext->isLoaded())
+        {
+            subsectionContext->touch();
+            continue;
+        }
 
         loadSubregionContext(subsectionContext.get());
     }
 
+    // Subsections of requested tile are most recently used ones now, so only other ones are unloaded
+    if(context->getCurrentEstimatedSize() > context->_memoryUsageLimit)
+        context->unloadLeastRecentlyUsedTiles(context->_memoryUsageLimit, itIndexedSubsectionContexts->size());
+
     return tileId;
 }
 
@@ -308,30 +468,23 @@ void OsmAnd::RoutePlanner::loadSubregionContext( RoutePlannerContext::RoutingSub
     if(context->owner->_routeStatistics) {
         context->owner->_routeStatistics->timeToLoadBegin = std::chrono::steady_clock::now();
     }
-    context->markLoaded();
-    ObfRoutingSectionReader::loadSubsectionData(context->origin, context->subsection, nullptr, nullptr, nullptr,
-        [=] (const std::shared_ptr<const OsmAnd::Model::Road>& road)
-        {
-            if(!context->owner->profileContext->acceptsRoad(road))
-                return false;
-
-            context->registerRoad(road);
-            return false;
-        }
-    );
+    // Subsection is decoded only if no other planner context uses it now
+    bool wasDecoded = false;
+    context->markLoaded(RoutingSubsectionsCache::instance->obtain(context->origin, context->subsection, &wasDecoded));
 
     if(context->owner->_routeStatistics) {
         context->owner->_routeStatistics->timeToLoad += (uint64_t) (
         std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - context->owner->_routeStatistics->timeToLoadBegin).count());
         context->owner->_routeStatistics->loadedTiles ++;
         context->owner->_loadedTiles++;
-        if (wasUnloaded) {
-            if(loadsCount == 1) {
-                context->owner->_routeStatistics->loadedPrevUnloadedTiles++;
-            }
+        if (wasUnloaded && loadsCount > 0) {
+            context->owner->_routeStatistics->loadedPrevUnloadedTiles++;
         } else {
             context->owner->_routeStatistics->distinctLoadedTiles++;
         }
+        if (!wasDecoded) {
+            context->owner->_routeStatistics->sharedLoadedTiles++;
+        }
     }
 }
 
@@ -435,7 +588,23 @@ OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::calculateRoute(
     }
 
     std::unique_ptr<RoutePlannerContext::CalculationContext> calculationContext(new RoutePlannerContext::CalculationContext(context));
-    return calculateRoute(calculationContext.get(), routeCalculationSegments[0], routeCalculationSegments[1], leftSideNavigation, controller);
+
+    // Hierarchy does not know about points inside roads, so start and target on same road are left to A*
+    const auto& from = routeCalculationSegments[0];
+    const auto& to = routeCalculationSegments[1];
+    if(from->road->id != to->road->id)
+    {
+        for(auto itHierarchy = context->_routingHierarchies.cbegin(); itHierarchy != context->_routingHierarchies.cend(); ++itHierarchy)
+        {
+            OsmAnd::RouteCalculationResult result;
+            if(calculateRouteUsingHierarchy(calculationContext.get(), *itHierarchy, from, to, leftSideNavigation, result, controller))
+                return result;
+            if(controller && controller->isAborted())
+                break;
+        }
+    }
+
+    return calculateRoute(calculationContext.get(), from, to, leftSideNavigation, controller);
 }
 
 void OsmAnd::RoutePlanner::printDebugInformation(OsmAnd::RoutePlannerContext::CalculationContext* ctx, int directSegmentSize, int reverseSegmentSize,
@@ -451,6 +620,8 @@ void OsmAnd::RoutePlanner::printDebugInformation(OsmAnd::RoutePlannerContext::Ca
         LogPrintf(LogSeverityLevel::Debug, "Current loaded tiles %d, maximum %d : " , ctx->owner->getCurrentlyLoadedTiles(), st->maxLoadedTiles);
                 LogPrintf(LogSeverityLevel::Debug, "Loaded tiles %u (distinct %u), unloaded tiles %u, loaded more than once same tiles %u",
                           st->loadedTiles, st->distinctLoadedTiles, st->unloadedTiles, st->loadedPrevUnloadedTiles);
+        LogPrintf(LogSeverityLevel::Debug, "Reload rate %.1f%%, shared with other contexts %u, maximum loaded size %llu bytes (current %llu)",
+                  st->getReloadRate() * 100.0, st->sharedLoadedTiles, st->maxLoadedTilesSize, static_cast<uint64_t>(ctx->owner->getCurrentEstimatedSize()));
         LogPrintf(LogSeverityLevel::Debug, "D-Queue size %d, R-Queue size %d", directSegmentSize, reverseSegmentSize);
         LogPrintf(LogSeverityLevel::Debug, "Routing calculated time distance %f", finalSegment->_distanceFromStart);
         LogFlush();
@@ -497,30 +668,34 @@ OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::calculateRoute(
             context->_entranceRoadDirection = -1;
     }
 
-    // Initializing priority queue to visit way segments 
-    const auto nonHeuristicRoadSegmentsComparator = []( const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& a, const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& b )
-    {
-        return roadPriorityComparator(
-            a->_distanceFromStart, a->_distanceToEnd,
-            b->_distanceFromStart, b->_distanceToEnd,
-            0.5) > 0;
-    };
-    const auto roadSegmentsComparator = [context]( const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& a, const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& b )
+    // After deviation from previous route to same target, only forward search is performed
+    const auto previousReverseSearchTree = checkPartialRecalculationPossible(context, from, to_);
+    if(previousReverseSearchTree)
     {
-        return roadPriorityComparator(
-            a->_distanceFromStart, a->_distanceToEnd,
-            b->_distanceFromStart, b->_distanceToEnd,
-            context->owner->_heuristicCoefficient) > 0;
-    };
-    RoadSegmentsPriorityQueue graphDirectSegments(roadSegmentsComparator);
-    RoadSegmentsPriorityQueue graphReverseSegments(roadSegmentsComparator);
+        auto result = recalculateRoutePartially(context, from, previousReverseSearchTree, leftSideNavigation, controller);
+        if(!result.list.isEmpty() || (controller && controller->isAborted()))
+            return result;
+    }
+
+    // Previous tree is replaced by reverse direction of this search, so it's not counted in memory taken by it
+    context->owner->retainReverseSearchTree(nullptr);
+
+    // Reverse direction is kept in context after route is found, so it's allocated together with its registry
+    std::shared_ptr<RoutePlannerContext::ReverseSearchTree> reverseSearchTree(new RoutePlannerContext::ReverseSearchTree(to_->road->id, context->_targetPoint));
+
+    // Each direction of search has own registry, so directions do not share any writable state
+    SegmentsRegistry directSegmentsRegistry;
+    SegmentsRegistry& reverseSegmentsRegistry = reverseSearchTree->_registry;
+
+    // Initializing priority queue to visit way segments 
+    RoadSegmentsPriorityQueue graphDirectSegments(&directSegmentsRegistry, context->owner->_heuristicCoefficient);
+    RoadSegmentsPriorityQueue graphReverseSegments(&reverseSegmentsRegistry, context->owner->_heuristicCoefficient);
     
     // Set to not visit one segment twice (stores road.id << X + segmentStart)
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> > visitedDirectSegments;
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> > visitedOppositeSegments;
+    VisitedSegments visitedDirectSegments(&directSegmentsRegistry);
+    VisitedSegments& visitedOppositeSegments = reverseSearchTree->_visitedSegments;
     
     auto to = to_;
-    const auto runRecalculation = checkPartialRecalculationPossible(context, visitedOppositeSegments, to);
     
     // for start : f(start) = g(start) + h(start) = 0 + h(start) = h(start)
     auto estimatedDistance = estimateTimeDistance(context, context->_targetPoint, context->_startPoint);
@@ -543,19 +718,26 @@ OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::calculateRoute(
 
 
     std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> finalSegment;
-    while (!pGraphSegments->empty())
+
+    // Unidirectional strategies depend on order of iterations, so they are always sequential
+    QString parallelSearchError;
+    const auto searchedInParallel =
+        context->owner->_parallelBidirectionalSearch &&
+        context->owner->_planRoadDirection == 0 &&
+        searchInParallel(context,
+            graphDirectSegments, graphReverseSegments,
+            visitedDirectSegments, visitedOppositeSegments,
+            controller, finalSegment, parallelSearchError);
+    if(searchedInParallel && !finalSegment)
+        return OsmAnd::RouteCalculationResult(parallelSearchError);
+
+    while (!searchedInParallel && !pGraphSegments->empty())
     {
 #if TRACE_DUMP_QUEUE
         LogPrintf(LogSeverityLevel::Debug, "---------------------------------------");
         LogPrintf(LogSeverityLevel::Debug, "%s-Queue (%d):", reverseSearch ? "R" : "D", pGraphSegments->size());
-        {
-            auto queueDuplicate = *pGraphSegments;
-            while(queueDuplicate.size() > 0)
-            {
-                queueDuplicate.top()->dump("\t");
-                queueDuplicate.pop();
-            }
-        }
+        for(auto position = 0; position < pGraphSegments->size(); position++)
+            pGraphSegments->at(position)->dump("\t");
 #endif
 
         auto segment = pGraphSegments->top();
@@ -616,12 +798,7 @@ OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::calculateRoute(
             }
         }
         
-        if(runRecalculation)
-        {
-            // nothing to do
-            reverseSearch = false;
-        }
-        else if (!initialized)
+        if (!initialized)
         {
             reverseSearch = !reverseSearch;
             initialized = true;
@@ -657,7 +834,172 @@ OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::calculateRoute(
         return OsmAnd::RouteCalculationResult("Route could not be calculated");
     printDebugInformation(context, graphDirectSegments.size(), graphReverseSegments.size(), finalSegment);
 
-    return prepareResult(context, finalSegment, leftSideNavigation);
+    reverseSearchTree->_routeCost = finalSegment->_distanceFromStart;
+    auto result = prepareResult(context, finalSegment, leftSideNavigation);
+    context->owner->retainReverseSearchTree(result.list.isEmpty() ? nullptr : reverseSearchTree);
+    return result;
+}
+
+OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::recalculateRoutePartially(
+    OsmAnd::RoutePlannerContext::CalculationContext* context,
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& from,
+    const std::shared_ptr<RoutePlannerContext::ReverseSearchTree>& reverseSearchTree,
+    bool leftSideNavigation,
+    const IQueryController* const controller)
+{
+    SegmentsRegistry directSegmentsRegistry;
+    RoadSegmentsPriorityQueue graphDirectSegments(&directSegmentsRegistry, context->owner->_heuristicCoefficient);
+    VisitedSegments visitedDirectSegments(&directSegmentsRegistry);
+
+    from->_distanceToEnd = estimateTimeDistance(context, context->_targetPoint, context->_startPoint);
+    graphDirectSegments.push(from);
+
+    // New start is close to previous route, so route through the tree costs about as much as previous one did
+    auto costLimit = std::numeric_limits<float>::max();
+    if(context->owner->_partialRecalculationCostFactor > 0)
+        costLimit = context->owner->_partialRecalculationCostFactor * reverseSearchTree->_routeCost;
+
+    // Tree is only read here: segments that meet it reference its segments as opposite ones, and distances of them
+    // from target are final, so segment that reaches target first through the tree is taken
+    while(!graphDirectSegments.empty())
+    {
+        auto segment = graphDirectSegments.top();
+        graphDirectSegments.pop();
+
+        if(dynamic_cast<RoutePlannerContext::RouteCalculationFinalSegment*>(segment.get()))
+        {
+            printDebugInformation(context, graphDirectSegments.size(), 0, segment);
+            return prepareResult(context, segment, leftSideNavigation);
+        }
+        if(segment->_distanceFromStart > costLimit)
+            break;
+        if(context->owner->getCurrentEstimatedSize() > context->owner->_memoryUsageLimit)
+            break;
+
+        calculateRouteSegment(context, false, graphDirectSegments, visitedDirectSegments, segment, reverseSearchTree->_visitedSegments, true);
+        calculateRouteSegment(context, false, graphDirectSegments, visitedDirectSegments, segment, reverseSearchTree->_visitedSegments, false);
+
+        if(context->owner->_routeStatistics)
+            context->owner->_routeStatistics->forwardIterations++;
+
+        if(controller && controller->isAborted())
+            return OsmAnd::RouteCalculationResult("Aborted");
+    }
+
+    return OsmAnd::RouteCalculationResult("Route could not be recalculated partially");
+}
+
+struct OsmAnd::RoutePlanner::ParallelSearchState
+{
+    ParallelSearchState()
+        : isFinished(0)
+    {
+    }
+
+    QAtomicInt isFinished;
+    QMutex mutex;
+    std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> finalSegment;
+    QString error;
+
+    // Only first direction that finishes provides result
+    void finish(const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment, const QString& error_)
+    {
+        QMutexLocker scopedLocker(&mutex);
+
+        if(isFinished.load())
+            return;
+        finalSegment = segment;
+        error = error_;
+        isFinished.fetchAndStoreOrdered(1);
+    }
+};
+
+void OsmAnd::RoutePlanner::expandFrontier(
+    OsmAnd::RoutePlannerContext::CalculationContext* context,
+    bool reverseWaySearch,
+    RoadSegmentsPriorityQueue& graphSegments,
+    VisitedSegments& visitedSegments,
+    VisitedSegments& oppositeSegments,
+    ParallelSearchState& state,
+    const IQueryController* const controller)
+{
+    while(!state.isFinished.load())
+    {
+        if(graphSegments.empty())
+        {
+            state.finish(nullptr, reverseWaySearch
+                ? QLatin1String("Route is not found to selected target point.")
+                : QLatin1String("Route is not found from selected start point."));
+            return;
+        }
+
+        auto segment = graphSegments.top();
+        graphSegments.pop();
+
+        if(dynamic_cast<RoutePlannerContext::RouteCalculationFinalSegment*>(segment.get()))
+        {
+            state.finish(segment, QString());
+            return;
+        }
+        if(context->owner->getCurrentEstimatedSize() > context->owner->_memoryUsageLimit)
+        {
+            state.finish(nullptr, "There is no enough memory " +
+                QString::number(context->owner->_memoryUsageLimit/(1<<20)) + " Mb");
+            return;
+        }
+
+        calculateRouteSegment(context, reverseWaySearch, graphSegments, visitedSegments, segment, oppositeSegments, true);
+        calculateRouteSegment(context, reverseWaySearch, graphSegments, visitedSegments, segment, oppositeSegments, false);
+
+        // Each direction updates only own counter
+        if(context->owner->_routeStatistics)
+        {
+            if(reverseWaySearch)
+                context->owner->_routeStatistics->backwardIterations++;
+            else
+                context->owner->_routeStatistics->forwardIterations++;
+        }
+
+        if(controller && controller->isAborted())
+        {
+            state.finish(nullptr, QLatin1String("Aborted"));
+            return;
+        }
+    }
+}
+
+bool OsmAnd::RoutePlanner::searchInParallel(
+    OsmAnd::RoutePlannerContext::CalculationContext* context,
+    RoadSegmentsPriorityQueue& graphDirectSegments,
+    RoadSegmentsPriorityQueue& graphReverseSegments,
+    VisitedSegments& visitedDirectSegments,
+    VisitedSegments& visitedOppositeSegments,
+    const IQueryController* const controller,
+    std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& outFinalSegment,
+    QString& outError)
+{
+    ParallelSearchState state;
+    QSemaphore reverseSearchFinished;
+
+    // Reverse frontier is expanded on pool thread, while direct one is expanded on calling thread
+    const auto task = new Concurrent::Task([context, &graphReverseSegments, &visitedOppositeSegments, &visitedDirectSegments, &state, &reverseSearchFinished, controller](const Concurrent::Task* task, QEventLoop& eventLoop)
+        {
+            expandFrontier(context, true, graphReverseSegments, visitedOppositeSegments, visitedDirectSegments, state, controller);
+            reverseSearchFinished.release();
+        });
+    if(!Concurrent::pools->routing->tryStart(task))
+    {
+        // No free thread to run search on, so caller has to perform sequential search
+        delete task;
+        return false;
+    }
+
+    expandFrontier(context, false, graphDirectSegments, visitedDirectSegments, visitedOppositeSegments, state, controller);
+    reverseSearchFinished.acquire();
+
+    outFinalSegment = state.finalSegment;
+    outError = state.error;
+    return true;
 }
 
 void OsmAnd::RoutePlanner::loadBorderPoints( OsmAnd::RoutePlannerContext::CalculationContext* context )
@@ -764,9 +1106,9 @@ void OsmAnd::RoutePlanner::calculateRouteSegment(
     OsmAnd::RoutePlannerContext::CalculationContext* context,
     bool reverseWaySearch,
     RoadSegmentsPriorityQueue& graphSegments,
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedSegments,
+    VisitedSegments& visitedSegments,
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& oppositeSegments,
+    VisitedSegments& oppositeSegments,
     bool forwardDirection )
 {
     const bool initDirectionAllowed = checkIfInitialMovementAllowedOnSegment(context, reverseWaySearch, visitedSegments, segment, forwardDirection, segment->road);
@@ -901,17 +1243,30 @@ float OsmAnd::RoutePlanner::calculateTurnTime(
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& a, uint32_t aEndPointIndex,
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& b, uint32_t bEndPointIndex )
 {
-    auto itPointTypesB = b->road->pointsTypes.constFind(bEndPointIndex);
-    if(itPointTypesB != b->road->pointsTypes.cend())
-    {
-        const auto& pointTypesB = *itPointTypesB;
+    // Segment starts where parent ends, so if it was loaded from junction table, parent is usually found there too.
+    // Index of parent in it is stored when parent is assigned
+    const auto& junction = a->_junction;
+    const auto bJunctionIndex = (junction && b == a->_parent) ? a->_parentJunctionIndex : -1;
 
-        // Check that there are no traffic signals, since they don't add turn info
-        for(auto itPointType = pointTypesB.cbegin(); itPointType != pointTypesB.cend(); ++itPointType)
+    // Check that there are no traffic signals, since they don't add turn info
+    if(bJunctionIndex >= 0)
+    {
+        if(junction->trafficSignals.testBit(bJunctionIndex))
+            return 0;
+    }
+    else
+    {
+        auto itPointTypesB = b->road->pointsTypes.constFind(bEndPointIndex);
+        if(itPointTypesB != b->road->pointsTypes.cend())
         {
-            auto rule = b->road->subsection->section->_d->_encodingRules[*itPointType];
-            if(rule->_tag == "highway" && rule->_value == "traffic_signals")
-                return 0;
+            const auto& pointTypesB = *itPointTypesB;
+
+            for(auto itPointType = pointTypesB.cbegin(); itPointType != pointTypesB.cend(); ++itPointType)
+            {
+                auto rule = b->road->subsection->section->_d->_encodingRules[*itPointType];
+                if(rule->_tag == "highway" && rule->_value == "traffic_signals")
+                    return 0;
+            }
         }
     }
 
@@ -921,8 +1276,18 @@ float OsmAnd::RoutePlanner::calculateTurnTime(
     
     if (context->owner->profileContext->profile->leftTurn > 0 || context->owner->profileContext->profile->rightTurn > 0)
     {
-        auto a1 = a->road->getDirectionDelta(a->pointIndex, a->pointIndex < aEndPointIndex);
-        auto a2 = b->road->getDirectionDelta(bEndPointIndex, bEndPointIndex < b->pointIndex);
+        double a1;
+        double a2;
+        if(bJunctionIndex >= 0)
+        {
+            a1 = a->pointIndex < aEndPointIndex ? junction->forwardDirections[a->_junctionIndex] : junction->backwardDirections[a->_junctionIndex];
+            a2 = bEndPointIndex < b->pointIndex ? junction->forwardDirections[bJunctionIndex] : junction->backwardDirections[bJunctionIndex];
+        }
+        else
+        {
+            a1 = a->road->getDirectionDelta(a->pointIndex, a->pointIndex < aEndPointIndex);
+            a2 = b->road->getDirectionDelta(bEndPointIndex, bEndPointIndex < b->pointIndex);
+        }
         auto diff = qAbs(Utilities::normalizedAngleRadians(a1 - a2 - M_PI));
 
         // more like UT
@@ -942,8 +1307,8 @@ float OsmAnd::RoutePlanner::calculateTurnTime(
 
 bool OsmAnd::RoutePlanner::checkIfInitialMovementAllowedOnSegment(
     OsmAnd::RoutePlannerContext::CalculationContext* context,
-    bool reverseWaySearch, QMap<uint64_t,
-    std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedSegments,
+    bool reverseWaySearch,
+    VisitedSegments& visitedSegments,
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
     bool forwardDirection,
     const std::shared_ptr<const Model::Road>& road )
@@ -991,7 +1356,7 @@ bool OsmAnd::RoutePlanner::checkIfOppositeSegmentWasVisited(
     bool reverseWaySearch,
     RoadSegmentsPriorityQueue& graphSegments,
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& oppositeSegments,
+    VisitedSegments& oppositeSegments,
     const std::shared_ptr<const Model::Road>& road,
     uint32_t segmentEnd,
     bool forwardDirection,
@@ -1001,11 +1366,12 @@ bool OsmAnd::RoutePlanner::checkIfOppositeSegmentWasVisited(
 {
     const auto id = encodeRoutePointId(road, intervalId, !forwardDirection);
 
-    auto itOppositeSegment = oppositeSegments.constFind(id);
-    if(itOppositeSegment == oppositeSegments.cend())
+    // Opposite direction may be expanded by other thread, so its distance is read as a snapshot
+    float oppositeDistanceFromStart;
+    const auto oppositeSegment = oppositeSegments.find(id, oppositeDistanceFromStart);
+    if(!oppositeSegment)
         return false;
 
-    auto oppositeSegment = *itOppositeSegment;
     if(oppositeSegment->pointIndex != segmentEnd)
         return false;
 
@@ -1013,7 +1379,7 @@ bool OsmAnd::RoutePlanner::checkIfOppositeSegmentWasVisited(
     auto distStartObstacles = segment->_distanceFromStart + calculateTimeWithObstacles(context, road, segmentDist, obstaclesTime);
     finalSegment->_parent = segment->_parent;
     finalSegment->_parentEndPointIndex = segment->_parentEndPointIndex;
-    finalSegment->_distanceFromStart = oppositeSegment->_distanceFromStart + distStartObstacles;
+    finalSegment->_distanceFromStart = oppositeDistanceFromStart + distStartObstacles;
     finalSegment->_distanceToEnd = 0;
     finalSegment->_reverseWaySearch = reverseWaySearch;
     finalSegment->_opposite = oppositeSegment;
@@ -1030,121 +1396,103 @@ float OsmAnd::RoutePlanner::calculateTimeWithObstacles(
     float distOnRoadToPass,
     float obstaclesTime)
 {
-    auto priority = context->owner->profileContext->getSpeedPriority(road);
-    auto speed = context->owner->profileContext->getSpeed(road) * priority;
+    auto distStartObstacles = obstaclesTime + distOnRoadToPass / calculateRoadSpeed(context->owner, road);
+    return distStartObstacles;
+}
+
+float OsmAnd::RoutePlanner::calculateRoadSpeed(
+    OsmAnd::RoutePlannerContext* context,
+    const std::shared_ptr<const Model::Road>& road)
+{
+    auto priority = context->profileContext->getSpeedPriority(road);
+    auto speed = context->profileContext->getSpeed(road) * priority;
     if(qFuzzyCompare(speed, 0.0f))
-        speed = context->owner->profileContext->profile->minDefaultSpeed * priority;
+        speed = context->profileContext->profile->minDefaultSpeed * priority;
 
     // Speed can not exceed max default speed according to A*
-    if(speed > context->owner->profileContext->profile->maxDefaultSpeed)
-        speed = context->owner->profileContext->profile->maxDefaultSpeed;
+    if(speed > context->profileContext->profile->maxDefaultSpeed)
+        speed = context->profileContext->profile->maxDefaultSpeed;
 
-    auto distStartObstacles = obstaclesTime + distOnRoadToPass / speed;
-    return distStartObstacles;
+    return speed;
 }
 
-bool OsmAnd::RoutePlanner::processRestrictions(
-    OsmAnd::RoutePlannerContext::CalculationContext* context,
-    QList< std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& prescripted,
+OsmAnd::Model::RoadRestriction OsmAnd::RoutePlanner::getTurnRestriction(
     const std::shared_ptr<const Model::Road>& road,
+    const RoutingSubsectionData::Junction* junction,
+    int roadJunctionIndex,
+    uint64_t loadedJunctionPoints,
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& next,
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& inputNext,
     bool reverseWay)
 {
-    QList< std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> > notForbidden;
-
-    auto exclusiveRestriction = false;
-    auto next = inputNext;
-    if (!reverseWay && road->restrictions.size() == 0)
-        return false;
-    
-    if(!context->owner->profileContext->profile->restrictionsAware)
-        return false;
-    
-    while(next)
+    // If all roads were loaded from same junction table, restrictions between them are taken from it
+    if (junction && !reverseWay)
+        return junction->getRestriction(roadJunctionIndex, next->_junctionIndex);
+    if (junction)
     {
-        Model::RoadRestriction type = Model::RoadRestriction::Invalid;
-        if (!reverseWay)
+        auto type = junction->getRestriction(next->_junctionIndex, roadJunctionIndex);
+
+        // Same as below: exclusive restriction to other road of this junction
+        const auto& targets = junction->exclusiveRestrictionsTargets[next->_junctionIndex];
+        for(auto itTarget = targets.cbegin(); type == Model::RoadRestriction::Invalid && itTarget != targets.cend(); ++itTarget)
         {
-            auto itRestriction = road->restrictions.constFind(next->road->id);
-            if(itRestriction != road->restrictions.cend())
-                type = *itRestriction;
+            if ((loadedJunctionPoints & (static_cast<uint64_t>(1) << *itTarget)) && junction->roadsIds[*itTarget] != road->id)
+                type = Model::RoadRestriction::Special_ReverseWayOnly;
         }
-        else
-        {
-            for(auto itRestriction = next->road->restrictions.cbegin(); itRestriction != next->road->restrictions.cend(); ++itRestriction)
-            {
-                auto restrictedTo = itRestriction.key();
-                auto crt = itRestriction.value();
-
-                if (restrictedTo == road->id)
-                {
-                    type = crt;
-                    break;
-                }
+        return type;
+    }
 
-                // Check if there is restriction only to the other than current road
-                if (crt == Model::RoadRestriction::OnlyRightTurn || crt == Model::RoadRestriction::OnlyLeftTurn || crt == Model::RoadRestriction::OnlyStraightOn)
-                {
-                    // check if that restriction applies to considered junction
-                    auto foundNext = inputNext;
-                    while(foundNext)
-                    {
-                        if (foundNext->road->id == restrictedTo)
-                            break;
+    Model::RoadRestriction type = Model::RoadRestriction::Invalid;
+    if (!reverseWay)
+    {
+        auto itRestriction = road->restrictions.constFind(next->road->id);
+        if(itRestriction != road->restrictions.cend())
+            type = *itRestriction;
+        return type;
+    }
 
-                        foundNext = foundNext->next;
-                    }
-                    if (foundNext)
-                        type = Model::RoadRestriction::Special_ReverseWayOnly; // special constant
-                }
-            }
-        }
+    for(auto itRestriction = next->road->restrictions.cbegin(); itRestriction != next->road->restrictions.cend(); ++itRestriction)
+    {
+        auto restrictedTo = itRestriction.key();
+        auto crt = itRestriction.value();
 
-        if (type == Model::RoadRestriction::Special_ReverseWayOnly)
+        if (restrictedTo == road->id)
         {
-            // next = next.next; continue;
-        }
-        else if (type == Model::RoadRestriction::Invalid && exclusiveRestriction)
-        {
-            // next = next.next; continue;
-        }
-        else if (type == Model::RoadRestriction::NoLeftTurn || type == Model::RoadRestriction::NoRightTurn || type == Model::RoadRestriction::NoUTurn || type == Model::RoadRestriction::NoStraightOn)
-        {
-            // next = next.next; continue;
-        }
-        else if (type == Model::RoadRestriction::Invalid)
-        {
-            // case no restriction
-            notForbidden.push_back(next);
+            type = crt;
+            break;
         }
-        else
+
+        // Check if there is restriction only to the other than current road
+        if (isExclusiveRestriction(crt))
         {
-            // case exclusive restriction (only_right, only_straight, ...)
-            // 1. in case we are going backward we should not consider only_restriction
-            // as exclusive because we have many "in" roads and one "out"
-            // 2. in case we are going forward we have one "in" and many "out"
-            if (!reverseWay)
-            {
-                exclusiveRestriction = true;
-                notForbidden.clear();
-                prescripted.push_back(next);
-            }
-            else
+            // check if that restriction applies to considered junction
+            auto foundNext = inputNext;
+            while(foundNext)
             {
-                notForbidden.push_back(next);
+                if (foundNext->road->id == restrictedTo)
+                    break;
+
+                foundNext = foundNext->next;
             }
+            if (foundNext)
+                type = Model::RoadRestriction::Special_ReverseWayOnly; // special constant
         }
-        next = next->next;
     }
+    return type;
+}
 
-    prescripted.append(notForbidden);
-    return true;
+bool OsmAnd::RoutePlanner::isExclusiveRestriction( Model::RoadRestriction restriction )
+{
+    return
+        restriction == Model::RoadRestriction::OnlyRightTurn ||
+        restriction == Model::RoadRestriction::OnlyLeftTurn ||
+        restriction == Model::RoadRestriction::OnlyStraightOn;
 }
 
 void OsmAnd::RoutePlanner::processIntersections(
     OsmAnd::RoutePlannerContext::CalculationContext* context,
     RoadSegmentsPriorityQueue& graphSegments,
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedSegments,
+    VisitedSegments& visitedSegments,
     float distFromStart,
     const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment, 
     uint32_t segmentEnd,
@@ -1153,10 +1501,55 @@ void OsmAnd::RoutePlanner::processIntersections(
     bool addSameRoadFutureDirection)
 {
     auto searchDirection = reverseWaySearch ? -1 : 1;
+    if(!inputNext)
+        return;
 
-    QList< std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> > prescripted;
-    const auto restrictionsPresent = processRestrictions(context, prescripted, segment->road, inputNext, reverseWaySearch);
-    auto itPrescripted = prescripted.cbegin();
+    // Loaded segments include all road points at end of segment, so if all of them come from same junction table,
+    // end point of segment is found among them, together with bitmap of points of junction that were loaded
+    const RoutingSubsectionData::Junction* junction = inputNext->_junction.get();
+    auto roadJunctionIndex = -1;
+    uint64_t loadedJunctionPoints = 0;
+    if(junction && junction->count() <= MaxJunctionPointsInBitmap)
+    {
+        for(auto candidate = inputNext; candidate; candidate = candidate->next)
+        {
+            if(candidate->_junction.get() != junction)
+            {
+                roadJunctionIndex = -1;
+                break;
+            }
+            loadedJunctionPoints |= static_cast<uint64_t>(1) << candidate->_junctionIndex;
+            if(candidate->road->id == segment->road->id && candidate->pointIndex == segmentEnd)
+                roadJunctionIndex = candidate->_junctionIndex;
+        }
+    }
+    if(roadJunctionIndex < 0)
+        junction = nullptr;
+
+    const auto restrictionsPresent =
+        context->owner->profileContext->profile->restrictionsAware &&
+        (reverseWaySearch || !segment->road->restrictions.isEmpty());
+
+    // Going forward there is one "in" road and many "out" ones, so exclusive (only_*) restriction forbids all roads
+    // it does not prescript. Going backward there are many "in" roads, so it's not exclusive
+    auto exclusiveRestriction = false;
+    if(restrictionsPresent && !reverseWaySearch)
+    {
+        if(junction)
+        {
+            const auto& targets = junction->exclusiveRestrictionsTargets[roadJunctionIndex];
+            for(auto itTarget = targets.cbegin(); !exclusiveRestriction && itTarget != targets.cend(); ++itTarget)
+                exclusiveRestriction = (loadedJunctionPoints & (static_cast<uint64_t>(1) << *itTarget)) != 0;
+        }
+        else
+        {
+            for(auto candidate = inputNext; candidate && !exclusiveRestriction; candidate = candidate->next)
+            {
+                exclusiveRestriction = isExclusiveRestriction(
+                    getTurnRestriction(segment->road, nullptr, -1, 0, candidate, inputNext, false));
+            }
+        }
+    }
 
 #if TRACE_ROUTING
     if(restrictionsPresent)
@@ -1164,11 +1557,20 @@ void OsmAnd::RoutePlanner::processIntersections(
 #endif
 
     // Calculate possible ways to put into priority queue
-    if(restrictionsPresent ? itPrescripted == prescripted.cend() : !inputNext)
-        return;
-    auto current = restrictionsPresent ? *itPrescripted : inputNext;
-    while(current)
+    for(auto candidate = inputNext; candidate; candidate = candidate->next)
     {
+        if(restrictionsPresent)
+        {
+            const auto type = getTurnRestriction(segment->road, junction, roadJunctionIndex, loadedJunctionPoints, candidate, inputNext, reverseWaySearch);
+            if(type == Model::RoadRestriction::Special_ReverseWayOnly ||
+                type == Model::RoadRestriction::NoLeftTurn || type == Model::RoadRestriction::NoRightTurn ||
+                type == Model::RoadRestriction::NoUTurn || type == Model::RoadRestriction::NoStraightOn)
+                continue;
+            if(type == Model::RoadRestriction::Invalid && exclusiveRestriction)
+                continue;
+        }
+
+        auto current = candidate;
         auto nextPlusNotAllowed =
             (current->pointIndex == current->road->points.size() - 1) ||
             visitedSegments.contains(encodeRoutePointId(current->road, current->pointIndex, true));
@@ -1190,7 +1592,13 @@ void OsmAnd::RoutePlanner::processIntersections(
             
             // assigned to wrong direction
             if(current->_assignedDirection == -searchDirection)
+            {
+                const auto currentJunction = current->_junction;
+                const auto currentJunctionIndex = current->_junctionIndex;
                 current.reset(new RoutePlannerContext::RouteCalculationSegment(current->road, current->pointIndex));
+                current->_junction = currentJunction;
+                current->_junctionIndex = currentJunctionIndex;
+            }
 
             if(!current->parent ||
                 roadPriorityComparator(
@@ -1200,34 +1608,24 @@ void OsmAnd::RoutePlanner::processIntersections(
             {
                 if (current->parent)
                 {
-                    //NOTE: This should be done somehow else (probably use different priority queue)
-                    RoadSegmentsPriorityQueue filteredGraphSegments;
-                    bool success = false;
-                    while (graphSegments.size() > 0)
-                    {
-                        auto segment = graphSegments.top();
-                        graphSegments.pop();
-
-                        if(segment == current)
-                        {
-                            success = true;
-                            continue;
-                        }
-
-                        filteredGraphSegments.push(segment);
-                    }
-                    OSMAND_ASSERT(success, "Should be handled by direction flag");
-                    graphSegments = filteredGraphSegments;
+                    const auto wasQueued = graphSegments.remove(current);
+                    OSMAND_ASSERT(wasQueued, "Should be handled by direction flag");
+                    Q_UNUSED(wasQueued);
                 } 
-                current->_assignedDirection = searchDirection;
-                current->_distanceFromStart = distFromStart;
-                current->_distanceToEnd = distanceToEnd;
-                if(sameRoadFutureDirection)
-                    current->_allowedDirection = segment->pointIndex < current->pointIndex ? 1 : - 1;
-
-                // put additional information to recover whole route after
-                current->_parent = segment;
-                current->_parentEndPointIndex = segmentEnd;
+                {
+                    QMutexLocker scopedLocker(&visitedSegments.getSegmentsMutex());
+
+                    current->_assignedDirection = searchDirection;
+                    current->_distanceFromStart = distFromStart;
+                    current->_distanceToEnd = distanceToEnd;
+                    if(sameRoadFutureDirection)
+                        current->_allowedDirection = segment->pointIndex < current->pointIndex ? 1 : - 1;
+
+                    // put additional information to recover whole route after
+                    current->_parent = segment;
+                    current->_parentEndPointIndex = segmentEnd;
+                    current->_parentJunctionIndex = current->_junction.get() == junction ? roadJunctionIndex : -1;
+                }
 
 #if TRACE_ROUTING
                 current->dump("\t>> ");
@@ -1259,9 +1657,14 @@ void OsmAnd::RoutePlanner::processIntersections(
                 // That code is incorrect (when segment is processed itself,
                 // then it tries to make wrong u-turn) -
                 // this situation should be very carefully checked in future (seems to be fixed)
-                current->_distanceFromStart = distFromStart;
-                current->_parent = segment;
-                current->_parentEndPointIndex = segmentEnd;
+                {
+                    QMutexLocker scopedLocker(&visitedSegments.getSegmentsMutex());
+                    current->_distanceFromStart = distFromStart;
+                    current->_parent = segment;
+                    current->_parentEndPointIndex = segmentEnd;
+                    current->_parentJunctionIndex = current->_junction.get() == junction ? roadJunctionIndex : -1;
+                }
+                graphSegments.update(current);
 
                 /*
                 if (ctx.visitor != null) {
@@ -1277,66 +1680,41 @@ void OsmAnd::RoutePlanner::processIntersections(
         }
 #endif
 
-        // Move to next
-        if(restrictionsPresent)
-        {
-            ++itPrescripted;
-            if(itPrescripted == prescripted.cend())
-                break;
-            current = *itPrescripted;
-        }
-        else
-            current = current->next;
     }
 }
 
-bool OsmAnd::RoutePlanner::checkPartialRecalculationPossible(
+std::shared_ptr<OsmAnd::RoutePlannerContext::ReverseSearchTree> OsmAnd::RoutePlanner::checkPartialRecalculationPossible(
     OsmAnd::RoutePlannerContext::CalculationContext* context,
-    QMap<uint64_t, std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> >& visitedOppositeSegments,
-    std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& outSegment)
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& from,
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& to)
 {
-    if(context->owner->_previouslyCalculatedRoute.isEmpty() || qFuzzyCompare(context->owner->_partialRecalculationDistanceLimit, 0))
-        return false;
-
-    QList< std::shared_ptr<RouteSegment> > filteredPreviousRoute;
-    auto threshold = 0.0f;
+    const auto& reverseSearchTree = context->owner->_reverseSearchTree;
+    if(!reverseSearchTree || context->owner->_previouslyCalculatedRoute.isEmpty() || qFuzzyCompare(context->owner->_partialRecalculationDistanceLimit, 0))
+        return nullptr;
+
+    // Target is snapped again for each calculation, so it's compared by road and location
+    const auto& targetPoint = to->road->points[to->pointIndex];
+    if(reverseSearchTree->targetRoadId != to->road->id || reverseSearchTree->targetPoint != targetPoint)
+        return nullptr;
+
+    // Tree covers surroundings of previous route, so start that is far from it would not meet the tree soon
+    const auto& startPoint = from->road->points[from->pointIndex];
+    const auto limit = context->owner->_partialRecalculationDistanceLimit;
     for(auto itPrevRouteSegment = context->owner->_previouslyCalculatedRoute.cbegin(); itPrevRouteSegment != context->owner->_previouslyCalculatedRoute.cend(); ++itPrevRouteSegment)
     {
-        auto prevRouteSegment = *itPrevRouteSegment;
-
-        threshold += prevRouteSegment->distance;
-
-        if(threshold > context->owner->_partialRecalculationDistanceLimit)
-            filteredPreviousRoute.push_back(prevRouteSegment);
-    }
+        const auto& prevRouteSegment = *itPrevRouteSegment;
 
-    if(filteredPreviousRoute.isEmpty())
-        return false;
-    
-    return false;
-    /*
-    TODO:
-    std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> previousSegment;
-    for(auto itPrevRouteSegment = filteredPreviousRoute.cbegin(); itPrevRouteSegment != filteredPreviousRoute.cend(); ++itPrevRouteSegment)
-    {
-        auto prevRouteSegment = *itPrevRouteSegment;
-
-        std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> segment(new RoutePlannerContext::RouteCalculationSegment(prevRouteSegment.getObject(), prevRouteSegment.getEndPointIndex()));
-        
-        if(previousSegment)
+        const auto& points = prevRouteSegment->road->points;
+        const auto fromIdx = qMin(prevRouteSegment->startPointIndex, prevRouteSegment->endPointIndex);
+        const auto toIdx = qMax(prevRouteSegment->startPointIndex, prevRouteSegment->endPointIndex);
+        for(auto idx = fromIdx; idx <= toIdx && idx < points.size(); idx++)
         {
-            previousSegment.setParentRoute(segment);
-            previousSegment.setParentSegmentEnd(prevRouteSegment.getStartPointIndex());
-            boolean positive = rr.getStartPointIndex() < rr.getEndPointIndex();
-            long t = calculateRoutePointId(rr.getObject(), positive ? rr.getEndPointIndex() - 1 : rr.getEndPointIndex(),
-                positive);
-            visitedOppositeSegments.put(t, segment);
+            if(Utilities::distance31(startPoint.x, startPoint.y, points[idx].x, points[idx].y) <= limit)
+                return reverseSearchTree;
         }
-
-        previousSegment = segment;
     }
-    outSegment = previousSegment;
-    return true;*/
+
+    return nullptr;
 }
 
 void OsmAnd::RoutePlanner::updateDistanceForBorderPoints( RoutePlannerContext::CalculationContext* context, const PointI& sPoint, bool isDistanceToStart )
@@ -1387,6 +1765,9 @@ std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment> OsmAnd::Ro
     OsmAnd::RoutePlannerContext* context,
     uint32_t x31, uint32_t y31)
 {
+    // Tiles may be loaded and unloaded by other direction of parallel search
+    QMutexLocker scopedLocker(&context->_tilesMutex);
+
     auto tileId = getRoutingTileId(context, x31, y31, false);
 
     QMap<uint64_t, std::shared_ptr<const Model::Road> > processed;
@@ -1,10 +1,15 @@
 #include "RoutePlanner.h"
 #include "RoutePlannerContext.h"
 
+#include <QFile>
+#include <QtAlgorithms>
+
 #include "OsmAndCore/Logging.h"
 
 #include "OsmAndCore/Utilities.h"
 #include "ObfReader.h"
+#include "ObfFile.h"
+#include "RoutingHierarchy.h"
 
 OsmAnd::RoutePlannerContext::RoutePlannerContext(
     const QList< std::shared_ptr<ObfReader> >& sources,
@@ -14,7 +19,10 @@ OsmAnd::RoutePlannerContext::RoutePlannerContext(
     float initialHeading /*= std::numeric_limits<float>::quiet_NaN()*/,
     QHash<QString, QString>* options /*=nullptr*/,
     size_t memoryLimit  )
-    : _useBasemap(useBasemap)
+    : _reverseSearchTreeSize(0)
+    , _tilesMutex(QMutex::Recursive)
+    , _loadedSubsectionsSize(0)
+    , _useBasemap(useBasemap)
     , _memoryUsageLimit(memoryLimit)
     , _loadedTiles(0)
     , _initialHeading(initialHeading)
@@ -25,8 +33,11 @@ OsmAnd::RoutePlannerContext::RoutePlannerContext(
 {
     _partialRecalculationDistanceLimit = Utilities::parseArbitraryFloat(configuration->resolveAttribute(vehicle, "recalculateDistanceHelp"), 10000.0f);
     _heuristicCoefficient = Utilities::parseArbitraryFloat(configuration->resolveAttribute(vehicle, "heuristicCoefficient"), 1.0f);
+    _partialRecalculationCostFactor = Utilities::parseArbitraryFloat(configuration->resolveAttribute(vehicle, "partialRecalculationCostFactor"), 1.5f);
+    _matrixTimeLimitFactor = Utilities::parseArbitraryFloat(configuration->resolveAttribute(vehicle, "matrixTimeLimitFactor"), 4.0f);
     _planRoadDirection = Utilities::parseArbitraryInt(configuration->resolveAttribute(vehicle, "planRoadDirection"), 0);
     _roadTilesLoadingZoomLevel = Utilities::parseArbitraryUInt(configuration->resolveAttribute(vehicle, "zoomToLoadTiles"), DefaultRoadTilesLoadingZoomLevel);
+    _parallelBidirectionalSearch = Utilities::parseArbitraryBool(configuration->resolveAttribute(vehicle, "parallelBidirectionalSearch"), false);
 
     for(auto itSource = sources.cbegin(); itSource != sources.cend(); ++itSource)
     {
@@ -46,6 +57,7 @@ OsmAnd::RoutePlannerContext::RoutingSubsectionContext::RoutingSubsectionContext(
     : subsection(subsection)
     , owner(owner)
     ,_mixedLoadsCounter(0)
+    , _memorySize(0)
     , origin(origin)
 {
 }
@@ -56,93 +68,114 @@ OsmAnd::RoutePlannerContext::RoutingSubsectionContext::~RoutingSubsectionContext
 
 
 
-uint32_t OsmAnd::RoutePlannerContext::getCurrentlyLoadedTiles() {
-    uint32_t cnt = 0;
-    for(std::shared_ptr<RoutingSubsectionContext> t : this->_subsectionsContexts){
-        if(t->isLoaded()) {
-            cnt++;
-        }
+bool OsmAnd::RoutePlannerContext::attachRoutingHierarchy( const std::shared_ptr<const RoutingHierarchy>& hierarchy )
+{
+    if(hierarchy->profileName != profileContext->profile->name)
+        return false;
+
+    // Costs of hierarchy built with other context values (e.g. avoid flags) differ from ones of this context
+    if(hierarchy->profileParametersHash != profileContext->getParametersHash())
+    {
+        LogPrintf(LogSeverityLevel::Warning, "Routing hierarchy of profile '%s' was built with other profile parameters",
+            qPrintable(hierarchy->profileName));
+        return false;
     }
-    return cnt;
+
+    _routingHierarchies.push_back(hierarchy);
+    return true;
 }
 
-int intpow(int base, int pw) {
-    int r = 1;
-    for (int i = 0; i < pw; i++) {
-        r *= base;
+int OsmAnd::RoutePlannerContext::attachRoutingHierarchies()
+{
+    auto attachedCount = 0;
+    for(auto itSource = sources.cbegin(); itSource != sources.cend(); ++itSource)
+    {
+        const auto& source = *itSource;
+
+        const auto& obfInfo = source->obtainInfo();
+        if(!source->obfFile || obfInfo->routingSections.isEmpty())
+            continue;
+        const auto hierarchyFileName = RoutingHierarchy::getSidecarFileName(source->obfFile->filePath, profileContext->profile->name);
+        if(!QFile::exists(hierarchyFileName))
+            continue;
+        const auto hierarchy = RoutingHierarchy::loadFrom(hierarchyFileName);
+        if(!hierarchy || hierarchy->obfCreationTimestamp != obfInfo->creationTimestamp)
+        {
+            LogPrintf(LogSeverityLevel::Warning, "Routing hierarchy '%s' is outdated", qPrintable(hierarchyFileName));
+            continue;
+        }
+        if(attachRoutingHierarchy(hierarchy))
+            attachedCount++;
     }
-    return r;
+
+    return attachedCount;
 }
 
+uint32_t OsmAnd::RoutePlannerContext::getCurrentlyLoadedTiles() {
+    QMutexLocker scopedLocker(&_tilesMutex);
 
-uint32_t OsmAnd::RoutePlannerContext::getCurrentEstimatedSize() {
-    // TODO proper clculation
-    return getCurrentlyLoadedTiles()*1000;
+    return _loadedSubsectionsContexts.size();
 }
 
-int compareSections(std::shared_ptr<OsmAnd::RoutePlannerContext::RoutingSubsectionContext> o1,
-                    std::shared_ptr<OsmAnd::RoutePlannerContext::RoutingSubsectionContext> o2) {
-    int v1 = (o1->getAccessCounter() + 1) * intpow(10, o1->getLoadsCounter() -1);
-    int v2 = (o2->getAccessCounter() + 1) * intpow(10, o1->getLoadsCounter() -1);
-    //return v1 < v2 ? -1 : (v1 == v2 ? 0 : 1);
-    return v1 < v2;
+size_t OsmAnd::RoutePlannerContext::getCurrentEstimatedSize() {
+    QMutexLocker scopedLocker(&_tilesMutex);
+
+    return _loadedSubsectionsSize + _reverseSearchTreeSize;
 }
 
+void OsmAnd::RoutePlannerContext::retainReverseSearchTree( const std::shared_ptr<ReverseSearchTree>& tree )
+{
+    QMutexLocker scopedLocker(&_tilesMutex);
+
+    _reverseSearchTree = tree;
+    _reverseSearchTreeSize = tree ? tree->getMemorySize() : 0;
+    if(_loadedSubsectionsSize + _reverseSearchTreeSize > _memoryUsageLimit)
+        unloadLeastRecentlyUsedTiles(_memoryUsageLimit, 0);
+}
 
 void OsmAnd::RoutePlannerContext::unloadUnusedTiles(size_t memoryTarget) {
-    float desirableSize = memoryTarget * 0.7f;
-    QList< std::shared_ptr<RoutingSubsectionContext> > list;
-    int loaded = 0;
-    for(std::shared_ptr<RoutingSubsectionContext>  t : this->_subsectionsContexts) {
-        if(t->isLoaded()) {
-            list.append(t);
-            loaded++;
-        }
-    }
+    // Free more than needed, so that unloading is not repeated on next load
+    unloadLeastRecentlyUsedTiles(memoryTarget * 0.7f, 0);
+}
+
+void OsmAnd::RoutePlannerContext::unloadLeastRecentlyUsedTiles( size_t memoryTarget, int keepCount )
+{
+    QMutexLocker scopedLocker(&_tilesMutex);
+
     if(_routeStatistics) {
-        _routeStatistics->maxLoadedTiles = qMax(_routeStatistics->maxLoadedTiles , getCurrentlyLoadedTiles());
+        _routeStatistics->maxLoadedTiles = qMax<uint32_t>(_routeStatistics->maxLoadedTiles, _loadedSubsectionsContexts.size());
+        _routeStatistics->maxLoadedTilesSize = qMax<uint64_t>(_routeStatistics->maxLoadedTilesSize, _loadedSubsectionsSize);
     }
-    qSort(list.begin(), list.end(), compareSections);
 
-    int i = 0;
-    while(getCurrentEstimatedSize() >= desirableSize && (list.size() - i) > loaded / 5 && i < list.size()) {
-        std::shared_ptr<RoutingSubsectionContext>  unload = list[i];
-        i++;
-        unload->unload();
+    while(_loadedSubsectionsSize + _reverseSearchTreeSize > memoryTarget && _loadedSubsectionsContexts.size() > keepCount)
+    {
+        _loadedSubsectionsContexts.last()->unload();
         if(_routeStatistics) {
-            _routeStatistics->unloadedTiles ++;
+            _routeStatistics->unloadedTiles++;
         }
-
     }
-    if(_routeStatistics) {
-        OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "Unloaded tiles %d (loaded prevUnloaded %d, currently loaded %d)",  _routeStatistics->unloadedTiles,  _routeStatistics->loadedPrevUnloadedTiles, getCurrentlyLoadedTiles());
-        OsmAnd::LogFlush();
-    }
-    for(std::shared_ptr<OsmAnd::RoutePlannerContext::RoutingSubsectionContext> t : _subsectionsContexts) {
-        t->_access /= 3;
+
+    // Tree only speeds up recalculation, while tiles that are kept are needed by current one
+    if(_loadedSubsectionsSize + _reverseSearchTreeSize > memoryTarget && _reverseSearchTree)
+    {
+        _reverseSearchTree.reset();
+        _reverseSearchTreeSize = 0;
     }
 }
 
-void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::registerRoad( const std::shared_ptr<const Model::Road>& road )
+void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::collectSegmentsInCell( uint64_t cellId, QList< QPair< std::shared_ptr<const Model::Road>, uint32_t > >& output ) const
 {
-    uint32_t idx = 0;
-    for(auto itPoint = road->points.cbegin(); itPoint != road->points.cend(); ++itPoint, idx++)
+    if(!_data)
+        return;
+    const auto segments = _data->findSegmentsInCell(cellId);
+    if(!segments)
+        return;
+
+    for(auto itSegment = segments->cbegin(); itSegment != segments->cend(); ++itSegment)
     {
-        const auto& x31 = itPoint->x;
-        const auto& y31 = itPoint->y;
-        uint64_t id = (static_cast<uint64_t>(x31) << 31) | y31;
-        
-        std::shared_ptr<RouteCalculationSegment> routeSegment(new RouteCalculationSegment(road, idx));
-        auto itRouteSegment = _roadSegments.constFind(id);
-        if(itRouteSegment == _roadSegments.cend())
-            _roadSegments.insert(id, routeSegment);
-        else
-        {
-            auto originalRouteSegment = *itRouteSegment;
-            while(originalRouteSegment->_next)
-                originalRouteSegment = originalRouteSegment->_next;
-            originalRouteSegment->_next = routeSegment;
-        }
+        if(!_acceptedRoads.testBit(itSegment->roadIndex))
+            continue;
+        output.push_back(qMakePair(_data->roads[itSegment->roadIndex], itSegment->pointIndex));
     }
 }
 
@@ -156,24 +189,28 @@ uint32_t OsmAnd::RoutePlannerContext::RoutingSubsectionContext::getLoadsCounter(
     return qAbs(_mixedLoadsCounter);
 }
 
+size_t OsmAnd::RoutePlannerContext::RoutingSubsectionContext::getMemorySize() const
+{
+    return _memorySize;
+}
+
 void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::collectRoads( QList< std::shared_ptr<const Model::Road> >& output, QMap<uint64_t, std::shared_ptr<const Model::Road> >* duplicatesRegistry /*= nullptr*/ )
 {
-    for(auto itRouteSegment = _roadSegments.cbegin(); itRouteSegment != _roadSegments.cend(); ++itRouteSegment)
-    {
-        auto routeSegment = itRouteSegment.value();
-        while(routeSegment)
-        {
-            auto road = routeSegment->road;
+    if(!_data)
+        return;
 
-            const auto isDuplicate = duplicatesRegistry && duplicatesRegistry->contains(road->id);
-            if(!isDuplicate)
-            {
-                if(duplicatesRegistry)
-                    duplicatesRegistry->insert(road->id, road);
-                output.push_back(road);
-            }
+    for(auto roadIdx = 0; roadIdx < _data->roads.size(); roadIdx++)
+    {
+        if(!_acceptedRoads.testBit(roadIdx))
+            continue;
+        const auto& road = _data->roads[roadIdx];
 
-            routeSegment = routeSegment->_next;
+        const auto isDuplicate = duplicatesRegistry && duplicatesRegistry->contains(road->id);
+        if(!isDuplicate)
+        {
+            if(duplicatesRegistry)
+                duplicatesRegistry->insert(road->id, road);
+            output.push_back(road);
         }
     }
 
@@ -194,15 +231,48 @@ void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::collectRoads( QList<
         */
 }
 
-void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::markLoaded()
+void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::markLoaded( const std::shared_ptr<const RoutingSubsectionData>& data )
 {
+    if(isLoaded())
+        return;
     _mixedLoadsCounter = qAbs(_mixedLoadsCounter) + 1;
+
+    // Shared data contains roads of all profiles, so ones that profile of owner does not accept are skipped by it
+    _data = data;
+    _acceptedRoads.resize(data->roads.size());
+    for(auto roadIdx = 0; roadIdx < data->roads.size(); roadIdx++)
+        _acceptedRoads.setBit(roadIdx, owner->profileContext->acceptsRoad(data->roads[roadIdx]));
+
+    // Shared data is accounted in full by each context, since it's kept in memory while any of them needs it
+    _memorySize = data->memorySize + _acceptedRoads.size() / 8;
+    owner->_loadedSubsectionsSize += _memorySize;
+
+    owner->_loadedSubsectionsContexts.push_front(this);
+    _lruPosition = owner->_loadedSubsectionsContexts.begin();
 }
 
 void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::unload()
 {
+    if(!isLoaded())
+        return;
     _mixedLoadsCounter = -qAbs(_mixedLoadsCounter);
-    _roadSegments.clear();
+
+    owner->_loadedSubsectionsContexts.erase(_lruPosition);
+    owner->_loadedSubsectionsSize -= _memorySize;
+    _memorySize = 0;
+
+    _data.reset();
+    _acceptedRoads.clear();
+}
+
+void OsmAnd::RoutePlannerContext::RoutingSubsectionContext::touch()
+{
+    if(!isLoaded() || _lruPosition == owner->_loadedSubsectionsContexts.begin())
+        return;
+
+    owner->_loadedSubsectionsContexts.erase(_lruPosition);
+    owner->_loadedSubsectionsContexts.push_front(this);
+    _lruPosition = owner->_loadedSubsectionsContexts.begin();
 }
 
 std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment> OsmAnd::RoutePlannerContext::RoutingSubsectionContext::loadRouteCalculationSegment(
@@ -210,36 +280,45 @@ std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment> OsmAnd::Ro
     QMap<uint64_t, std::shared_ptr<const Model::Road> >& processed,
     const std::shared_ptr<RouteCalculationSegment>& original_)
 {
-    uint64_t id = (static_cast<uint64_t>(x31) << 31) | y31;
-    auto itSegment = _roadSegments.constFind(id);
-    if(itSegment == _roadSegments.cend())
+    if(!_data)
         return original_;
-    this->_access++;
+    const auto roadsPoints = _data->findRoadsPoints(x31, y31);
+    if(!roadsPoints)
+        return original_;
+    touch();
+    const auto junction = _data->findJunction(x31, y31);
 
     auto original = original_;
-    auto segment = *itSegment;
-    while(segment)
+    for(auto itRoadPoint = roadsPoints->cbegin(); itRoadPoint != roadsPoints->cend(); ++itRoadPoint)
     {
-        auto road = segment->road;
-        auto roadPointId = RoutePlanner::encodeRoutePointId(road, segment->pointIndex);
+        if(!_acceptedRoads.testBit(itRoadPoint->roadIndex))
+            continue;
+
+        const auto& road = _data->roads[itRoadPoint->roadIndex];
+        auto roadPointId = RoutePlanner::encodeRoutePointId(road, itRoadPoint->pointIndex);
         auto itOtherRoad = processed.constFind(roadPointId);
         if(itOtherRoad == processed.cend() || (*itOtherRoad)->points.size() < road->points.size())
         {
             processed.insert(roadPointId, road);
 
-            std::shared_ptr<RouteCalculationSegment> newSegment(new RouteCalculationSegment(road, segment->pointIndex));
+            std::shared_ptr<RouteCalculationSegment> newSegment(new RouteCalculationSegment(road, itRoadPoint->pointIndex));
+            if(junction)
+            {
+                newSegment->_junction = junction;
+                newSegment->_junctionIndex = itRoadPoint - roadsPoints->cbegin();
+            }
             newSegment->_next = original;
             original = newSegment;
         }
-
-        segment = segment->next;
     }
     
     return original;
 }
 
 OsmAnd::RoutePlannerContext::CalculationContext::CalculationContext( RoutePlannerContext* owner )
-    : owner(owner)
+    : _entranceRoadId(0)
+    , _entranceRoadDirection(0)
+    , owner(owner)
 {
 }
 
@@ -247,6 +326,340 @@ OsmAnd::RoutePlannerContext::CalculationContext::~CalculationContext()
 {
 }
 
+QAtomicInt OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::_nextId(1);
+
+OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::RouteCalculationSegmentsRegistry()
+    : _id(_nextId.fetchAndAddOrdered(1))
+{
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::~RouteCalculationSegmentsRegistry()
+{
+}
+
+int OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::size() const
+{
+    return _segments.size();
+}
+
+int OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::registerSegment( const std::shared_ptr<RouteCalculationSegment>& segment )
+{
+    // Segments may outlive registries, so index is valid only for registry that has same identifier
+    if(segment->_registryId == _id)
+        return segment->_registryIndex;
+
+    segment->_registryId = _id;
+    segment->_registryIndex = _segments.size();
+    _segments.push_back(segment);
+    return segment->_registryIndex;
+}
+
+int OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::indexOf( const RouteCalculationSegment* segment ) const
+{
+    if(segment->_registryId != _id)
+        return -1;
+    return segment->_registryIndex;
+}
+
+const std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment>& OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::at( int index ) const
+{
+    return _segments[index];
+}
+
+size_t OsmAnd::RoutePlannerContext::RouteCalculationSegmentsRegistry::getMemorySize() const
+{
+    return _segments.capacity() * sizeof(std::shared_ptr<RouteCalculationSegment>) + _segments.size() * sizeof(RouteCalculationSegment);
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::RouteCalculationSegmentsQueue( RouteCalculationSegmentsRegistry* registry, double heuristicCoefficient )
+    : _registry(registry)
+    , _heuristicCoefficient(heuristicCoefficient)
+{
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::~RouteCalculationSegmentsQueue()
+{
+}
+
+inline double OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::priorityOf( const RouteCalculationSegment* segment ) const
+{
+    // Same as RoutePlanner::roadPriorityComparator(), since distances are never NaN
+    return static_cast<double>(segment->_distanceFromStart) + _heuristicCoefficient * static_cast<double>(segment->_distanceToEnd);
+}
+
+inline int OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::positionOf( const RouteCalculationSegment* segment ) const
+{
+    const auto index = _registry->indexOf(segment);
+    if(index < 0 || index >= _positions.size())
+        return -1;
+    return _positions[index];
+}
+
+inline void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::place( int position, const Entry& entry )
+{
+    _heap[position] = entry;
+    _positions[entry.segmentIndex] = position;
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::siftUp( int position, const Entry& entry )
+{
+    while(position > 0)
+    {
+        const auto parentPosition = (position - 1) / Arity;
+        const auto parent = _heap[parentPosition];
+        if(!(entry.priority < parent.priority))
+            break;
+
+        place(position, parent);
+        position = parentPosition;
+    }
+    place(position, entry);
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::siftDown( int position, const Entry& entry )
+{
+    const auto count = _heap.size();
+    for(;;)
+    {
+        const auto firstChild = position * Arity + 1;
+        if(firstChild >= count)
+            break;
+
+        auto bestChild = firstChild;
+        const auto childrenEnd = qMin(firstChild + static_cast<int>(Arity), count);
+        for(auto child = firstChild + 1; child < childrenEnd; child++)
+        {
+            if(_heap[child].priority < _heap[bestChild].priority)
+                bestChild = child;
+        }
+        if(!(_heap[bestChild].priority < entry.priority))
+            break;
+
+        place(position, _heap[bestChild]);
+        position = bestChild;
+    }
+    place(position, entry);
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::reposition( int position, const Entry& entry )
+{
+    if(position > 0 && entry.priority < _heap[(position - 1) / Arity].priority)
+        siftUp(position, entry);
+    else
+        siftDown(position, entry);
+}
+
+bool OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::empty() const
+{
+    return _heap.isEmpty();
+}
+
+int OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::size() const
+{
+    return _heap.size();
+}
+
+const std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment>& OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::top() const
+{
+    return _registry->at(_heap.first().segmentIndex);
+}
+
+const std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment>& OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::at( int position ) const
+{
+    return _registry->at(_heap[position].segmentIndex);
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::push( const std::shared_ptr<RouteCalculationSegment>& segment )
+{
+    Entry entry;
+    entry.priority = priorityOf(segment.get());
+    entry.segmentIndex = _registry->registerSegment(segment);
+    while(_positions.size() < _registry->size())
+        _positions.push_back(-1);
+    if(_positions[entry.segmentIndex] >= 0)
+    {
+        reposition(_positions[entry.segmentIndex], entry);
+        return;
+    }
+
+    _heap.push_back(entry);
+    siftUp(_heap.size() - 1, entry);
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::pop()
+{
+    _positions[_heap.first().segmentIndex] = -1;
+
+    const auto last = _heap.last();
+    _heap.pop_back();
+    if(!_heap.isEmpty())
+        siftDown(0, last);
+}
+
+bool OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::remove( const std::shared_ptr<RouteCalculationSegment>& segment )
+{
+    const auto position = positionOf(segment.get());
+    if(position < 0)
+        return false;
+    _positions[segment->_registryIndex] = -1;
+
+    const auto last = _heap.last();
+    _heap.pop_back();
+    if(position < _heap.size())
+        reposition(position, last);
+    return true;
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationSegmentsQueue::update( const std::shared_ptr<RouteCalculationSegment>& segment )
+{
+    const auto position = positionOf(segment.get());
+    if(position < 0)
+        return;
+
+    Entry entry;
+    entry.priority = priorityOf(segment.get());
+    entry.segmentIndex = segment->_registryIndex;
+    reposition(position, entry);
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::Bucket::Bucket()
+    : id(0)
+    , segment(nullptr)
+{
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::Bucket::Bucket( const Bucket& that )
+    : id(that.id)
+    , segment(that.segment.load())
+{
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::RouteCalculationVisitedSegments( RouteCalculationSegmentsRegistry* registry )
+    : _registry(registry)
+    , _table(nullptr)
+    , _size(0)
+{
+    const auto table = new Table(InitialCapacity);
+    _tables.push_back(table);
+    _table.storeRelease(table);
+}
+
+OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::~RouteCalculationVisitedSegments()
+{
+    qDeleteAll(_tables);
+}
+
+int OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::bucketOf( const Table& table, uint64_t id )
+{
+    // Route point ids differ mostly in low bits, so they are mixed before masking (MurmurHash3 finalizer)
+    auto hash = id;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    const auto mask = static_cast<uint64_t>(table.size() - 1);
+    auto bucket = static_cast<int>(hash & mask);
+    while(table[bucket].segment.loadAcquire() != nullptr && table[bucket].id != id)
+        bucket = static_cast<int>((bucket + 1) & mask);
+    return bucket;
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::grow()
+{
+    const auto& oldTable = *_table.load();
+    const auto table = new Table(oldTable.size() * 2);
+    for(auto itBucket = oldTable.cbegin(); itBucket != oldTable.cend(); ++itBucket)
+    {
+        if(itBucket->segment.load() == nullptr)
+            continue;
+        (*table)[bucketOf(*table, itBucket->id)] = *itBucket;
+    }
+
+    // Readers may still probe old table, so it's released only with this set
+    _tables.push_back(table);
+    _table.storeRelease(table);
+}
+
+int OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::size() const
+{
+    return _size;
+}
+
+bool OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::contains( uint64_t id ) const
+{
+    const auto& table = *_table.loadAcquire();
+    return table[bucketOf(table, id)].segment.loadAcquire() != nullptr;
+}
+
+std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment> OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::find( uint64_t id ) const
+{
+    const auto& table = *_table.loadAcquire();
+    const auto segment = table[bucketOf(table, id)].segment.loadAcquire();
+    if(segment == nullptr)
+        return nullptr;
+    return segment->shared_from_this();
+}
+
+std::shared_ptr<OsmAnd::RoutePlannerContext::RouteCalculationSegment> OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::find( uint64_t id, float& outDistanceFromStart ) const
+{
+    const auto segment = find(id);
+    if(!segment)
+        return nullptr;
+
+    QMutexLocker scopedLocker(&_segmentsMutex);
+    outDistanceFromStart = segment->_distanceFromStart;
+    return segment;
+}
+
+QMutex& OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::getSegmentsMutex() const
+{
+    return _segmentsMutex;
+}
+
+size_t OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::getMemorySize() const
+{
+    size_t size = 0;
+    for(auto itTable = _tables.cbegin(); itTable != _tables.cend(); ++itTable)
+        size += (*itTable)->capacity() * sizeof(Bucket);
+    return size;
+}
+
+void OsmAnd::RoutePlannerContext::RouteCalculationVisitedSegments::insert( uint64_t id, const std::shared_ptr<RouteCalculationSegment>& segment )
+{
+    // Keep load factor below 1/2, so probe sequences stay short
+    if((_size + 1) * 2 > _table.load()->size())
+        grow();
+
+    // Registry keeps segment alive while it's referenced by bucket
+    _registry->registerSegment(segment);
+
+    auto& table = *_table.load();
+    auto& bucket = table[bucketOf(table, id)];
+    if(bucket.segment.load() == nullptr)
+    {
+        _size++;
+        bucket.id = id;
+    }
+    bucket.segment.storeRelease(segment.get());
+}
+
+OsmAnd::RoutePlannerContext::ReverseSearchTree::ReverseSearchTree( uint64_t targetRoadId_, const PointI& targetPoint_ )
+    : _visitedSegments(&_registry)
+    , _routeCost(0)
+    , targetRoadId(targetRoadId_)
+    , targetPoint(targetPoint_)
+{
+}
+
+OsmAnd::RoutePlannerContext::ReverseSearchTree::~ReverseSearchTree()
+{
+}
+
+size_t OsmAnd::RoutePlannerContext::ReverseSearchTree::getMemorySize() const
+{
+    return _registry.getMemorySize() + _visitedSegments.getMemorySize();
+}
+
 OsmAnd::RoutePlannerContext::RouteCalculationSegment::RouteCalculationSegment( const std::shared_ptr<const Model::Road>& road_, uint32_t pointIndex )
     : _distanceFromStart(0)
     , _distanceToEnd(0)
@@ -257,6 +670,10 @@ OsmAnd::RoutePlannerContext::RouteCalculationSegment::RouteCalculationSegment( c
     , pointIndex(pointIndex)
     , _allowedDirection(0)
     , _assignedDirection(0)
+    , _registryId(0)
+    , _registryIndex(-1)
+    , _junctionIndex(-1)
+    , _parentJunctionIndex(-1)
 {
 }
 
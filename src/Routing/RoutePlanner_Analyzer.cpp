@@ -50,6 +50,14 @@ OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::prepareResult(
     }
     std::reverse(route.begin(), route.end());
 
+    return prepareResult(context, route, leftSideNavigation);
+}
+
+OsmAnd::RouteCalculationResult OsmAnd::RoutePlanner::prepareResult(
+    OsmAnd::RoutePlannerContext::CalculationContext* context,
+    QVector< std::shared_ptr<RouteSegment> >& route,
+    bool leftSideNavigation)
+{
     if(!validateAllPointsConnected(route))
         return OsmAnd::RouteCalculationResult("Calculated route has broken paths");
     splitRoadsAndAttachRoadSegments(context, route);
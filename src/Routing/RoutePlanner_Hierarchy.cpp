@@ -0,0 +1,411 @@
+#include "RoutePlanner.h"
+
+#include <chrono>
+
+#include <QtCore>
+
+#include "ObfReader.h"
+#include "ObfRoutingSectionReader.h"
+#include "ObfRoutingSectionInfo.h"
+#include "Road.h"
+#include "Common.h"
+#include "Logging.h"
+#include "Utilities.h"
+
+std::shared_ptr<OsmAnd::RoutingHierarchy> OsmAnd::RoutePlanner::buildRoutingHierarchy(
+    OsmAnd::RoutePlannerContext* context,
+    const std::shared_ptr<ObfReader>& source,
+    const IQueryController* const controller /*= nullptr*/)
+{
+    const auto& obfInfo = source->obtainInfo();
+
+    // Load all roads that are accepted by profile
+    QHash< uint64_t, std::shared_ptr<const Model::Road> > roads;
+    for(auto itRoutingSection = obfInfo->routingSections.cbegin(); itRoutingSection != obfInfo->routingSections.cend(); ++itRoutingSection)
+    {
+        const auto& routingSection = *itRoutingSection;
+
+        QList< std::shared_ptr<const ObfRoutingSubsectionInfo> > subsections;
+        ObfRoutingSectionReader::querySubsections(
+            source,
+            context->_useBasemap ? routingSection->baseSubsections : routingSection->subsections,
+            &subsections,
+            nullptr,
+            [](const std::shared_ptr<const ObfRoutingSubsectionInfo>& subsection)
+            {
+                return subsection->containsData();
+            }
+        );
+        for(auto itSubsection = subsections.cbegin(); itSubsection != subsections.cend(); ++itSubsection)
+        {
+            if(controller && controller->isAborted())
+                return nullptr;
+
+            ObfRoutingSectionReader::loadSubsectionData(source, *itSubsection, nullptr, nullptr, nullptr,
+                [context, &roads] (const std::shared_ptr<const OsmAnd::Model::Road>& road)
+                {
+                    if(road->points.size() < 2 || roads.contains(road->id) || !context->profileContext->acceptsRoad(road))
+                        return false;
+
+                    roads.insert(road->id, road);
+                    return false;
+                }
+            );
+        }
+    }
+
+    // Junctions and ends of roads become nodes of graph
+    QHash<uint64_t, int> pointsUsages;
+    for(auto itRoad = roads.cbegin(); itRoad != roads.cend(); ++itRoad)
+    {
+        const auto& points = itRoad.value()->points;
+        for(auto pointIdx = 0; pointIdx < points.size(); pointIdx++)
+        {
+            const auto isEnd = (pointIdx == 0 || pointIdx == points.size() - 1);
+            pointsUsages[(static_cast<uint64_t>(points[pointIdx].x) << 31) | points[pointIdx].y] += isEnd ? 2 : 1;
+        }
+    }
+
+    QVector<PointI> nodesLocations;
+    QHash<uint64_t, int> nodesByLocation;
+    for(auto itUsage = pointsUsages.cbegin(); itUsage != pointsUsages.cend(); ++itUsage)
+    {
+        if(itUsage.value() < 2)
+            continue;
+
+        PointI location;
+        location.x = static_cast<int32_t>(itUsage.key() >> 31);
+        location.y = static_cast<int32_t>(itUsage.key() & 0x7FFFFFFF);
+        nodesByLocation.insert(itUsage.key(), nodesLocations.size());
+        nodesLocations.push_back(location);
+    }
+    pointsUsages.clear();
+
+    // Parts of roads between neighbour nodes become arcs, separately for each allowed direction
+    QVector<RoutingHierarchy::RoadPiece> pieces;
+    QVector<RoutingHierarchy::Arc> arcs;
+    for(auto itRoad = roads.cbegin(); itRoad != roads.cend(); ++itRoad)
+    {
+        const auto& road = itRoad.value();
+        const auto speed = calculateRoadSpeed(context, road);
+        const auto increasingAllowed = isRoadMovementAllowed(context, road, true);
+        const auto decreasingAllowed = isRoadMovementAllowed(context, road, false);
+
+        int prevNode = -1;
+        uint32_t prevNodePointIdx = 0;
+        for(auto pointIdx = 0; pointIdx < road->points.size(); pointIdx++)
+        {
+            const auto& point = road->points[pointIdx];
+            const auto itNode = nodesByLocation.constFind((static_cast<uint64_t>(point.x) << 31) | point.y);
+            if(itNode == nodesByLocation.cend())
+                continue;
+            const auto node = *itNode;
+
+            if(prevNode >= 0 && prevNode != node)
+            {
+                const auto addArc = [&](int source, int target, uint32_t startPointIndex, uint32_t endPointIndex)
+                {
+                    const auto cost = calculateRoadPieceTime(context, road, speed, startPointIndex, endPointIndex);
+                    if(cost < 0)
+                        return;
+
+                    RoutingHierarchy::RoadPiece piece;
+                    piece.roadId = road->id;
+                    piece.startPointIndex = startPointIndex;
+                    piece.endPointIndex = endPointIndex;
+
+                    RoutingHierarchy::Arc arc;
+                    arc.source = source;
+                    arc.target = target;
+                    arc.cost = cost;
+                    arc.piece = pieces.size();
+
+                    pieces.push_back(piece);
+                    arcs.push_back(arc);
+                };
+
+                if(increasingAllowed)
+                    addArc(prevNode, node, prevNodePointIdx, pointIdx);
+                if(decreasingAllowed)
+                    addArc(node, prevNode, pointIdx, prevNodePointIdx);
+            }
+
+            prevNode = node;
+            prevNodePointIdx = pointIdx;
+        }
+    }
+    roads.clear();
+
+    if(controller && controller->isAborted())
+        return nullptr;
+
+    LogPrintf(LogSeverityLevel::Info, "Contracting routing graph of %d nodes and %d arcs", nodesLocations.size(), arcs.size());
+    return RoutingHierarchy::contract(context->profileContext->profile->name, context->profileContext->getParametersHash(), obfInfo->creationTimestamp,
+        nodesLocations, pieces, arcs, controller);
+}
+
+float OsmAnd::RoutePlanner::calculateRoadPieceTime(
+    OsmAnd::RoutePlannerContext* context,
+    const std::shared_ptr<const Model::Road>& road,
+    float speed,
+    uint32_t fromPointIndex,
+    uint32_t toPointIndex)
+{
+    // Same as A* counts it: distance by speed of road plus obstacles at each passed point
+    float distance = 0;
+    float obstaclesTime = 0;
+    const bool isIncrement = fromPointIndex < toPointIndex;
+    for(auto pointIdx = fromPointIndex; pointIdx != toPointIndex; )
+    {
+        const auto prevIdx = pointIdx;
+        isIncrement ? pointIdx++ : pointIdx--;
+
+        const auto& point = road->points[pointIdx];
+        const auto& prevPoint = road->points[prevIdx];
+        distance += Utilities::distance31(point.x, point.y, prevPoint.x, prevPoint.y);
+
+        const auto obstacleTime = context->profileContext->getRoutingObstaclesExtraTime(road, pointIdx);
+        if(obstacleTime < 0)
+            return -1.0f;
+        obstaclesTime += obstacleTime;
+    }
+
+    return obstaclesTime + distance / speed;
+}
+
+bool OsmAnd::RoutePlanner::isRoadMovementAllowed(
+    OsmAnd::RoutePlannerContext* context,
+    const std::shared_ptr<const Model::Road>& road,
+    bool increasing)
+{
+    // Same as initial movement check of forward search
+    const auto direction = context->profileContext->getDirection(road);
+    if(increasing)
+        return (direction == Model::RoadDirection::TwoWay || direction == Model::RoadDirection::OneWayReverse);
+    return (direction == Model::RoadDirection::TwoWay || direction == Model::RoadDirection::OneWayForward);
+}
+
+void OsmAnd::RoutePlanner::collectHierarchyEndpoints(
+    OsmAnd::RoutePlannerContext* context,
+    const std::shared_ptr<const RoutingHierarchy>& hierarchy,
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
+    bool isTarget,
+    QList<RoutingHierarchy::Endpoint>& outEndpoints,
+    QList<uint32_t>& outPointIndices)
+{
+    const auto& road = segment->road;
+    const auto pointIndex = segment->pointIndex;
+
+    const auto node = hierarchy->findNode(road->points[pointIndex]);
+    if(node >= 0)
+    {
+        RoutingHierarchy::Endpoint endpoint;
+        endpoint.node = node;
+        endpoint.cost = 0.0f;
+        outEndpoints.push_back(endpoint);
+        outPointIndices.push_back(pointIndex);
+        return;
+    }
+
+    // Closest node in each direction along the road is enough, since all further ones are reachable through it
+    const auto speed = calculateRoadSpeed(context, road);
+    for(auto isIncrement = 0; isIncrement < 2; isIncrement++)
+    {
+        int nodePointIdx = pointIndex;
+        int nodeOnRoad = -1;
+        while(nodeOnRoad < 0)
+        {
+            isIncrement ? nodePointIdx++ : nodePointIdx--;
+            if(nodePointIdx < 0 || nodePointIdx >= road->points.size())
+                break;
+            nodeOnRoad = hierarchy->findNode(road->points[nodePointIdx]);
+        }
+        if(nodeOnRoad < 0)
+            continue;
+
+        // Target is reached by movement from node, start is left by movement to node
+        const auto fromPointIdx = isTarget ? static_cast<uint32_t>(nodePointIdx) : pointIndex;
+        const auto toPointIdx = isTarget ? pointIndex : static_cast<uint32_t>(nodePointIdx);
+        if(!isRoadMovementAllowed(context, road, fromPointIdx < toPointIdx))
+            continue;
+        const auto cost = calculateRoadPieceTime(context, road, speed, fromPointIdx, toPointIdx);
+        if(cost < 0)
+            continue;
+
+        RoutingHierarchy::Endpoint endpoint;
+        endpoint.node = nodeOnRoad;
+        endpoint.cost = cost;
+        outEndpoints.push_back(endpoint);
+        outPointIndices.push_back(nodePointIdx);
+    }
+}
+
+std::shared_ptr<const OsmAnd::Model::Road> OsmAnd::RoutePlanner::obtainRoad(
+    OsmAnd::RoutePlannerContext* context,
+    const RoutingHierarchy::RoadPiece& piece,
+    const PointI& startLocation31,
+    QHash< uint64_t, std::shared_ptr<const Model::Road> >& roadsCache,
+    QSet<uint64_t>& processedTiles)
+{
+    auto itRoad = roadsCache.constFind(piece.roadId);
+    if(itRoad != roadsCache.cend())
+        return *itRoad;
+
+    // Roads cached in tiles may be clones with inserted points, so original roads are taken from subsections
+    const auto tileId = getRoutingTileId(context, startLocation31.x, startLocation31.y, false);
+    if(processedTiles.contains(tileId))
+        return nullptr;
+    processedTiles.insert(tileId);
+
+    // Tiles are loaded and unloaded by other calculations under same lock
+    QList< std::shared_ptr<const Model::Road> > roads;
+    {
+        QMutexLocker scopedLocker(&context->_tilesMutex);
+
+        const auto subsectionsContexts = context->_indexedSubsectionsContexts.value(tileId);
+        for(auto itSubsectionContext = subsectionsContexts.cbegin(); itSubsectionContext != subsectionsContexts.cend(); ++itSubsectionContext)
+            (*itSubsectionContext)->collectRoads(roads);
+    }
+    for(auto itTileRoad = roads.cbegin(); itTileRoad != roads.cend(); ++itTileRoad)
+    {
+        if(!roadsCache.contains((*itTileRoad)->id))
+            roadsCache.insert((*itTileRoad)->id, *itTileRoad);
+    }
+
+    return roadsCache.value(piece.roadId);
+}
+
+bool OsmAnd::RoutePlanner::isRouteTurnAllowed(
+    OsmAnd::RoutePlannerContext* context,
+    const std::shared_ptr<RouteSegment>& from,
+    const std::shared_ptr<RouteSegment>& to)
+{
+    if(!context->profileContext->profile->restrictionsAware || from->road->id == to->road->id)
+        return true;
+
+    const auto& location = from->road->points[from->endPointIndex];
+    std::shared_ptr<const RoutingSubsectionData::Junction> junction;
+    {
+        QMutexLocker scopedLocker(&context->_tilesMutex);
+
+        const auto tileId = getRoutingTileId(context, location.x, location.y, false);
+        const auto subsectionsContexts = context->_indexedSubsectionsContexts.value(tileId);
+        for(auto itSubsectionContext = subsectionsContexts.cbegin(); !junction && itSubsectionContext != subsectionsContexts.cend(); ++itSubsectionContext)
+        {
+            const auto& data = (*itSubsectionContext)->_data;
+            if(data)
+                junction = data->findJunction(location.x, location.y);
+        }
+    }
+
+    // Ends of route may be clones of roads with inserted point, so their points are also matched by road alone
+    const auto indexOfRoad = [&junction](const std::shared_ptr<const Model::Road>& road, uint32_t pointIndex) -> int
+    {
+        const auto index = junction->indexOf(road->id, pointIndex);
+        return index >= 0 ? index : junction->roadsIds.indexOf(road->id);
+    };
+    const auto fromIndex = junction ? indexOfRoad(from->road, from->endPointIndex) : -1;
+    const auto toIndex = junction ? indexOfRoad(to->road, to->startPointIndex) : -1;
+
+    Model::RoadRestriction type = Model::RoadRestriction::Invalid;
+    auto hasExclusiveRestriction = false;
+    if(fromIndex >= 0 && toIndex >= 0)
+    {
+        type = junction->getRestriction(fromIndex, toIndex);
+        hasExclusiveRestriction = !junction->exclusiveRestrictionsTargets[fromIndex].isEmpty();
+    }
+    else
+    {
+        // Junction is not known, so any exclusive restriction of road is assumed to apply here
+        type = from->road->restrictions.value(to->road->id, Model::RoadRestriction::Invalid);
+        for(auto itRestriction = from->road->restrictions.cbegin(); !hasExclusiveRestriction && itRestriction != from->road->restrictions.cend(); ++itRestriction)
+            hasExclusiveRestriction = isExclusiveRestriction(itRestriction.value());
+    }
+
+    if(type == Model::RoadRestriction::NoLeftTurn || type == Model::RoadRestriction::NoRightTurn ||
+        type == Model::RoadRestriction::NoUTurn || type == Model::RoadRestriction::NoStraightOn)
+        return false;
+    if(hasExclusiveRestriction && !isExclusiveRestriction(type))
+        return false;
+    return true;
+}
+
+bool OsmAnd::RoutePlanner::calculateRouteUsingHierarchy(
+    OsmAnd::RoutePlannerContext::CalculationContext* context,
+    const std::shared_ptr<const RoutingHierarchy>& hierarchy,
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& from,
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& to,
+    bool leftSideNavigation,
+    RouteCalculationResult& outResult,
+    const IQueryController* const controller)
+{
+    const auto calculationBegin = std::chrono::steady_clock::now();
+
+    context->_startPoint = from->road->points[from->pointIndex];
+    context->_targetPoint = to->road->points[to->pointIndex];
+
+    QList<RoutingHierarchy::Endpoint> sources;
+    QList<uint32_t> sourcesPointIndices;
+    collectHierarchyEndpoints(context->owner, hierarchy, from, false, sources, sourcesPointIndices);
+    QList<RoutingHierarchy::Endpoint> targets;
+    QList<uint32_t> targetsPointIndices;
+    collectHierarchyEndpoints(context->owner, hierarchy, to, true, targets, targetsPointIndices);
+    if(sources.isEmpty() || targets.isEmpty())
+        return false;
+
+    QList<RoutingHierarchy::RoadPiece> pieces;
+    QList<int> nodes;
+    float cost;
+    int sourceIndex;
+    int targetIndex;
+    if(!hierarchy->findPath(sources, targets, pieces, nodes, cost, sourceIndex, targetIndex, controller))
+        return false;
+
+    // Pieces of same road that follow each other are joined, as A* does
+    QVector< std::shared_ptr<RouteSegment> > route;
+    const auto appendSegment = [&route](const std::shared_ptr<RouteSegment>& segment)
+    {
+        if(segment->startPointIndex == segment->endPointIndex)
+            return;
+        if(!route.isEmpty() && route.back()->road == segment->road && combineTwoSegmentResult(segment, route.back(), false))
+            return;
+        route.push_back(segment);
+    };
+
+    appendSegment(std::shared_ptr<RouteSegment>(new RouteSegment(from->road, from->pointIndex, sourcesPointIndices[sourceIndex])));
+    QHash< uint64_t, std::shared_ptr<const Model::Road> > roadsCache;
+    QSet<uint64_t> processedTiles;
+    for(auto pieceIdx = 0; pieceIdx < pieces.size(); pieceIdx++)
+    {
+        const auto& piece = pieces[pieceIdx];
+        const auto& startLocation = hierarchy->getNodeLocation(nodes[pieceIdx]);
+
+        const auto road = obtainRoad(context->owner, piece, startLocation, roadsCache, processedTiles);
+        if(!road || piece.startPointIndex >= road->points.size() || piece.endPointIndex >= road->points.size())
+        {
+            LogPrintf(LogSeverityLevel::Warning, "Road %llu of routing hierarchy was not found", piece.roadId);
+            return false;
+        }
+        appendSegment(std::shared_ptr<RouteSegment>(new RouteSegment(road, piece.startPointIndex, piece.endPointIndex)));
+    }
+    appendSegment(std::shared_ptr<RouteSegment>(new RouteSegment(to->road, targetsPointIndices[targetIndex], to->pointIndex)));
+    if(route.size() < 2)
+        return false;
+
+    // Route through forbidden turn is wrong, so it's left to A*, which respects restrictions
+    for(auto segmentIdx = 1; segmentIdx < route.size(); segmentIdx++)
+    {
+        if(!isRouteTurnAllowed(context->owner, route[segmentIdx - 1], route[segmentIdx]))
+        {
+            LogPrintf(LogSeverityLevel::Debug, "Route using hierarchy turns against restriction from road %llu to %llu",
+                route[segmentIdx - 1]->road->id, route[segmentIdx]->road->id);
+            return false;
+        }
+    }
+
+    LogPrintf(LogSeverityLevel::Debug, "Route using hierarchy: cost %f, %d pieces, %f ms",
+        cost, pieces.size(), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - calculationBegin).count());
+
+    outResult = prepareResult(context, route, leftSideNavigation);
+    return outResult.warnMessage.isEmpty();
+}
@@ -0,0 +1,278 @@
+#include "RoutePlanner.h"
+
+#include <cassert>
+
+#include <QtCore>
+
+#include "Road.h"
+#include "Common.h"
+#include "Logging.h"
+#include "Utilities.h"
+#include "Concurrent.h"
+
+OsmAnd::RoutePlanner::MatrixPoint::MatrixPoint()
+    : pointIndex(0)
+    , extraTime(0.0f)
+    , extraDistance(0.0f)
+{
+}
+
+OsmAnd::RouteMatrixResult OsmAnd::RoutePlanner::calculateRouteMatrix(
+    OsmAnd::RoutePlannerContext* context,
+    const QList< std::pair<double, double> >& sources,
+    const QList< std::pair<double, double> >& targets,
+    const IQueryController* const controller /*= nullptr*/)
+{
+    assert(context != nullptr);
+
+    OsmAnd::RouteMatrixResult result;
+    result.sourcesCount = sources.size();
+    result.targetsCount = targets.size();
+    result.times.fill(-1.0f, sources.size() * targets.size());
+    result.distances.fill(-1.0f, sources.size() * targets.size());
+    if(sources.isEmpty() || targets.isEmpty())
+        return result;
+
+    // Snap every location only once
+    QVector<RoadSegmentProjection> projections;
+    findClosestRoadPoints(context, sources + targets, projections, controller);
+    QVector<MatrixPoint> sourcePoints(sources.size());
+    for(auto idx = 0; idx < sources.size(); idx++)
+        snapMatrixPoint(context, projections[idx], sourcePoints[idx]);
+    QVector<MatrixPoint> targetPoints(targets.size());
+    for(auto idx = 0; idx < targets.size(); idx++)
+        snapMatrixPoint(context, projections[sources.size() + idx], targetPoints[idx]);
+
+    // Targets are registered same way as visited segments of reverse search, so that search from each source
+    // detects target when it reaches its point moving along road. Set is only read while rows are calculated
+    SegmentsRegistry targetSegmentsRegistry;
+    VisitedSegments targetSegments(&targetSegmentsRegistry);
+    QHash< uint64_t, QList<int> > targetsByRoutePoint;
+    for(auto idx = 0; idx < targetPoints.size(); idx++)
+    {
+        const auto& target = targetPoints[idx];
+        if(!target.road)
+            continue;
+
+        const auto routePointId = encodeRoutePointId(target.road, target.pointIndex);
+        auto itTargets = targetsByRoutePoint.find(routePointId);
+        if(itTargets == targetsByRoutePoint.end())
+        {
+            itTargets = targetsByRoutePoint.insert(routePointId, QList<int>());
+
+            std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> segment(new RoutePlannerContext::RouteCalculationSegment(target.road, target.pointIndex));
+            if(target.pointIndex + 1 < target.road->points.size())
+                targetSegments.insert(encodeRoutePointId(target.road, target.pointIndex, true), segment);
+            if(target.pointIndex > 0)
+                targetSegments.insert(encodeRoutePointId(target.road, target.pointIndex - 1, false), segment);
+        }
+        itTargets->push_back(idx);
+    }
+    if(targetsByRoutePoint.isEmpty())
+    {
+        result.warnMessage = "Target points were not found";
+        return result;
+    }
+
+    // Each row is calculated by separate task, that writes only own part of matrix
+    const auto pTimes = result.times.data();
+    const auto pDistances = result.distances.data();
+    QSemaphore finishedRows;
+    QAtomicInt memoryLimitExceeded(0);
+    QAtomicInt runningRowsSizeKb(0);
+    auto startedRows = 0;
+    for(auto idx = 0; idx < sourcePoints.size(); idx++)
+    {
+        const auto& source = sourcePoints[idx];
+        if(!source.road)
+            continue;
+
+        const auto rowOffset = idx * targets.size();
+        Concurrent::pools->routing->start(new Concurrent::Task([context, &source, &targetPoints, &targetSegments, &targetsByRoutePoint, pTimes, pDistances, rowOffset, &finishedRows, &memoryLimitExceeded, &runningRowsSizeKb, controller](const Concurrent::Task* task, QEventLoop& eventLoop)
+            {
+                if(!calculateRouteMatrixRow(context, source, targetPoints, targetSegments, targetsByRoutePoint, pTimes + rowOffset, pDistances + rowOffset, runningRowsSizeKb, controller))
+                    memoryLimitExceeded.store(1);
+                finishedRows.release();
+            }));
+        startedRows++;
+    }
+    finishedRows.acquire(startedRows);
+
+    QStringList warnings;
+    if(startedRows != sourcePoints.size())
+        warnings.push_back("Some of source points were not found");
+    if(memoryLimitExceeded.load())
+        warnings.push_back("There is no enough memory " + QString::number(context->_memoryUsageLimit/(1<<20)) + " Mb");
+    if(controller && controller->isAborted())
+        warnings.push_back("Aborted");
+    result.warnMessage = warnings.join("; ");
+
+    return result;
+}
+
+void OsmAnd::RoutePlanner::snapMatrixPoint(
+    OsmAnd::RoutePlannerContext* context,
+    const RoadSegmentProjection& projection,
+    MatrixPoint& outPoint)
+{
+    if(!projection.road)
+        return;
+
+    const auto& road = projection.road;
+    const auto pointIndex = projection.pointIndex;
+    const auto rx31 = projection.x31;
+    const auto ry31 = projection.y31;
+
+    // Projection lies between previous and given points, so nearest of them is taken. Unlike findClosestRouteSegment(),
+    // road is not split at projection, so that all searches traverse same roads
+    const auto& prevPoint = road->points[pointIndex - 1];
+    const auto& point = road->points[pointIndex];
+    const auto distanceToPrev = Utilities::distance31(rx31, ry31, prevPoint.x, prevPoint.y);
+    const auto distanceToNext = Utilities::distance31(rx31, ry31, point.x, point.y);
+
+    outPoint.road = road;
+    outPoint.pointIndex = distanceToPrev < distanceToNext ? pointIndex - 1 : pointIndex;
+    outPoint.extraDistance = qMin(distanceToPrev, distanceToNext);
+    outPoint.extraTime = outPoint.extraDistance / calculateRoadSpeed(context, road);
+}
+
+bool OsmAnd::RoutePlanner::calculateRouteMatrixRow(
+    OsmAnd::RoutePlannerContext* context,
+    const MatrixPoint& source,
+    const QVector<MatrixPoint>& targets,
+    VisitedSegments& targetSegments,
+    const QHash< uint64_t, QList<int> >& targetsByRoutePoint,
+    float* outTimes,
+    float* outDistances,
+    QAtomicInt& runningRowsSizeKb,
+    const IQueryController* const controller)
+{
+    std::unique_ptr<RoutePlannerContext::CalculationContext> calculationContext(new RoutePlannerContext::CalculationContext(context));
+    calculationContext->_startPoint = source.road->points[source.pointIndex];
+    calculationContext->_targetPoint = calculationContext->_startPoint;
+
+    // Without heuristic, segments are taken from queue in order of time from source (Dijkstra)
+    SegmentsRegistry segmentsRegistry;
+    RoadSegmentsPriorityQueue graphSegments(&segmentsRegistry, 0.0);
+    VisitedSegments visitedSegments(&segmentsRegistry);
+
+    QSet<uint64_t> reachedRoutePoints;
+    const auto reach = [&](uint64_t routePointId, float time, float distance)
+    {
+        if(reachedRoutePoints.contains(routePointId))
+            return;
+        reachedRoutePoints.insert(routePointId);
+
+        const auto& targetsIndices = *targetsByRoutePoint.constFind(routePointId);
+        for(auto itTargetIdx = targetsIndices.cbegin(); itTargetIdx != targetsIndices.cend(); ++itTargetIdx)
+        {
+            const auto& target = targets[*itTargetIdx];
+            outTimes[*itTargetIdx] = source.extraTime + time + target.extraTime;
+            outDistances[*itTargetIdx] = source.extraDistance + distance + target.extraDistance;
+        }
+    };
+
+    // Time bound, since row can not settle targets that are unreachable from source
+    auto timeLimit = std::numeric_limits<float>::max();
+    if(context->_matrixTimeLimitFactor > 0)
+    {
+        auto farthestTargetTime = 0.0f;
+        for(auto itTarget = targets.cbegin(); itTarget != targets.cend(); ++itTarget)
+        {
+            if(!itTarget->road)
+                continue;
+            const auto targetTime = estimateTimeDistance(calculationContext.get(), calculationContext->_startPoint, itTarget->road->points[itTarget->pointIndex]);
+            farthestTargetTime = qMax(farthestTargetTime, targetTime);
+        }
+        timeLimit = context->_matrixTimeLimitFactor * farthestTargetTime;
+    }
+
+    std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> start(new RoutePlannerContext::RouteCalculationSegment(source.road, source.pointIndex));
+    graphSegments.push(start);
+
+    auto completed = true;
+    auto reportedRowSizeKb = 0;
+    while(!graphSegments.empty() && reachedRoutePoints.size() < targetsByRoutePoint.size())
+    {
+        auto segment = graphSegments.top();
+        graphSegments.pop();
+
+        // Segments are taken in order of time, so none of remaining ones is within limit
+        if(segment->_distanceFromStart > timeLimit)
+            break;
+        // Segments of all running rows are counted together with tiles, since they are not limited otherwise
+        const auto rowSizeKb = static_cast<int>((segmentsRegistry.getMemorySize() + visitedSegments.getMemorySize()) >> 10);
+        if(rowSizeKb != reportedRowSizeKb)
+        {
+            runningRowsSizeKb.fetchAndAddOrdered(rowSizeKb - reportedRowSizeKb);
+            reportedRowSizeKb = rowSizeKb;
+        }
+        const auto runningRowsSize = static_cast<size_t>(runningRowsSizeKb.load()) << 10;
+        if(context->getCurrentEstimatedSize() + runningRowsSize > context->_memoryUsageLimit)
+        {
+            completed = false;
+            break;
+        }
+
+        if(const auto finalSegment = dynamic_cast<RoutePlannerContext::RouteCalculationFinalSegment*>(segment.get()))
+        {
+            // Target was reached moving along road
+            const auto& target = finalSegment->_opposite;
+            reach(encodeRoutePointId(target->road, target->pointIndex),
+                finalSegment->_distanceFromStart,
+                calculateSegmentsChainDistance(segment, target->pointIndex));
+
+            // Search along this road was stopped at target, but other targets may lie further on it
+            std::shared_ptr<RoutePlannerContext::RouteCalculationSegment> continuation(new RoutePlannerContext::RouteCalculationSegment(segment->road, target->pointIndex));
+            continuation->_parent = segment;
+            continuation->_parentEndPointIndex = target->pointIndex;
+            continuation->_distanceFromStart = segment->_distanceFromStart;
+            continuation->_allowedDirection = target->pointIndex > segment->pointIndex ? 1 : -1;
+            graphSegments.push(continuation);
+            continue;
+        }
+
+        // Target was reached from other road, or it's same point as source
+        const auto routePointId = encodeRoutePointId(segment->road, segment->pointIndex);
+        if(targetsByRoutePoint.contains(routePointId))
+        {
+            reach(routePointId,
+                segment->_distanceFromStart,
+                segment->_parent ? calculateSegmentsChainDistance(segment->_parent, segment->_parentEndPointIndex) : 0.0f);
+        }
+
+        calculateRouteSegment(calculationContext.get(), false, graphSegments, visitedSegments, segment, targetSegments, true);
+        calculateRouteSegment(calculationContext.get(), false, graphSegments, visitedSegments, segment, targetSegments, false);
+
+        if(controller && controller->isAborted())
+            break;
+    }
+
+    // Segments of this row are released on return, so they no longer count against limit
+    runningRowsSizeKb.fetchAndAddOrdered(-reportedRowSizeKb);
+
+    return completed;
+}
+
+float OsmAnd::RoutePlanner::calculateSegmentsChainDistance(
+    const std::shared_ptr<RoutePlannerContext::RouteCalculationSegment>& segment,
+    uint32_t endPointIndex)
+{
+    auto distance = 0.0;
+
+    auto current = segment;
+    auto currentEndPointIndex = endPointIndex;
+    while(current)
+    {
+        const auto& points = current->road->points;
+        const auto fromIdx = qMin(current->pointIndex, currentEndPointIndex);
+        const auto toIdx = qMax(current->pointIndex, currentEndPointIndex);
+        for(auto idx = fromIdx; idx < toIdx; idx++)
+            distance += Utilities::distance31(points[idx].x, points[idx].y, points[idx + 1].x, points[idx + 1].y);
+
+        currentEndPointIndex = current->_parentEndPointIndex;
+        current = current->_parent;
+    }
+
+    return static_cast<float>(distance);
+}
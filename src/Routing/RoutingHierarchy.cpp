@@ -0,0 +1,689 @@
+#include "RoutingHierarchy.h"
+
+#include <cassert>
+#include <limits>
+#include <queue>
+#include <functional>
+#include <chrono>
+
+#include <QFile>
+#include <QDataStream>
+
+#include "IQueryController.h"
+#include "Logging.h"
+
+namespace {
+
+    struct DynamicArc
+    {
+        int node;
+        float cost;
+        int middle;
+        int piece;
+    };
+
+    // Arcs between nodes that are not contracted yet
+    struct ContractionGraph
+    {
+        ContractionGraph(int nodesCount)
+            : outArcs(nodesCount)
+            , inArcs(nodesCount)
+        {
+        }
+
+        QVector< QVector<DynamicArc> > outArcs;
+        QVector< QVector<DynamicArc> > inArcs;
+
+        void addArc(int source, int target, float cost, int middle, int piece)
+        {
+            // Only cheapest of parallel arcs is kept
+            auto& sourceOutArcs = outArcs[source];
+            for(auto itArc = sourceOutArcs.begin(); itArc != sourceOutArcs.end(); ++itArc)
+            {
+                if(itArc->node != target)
+                    continue;
+                if(!(cost < itArc->cost))
+                    return;
+
+                itArc->cost = cost;
+                itArc->middle = middle;
+                itArc->piece = piece;
+                auto& targetInArcs = inArcs[target];
+                for(auto itInArc = targetInArcs.begin(); itInArc != targetInArcs.end(); ++itInArc)
+                {
+                    if(itInArc->node != source)
+                        continue;
+                    itInArc->cost = cost;
+                    itInArc->middle = middle;
+                    itInArc->piece = piece;
+                    break;
+                }
+                return;
+            }
+
+            DynamicArc arc;
+            arc.cost = cost;
+            arc.middle = middle;
+            arc.piece = piece;
+            arc.node = target;
+            sourceOutArcs.push_back(arc);
+            arc.node = source;
+            inArcs[target].push_back(arc);
+        }
+
+        void detach(int node)
+        {
+            const auto removeArcsTo = [node](QVector<DynamicArc>& arcs)
+            {
+                for(auto idx = 0; idx < arcs.size();)
+                {
+                    if(arcs[idx].node == node)
+                    {
+                        arcs[idx] = arcs.last();
+                        arcs.pop_back();
+                    }
+                    else
+                        idx++;
+                }
+            };
+
+            for(auto itArc = outArcs[node].cbegin(); itArc != outArcs[node].cend(); ++itArc)
+                removeArcsTo(inArcs[itArc->node]);
+            for(auto itArc = inArcs[node].cbegin(); itArc != inArcs[node].cend(); ++itArc)
+                removeArcsTo(outArcs[itArc->node]);
+            outArcs[node].clear();
+            inArcs[node].clear();
+        }
+    };
+
+    typedef std::pair<float, int> QueueItem;
+    typedef std::priority_queue< QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > MinQueue;
+
+    // Dijkstra search limited by cost and count of settled nodes, that looks for paths that avoid contracted node
+    struct WitnessSearch
+    {
+        WitnessSearch(int nodesCount)
+            : distances(nodesCount, std::numeric_limits<float>::infinity())
+        {
+        }
+
+        QVector<float> distances;
+        QVector<int> touched;
+
+        void run(const ContractionGraph& graph, int source, int ignored, float maxCost, int settledNodesLimit)
+        {
+            for(auto itNode = touched.cbegin(); itNode != touched.cend(); ++itNode)
+                distances[*itNode] = std::numeric_limits<float>::infinity();
+            touched.clear();
+
+            MinQueue queue;
+            distances[source] = 0.0f;
+            touched.push_back(source);
+            queue.push(QueueItem(0.0f, source));
+
+            auto settledNodes = 0;
+            while(!queue.empty())
+            {
+                const auto item = queue.top();
+                queue.pop();
+                if(item.first > distances[item.second])
+                    continue;
+                if(item.first > maxCost || ++settledNodes > settledNodesLimit)
+                    break;
+
+                const auto& arcs = graph.outArcs[item.second];
+                for(auto itArc = arcs.cbegin(); itArc != arcs.cend(); ++itArc)
+                {
+                    if(itArc->node == ignored)
+                        continue;
+
+                    const auto distance = item.first + itArc->cost;
+                    auto& knownDistance = distances[itArc->node];
+                    if(!(distance < knownDistance))
+                        continue;
+                    if(knownDistance == std::numeric_limits<float>::infinity())
+                        touched.push_back(itArc->node);
+                    knownDistance = distance;
+                    queue.push(QueueItem(distance, itArc->node));
+                }
+            }
+        }
+    };
+
+    // Returns count of shortcuts needed to contract node, and adds them if requested
+    int contractNode(ContractionGraph& graph, WitnessSearch& witnessSearch, int node, bool addShortcuts, int settledNodesLimit)
+    {
+        auto shortcutsCount = 0;
+
+        // Copies, since shortcuts are added to arcs of neighbours
+        const auto inArcs = graph.inArcs[node];
+        const auto outArcs = graph.outArcs[node];
+        for(auto itInArc = inArcs.cbegin(); itInArc != inArcs.cend(); ++itInArc)
+        {
+            auto maxCost = -1.0f;
+            for(auto itOutArc = outArcs.cbegin(); itOutArc != outArcs.cend(); ++itOutArc)
+            {
+                if(itOutArc->node != itInArc->node)
+                    maxCost = qMax(maxCost, itInArc->cost + itOutArc->cost);
+            }
+            if(maxCost < 0.0f)
+                continue;
+
+            witnessSearch.run(graph, itInArc->node, node, maxCost, settledNodesLimit);
+            for(auto itOutArc = outArcs.cbegin(); itOutArc != outArcs.cend(); ++itOutArc)
+            {
+                if(itOutArc->node == itInArc->node)
+                    continue;
+
+                const auto cost = itInArc->cost + itOutArc->cost;
+                if(witnessSearch.distances[itOutArc->node] <= cost)
+                    continue;
+
+                shortcutsCount++;
+                if(addShortcuts)
+                    graph.addArc(itInArc->node, itOutArc->node, cost, node, -1);
+            }
+        }
+
+        return shortcutsCount;
+    }
+
+} // namespace
+
+OsmAnd::RoutingHierarchy::RoutingHierarchy( const QString& profileName_, uint32_t profileParametersHash_, uint64_t obfCreationTimestamp_ )
+    : _profileName(profileName_)
+    , _profileParametersHash(profileParametersHash_)
+    , _obfCreationTimestamp(obfCreationTimestamp_)
+    , profileName(_profileName)
+    , profileParametersHash(_profileParametersHash)
+    , obfCreationTimestamp(_obfCreationTimestamp)
+{
+}
+
+OsmAnd::RoutingHierarchy::~RoutingHierarchy()
+{
+}
+
+uint64_t OsmAnd::RoutingHierarchy::locationKey( const PointI& location31 )
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(location31.x)) << 32) | static_cast<uint32_t>(location31.y);
+}
+
+void OsmAnd::RoutingHierarchy::indexNodesLocations()
+{
+    _nodesByLocation.clear();
+    _nodesByLocation.reserve(_nodesLocations.size());
+    for(auto node = 0; node < _nodesLocations.size(); node++)
+        _nodesByLocation.insert(locationKey(_nodesLocations[node]), node);
+}
+
+int OsmAnd::RoutingHierarchy::getNodesCount() const
+{
+    return _nodesLocations.size();
+}
+
+int OsmAnd::RoutingHierarchy::getEdgesCount() const
+{
+    return _edges.size();
+}
+
+const OsmAnd::PointI& OsmAnd::RoutingHierarchy::getNodeLocation( int node ) const
+{
+    return _nodesLocations[node];
+}
+
+int OsmAnd::RoutingHierarchy::findNode( const PointI& location31 ) const
+{
+    return _nodesByLocation.value(locationKey(location31), -1);
+}
+
+int OsmAnd::RoutingHierarchy::findEdge( int owner, int target, bool outgoing ) const
+{
+    auto result = -1;
+    for(auto edgeIdx = _firstEdges[owner]; edgeIdx < _firstEdges[owner + 1]; edgeIdx++)
+    {
+        const auto& edge = _edges[edgeIdx];
+        if(edge.target != target || edge.outgoing != outgoing)
+            continue;
+        if(result < 0 || edge.cost < _edges[result].cost)
+            result = edgeIdx;
+    }
+    return result;
+}
+
+bool OsmAnd::RoutingHierarchy::checkIntegrity() const
+{
+    const auto nodesCount = _nodesLocations.size();
+    const auto edgesCount = _edges.size();
+    if(_firstEdges.size() != nodesCount + 1 || _nodesRanks.size() != nodesCount)
+        return false;
+    for(auto node = 0; node < nodesCount; node++)
+    {
+        if(_firstEdges[node] < 0 || _firstEdges[node] > _firstEdges[node + 1] || _firstEdges[node + 1] > edgesCount)
+            return false;
+    }
+
+    // Edges are indexed first, since halves of shortcuts are looked up by findEdge()
+    for(auto owner = 0; owner < nodesCount; owner++)
+    {
+        for(auto edgeIdx = _firstEdges[owner]; edgeIdx < _firstEdges[owner + 1]; edgeIdx++)
+        {
+            const auto& edge = _edges[edgeIdx];
+            if(edge.target < 0 || edge.target >= nodesCount)
+                return false;
+            if(edge.middle < 0)
+            {
+                if(edge.piece < 0 || edge.piece >= _pieces.size())
+                    return false;
+                continue;
+            }
+            if(edge.middle >= nodesCount)
+                return false;
+        }
+    }
+
+    // Halves of shortcut are stored at its middle node, which has lower rank than both ends, so unpacking terminates
+    for(auto owner = 0; owner < nodesCount; owner++)
+    {
+        for(auto edgeIdx = _firstEdges[owner]; edgeIdx < _firstEdges[owner + 1]; edgeIdx++)
+        {
+            const auto& edge = _edges[edgeIdx];
+            if(edge.middle < 0)
+                continue;
+
+            const auto middleRank = _nodesRanks[edge.middle];
+            if(middleRank >= _nodesRanks[owner] || middleRank >= _nodesRanks[edge.target])
+                return false;
+            const auto from = edge.outgoing ? owner : edge.target;
+            const auto to = edge.outgoing ? edge.target : owner;
+            if(findEdge(edge.middle, from, false) < 0 || findEdge(edge.middle, to, true) < 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void OsmAnd::RoutingHierarchy::unpackArc( int from, int to, const Edge& edge, QList<RoadPiece>& outPieces, QList<int>& outNodes ) const
+{
+    if(edge.middle < 0)
+    {
+        outPieces.push_back(_pieces[edge.piece]);
+        outNodes.push_back(from);
+        return;
+    }
+
+    // Both halves of shortcut are stored at its middle node, since it has lower rank than both ends
+    const auto firstHalf = findEdge(edge.middle, from, false);
+    const auto secondHalf = findEdge(edge.middle, to, true);
+    assert(firstHalf >= 0 && secondHalf >= 0);
+
+    unpackArc(from, edge.middle, _edges[firstHalf], outPieces, outNodes);
+    unpackArc(edge.middle, to, _edges[secondHalf], outPieces, outNodes);
+}
+
+bool OsmAnd::RoutingHierarchy::findPath(
+    const QList<Endpoint>& sources, const QList<Endpoint>& targets,
+    QList<RoadPiece>& outPieces, QList<int>& outNodes,
+    float& outCost, int& outSourceIndex, int& outTargetIndex,
+    const IQueryController* const controller /*= nullptr*/ ) const
+{
+    // Node is reached either by edge from its owner (owner, edge index) or is an endpoint (-1, endpoint index)
+    typedef std::pair<int, int> Parent;
+
+    QHash<int, float> distances[2];
+    QHash<int, Parent> parents[2];
+    MinQueue queues[2];
+    const QList<Endpoint>* endpoints[2] = { &sources, &targets };
+    for(auto direction = 0; direction < 2; direction++)
+    {
+        const auto& directionEndpoints = *endpoints[direction];
+        for(auto endpointIdx = 0; endpointIdx < directionEndpoints.size(); endpointIdx++)
+        {
+            const auto& endpoint = directionEndpoints[endpointIdx];
+            const auto itDistance = distances[direction].constFind(endpoint.node);
+            if(itDistance != distances[direction].cend() && !(endpoint.cost < *itDistance))
+                continue;
+
+            distances[direction].insert(endpoint.node, endpoint.cost);
+            parents[direction].insert(endpoint.node, Parent(-1, endpointIdx));
+            queues[direction].push(QueueItem(endpoint.cost, endpoint.node));
+        }
+    }
+
+    // Both searches go only upwards, so they stop when cheapest queued node is not cheaper than best known path
+    auto bestCost = std::numeric_limits<float>::infinity();
+    auto meetingNode = -1;
+    for(;;)
+    {
+        if(controller && controller->isAborted())
+            return false;
+
+        const auto forwardMin = queues[0].empty() ? std::numeric_limits<float>::infinity() : queues[0].top().first;
+        const auto backwardMin = queues[1].empty() ? std::numeric_limits<float>::infinity() : queues[1].top().first;
+        if(!(qMin(forwardMin, backwardMin) < bestCost))
+            break;
+
+        const auto direction = (forwardMin <= backwardMin) ? 0 : 1;
+        auto& queue = queues[direction];
+        auto& directionDistances = distances[direction];
+        const auto item = queue.top();
+        queue.pop();
+        const auto node = item.second;
+        if(item.first > directionDistances[node])
+            continue;
+
+        const auto itOppositeDistance = distances[1 - direction].constFind(node);
+        if(itOppositeDistance != distances[1 - direction].cend() && item.first + *itOppositeDistance < bestCost)
+        {
+            bestCost = item.first + *itOppositeDistance;
+            meetingNode = node;
+        }
+
+        const auto outgoing = (direction == 0);
+        for(auto edgeIdx = _firstEdges[node]; edgeIdx < _firstEdges[node + 1]; edgeIdx++)
+        {
+            const auto& edge = _edges[edgeIdx];
+            if(edge.outgoing != outgoing)
+                continue;
+
+            const auto distance = item.first + edge.cost;
+            const auto itDistance = directionDistances.constFind(edge.target);
+            if(itDistance != directionDistances.cend() && !(distance < *itDistance))
+                continue;
+
+            directionDistances.insert(edge.target, distance);
+            parents[direction].insert(edge.target, Parent(node, edgeIdx));
+            queue.push(QueueItem(distance, edge.target));
+        }
+    }
+    if(meetingNode < 0)
+        return false;
+
+    outPieces.clear();
+    outNodes.clear();
+
+    // Forward part is collected from meeting node down to source, so it's unpacked in reverse order
+    QList<Parent> forwardChain;
+    for(auto node = meetingNode;;)
+    {
+        const auto& parent = parents[0][node];
+        if(parent.first < 0)
+        {
+            outSourceIndex = parent.second;
+            break;
+        }
+        forwardChain.push_front(parent);
+        node = parent.first;
+    }
+    for(auto itParent = forwardChain.cbegin(); itParent != forwardChain.cend(); ++itParent)
+    {
+        const auto& edge = _edges[itParent->second];
+        unpackArc(itParent->first, edge.target, edge, outPieces, outNodes);
+    }
+
+    auto node = meetingNode;
+    for(;;)
+    {
+        const auto& parent = parents[1][node];
+        if(parent.first < 0)
+        {
+            outTargetIndex = parent.second;
+            break;
+        }
+        unpackArc(node, parent.first, _edges[parent.second], outPieces, outNodes);
+        node = parent.first;
+    }
+    outNodes.push_back(node);
+
+    outCost = bestCost;
+    return true;
+}
+
+bool OsmAnd::RoutingHierarchy::saveTo( const QString& fileName ) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << static_cast<quint32>(FileSignature) << static_cast<quint32>(FileVersion);
+    stream << _profileName << static_cast<quint32>(_profileParametersHash) << static_cast<quint64>(_obfCreationTimestamp);
+
+    stream << static_cast<qint32>(_nodesLocations.size());
+    for(auto node = 0; node < _nodesLocations.size(); node++)
+    {
+        stream << static_cast<qint32>(_nodesLocations[node].x) << static_cast<qint32>(_nodesLocations[node].y);
+        stream << static_cast<qint32>(_nodesRanks[node]);
+        stream << static_cast<qint32>(_firstEdges[node]);
+    }
+
+    stream << static_cast<qint32>(_edges.size());
+    for(auto itEdge = _edges.cbegin(); itEdge != _edges.cend(); ++itEdge)
+    {
+        stream << static_cast<qint32>(itEdge->target) << itEdge->cost;
+        stream << static_cast<qint32>(itEdge->middle) << static_cast<qint32>(itEdge->piece);
+        stream << static_cast<quint8>(itEdge->outgoing ? 1 : 0);
+    }
+
+    stream << static_cast<qint32>(_pieces.size());
+    for(auto itPiece = _pieces.cbegin(); itPiece != _pieces.cend(); ++itPiece)
+    {
+        stream << static_cast<quint64>(itPiece->roadId);
+        stream << static_cast<quint32>(itPiece->startPointIndex) << static_cast<quint32>(itPiece->endPointIndex);
+    }
+
+    const auto ok = (stream.status() == QDataStream::Ok);
+    file.close();
+    if(!ok)
+        file.remove();
+    return ok;
+}
+
+std::shared_ptr<OsmAnd::RoutingHierarchy> OsmAnd::RoutingHierarchy::loadFrom( const QString& fileName )
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 signature, version;
+    stream >> signature >> version;
+    if(signature != FileSignature || version != FileVersion)
+    {
+        LogPrintf(LogSeverityLevel::Warning, "'%s' is not a routing hierarchy of supported version", qPrintable(fileName));
+        return nullptr;
+    }
+
+    QString profileName;
+    quint32 profileParametersHash;
+    quint64 obfCreationTimestamp;
+    stream >> profileName >> profileParametersHash >> obfCreationTimestamp;
+    std::shared_ptr<RoutingHierarchy> hierarchy(new RoutingHierarchy(profileName, profileParametersHash, obfCreationTimestamp));
+
+    // Counts are bounded by what is left in file, so that corrupted one does not allocate arbitrary amount of memory
+    const auto isTruncated = [&file, &fileName](qint32 count, qint64 recordSize) -> bool
+    {
+        if(count >= 0 && count <= (file.size() - file.pos()) / recordSize)
+            return false;
+        LogPrintf(LogSeverityLevel::Warning, "Routing hierarchy '%s' is truncated", qPrintable(fileName));
+        return true;
+    };
+
+    qint32 nodesCount;
+    stream >> nodesCount;
+    if(stream.status() != QDataStream::Ok || isTruncated(nodesCount, NodeRecordSize))
+        return nullptr;
+    hierarchy->_nodesLocations.resize(nodesCount);
+    hierarchy->_nodesRanks.resize(nodesCount);
+    hierarchy->_firstEdges.resize(nodesCount + 1);
+    for(auto node = 0; node < nodesCount; node++)
+    {
+        qint32 x, y, rank, firstEdge;
+        stream >> x >> y >> rank >> firstEdge;
+        hierarchy->_nodesLocations[node] = PointI(x, y);
+        hierarchy->_nodesRanks[node] = rank;
+        hierarchy->_firstEdges[node] = firstEdge;
+    }
+
+    qint32 edgesCount;
+    stream >> edgesCount;
+    if(stream.status() != QDataStream::Ok || isTruncated(edgesCount, EdgeRecordSize))
+        return nullptr;
+    hierarchy->_firstEdges[nodesCount] = edgesCount;
+    hierarchy->_edges.resize(edgesCount);
+    for(auto itEdge = hierarchy->_edges.begin(); itEdge != hierarchy->_edges.end(); ++itEdge)
+    {
+        qint32 target, middle, piece;
+        quint8 outgoing;
+        stream >> target >> itEdge->cost >> middle >> piece >> outgoing;
+        itEdge->target = target;
+        itEdge->middle = middle;
+        itEdge->piece = piece;
+        itEdge->outgoing = (outgoing != 0);
+    }
+
+    qint32 piecesCount;
+    stream >> piecesCount;
+    if(stream.status() != QDataStream::Ok || isTruncated(piecesCount, PieceRecordSize))
+        return nullptr;
+    hierarchy->_pieces.resize(piecesCount);
+    for(auto itPiece = hierarchy->_pieces.begin(); itPiece != hierarchy->_pieces.end(); ++itPiece)
+    {
+        quint64 roadId;
+        quint32 startPointIndex, endPointIndex;
+        stream >> roadId >> startPointIndex >> endPointIndex;
+        itPiece->roadId = roadId;
+        itPiece->startPointIndex = startPointIndex;
+        itPiece->endPointIndex = endPointIndex;
+    }
+
+    if(stream.status() != QDataStream::Ok)
+    {
+        LogPrintf(LogSeverityLevel::Warning, "Routing hierarchy '%s' is truncated", qPrintable(fileName));
+        return nullptr;
+    }
+    if(!hierarchy->checkIntegrity())
+    {
+        LogPrintf(LogSeverityLevel::Warning, "Routing hierarchy '%s' is corrupted", qPrintable(fileName));
+        return nullptr;
+    }
+
+    hierarchy->indexNodesLocations();
+    return hierarchy;
+}
+
+QString OsmAnd::RoutingHierarchy::getSidecarFileName( const QString& obfFileName, const QString& profileName )
+{
+    return obfFileName + QLatin1String(".") + profileName + QLatin1String(".rch");
+}
+
+std::shared_ptr<OsmAnd::RoutingHierarchy> OsmAnd::RoutingHierarchy::contract(
+    const QString& profileName, uint32_t profileParametersHash, uint64_t obfCreationTimestamp,
+    const QVector<PointI>& nodesLocations, const QVector<RoadPiece>& pieces, const QVector<Arc>& arcs,
+    const IQueryController* const controller /*= nullptr*/ )
+{
+    const auto contractionStart = std::chrono::steady_clock::now();
+    const auto nodesCount = nodesLocations.size();
+
+    ContractionGraph graph(nodesCount);
+    for(auto itArc = arcs.cbegin(); itArc != arcs.cend(); ++itArc)
+    {
+        if(itArc->source == itArc->target)
+            continue;
+        graph.addArc(itArc->source, itArc->target, itArc->cost, -1, itArc->piece);
+    }
+
+    // Nodes are contracted in order of edge difference (shortcuts added minus arcs removed), preferring nodes whose
+    // neighbours were not contracted yet, so that contraction spreads uniformly
+    WitnessSearch witnessSearch(nodesCount);
+    QVector<int> contractedNeighbours(nodesCount, 0);
+    const auto priorityOf = [&](int node) -> int
+    {
+        const auto shortcutsCount = contractNode(graph, witnessSearch, node, false, WitnessSearchSettledNodesLimit);
+        const auto arcsCount = graph.inArcs[node].size() + graph.outArcs[node].size();
+        return shortcutsCount - arcsCount + contractedNeighbours[node];
+    };
+    typedef std::pair<int, int> PriorityItem;
+    std::priority_queue< PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem> > contractionQueue;
+    for(auto node = 0; node < nodesCount; node++)
+        contractionQueue.push(PriorityItem(priorityOf(node), node));
+
+    std::shared_ptr<RoutingHierarchy> hierarchy(new RoutingHierarchy(profileName, profileParametersHash, obfCreationTimestamp));
+    hierarchy->_nodesLocations = nodesLocations;
+    hierarchy->_nodesRanks.fill(-1, nodesCount);
+    hierarchy->_pieces = pieces;
+
+    QVector< std::pair<int, Edge> > ownedEdges;
+    auto rank = 0;
+    while(!contractionQueue.empty())
+    {
+        if(controller && controller->isAborted())
+            return nullptr;
+
+        const auto node = contractionQueue.top().second;
+        contractionQueue.pop();
+        if(hierarchy->_nodesRanks[node] >= 0)
+            continue;
+
+        // Priorities of queued nodes are lazily updated: if node became worse than next one, it's postponed
+        const auto priority = priorityOf(node);
+        if(!contractionQueue.empty() && priority > contractionQueue.top().first)
+        {
+            contractionQueue.push(PriorityItem(priority, node));
+            continue;
+        }
+
+        // All remaining arcs of node lead to nodes that will get higher rank
+        Edge edge;
+        edge.outgoing = true;
+        for(auto itArc = graph.outArcs[node].cbegin(); itArc != graph.outArcs[node].cend(); ++itArc)
+        {
+            edge.target = itArc->node;
+            edge.cost = itArc->cost;
+            edge.middle = itArc->middle;
+            edge.piece = itArc->piece;
+            ownedEdges.push_back(std::make_pair(node, edge));
+            contractedNeighbours[itArc->node]++;
+        }
+        edge.outgoing = false;
+        for(auto itArc = graph.inArcs[node].cbegin(); itArc != graph.inArcs[node].cend(); ++itArc)
+        {
+            edge.target = itArc->node;
+            edge.cost = itArc->cost;
+            edge.middle = itArc->middle;
+            edge.piece = itArc->piece;
+            ownedEdges.push_back(std::make_pair(node, edge));
+            contractedNeighbours[itArc->node]++;
+        }
+
+        contractNode(graph, witnessSearch, node, true, WitnessSearchSettledNodesLimit);
+        graph.detach(node);
+        hierarchy->_nodesRanks[node] = rank++;
+    }
+
+    // Edges are grouped by owner node
+    hierarchy->_firstEdges.fill(0, nodesCount + 1);
+    for(auto itOwnedEdge = ownedEdges.cbegin(); itOwnedEdge != ownedEdges.cend(); ++itOwnedEdge)
+        hierarchy->_firstEdges[itOwnedEdge->first + 1]++;
+    for(auto node = 0; node < nodesCount; node++)
+        hierarchy->_firstEdges[node + 1] += hierarchy->_firstEdges[node];
+    hierarchy->_edges.resize(ownedEdges.size());
+    auto nextEdges = hierarchy->_firstEdges;
+    for(auto itOwnedEdge = ownedEdges.cbegin(); itOwnedEdge != ownedEdges.cend(); ++itOwnedEdge)
+        hierarchy->_edges[nextEdges[itOwnedEdge->first]++] = itOwnedEdge->second;
+
+    hierarchy->indexNodesLocations();
+
+    const auto contractionTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - contractionStart).count();
+    LogPrintf(LogSeverityLevel::Info, "Contracted %d nodes and %d arcs into %d edges, took %fms",
+        nodesCount, arcs.size(), hierarchy->_edges.size(), contractionTime);
+
+    return hierarchy;
+}
@@ -1,10 +1,13 @@
 #include "RoutingProfileContext.h"
 
+#include <QtAlgorithms>
+
 #include "ObfRoutingSectionInfo.h"
 #include "Road.h"
 
 OsmAnd::RoutingProfileContext::RoutingProfileContext( const std::shared_ptr<RoutingProfile>& profile, QHash<QString, QString>* contextValues /*= nullptr*/ )
-    : profile(profile)
+    : _evaluationCacheLock(QReadWriteLock::NonRecursive)
+    , profile(profile)
 {
     for(auto type = 0; type < RoutingRuleset::TypesCount; type++)
     {
@@ -24,6 +27,50 @@ std::shared_ptr<OsmAnd::RoutingRulesetContext> OsmAnd::RoutingProfileContext::ge
     return _rulesetContexts[static_cast<int>(type)];
 }
 
+bool OsmAnd::RoutingProfileContext::evaluateCached(
+    RoutingRulesetContext* const rulesetContext,
+    const std::shared_ptr<const ObfRoutingSectionInfo>& section,
+    const QVector<uint32_t>& roadTypes,
+    float& value )
+{
+    EvaluationKey key;
+    key.rulesetType = rulesetContext->ruleset->type;
+    key.section = section.get();
+    key.roadTypes = roadTypes;
+    {
+        QReadLocker scopedLocker(&_evaluationCacheLock);
+
+        const auto itResult = _evaluationCache.constFind(key);
+        if(itResult != _evaluationCache.cend())
+        {
+            value = itResult->value;
+            return itResult->isFound;
+        }
+    }
+
+    QWriteLocker scopedLocker(&_evaluationCacheLock);
+
+    // Other thread may have evaluated same key while lock was released
+    auto itResult = _evaluationCache.constFind(key);
+    if(itResult == _evaluationCache.cend())
+    {
+        EvaluationResult result;
+        result.value = 0.0f;
+        result.isFound = rulesetContext->evaluate(rulesetContext->encode(section, roadTypes), RoutingRuleExpression::ResultType::Float, &result.value);
+        itResult = _evaluationCache.insert(key, result);
+    }
+
+    value = itResult->value;
+    return itResult->isFound;
+}
+
+int OsmAnd::RoutingProfileContext::getEvaluationCacheSize() const
+{
+    QReadLocker scopedLocker(&_evaluationCacheLock);
+
+    return _evaluationCache.size();
+}
+
 OsmAnd::Model::RoadDirection OsmAnd::RoutingProfileContext::getDirection( const std::shared_ptr<const OsmAnd::Model::Road>& road )
 {
     auto value = getRulesetContext(RoutingRuleset::OneWay)->evaluateAsInteger(road, 0);
@@ -73,3 +120,30 @@ float OsmAnd::RoutingProfileContext::getRoutingObstaclesExtraTime( const std::sh
     auto value = getRulesetContext(RoutingRuleset::RoutingObstacles)->evaluateAsFloat(road->subsection->section, *itPointTypes, 0.0f);
     return value;
 }
+
+uint32_t OsmAnd::RoutingProfileContext::getParametersHash() const
+{
+    // qHash() of strings may be seeded differently in each run, so FNV-1a is used instead
+    uint32_t hash = 2166136261u;
+    const auto hashString = [&hash](const QString& value)
+    {
+        const auto pData = value.constData();
+        for(auto idx = 0; idx < value.size(); idx++)
+            hash = (hash ^ pData[idx].unicode()) * 16777619u;
+        hash = (hash ^ 0xFFFFu) * 16777619u;
+    };
+
+    hashString(profile->name);
+
+    // Values are same for all rulesets, and they are hashed in order of keys
+    const auto& contextValues = _rulesetContexts[0]->contextValues;
+    auto keys = contextValues.keys();
+    qSort(keys);
+    for(auto itKey = keys.cbegin(); itKey != keys.cend(); ++itKey)
+    {
+        hashString(*itKey);
+        hashString(contextValues.value(*itKey));
+    }
+
+    return hash;
+}
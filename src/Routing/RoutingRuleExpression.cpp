@@ -41,15 +41,9 @@ void OsmAnd::RoutingRuleExpression::registerAndTagValue( const QString& tag, con
     {
         auto valueType = ruleset->owner->registerTagValueAttribute(tag, value);
 
-        if(_filterNotTypes.size() <= valueType)
-            _filterNotTypes.resize(valueType + 1);
-        if(_filterTypes.size() <= valueType)
-            _filterTypes.resize(valueType + 1);
-
-        if(negation)
-            _filterNotTypes.setBit(valueType);
-        else
-            _filterTypes.setBit(valueType);
+        auto& filter = negation ? _filterNotTypes : _filterTypes;
+        if(!filter.contains(valueType))
+            filter.push_back(valueType);
     }
 }
 
@@ -129,17 +123,26 @@ bool OsmAnd::RoutingRuleExpression::validate( const QBitArray& types, RoutingRul
 
 bool OsmAnd::RoutingRuleExpression::validateAllTypesShouldBePresent( const QBitArray& types ) const
 {
-    const auto& intermediate = types & _filterTypes;
-    return intermediate.count(true) == _filterTypes.count(true);
+    for(auto itType = _filterTypes.cbegin(); itType != _filterTypes.cend(); ++itType)
+    {
+        const auto type = static_cast<int>(*itType);
+        if(type >= types.size() || !types.testBit(type))
+            return false;
+    }
+
+    return true;
 }
 
 bool OsmAnd::RoutingRuleExpression::validateAllTypesShouldNotBePresent( const QBitArray& types ) const
 {
-    if(_filterNotTypes.isEmpty())
-        return true;
+    for(auto itType = _filterNotTypes.cbegin(); itType != _filterNotTypes.cend(); ++itType)
+    {
+        const auto type = static_cast<int>(*itType);
+        if(type < types.size() && types.testBit(type))
+            return false;
+    }
 
-    const auto& intermediate = types & _filterNotTypes;
-    return intermediate.count(true) == 0;
+    return true;
 }
 
 bool OsmAnd::RoutingRuleExpression::validateFreeTags( const QBitArray& types ) const
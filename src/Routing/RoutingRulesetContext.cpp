@@ -67,7 +67,7 @@ float OsmAnd::RoutingRulesetContext::evaluateAsFloat( const std::shared_ptr<cons
 int OsmAnd::RoutingRulesetContext::evaluateAsInteger( const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes, int defaultValue )
 {
     int result;
-    if(!evaluate(encode(section, roadTypes), RoutingRuleExpression::ResultType::Integer, &result))
+    if(!evaluate(section, roadTypes, RoutingRuleExpression::ResultType::Integer, &result))
         return defaultValue;
     return result;
 }
@@ -75,14 +75,30 @@ int OsmAnd::RoutingRulesetContext::evaluateAsInteger( const std::shared_ptr<cons
 float OsmAnd::RoutingRulesetContext::evaluateAsFloat( const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes, float defaultValue )
 {
     float result;
-    if(!evaluate(encode(section, roadTypes), RoutingRuleExpression::ResultType::Float, &result))
+    if(!evaluate(section, roadTypes, RoutingRuleExpression::ResultType::Float, &result))
         return defaultValue;
     return result;
 }
 
 bool OsmAnd::RoutingRulesetContext::evaluate( const std::shared_ptr<const Model::Road>& road, RoutingRuleExpression::ResultType type, void* result )
 {
-    return evaluate(encode(road->subsection->section, road->types), type, result);
+    return evaluate(road->subsection->section, road->types, type, result);
+}
+
+bool OsmAnd::RoutingRulesetContext::evaluate( const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes, RoutingRuleExpression::ResultType type, void* result )
+{
+    // Integer result is a truncated float one, so only float is evaluated and cached
+    float value;
+    if(!owner->evaluateCached(this, section, roadTypes, value))
+        return false;
+
+    if(type == RoutingRuleExpression::ResultType::Float)
+        *reinterpret_cast<float*>(result) = value;
+    else if(type == RoutingRuleExpression::ResultType::Integer)
+        *reinterpret_cast<int*>(result) = (int)value;
+    else
+        return false;
+    return true;
 }
 
 bool OsmAnd::RoutingRulesetContext::evaluate( const QBitArray& types, RoutingRuleExpression::ResultType type, void* result )
@@ -97,9 +113,12 @@ bool OsmAnd::RoutingRulesetContext::evaluate( const QBitArray& types, RoutingRul
     return false;
 }
 
-QBitArray OsmAnd::RoutingRulesetContext::encode( const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes )
+const QBitArray& OsmAnd::RoutingRulesetContext::encode( const std::shared_ptr<const ObfRoutingSectionInfo>& section, const QVector<uint32_t>& roadTypes )
 {
-    QBitArray bitset(ruleset->owner->_universalRules.size());
+    auto& bitset = _encodedTypes;
+    if(bitset.size() < ruleset->owner->_universalRules.size())
+        bitset.resize(ruleset->owner->_universalRules.size());
+    bitset.fill(false);
     
     auto itTagValueAttribIdCache = owner->_tagValueAttribIdCache.find(section);
     if(itTagValueAttribIdCache == owner->_tagValueAttribIdCache.end())
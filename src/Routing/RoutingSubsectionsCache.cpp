@@ -0,0 +1,355 @@
+#include "RoutingSubsectionsCache.h"
+
+#include <cassert>
+
+#include "ObfReader.h"
+#include "ObfFile.h"
+#include "ObfInfo.h"
+#include "ObfRoutingSectionInfo.h"
+#include "ObfRoutingSectionInfo_P.h"
+#include "ObfRoutingSectionReader.h"
+
+OsmAnd::RoutingSubsectionData::RoutingSubsectionData()
+    : _memorySize(0)
+    , roads(_roads)
+    , memorySize(_memorySize)
+{
+}
+
+OsmAnd::RoutingSubsectionData::~RoutingSubsectionData()
+{
+}
+
+std::shared_ptr<const OsmAnd::RoutingSubsectionData> OsmAnd::RoutingSubsectionData::decode(
+    const std::shared_ptr<ObfReader>& origin,
+    const std::shared_ptr<const ObfRoutingSubsectionInfo>& subsection )
+{
+    std::shared_ptr<RoutingSubsectionData> data(new RoutingSubsectionData());
+    ObfRoutingSectionReader::loadSubsectionData(origin, subsection, nullptr, nullptr, nullptr,
+        [&data] (const std::shared_ptr<const OsmAnd::Model::Road>& road)
+        {
+            data->registerRoad(road);
+            return false;
+        }
+    );
+    data->buildJunctions();
+    return data;
+}
+
+void OsmAnd::RoutingSubsectionData::registerRoad( const std::shared_ptr<const Model::Road>& road )
+{
+    const auto roadIndex = _roads.size();
+    _roads.push_back(road);
+
+    const auto sizeBeforeRegistering = _roadsPoints.size();
+    RoadPoint roadPoint;
+    roadPoint.roadIndex = roadIndex;
+    roadPoint.pointIndex = 0;
+    for(auto itPoint = road->points.cbegin(); itPoint != road->points.cend(); ++itPoint, roadPoint.pointIndex++)
+        _roadsPoints[encodeLocationId(itPoint->x, itPoint->y)].push_back(roadPoint);
+
+    // Road with its control block and containers, per point: entry of location table, and per new location: node of it
+    auto size = sizeof(Model::Road) + 2 * sizeof(void*) + sizeof(std::shared_ptr<const Model::Road>);
+    size += road->points.capacity() * sizeof(PointI);
+    size += road->types.capacity() * sizeof(uint32_t);
+    for(auto itPointTypes = road->pointsTypes.cbegin(); itPointTypes != road->pointsTypes.cend(); ++itPointTypes)
+        size += 4 * sizeof(void*) + sizeof(uint32_t) + sizeof(QVector<uint32_t>) + itPointTypes->capacity() * sizeof(uint32_t);
+    for(auto itName = road->names.cbegin(); itName != road->names.cend(); ++itName)
+        size += 4 * sizeof(void*) + sizeof(uint32_t) + sizeof(QString) + itName->capacity() * sizeof(QChar);
+    size += road->restrictions.size() * (4 * sizeof(void*) + sizeof(uint64_t) + sizeof(Model::RoadRestriction));
+    size += road->points.size() * sizeof(RoadPoint);
+    size += (_roadsPoints.size() - sizeBeforeRegistering) * (2 * sizeof(void*) + sizeof(uint64_t) + sizeof(QVector<RoadPoint>));
+    _memorySize += size;
+
+    indexRoadSegments(roadIndex);
+}
+
+void OsmAnd::RoutingSubsectionData::indexRoadSegments( int roadIndex )
+{
+    const auto& road = _roads[roadIndex];
+    const auto sizeBeforeIndexing = _segmentsGrid.size();
+
+    const auto cellShift = 31 - SegmentsGridZoomLevel;
+    for(auto idx = 1; idx < road->points.size(); idx++)
+    {
+        const auto& a = road->points[idx - 1];
+        const auto& b = road->points[idx];
+
+        RoadPoint gridSegment;
+        gridSegment.roadIndex = roadIndex;
+        gridSegment.pointIndex = idx;
+
+        // Go through rows of cells crossed by segment, and take range of columns that segment occupies in each row
+        const int64_t top = qMin(a.y, b.y);
+        const int64_t bottom = qMax(a.y, b.y);
+        for(auto cellY = top >> cellShift; cellY <= (bottom >> cellShift); cellY++)
+        {
+            const auto rowTop = qMax(top, cellY << cellShift);
+            const auto rowBottom = qMin(bottom, ((cellY + 1) << cellShift) - 1);
+
+            int64_t x0 = a.x;
+            int64_t x1 = b.x;
+            if(a.y != b.y)
+            {
+                const auto dxdy = static_cast<double>(b.x - a.x) / (b.y - a.y);
+                x0 = a.x + static_cast<int64_t>(dxdy * (rowTop - a.y));
+                x1 = a.x + static_cast<int64_t>(dxdy * (rowBottom - a.y));
+            }
+
+            for(auto cellX = qMin(x0, x1) >> cellShift; cellX <= (qMax(x0, x1) >> cellShift); cellX++)
+            {
+                _segmentsGrid[encodeSegmentsGridCellId(cellX, cellY)].push_back(gridSegment);
+                _memorySize += sizeof(RoadPoint);
+            }
+        }
+    }
+
+    _memorySize += (_segmentsGrid.size() - sizeBeforeIndexing) * (2 * sizeof(void*) + sizeof(uint64_t) + sizeof(QVector<RoadPoint>));
+}
+
+void OsmAnd::RoutingSubsectionData::buildJunctions()
+{
+    for(auto itRoadsPoints = _roadsPoints.cbegin(); itRoadsPoints != _roadsPoints.cend(); ++itRoadsPoints)
+    {
+        const auto& roadsPoints = itRoadsPoints.value();
+        const auto count = roadsPoints.size();
+        if(count < 2)
+            continue;
+
+        std::shared_ptr<Junction> junction(new Junction());
+        junction->trafficSignals.resize(count);
+        junction->restrictions.fill(Model::RoadRestriction::Invalid, count * count);
+        junction->exclusiveRestrictionsTargets.resize(count);
+        for(auto idx = 0; idx < count; idx++)
+        {
+            const auto& road = _roads[roadsPoints[idx].roadIndex];
+            const auto pointIndex = roadsPoints[idx].pointIndex;
+
+            junction->roadsIds.push_back(road->id);
+            junction->pointsIndices.push_back(pointIndex);
+            junction->forwardDirections.push_back(road->getDirectionDelta(pointIndex, true));
+            junction->backwardDirections.push_back(road->getDirectionDelta(pointIndex, false));
+
+            const auto itPointTypes = road->pointsTypes.constFind(pointIndex);
+            if(itPointTypes != road->pointsTypes.cend())
+            {
+                for(auto itPointType = itPointTypes->cbegin(); itPointType != itPointTypes->cend(); ++itPointType)
+                {
+                    const auto& rule = road->subsection->section->_d->_encodingRules[*itPointType];
+                    if(rule->_tag == "highway" && rule->_value == "traffic_signals")
+                        junction->trafficSignals.setBit(idx);
+                }
+            }
+        }
+
+        for(auto from = 0; from < count; from++)
+        {
+            const auto& restrictions = _roads[roadsPoints[from].roadIndex]->restrictions;
+            if(restrictions.isEmpty())
+                continue;
+
+            for(auto to = 0; to < count; to++)
+            {
+                const auto itRestriction = restrictions.constFind(junction->roadsIds[to]);
+                if(itRestriction == restrictions.cend())
+                    continue;
+
+                const auto restriction = *itRestriction;
+                junction->restrictions[from * count + to] = restriction;
+                if(restriction == Model::RoadRestriction::OnlyRightTurn || restriction == Model::RoadRestriction::OnlyLeftTurn || restriction == Model::RoadRestriction::OnlyStraightOn)
+                    junction->exclusiveRestrictionsTargets[from].push_back(to);
+            }
+        }
+
+        _junctions.insert(itRoadsPoints.key(), junction);
+        _memorySize += 2 * sizeof(void*) + sizeof(uint64_t) + sizeof(std::shared_ptr<const Junction>) + sizeof(Junction);
+        _memorySize += count * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(double) + sizeof(QVector<int>));
+        _memorySize += count * count * sizeof(Model::RoadRestriction) + count / 8 + 1;
+    }
+}
+
+std::shared_ptr<const OsmAnd::RoutingSubsectionData::Junction> OsmAnd::RoutingSubsectionData::findJunction( uint32_t x31, uint32_t y31 ) const
+{
+    return _junctions.value(encodeLocationId(x31, y31));
+}
+
+int OsmAnd::RoutingSubsectionData::Junction::count() const
+{
+    return roadsIds.size();
+}
+
+int OsmAnd::RoutingSubsectionData::Junction::indexOf( uint64_t roadId, uint32_t pointIndex ) const
+{
+    for(auto idx = 0; idx < roadsIds.size(); idx++)
+    {
+        if(roadsIds[idx] == roadId && pointsIndices[idx] == pointIndex)
+            return idx;
+    }
+    return -1;
+}
+
+OsmAnd::Model::RoadRestriction OsmAnd::RoutingSubsectionData::Junction::getRestriction( int from, int to ) const
+{
+    return restrictions[from * roadsIds.size() + to];
+}
+
+const QVector<OsmAnd::RoutingSubsectionData::RoadPoint>* OsmAnd::RoutingSubsectionData::findRoadsPoints( uint32_t x31, uint32_t y31 ) const
+{
+    const auto itRoadsPoints = _roadsPoints.constFind(encodeLocationId(x31, y31));
+    if(itRoadsPoints == _roadsPoints.cend())
+        return nullptr;
+    return &(*itRoadsPoints);
+}
+
+const QVector<OsmAnd::RoutingSubsectionData::RoadPoint>* OsmAnd::RoutingSubsectionData::findSegmentsInCell( uint64_t cellId ) const
+{
+    const auto itCell = _segmentsGrid.constFind(cellId);
+    if(itCell == _segmentsGrid.cend())
+        return nullptr;
+    return &(*itCell);
+}
+
+uint64_t OsmAnd::RoutingSubsectionData::encodeLocationId( uint32_t x31, uint32_t y31 )
+{
+    return (static_cast<uint64_t>(x31) << 31) | y31;
+}
+
+uint64_t OsmAnd::RoutingSubsectionData::encodeSegmentsGridCellId( uint32_t cellX, uint32_t cellY )
+{
+    return (static_cast<uint64_t>(cellX) << 32) | cellY;
+}
+
+const std::shared_ptr<OsmAnd::RoutingSubsectionsCache> OsmAnd::RoutingSubsectionsCache::instance(new OsmAnd::RoutingSubsectionsCache());
+
+OsmAnd::RoutingSubsectionsCache::RoutingSubsectionsCache()
+    : _pruneThreshold(64)
+    , _retainedSize(0)
+    , _retainedSizeLimit(DefaultRetainedSizeLimit)
+{
+}
+
+OsmAnd::RoutingSubsectionsCache::~RoutingSubsectionsCache()
+{
+}
+
+std::shared_ptr<const OsmAnd::RoutingSubsectionData> OsmAnd::RoutingSubsectionsCache::obtain(
+    const std::shared_ptr<ObfReader>& origin,
+    const std::shared_ptr<const ObfRoutingSubsectionInfo>& subsection,
+    bool* outWasDecoded /*= nullptr*/ )
+{
+    if(outWasDecoded)
+        *outWasDecoded = true;
+    if(!origin->obfFile)
+        return RoutingSubsectionData::decode(origin, subsection);
+
+    Key key;
+    key.filePath = origin->obfFile->filePath;
+    key.creationTimestamp = origin->obtainInfo()->creationTimestamp;
+    key.offset = subsection->offset;
+
+    std::shared_ptr<Entry> entry;
+    {
+        QMutexLocker scopedLocker(&_entriesMutex);
+
+        auto itEntry = _entries.find(key);
+        if(itEntry == _entries.end())
+        {
+            if(_entries.size() >= _pruneThreshold)
+                pruneExpiredEntries();
+            itEntry = _entries.insert(key, std::shared_ptr<Entry>(new Entry()));
+        }
+        entry = *itEntry;
+    }
+
+    // Other subsections are decoded concurrently, only requests of same subsection wait here
+    QMutexLocker scopedLocker(&entry->decodeMutex);
+
+    auto data = entry->data.lock();
+    if(data)
+    {
+        if(outWasDecoded)
+            *outWasDecoded = false;
+    }
+    else
+    {
+        data = RoutingSubsectionData::decode(origin, subsection);
+        entry->data = data;
+    }
+
+    retain(entry.get(), data);
+    return data;
+}
+
+void OsmAnd::RoutingSubsectionsCache::retain( Entry* entry, const std::shared_ptr<const RoutingSubsectionData>& data )
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    if(entry->retainedData)
+    {
+        _retainedEntries.erase(entry->retainedPosition);
+        _retainedSize -= entry->retainedData->memorySize;
+        entry->retainedData.reset();
+    }
+    if(!data || data->memorySize > _retainedSizeLimit)
+        return;
+
+    entry->retainedData = data;
+    _retainedEntries.push_front(entry);
+    entry->retainedPosition = _retainedEntries.begin();
+    _retainedSize += data->memorySize;
+    releaseRetainedEntries(_retainedSizeLimit);
+}
+
+void OsmAnd::RoutingSubsectionsCache::releaseRetainedEntries( size_t sizeLimit )
+{
+    // Released data is still shared through weak reference while contexts use it
+    while(_retainedSize > sizeLimit && !_retainedEntries.isEmpty())
+    {
+        const auto entry = _retainedEntries.last();
+        _retainedEntries.erase(entry->retainedPosition);
+        _retainedSize -= entry->retainedData->memorySize;
+        entry->retainedData.reset();
+    }
+}
+
+void OsmAnd::RoutingSubsectionsCache::pruneExpiredEntries()
+{
+    for(auto itEntry = _entries.begin(); itEntry != _entries.end();)
+    {
+        // Entry is kept while anyone is going to decode into it, otherwise its result would not be shared
+        if((*itEntry)->data.expired() && itEntry->use_count() == 1)
+            itEntry = _entries.erase(itEntry);
+        else
+            ++itEntry;
+    }
+    _pruneThreshold = qMax(64, _entries.size() * 2);
+}
+
+int OsmAnd::RoutingSubsectionsCache::getEntriesCount() const
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    return _entries.size();
+}
+
+void OsmAnd::RoutingSubsectionsCache::setRetainedSizeLimit( size_t sizeLimit )
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    _retainedSizeLimit = sizeLimit;
+    releaseRetainedEntries(_retainedSizeLimit);
+}
+
+size_t OsmAnd::RoutingSubsectionsCache::getRetainedSizeLimit() const
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    return _retainedSizeLimit;
+}
+
+size_t OsmAnd::RoutingSubsectionsCache::getRetainedSize() const
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    return _retainedSize;
+}
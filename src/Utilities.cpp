@@ -435,17 +435,24 @@ OSMAND_CORE_API void OSMAND_CORE_CALL OsmAnd::Utilities::findFiles( const QDir&
 }
 
 OSMAND_CORE_API double OSMAND_CORE_CALL OsmAnd::Utilities::polygonArea( const QVector<PointI>& points )
+{
+    return polygonArea(points.constData(), points.size());
+}
+
+OSMAND_CORE_API double OSMAND_CORE_CALL OsmAnd::Utilities::polygonArea( const PointI* points, const int count )
 {
     double area = 0.0;
 
-    assert(points.first() == points.last());
+    assert(count > 0);
+    assert(points[0] == points[count - 1]);
 
-    auto itPrevPoint = points.cbegin();
-    auto itPoint = itPrevPoint + 1;
-    for(; itPoint != points.cend(); itPrevPoint = itPoint, ++itPoint)
+    auto pPrevPoint = points;
+    auto pPoint = pPrevPoint + 1;
+    const auto pEnd = points + count;
+    for(; pPoint != pEnd; pPrevPoint = pPoint, ++pPoint)
     {
-        const auto& p0 = *itPrevPoint;
-        const auto& p1 = *itPoint;
+        const auto& p0 = *pPrevPoint;
+        const auto& p1 = *pPoint;
 
         area += static_cast<double>(p0.x) * static_cast<double>(p1.y) - static_cast<double>(p1.x) * static_cast<double>(p0.y);
     }
@@ -0,0 +1,541 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <limits>
+
+#include <QFile>
+#include <QAtomicInt>
+
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Concurrent.h>
+#include <OsmAndCore/TilesCollection.h>
+#include <OsmAndCore/Data/ObfFile.h>
+#include <OsmAndCore/Data/ObfReader.h>
+#include <OsmAndCore/Data/ObfMapSectionInfo.h>
+#include <OsmAndCore/Data/ObfMapSectionReader.h>
+#include <OsmAndCore/Data/ObfsCollection.h>
+#include <OsmAndCore/Data/ObfDataInterface.h>
+#include <OsmAndCore/Data/Model/MapObject.h>
+#include <OsmAndCore/Map/MapStyles.h>
+#include <OsmAndCore/Map/MapStyle.h>
+#include <OsmAndCore/Map/MapStyleEvaluator.h>
+#include <OsmAndCore/Map/OfflineMapDataProvider.h>
+#include <OsmAndCore/Map/OfflineMapRasterTileProvider_Software.h>
+
+OsmAnd::Benchmark::Configuration::Configuration()
+    : verbose(false)
+    , test(Test::Unknown)
+    , styleName("default")
+    , bbox(90.0, -180.0, -90.0, 179.9999999999)
+    , zoom(ZoomLevel14)
+    , maxZoom(ZoomLevel14)
+    , metatileSize(4)
+    , threads(32)
+    , iterations(10)
+{
+}
+
+OSMAND_CORE_UTILS_API bool OSMAND_CORE_UTILS_CALL OsmAnd::Benchmark::parseCommandLineArguments( const QStringList& cmdLineArgs, Configuration& cfg, QString& error )
+{
+    for(auto itArg = cmdLineArgs.cbegin(); itArg != cmdLineArgs.cend(); ++itArg)
+    {
+        auto arg = *itArg;
+        if (arg == "-verbose")
+        {
+            cfg.verbose = true;
+        }
+        else if (arg.startsWith("-test="))
+        {
+            const auto testName = arg.mid(strlen("-test="));
+            if(testName == "obfStreams")
+                cfg.test = Test::ObfStreams;
+            else if(testName == "styleEvaluation")
+                cfg.test = Test::StyleEvaluation;
+            else if(testName == "rasterization")
+                cfg.test = Test::Rasterization;
+            else if(testName == "tilesCollection")
+                cfg.test = Test::TilesCollection;
+            else
+            {
+                error = "Unknown test '" + testName + "'";
+                return false;
+            }
+        }
+        else if (arg.startsWith("-obf="))
+        {
+            cfg.obfFile = arg.mid(strlen("-obf="));
+        }
+        else if (arg.startsWith("-style="))
+        {
+            cfg.styleName = arg.mid(strlen("-style="));
+        }
+        else if(arg.startsWith("-bbox="))
+        {
+            auto values = arg.mid(strlen("-bbox=")).split(",");
+            cfg.bbox.left = values[0].toDouble();
+            cfg.bbox.top = values[1].toDouble();
+            cfg.bbox.right = values[2].toDouble();
+            cfg.bbox.bottom =  values[3].toDouble();
+        }
+        else if(arg.startsWith("-zoom="))
+        {
+            cfg.zoom = static_cast<ZoomLevel>(arg.mid(strlen("-zoom=")).toInt());
+        }
+        else if(arg.startsWith("-maxZoom="))
+        {
+            cfg.maxZoom = static_cast<ZoomLevel>(arg.mid(strlen("-maxZoom=")).toInt());
+        }
+        else if(arg.startsWith("-metatileSize="))
+        {
+            cfg.metatileSize = arg.mid(strlen("-metatileSize=")).toUInt();
+        }
+        else if(arg.startsWith("-threads="))
+        {
+            cfg.threads = arg.mid(strlen("-threads=")).toUInt();
+        }
+        else if(arg.startsWith("-iterations="))
+        {
+            cfg.iterations = arg.mid(strlen("-iterations=")).toInt();
+        }
+    }
+
+    if(cfg.test == Test::Unknown)
+    {
+        error = "Test not defined";
+        return false;
+    }
+    if(cfg.iterations <= 0)
+    {
+        error = "Iterations count must be positive";
+        return false;
+    }
+    if(cfg.threads == 0)
+    {
+        error = "Threads count must be positive";
+        return false;
+    }
+    if((cfg.test == Test::ObfStreams || cfg.test == Test::StyleEvaluation || cfg.test == Test::Rasterization) && cfg.obfFile.isEmpty())
+    {
+        error = "OBF file not defined";
+        return false;
+    }
+
+    return true;
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+void run(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkObfStreams(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkStyleEvaluation(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkRasterization(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkTilesCollection(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+#else
+void run(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkObfStreams(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkStyleEvaluation(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkRasterization(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+void benchmarkTilesCollection(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg);
+#endif
+
+OSMAND_CORE_UTILS_API void OSMAND_CORE_UTILS_CALL OsmAnd::Benchmark::runToStdOut( const Configuration& cfg )
+{
+#if defined(_UNICODE) || defined(UNICODE)
+    run(std::wcout, cfg);
+#else
+    run(std::cout, cfg);
+#endif
+}
+
+OSMAND_CORE_UTILS_API QString OSMAND_CORE_UTILS_CALL OsmAnd::Benchmark::runToString( const Configuration& cfg )
+{
+#if defined(_UNICODE) || defined(UNICODE)
+    std::wostringstream output;
+    run(output, cfg);
+    return QString::fromStdWString(output.str());
+#else
+    std::ostringstream output;
+    run(output, cfg);
+    return QString::fromStdString(output.str());
+#endif
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+void run(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#else
+void run(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#endif
+{
+    switch(cfg.test)
+    {
+    case OsmAnd::Benchmark::Test::ObfStreams:
+        benchmarkObfStreams(output, cfg);
+        break;
+    case OsmAnd::Benchmark::Test::StyleEvaluation:
+        benchmarkStyleEvaluation(output, cfg);
+        break;
+    case OsmAnd::Benchmark::Test::Rasterization:
+        benchmarkRasterization(output, cfg);
+        break;
+    case OsmAnd::Benchmark::Test::TilesCollection:
+        benchmarkTilesCollection(output, cfg);
+        break;
+    default:
+        output << xT("Unknown test") << std::endl;
+        break;
+    }
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+void benchmarkObfStreams(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#else
+void benchmarkObfStreams(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#endif
+{
+    if(!QFile::exists(cfg.obfFile))
+    {
+        output << xT("OBF '") << QStringToStlString(cfg.obfFile) << xT("' does not exist.") << std::endl;
+        return;
+    }
+
+    const OsmAnd::AreaI bbox31(
+        OsmAnd::Utilities::get31TileNumberY(cfg.bbox.top),
+        OsmAnd::Utilities::get31TileNumberX(cfg.bbox.left),
+        OsmAnd::Utilities::get31TileNumberY(cfg.bbox.bottom),
+        OsmAnd::Utilities::get31TileNumberX(cfg.bbox.right));
+
+    // Reader over ObfFile uses memory-mapped stream, while reader over QIODevice uses QZeroCopyInputStream
+    std::shared_ptr<const OsmAnd::ObfFile> obfFile(new OsmAnd::ObfFile(cfg.obfFile));
+    std::shared_ptr<OsmAnd::ObfReader> mappedReader(new OsmAnd::ObfReader(obfFile));
+    std::shared_ptr<OsmAnd::ObfReader> deviceReader(new OsmAnd::ObfReader(std::shared_ptr<QIODevice>(new QFile(cfg.obfFile))));
+
+    const std::pair<const char*, std::shared_ptr<OsmAnd::ObfReader> > subjects[] = {
+        std::make_pair("QMemoryMappedInputStream", mappedReader),
+        std::make_pair("QZeroCopyInputStream", deviceReader),
+    };
+    for(auto idx = 0u; idx < sizeof(subjects) / sizeof(subjects[0]); idx++)
+    {
+        const auto& subject = subjects[idx];
+        const auto& obfReader = subject.second;
+
+        // Warm up: parse OBF structure, rules and root nodes, so that only readout is measured
+        const auto& obfInfo = obfReader->obtainInfo();
+        for(auto itMapSection = obfInfo->mapSections.cbegin(); itMapSection != obfInfo->mapSections.cend(); ++itMapSection)
+            OsmAnd::ObfMapSectionReader::loadMapObjects(obfReader, *itMapSection, cfg.zoom, &bbox31);
+
+        auto mapObjectsCount = 0;
+        const auto begin = std::chrono::high_resolution_clock::now();
+        for(auto iteration = 0; iteration < cfg.iterations; iteration++)
+        {
+            QList< std::shared_ptr<const OsmAnd::Model::MapObject> > mapObjects;
+            for(auto itMapSection = obfInfo->mapSections.cbegin(); itMapSection != obfInfo->mapSections.cend(); ++itMapSection)
+                OsmAnd::ObfMapSectionReader::loadMapObjects(obfReader, *itMapSection, cfg.zoom, &bbox31, &mapObjects);
+            mapObjectsCount = mapObjects.count();
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> elapsed = end - begin;
+
+        output << subject.first << xT(": ") << mapObjectsCount << xT(" map objects, ")
+            << elapsed.count() / cfg.iterations << xT("ms per readout (") << cfg.iterations << xT(" iterations)") << std::endl;
+    }
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+void benchmarkStyleEvaluation(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#else
+void benchmarkStyleEvaluation(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#endif
+{
+    if(!QFile::exists(cfg.obfFile))
+    {
+        output << xT("OBF '") << QStringToStlString(cfg.obfFile) << xT("' does not exist.") << std::endl;
+        return;
+    }
+
+    OsmAnd::MapStyles stylesCollection;
+    std::shared_ptr<const OsmAnd::MapStyle> style;
+    if(!stylesCollection.obtainStyle(cfg.styleName, style))
+    {
+        output << xT("Failed to resolve style '") << QStringToStlString(cfg.styleName) << xT("'") << std::endl;
+        return;
+    }
+
+    const OsmAnd::AreaI bbox31(
+        OsmAnd::Utilities::get31TileNumberY(cfg.bbox.top),
+        OsmAnd::Utilities::get31TileNumberX(cfg.bbox.left),
+        OsmAnd::Utilities::get31TileNumberY(cfg.bbox.bottom),
+        OsmAnd::Utilities::get31TileNumberX(cfg.bbox.right));
+
+    // Load all map objects of area (a dense city tile is expected)
+    std::shared_ptr<const OsmAnd::ObfFile> obfFile(new OsmAnd::ObfFile(cfg.obfFile));
+    std::shared_ptr<OsmAnd::ObfReader> obfReader(new OsmAnd::ObfReader(obfFile));
+    const auto& obfInfo = obfReader->obtainInfo();
+    QList< std::shared_ptr<const OsmAnd::Model::MapObject> > mapObjects;
+    for(auto itMapSection = obfInfo->mapSections.cbegin(); itMapSection != obfInfo->mapSections.cend(); ++itMapSection)
+        OsmAnd::ObfMapSectionReader::loadMapObjects(obfReader, *itMapSection, cfg.zoom, &bbox31, &mapObjects);
+
+    // Resolve style string ids of all types once, as rasterizer does per OBF rule id
+    QVector<uint32_t> typesStringIds;
+    for(auto itMapObject = mapObjects.cbegin(); itMapObject != mapObjects.cend(); ++itMapObject)
+    {
+        const auto& mapObject = *itMapObject;
+        for(auto itType = mapObject->types.cbegin(); itType != mapObject->types.cend(); ++itType)
+        {
+            uint32_t tagStringId;
+            if(!style->lookupStringId(itType->tag, tagStringId))
+                tagStringId = std::numeric_limits<uint32_t>::max();
+            uint32_t valueStringId;
+            if(!style->lookupStringId(itType->value, valueStringId))
+                valueStringId = std::numeric_limits<uint32_t>::max();
+            typesStringIds.push_back(tagStringId);
+            typesStringIds.push_back(valueStringId);
+        }
+    }
+
+    const auto& defs = OsmAnd::MapStyle::builtinValueDefinitions;
+    const auto setObjectInputs = [&cfg, &defs](OsmAnd::MapStyleEvaluator& evaluator, const std::shared_ptr<const OsmAnd::Model::MapObject>& mapObject)
+    {
+        evaluator.setIntegerValue(defs.INPUT_MINZOOM, cfg.zoom);
+        evaluator.setIntegerValue(defs.INPUT_MAXZOOM, cfg.zoom);
+        evaluator.setIntegerValue(defs.INPUT_LAYER, mapObject->getSimpleLayerValue());
+        evaluator.setBooleanValue(defs.INPUT_AREA, mapObject->isArea);
+        evaluator.setBooleanValue(defs.INPUT_POINT, mapObject->points31.size() == 1);
+        evaluator.setBooleanValue(defs.INPUT_CYCLE, mapObject->isClosedFigure());
+    };
+
+    // Evaluator created per each type and fed with strings, versus single evaluator reset between types and fed with string ids
+    for(auto subject = 0; subject < 2; subject++)
+    {
+        const auto reuseEvaluator = (subject == 1);
+
+        auto evaluationsCount = 0;
+        auto matchedCount = 0;
+        OsmAnd::MapStyleEvaluator sharedEvaluator(style, 1.0f, OsmAnd::MapStyleRulesetType::Order);
+        const auto begin = std::chrono::high_resolution_clock::now();
+        for(auto iteration = 0; iteration < cfg.iterations; iteration++)
+        {
+            evaluationsCount = 0;
+            matchedCount = 0;
+            auto pTypeStringIds = typesStringIds.constData();
+            for(auto itMapObject = mapObjects.cbegin(); itMapObject != mapObjects.cend(); ++itMapObject)
+            {
+                const auto& mapObject = *itMapObject;
+                for(auto itType = mapObject->types.cbegin(); itType != mapObject->types.cend(); ++itType, pTypeStringIds += 2)
+                {
+                    bool matched;
+                    if(reuseEvaluator)
+                    {
+                        sharedEvaluator.reset(mapObject);
+                        sharedEvaluator.setStringIdValue(defs.INPUT_TAG, pTypeStringIds[0]);
+                        sharedEvaluator.setStringIdValue(defs.INPUT_VALUE, pTypeStringIds[1]);
+                        setObjectInputs(sharedEvaluator, mapObject);
+                        matched = sharedEvaluator.evaluate();
+                    }
+                    else
+                    {
+                        OsmAnd::MapStyleEvaluator evaluator(style, 1.0f, OsmAnd::MapStyleRulesetType::Order, mapObject);
+                        evaluator.setStringValue(defs.INPUT_TAG, itType->tag);
+                        evaluator.setStringValue(defs.INPUT_VALUE, itType->value);
+                        setObjectInputs(evaluator, mapObject);
+                        matched = evaluator.evaluate();
+                    }
+
+                    evaluationsCount++;
+                    if(matched)
+                        matchedCount++;
+                }
+            }
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> elapsed = end - begin;
+
+        output << (reuseEvaluator ? xT("Reused evaluator with string ids") : xT("Evaluator per type with strings")) << xT(": ")
+            << mapObjects.count() << xT(" map objects, ") << evaluationsCount << xT(" evaluations (") << matchedCount << xT(" matched), ")
+            << elapsed.count() / cfg.iterations << xT("ms per pass (") << cfg.iterations << xT(" iterations)") << std::endl;
+    }
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+void benchmarkRasterization(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#else
+void benchmarkRasterization(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#endif
+{
+    if(!QFile::exists(cfg.obfFile))
+    {
+        output << xT("OBF '") << QStringToStlString(cfg.obfFile) << xT("' does not exist.") << std::endl;
+        return;
+    }
+
+    OsmAnd::MapStyles stylesCollection;
+    std::shared_ptr<const OsmAnd::MapStyle> style;
+    if(!stylesCollection.obtainStyle(cfg.styleName, style))
+    {
+        output << xT("Failed to resolve style '") << QStringToStlString(cfg.styleName) << xT("'") << std::endl;
+        return;
+    }
+
+    std::shared_ptr<OsmAnd::ObfsCollection> obfsCollection(new OsmAnd::ObfsCollection());
+    obfsCollection->registerExplicitFile(cfg.obfFile);
+
+    const OsmAnd::AreaI bbox31(
+        OsmAnd::Utilities::get31TileNumberY(cfg.bbox.top),
+        OsmAnd::Utilities::get31TileNumberX(cfg.bbox.left),
+        OsmAnd::Utilities::get31TileNumberY(cfg.bbox.bottom),
+        OsmAnd::Utilities::get31TileNumberX(cfg.bbox.right));
+
+    // Collect tiles of area for all zoom levels, lower zoom levels go first. Also warm up OBF structures,
+    // so that both subjects start in same conditions
+    const auto maxZoom = qMax(cfg.zoom, cfg.maxZoom);
+    QList< std::pair<OsmAnd::TileId, OsmAnd::ZoomLevel> > tiles;
+    for(auto zoom = cfg.zoom; zoom <= maxZoom; zoom = static_cast<OsmAnd::ZoomLevel>(zoom + 1))
+    {
+        const auto x0 = static_cast<int32_t>(OsmAnd::Utilities::getTileNumberX(zoom, cfg.bbox.left));
+        const auto x1 = static_cast<int32_t>(OsmAnd::Utilities::getTileNumberX(zoom, cfg.bbox.right));
+        const auto y0 = static_cast<int32_t>(OsmAnd::Utilities::getTileNumberY(zoom, cfg.bbox.top));
+        const auto y1 = static_cast<int32_t>(OsmAnd::Utilities::getTileNumberY(zoom, cfg.bbox.bottom));
+        for(auto y = y0; y <= y1; y++)
+        {
+            for(auto x = x0; x <= x1; x++)
+            {
+                OsmAnd::TileId tileId;
+                tileId.x = x;
+                tileId.y = y;
+                tiles.push_back(std::make_pair(tileId, zoom));
+            }
+        }
+
+        obfsCollection->obtainDataInterface()->obtainMapObjects(nullptr, nullptr, bbox31, zoom);
+    }
+
+    // Tiles one by one through obtainTile(), versus pipelined readout, preparation and drawing of tiles and of metatiles
+    const char* const subjectsNames[] = {
+        "Serial",
+        "Pipelined",
+        "Pipelined metatiles",
+    };
+    for(auto subject = 0; subject < 3; subject++)
+    {
+        const auto pipelined = (subject != 0);
+        OsmAnd::OfflineMapRasterTileProvider_Software::PipelineConfiguration pipelineConfiguration;
+        if(subject == 2)
+            pipelineConfiguration.metatileSize = cfg.metatileSize;
+
+        QAtomicInt nonEmptyTilesCount(0);
+        std::chrono::duration<double, std::milli> elapsed(0);
+        for(auto iteration = 0; iteration < cfg.iterations; iteration++)
+        {
+            // Fresh providers each time, so that no tiles are reused
+            std::shared_ptr<OsmAnd::OfflineMapDataProvider> dataProvider(new OsmAnd::OfflineMapDataProvider(obfsCollection, style, 1.0f));
+            OsmAnd::OfflineMapRasterTileProvider_Software tileProvider(dataProvider);
+
+            nonEmptyTilesCount.store(0);
+            const auto begin = std::chrono::high_resolution_clock::now();
+            if(pipelined)
+            {
+                tileProvider.rasterizeTiles(tiles,
+                    [&nonEmptyTilesCount](const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom, const bool success, const std::shared_ptr<const OsmAnd::MapTile>& tile)
+                    {
+                        if(success && tile)
+                            nonEmptyTilesCount.fetchAndAddOrdered(1);
+                    }, pipelineConfiguration);
+            }
+            else
+            {
+                for(auto itTile = tiles.cbegin(); itTile != tiles.cend(); ++itTile)
+                {
+                    std::shared_ptr<const OsmAnd::MapTile> tile;
+                    if(tileProvider.obtainTile(itTile->first, itTile->second, tile) && tile)
+                        nonEmptyTilesCount.fetchAndAddOrdered(1);
+                }
+            }
+            const auto end = std::chrono::high_resolution_clock::now();
+            elapsed += end - begin;
+        }
+
+        const auto tilesPerSecond = (tiles.count() * cfg.iterations) / (elapsed.count() / 1000.0);
+        output << subjectsNames[subject] << xT(": ")
+            << tiles.count() << xT(" tiles (") << nonEmptyTilesCount.load() << xT(" not empty), ")
+            << elapsed.count() / cfg.iterations << xT("ms per pass, ") << tilesPerSecond << xT(" tiles/sec (")
+            << cfg.iterations << xT(" iterations)") << std::endl;
+    }
+}
+
+class BenchmarkTileEntry : public OsmAnd::TilesCollectionEntry<BenchmarkTileEntry>
+{
+public:
+    BenchmarkTileEntry(const OsmAnd::TilesCollection<BenchmarkTileEntry>& collection, const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom)
+        : TilesCollectionEntry(collection, tileId, zoom)
+    {}
+};
+
+#if defined(_UNICODE) || defined(UNICODE)
+void benchmarkTilesCollection(std::wostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#else
+void benchmarkTilesCollection(std::ostream &output, const OsmAnd::Benchmark::Configuration& cfg)
+#endif
+{
+    // Working set resembles tiles of a few screens: 64x64 tiles at 3 zoom levels
+    const auto tilesPerSide = 64u;
+    const auto operationsPerThread = 100000 * cfg.iterations;
+
+    const std::function<BenchmarkTileEntry* (const OsmAnd::TilesCollection<BenchmarkTileEntry>&, const OsmAnd::TileId, const OsmAnd::ZoomLevel)> allocator =
+        [](const OsmAnd::TilesCollection<BenchmarkTileEntry>& collection, const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom) -> BenchmarkTileEntry*
+        {
+            return new BenchmarkTileEntry(collection, tileId, zoom);
+        };
+
+    // Single thread gives reference throughput, that configured number of threads should scale
+    const unsigned int threadsCounts[] = { 1u, cfg.threads };
+    for(auto idx = 0u; idx < sizeof(threadsCounts) / sizeof(threadsCounts[0]); idx++)
+    {
+        const auto threadsCount = threadsCounts[idx];
+
+        OsmAnd::TilesCollection<BenchmarkTileEntry> collection;
+        QList< std::shared_ptr<OsmAnd::Concurrent::Thread> > threads;
+        for(auto threadIdx = 0u; threadIdx < threadsCount; threadIdx++)
+        {
+            // Mostly lookups of existing entries, with every 16th operation removing entry
+            const auto threadProcedure =
+                [&cfg, &collection, &allocator, tilesPerSide, operationsPerThread, threadIdx]()
+                {
+                    uint32_t random = 2463534242u + threadIdx;
+                    for(auto operationIdx = 0; operationIdx < operationsPerThread; operationIdx++)
+                    {
+                        random ^= random << 13;
+                        random ^= random >> 17;
+                        random ^= random << 5;
+
+                        OsmAnd::TileId tileId;
+                        tileId.x = random % tilesPerSide;
+                        tileId.y = (random >> 8) % tilesPerSide;
+                        const auto zoom = static_cast<OsmAnd::ZoomLevel>(qMin(cfg.zoom + (random >> 16) % 3, static_cast<uint32_t>(OsmAnd::MaxZoomLevel)));
+
+                        if((random >> 24) % 16 == 0)
+                        {
+                            collection.removeEntry(tileId, zoom);
+                            continue;
+                        }
+
+                        std::shared_ptr<BenchmarkTileEntry> entry;
+                        collection.obtainOrAllocateTileEntry(entry, tileId, zoom, allocator);
+                    }
+                };
+            threads.push_back(std::shared_ptr<OsmAnd::Concurrent::Thread>(new OsmAnd::Concurrent::Thread(threadProcedure)));
+        }
+
+        const auto begin = std::chrono::high_resolution_clock::now();
+        for(auto itThread = threads.cbegin(); itThread != threads.cend(); ++itThread)
+            (*itThread)->start();
+        for(auto itThread = threads.cbegin(); itThread != threads.cend(); ++itThread)
+            (*itThread)->wait();
+        const auto end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> elapsed = end - begin;
+
+        const auto operationsCount = static_cast<double>(operationsPerThread) * threadsCount;
+        output << threadsCount << xT(" threads: ") << operationsCount << xT(" operations in ") << elapsed.count() << xT("ms, ")
+            << operationsCount / (elapsed.count() / 1000.0) << xT(" operations/sec") << std::endl;
+    }
+}
@@ -0,0 +1,79 @@
+/**
+* @file
+*
+* @section LICENSE
+*
+* OsmAnd - Android navigation software based on OSM maps.
+* Copyright (C) 2010-2013  OsmAnd Authors listed in AUTHORS file
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __BENCHMARK_H_
+#define __BENCHMARK_H_
+
+#include <memory>
+
+#include <QString>
+#include <QStringList>
+#include <QDir>
+#include <QFile>
+
+#include <OsmAndCoreUtils.h>
+#include <OsmAndCore/CommonTypes.h>
+
+namespace OsmAnd
+{
+    namespace Benchmark
+    {
+        enum class Test
+        {
+            Unknown = -1,
+
+            // Map data readout through memory-mapped and plain QIODevice streams
+            ObfStreams,
+
+            // Evaluation of 'order' style rules for all map objects of area
+            StyleEvaluation,
+
+            // Rasterization of all tiles of area in zoom range, serially, by pipeline and by pipeline of metatiles
+            Rasterization,
+
+            // Concurrent lookups, allocations and removals of tile entries
+            TilesCollection,
+        };
+
+        struct OSMAND_CORE_UTILS_API Configuration
+        {
+            Configuration();
+
+            bool verbose;
+            Test test;
+            QString obfFile;
+            QString styleName;
+            AreaD bbox;
+            ZoomLevel zoom;
+            ZoomLevel maxZoom;
+            unsigned int metatileSize;
+            unsigned int threads;
+            int iterations;
+        };
+        OSMAND_CORE_UTILS_API bool OSMAND_CORE_UTILS_CALL parseCommandLineArguments(const QStringList& cmdLineArgs, Configuration& cfg, QString& error);
+        OSMAND_CORE_UTILS_API void OSMAND_CORE_UTILS_CALL runToStdOut(const Configuration& cfg);
+        OSMAND_CORE_UTILS_API QString OSMAND_CORE_UTILS_CALL runToString(const Configuration& cfg);
+    } // namespace Benchmark
+
+} // namespace OsmAnd
+
+#endif // __BENCHMARK_H_
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <ctime>
 #include <chrono>
+#include <limits>
 
 #include <QDateTime>
 #include <QTextStream>
@@ -13,6 +14,7 @@
 #include <OsmAndCore/Utilities.h>
 #include <OsmAndCore/Routing/RoutePlanner.h>
 #include <OsmAndCore/Routing/RoutePlannerContext.h>
+#include <OsmAndCore/Routing/RoutingHierarchy.h>
 
 OsmAnd::Voyager::Configuration::Configuration()
     : verbose(false)
@@ -25,6 +27,9 @@ OsmAnd::Voyager::Configuration::Configuration()
     , endLatitude(0)
     , endLongitude(0)
     , leftSide(false)
+    , benchmarkIterations(5)
+    , buildHierarchy(false)
+    , useHierarchy(false)
     , routingConfig(new RoutingConfiguration())
 {
 }
@@ -117,6 +122,36 @@ OSMAND_CORE_UTILS_API bool OSMAND_CORE_UTILS_CALL OsmAnd::Voyager::parseCommandL
         {
             cfg.gpxPath = arg.mid(strlen("-gpx="));
         }
+        else if (arg.startsWith("-benchmarkRoute="))
+        {
+            auto coords = arg.mid(strlen("-benchmarkRoute=")).split(QChar(';'));
+            if(coords.size() != 4)
+            {
+                error = "Bad benchmark route, expected startLat;startLon;endLat;endLon";
+                return false;
+            }
+            const auto start = std::pair<double, double>(coords[0].toDouble(), coords[1].toDouble());
+            const auto end = std::pair<double, double>(coords[2].toDouble(), coords[3].toDouble());
+            cfg.benchmarkRoutes.push_back(std::make_pair(start, end));
+        }
+        else if (arg.startsWith("-benchmarkIterations="))
+        {
+            bool ok;
+            cfg.benchmarkIterations = arg.mid(strlen("-benchmarkIterations=")).toInt(&ok);
+            if(!ok || cfg.benchmarkIterations <= 0)
+            {
+                error = "Bad benchmark iterations count";
+                return false;
+            }
+        }
+        else if (arg == "-buildHierarchy")
+        {
+            cfg.buildHierarchy = true;
+        }
+        else if (arg == "-useHierarchy")
+        {
+            cfg.useHierarchy = true;
+        }
     }
 
     if(!wasObfRootSpecified)
@@ -134,9 +169,14 @@ OSMAND_CORE_UTILS_API bool OSMAND_CORE_UTILS_CALL OsmAnd::Voyager::parseCommandL
 
 #if defined(_UNICODE) || defined(UNICODE)
 void performJourney(std::wostream &output, const OsmAnd::Voyager::Configuration& cfg);
+void performBenchmark(std::wostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData);
+void buildHierarchies(std::wostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData);
 #else
 void performJourney(std::ostream &output, const OsmAnd::Voyager::Configuration& cfg);
+void performBenchmark(std::ostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData);
+void buildHierarchies(std::ostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData);
 #endif
+void attachHierarchies(const OsmAnd::Voyager::Configuration& cfg, OsmAnd::RoutePlannerContext& plannerContext);
 
 OSMAND_CORE_UTILS_API void OSMAND_CORE_UTILS_CALL OsmAnd::Voyager::logJourneyToStdOut( const Configuration& cfg )
 {
@@ -183,7 +223,18 @@ void performJourney(std::ostream &output, const OsmAnd::Voyager::Configuration&
         obfData.push_back(obfReader);
     }
 
+    if(cfg.buildHierarchy)
+        buildHierarchies(output, cfg, obfData);
+
+    if(!cfg.benchmarkRoutes.isEmpty())
+    {
+        performBenchmark(output, cfg, obfData);
+        return;
+    }
+
     OsmAnd::RoutePlannerContext plannerContext(obfData, cfg.routingConfig, cfg.vehicle, false);
+    if(cfg.useHierarchy)
+        attachHierarchies(cfg, plannerContext);
     std::shared_ptr<const OsmAnd::Model::Road> startRoad;
     if(!OsmAnd::RoutePlanner::findClosestRoadPoint(&plannerContext, cfg.startLatitude, cfg.startLongitude, &startRoad))
     {
@@ -448,3 +499,123 @@ void performJourney(std::ostream &output, const OsmAnd::Voyager::Configuration&
     if(cfg.generateXml)
         output << xT("</test>") << std::endl;
 }
+
+#if defined(_UNICODE) || defined(UNICODE)
+void performBenchmark(std::wostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData)
+#else
+void performBenchmark(std::ostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData)
+#endif
+{
+    // With hierarchies each route is calculated both by plain A* and using hierarchies
+    const auto modesCount = cfg.useHierarchy ? 2 : 1;
+    double totalWarmTime[2] = { 0.0, 0.0 };
+    int warmRuns[2] = { 0, 0 };
+    for(auto itRoute = cfg.benchmarkRoutes.cbegin(); itRoute != cfg.benchmarkRoutes.cend(); ++itRoute)
+    {
+        const auto& start = itRoute->first;
+        const auto& end = itRoute->second;
+
+        QList< std::pair<double, double> > points;
+        points.push_back(start);
+        points.push_back(end);
+
+        output << xT("Route (LAT ") << start.first << xT("; LON ") << start.second << xT(") -> (LAT ") << end.first << xT("; LON ") << end.second << xT("):") << std::endl;
+
+        float routeTime[2] = { 0.0f, 0.0f };
+        for(auto mode = 0; mode < modesCount; mode++)
+        {
+            if(cfg.useHierarchy)
+                output << (mode == 0 ? xT("\tA*:") : xT("\thierarchy:")) << std::endl;
+
+            // First iteration also loads road tiles, all following ones reuse them
+            OsmAnd::RoutePlannerContext plannerContext(obfData, cfg.routingConfig, cfg.vehicle, false);
+            if(mode == 1)
+                attachHierarchies(cfg, plannerContext);
+            auto minTime = std::numeric_limits<double>::max();
+            auto maxTime = 0.0;
+            auto sumTime = 0.0;
+            for(auto iteration = 0; iteration < cfg.benchmarkIterations; iteration++)
+            {
+                const auto calculationStart = std::chrono::steady_clock::now();
+                const auto result = OsmAnd::RoutePlanner::calculateRoute(&plannerContext, points, cfg.leftSide, nullptr);
+                const auto calculationFinish = std::chrono::steady_clock::now();
+                const auto time = std::chrono::duration<double, std::milli>(calculationFinish - calculationStart).count();
+
+                if(iteration == 0)
+                {
+                    auto totalDistance = 0.0f;
+                    for(auto itSegment = result.list.cbegin(); itSegment != result.list.cend(); ++itSegment)
+                    {
+                        totalDistance += (*itSegment)->distance;
+                        routeTime[mode] += (*itSegment)->time;
+                    }
+
+                    output << xT("\tcold: ") << time << xT(" ms, ") << result.list.size() << xT(" segments, ") << totalDistance << xT(" m, ") << routeTime[mode] << xT(" s");
+                    if(!result.warnMessage.isEmpty())
+                        output << xT(" (") << QStringToStlString(result.warnMessage) << xT(")");
+                    output << std::endl;
+                    continue;
+                }
+
+                minTime = qMin(minTime, time);
+                maxTime = qMax(maxTime, time);
+                sumTime += time;
+                if(cfg.verbose)
+                    output << xT("\t#") << iteration << xT(": ") << time << xT(" ms") << std::endl;
+            }
+
+            if(cfg.benchmarkIterations > 1)
+            {
+                const auto runs = cfg.benchmarkIterations - 1;
+                output << xT("\twarm: avg ") << sumTime / runs << xT(" ms, min ") << minTime << xT(" ms, max ") << maxTime << xT(" ms") << std::endl;
+                totalWarmTime[mode] += sumTime;
+                warmRuns[mode] += runs;
+            }
+        }
+
+        if(cfg.useHierarchy && routeTime[0] > 0.0f)
+            output << xT("\troute time difference: ") << (routeTime[1] - routeTime[0]) / routeTime[0] * 100.0f << xT("%") << std::endl;
+    }
+
+    if(warmRuns[0] > 0)
+        output << xT("Average warm route calculation: ") << totalWarmTime[0] / warmRuns[0] << xT(" ms") << std::endl;
+    if(warmRuns[1] > 0)
+        output << xT("Average warm route calculation using hierarchy: ") << totalWarmTime[1] / warmRuns[1] << xT(" ms") << std::endl;
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+void buildHierarchies(std::wostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData)
+#else
+void buildHierarchies(std::ostream &output, const OsmAnd::Voyager::Configuration& cfg, const QList< std::shared_ptr<OsmAnd::ObfReader> >& obfData)
+#endif
+{
+    for(auto obfIdx = 0; obfIdx < obfData.size(); obfIdx++)
+    {
+        const auto& obfReader = obfData[obfIdx];
+        if(obfReader->obtainInfo()->routingSections.isEmpty())
+            continue;
+
+        QList< std::shared_ptr<OsmAnd::ObfReader> > sources;
+        sources.push_back(obfReader);
+        OsmAnd::RoutePlannerContext plannerContext(sources, cfg.routingConfig, cfg.vehicle, false);
+
+        const auto buildStart = std::chrono::steady_clock::now();
+        const auto hierarchy = OsmAnd::RoutePlanner::buildRoutingHierarchy(&plannerContext, obfReader);
+        const auto buildFinish = std::chrono::steady_clock::now();
+
+        const auto fileName = OsmAnd::RoutingHierarchy::getSidecarFileName(cfg.obfs[obfIdx].absoluteFilePath(), plannerContext.profileContext->profile->name);
+        output << xT("Hierarchy ") << QStringToStlString(fileName) << xT(": ");
+        if(!hierarchy || !hierarchy->saveTo(fileName))
+        {
+            output << xT("failed") << std::endl;
+            continue;
+        }
+        output << hierarchy->getNodesCount() << xT(" nodes, ") << hierarchy->getEdgesCount() << xT(" edges, ")
+            << std::chrono::duration<double, std::milli>(buildFinish - buildStart).count() << xT(" ms") << std::endl;
+    }
+}
+
+void attachHierarchies(const OsmAnd::Voyager::Configuration& cfg, OsmAnd::RoutePlannerContext& plannerContext)
+{
+    plannerContext.attachRoutingHierarchies();
+}
@@ -55,6 +55,15 @@ namespace OsmAnd
             bool leftSide;
             QString gpxPath;
 
+            // When set, each start/end pair is routed benchmarkIterations times instead of performing the journey
+            QList< std::pair< std::pair<double, double>, std::pair<double, double> > > benchmarkRoutes;
+            int benchmarkIterations;
+
+            // Build routing hierarchies of all OBFs and store them next to OBF files
+            bool buildHierarchy;
+            // Use routing hierarchies stored next to OBF files. Benchmark compares routes with and without them
+            bool useHierarchy;
+
             std::shared_ptr<RoutingConfiguration> routingConfig;
         };
         OSMAND_CORE_UTILS_API bool OSMAND_CORE_UTILS_CALL parseCommandLineArguments(const QStringList& cmdLineArgs, Configuration& cfg, QString& error);